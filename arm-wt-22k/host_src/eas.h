@@ -98,6 +98,15 @@ typedef enum
 #define PCM_FLAGS_UNSIGNED      0x00000010  /* unsigned format */
 #define PCM_FLAGS_STREAMING     0x80000000  /* streaming mode */
 
+/* per-instance configuration for EAS_InitEx, zero selects the build default */
+typedef struct
+{
+    EAS_I32     blockSize;      /* samples per render block, power of two */
+    EAS_I32     controlPeriod;  /* samples between envelope/LFO updates, power of two <= blockSize */
+    EAS_I32     sampleRate;     /* output sample rate in Hz */
+    EAS_I32     maxVoices;      /* voices allocated for the instance, EAS_SetSynthPolyphony limits the voices in use */
+} S_EAS_INIT_CONFIG;
+
 /* maximum volume setting */
 #define EAS_MAX_VOLUME          196
 #define EAS_REF_VOLUME          100
@@ -118,6 +127,60 @@ typedef enum
 */
 EAS_PUBLIC EAS_RESULT EAS_Init (EAS_DATA_HANDLE *ppEASData);
 
+/*----------------------------------------------------------------------------
+ * EAS_InitEx()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Initialize the synthesizer library with per-instance settings.
+ *
+ * The block size sets the number of samples EAS_Render produces per
+ * call. It must be a power of two between 32 and 1024; the static
+ * memory model only supports the build default.
+ *
+ * The control period sets how often voices update their envelopes,
+ * LFOs and gain ramps. It must be a power of two between 32 and the
+ * block size. The default is the build default block size, or the
+ * block size if that is smaller. Longer periods reduce the per-voice
+ * overhead at the cost of coarser envelopes.
+ *
+ * The sample rate sets the output rate of the instance. Supported rates
+ * are 8000, 11025, 16000, 20000, 22050, 24000, 32000, 44100, 48000,
+ * 88200 and 96000 Hz; the static memory model only supports the build
+ * default. The sound library is still built for the build default rate,
+ * pitches, filters, envelopes and effects are scaled to the instance rate.
+ *
+ * The voice capacity sets how many voices the instance allocates, from 1
+ * to 1024; the static memory model only supports the build default,
+ * S_EAS_LIB_CONFIG.maxVoices. The polyphony starts at the capacity and
+ * EAS_SetSynthPolyphony can lower it. Memory and the per-block cost of
+ * voice management follow the capacity.
+ *
+ * Inputs:
+ *  ppEASData       - pointer to data handle variable for this instance
+ *  pConfig         - instance settings, NULL for the build defaults
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_InitEx (EAS_DATA_HANDLE *ppEASData, const S_EAS_INIT_CONFIG *pConfig);
+
+/*----------------------------------------------------------------------------
+ * EAS_GetInitConfig()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the settings in effect for this instance, with defaults resolved.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pConfig         - receives the instance settings
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_GetInitConfig (EAS_DATA_HANDLE pEASData, S_EAS_INIT_CONFIG *pConfig);
+
 /*----------------------------------------------------------------------------
  * EAS_Config()
  *----------------------------------------------------------------------------
@@ -158,7 +221,8 @@ EAS_PUBLIC EAS_RESULT EAS_Shutdown (EAS_DATA_HANDLE pEASData);
  * Inputs:
  *  pEASData        - buffer for internal EAS data
  *  pOut            - output buffer pointer
- *  nNumRequested   - requested num samples to generate
+ *  nNumRequested   - requested num samples to generate, must equal the
+ *                    block size of the instance
  *  pnNumGenerated  - actual number of samples generated
  *
  * Outputs:
@@ -168,6 +232,77 @@ EAS_PUBLIC EAS_RESULT EAS_Shutdown (EAS_DATA_HANDLE pEASData);
 */
 EAS_PUBLIC EAS_RESULT EAS_Render (EAS_DATA_HANDLE pEASData, EAS_PCM *pOut, EAS_I32 numRequested, EAS_I32 *pNumGenerated);
 
+/*----------------------------------------------------------------------------
+ * EAS_RenderFrames()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Parse the Midi data and render any number of frames of PCM audio data.
+ * Unlike EAS_Render, the request does not have to be a multiple of the
+ * mix buffer size. Frames of a partially consumed block are kept by the
+ * library and returned first on the next call. Opening, closing or
+ * locating a stream drops them. While frames are kept, EAS_Render,
+ * EAS_RenderFloat and EAS_RenderFloatPlanar return
+ * EAS_ERROR_NOT_VALID_IN_THIS_STATE.
+ *
+ * Inputs:
+ *  pEASData        - buffer for internal EAS data
+ *  pOut            - output buffer pointer
+ *  numFrames       - requested number of frames to generate
+ *  pNumGenerated   - actual number of frames generated
+ *
+ * Outputs:
+ *  EAS_SUCCESS if PCM data was successfully rendered
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_RenderFrames (EAS_DATA_HANDLE pEASData, EAS_PCM *pOut, EAS_I32 numFrames, EAS_I32 *pNumGenerated);
+
+/*----------------------------------------------------------------------------
+ * EAS_RenderFloat()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Parse the Midi data and render interleaved float audio data. The samples
+ * are scaled directly from the 32-bit mix buffer so that 16-bit full scale
+ * maps to +/-1.0, and are not clipped. As with EAS_Render, the request must
+ * match the mix buffer size.
+ *
+ * Inputs:
+ *  pEASData        - buffer for internal EAS data
+ *  pOut            - output buffer pointer
+ *  numRequested    - requested num samples to generate
+ *  pNumGenerated   - actual number of samples generated
+ *
+ * Outputs:
+ *  EAS_SUCCESS if audio data was successfully rendered
+ *
+ * Notes:
+ *  Post-mix effects that work on 16-bit audio (reverb and chorus with the
+ *  CC override set) still use the 16-bit stage, and their output is
+ *  converted to float.
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_RenderFloat (EAS_DATA_HANDLE pEASData, float *pOut, EAS_I32 numRequested, EAS_I32 *pNumGenerated);
+
+/*----------------------------------------------------------------------------
+ * EAS_RenderFloatPlanar()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Same as EAS_RenderFloat, but writes each output channel to its own
+ * buffer.
+ *
+ * Inputs:
+ *  pEASData        - buffer for internal EAS data
+ *  ppOut           - one output buffer pointer per channel (see numChannels)
+ *  numRequested    - requested num samples to generate
+ *  pNumGenerated   - actual number of samples generated
+ *
+ * Outputs:
+ *  EAS_SUCCESS if audio data was successfully rendered
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_RenderFloatPlanar (EAS_DATA_HANDLE pEASData, float * const *ppOut, EAS_I32 numRequested, EAS_I32 *pNumGenerated);
+
 /*----------------------------------------------------------------------------
  * EAS_SetRepeat()
  *----------------------------------------------------------------------------
@@ -262,7 +397,7 @@ EAS_PUBLIC EAS_RESULT EAS_SetTransposition (EAS_DATA_HANDLE pEASData, EAS_HANDLE
  *----------------------------------------------------------------------------
  * Purpose:
  * Set the polyphony of the synthesizer. Value must be >= 1 and <= the
- * maximum number of voices. This function will pin the polyphony
+ * voice capacity set by EAS_InitEx. This function will pin the polyphony
  * at those limits
  *
  * Inputs:
@@ -442,6 +577,48 @@ EAS_PUBLIC EAS_I32 EAS_GetVolume (EAS_DATA_HANDLE pEASData, EAS_HANDLE streamHan
 */
 EAS_PUBLIC EAS_RESULT EAS_SetMaxLoad (EAS_DATA_HANDLE pEASData, EAS_I32 maxLoad);
 
+/*----------------------------------------------------------------------------
+ * EAS_SetRenderBudget()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Sets the time the synthesizer may take to render a block. The time of
+ * each block is measured, and when several blocks in a row run over the
+ * budget the polyphony is lowered and the quietest voices are muted. The
+ * polyphony rises again, up to the synthesizer polyphony, while there is
+ * room in the budget. Setting the budget to zero turns it off and restores
+ * the polyphony.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  budget          - microseconds per block, 0 to 100000
+ *
+ * Outputs:
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetRenderBudget (EAS_DATA_HANDLE pEASData, EAS_I32 budget);
+
+/*----------------------------------------------------------------------------
+ * EAS_GetBudgetPolyphony()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the number of voices that may currently play, as limited by the
+ * synthesizer polyphony and the render time budget.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *
+ * Outputs:
+ *  pPolyphonyCount - the polyphony in effect
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_GetBudgetPolyphony (EAS_DATA_HANDLE pEASData, EAS_I32 *pPolyphonyCount);
+
 /*----------------------------------------------------------------------------
  * EAS_SetMaxPCMStreams()
  *----------------------------------------------------------------------------
@@ -968,6 +1145,151 @@ EAS_PUBLIC EAS_RESULT EAS_SetPlayMode (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStr
 */
 EAS_PUBLIC EAS_RESULT EAS_LoadDLSCollection (EAS_DATA_HANDLE pEASData, EAS_HANDLE streamHandle, EAS_FILE_LOCATOR locator);
 
+/*----------------------------------------------------------------------------
+ * EAS_LoadDLSCollectionHandle()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Parses a DLS or SF2 collection once into a read-only handle that can be
+ * attached to any number of instances, on any thread, with
+ * EAS_SetDLSCollection. The collection stays in memory until the host has
+ * called EAS_ReleaseDLSCollection and no instance uses it anymore.
+ *
+ * Inputs:
+ * pEASData             - instance data handle, used only for file access
+ * locator              - file locator
+ * ppDLS                - pointer to variable to receive the handle
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_LoadDLSCollectionHandle (EAS_DATA_HANDLE pEASData, EAS_FILE_LOCATOR locator, EAS_DLSLIB_HANDLE *ppDLS);
+
+/*----------------------------------------------------------------------------
+ * EAS_LoadDLSCollectionMapped()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Same as EAS_LoadDLSCollectionHandle, for a collection the host has
+ * already in memory, typically by memory-mapping the file. 16-bit PCM
+ * samples are played from that memory instead of being copied, saving the
+ * copy at load time and the heap it would use, and letting processes that
+ * map the same file share its pages.
+ *
+ * Inputs:
+ * pEASData             - instance data handle, used only for parsing
+ * pData                - file contents, aligned to 2 bytes
+ * size                 - size of the file contents in bytes
+ * ppDLS                - pointer to variable to receive the handle
+ *
+ * Outputs:
+ *
+ * Side Effects:
+ * pData must stay valid and unchanged until the collection is freed, that
+ * is until EAS_ReleaseDLSCollection has been called and no instance uses it
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_LoadDLSCollectionMapped (EAS_DATA_HANDLE pEASData, const void *pData, EAS_I32 size, EAS_DLSLIB_HANDLE *ppDLS);
+
+/*----------------------------------------------------------------------------
+ * EAS_WriteDLSCollectionCache()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Writes a precompiled image of a loaded collection into pBuffer, for the
+ * host to store and pass to EAS_LoadDLSCollectionCache on later starts,
+ * which then skips parsing the source file. Call it with pBuffer NULL
+ * first to get the size of the image.
+ *
+ * The image is tied to this build of the library and to the source file,
+ * identified by its size and by sourceStamp, a value the host derives from
+ * the file, such as its modification time or a hash of its contents.
+ * Collections loaded with EAS_LoadDLSCollectionMapped keep their samples in
+ * the source file, others store them in the image.
+ *
+ * Inputs:
+ * pDLS                 - collection handle
+ * sourceSize           - size of the source file in bytes
+ * sourceStamp          - host defined stamp of the source file
+ * pBuffer              - buffer for the image, or NULL
+ * bufferSize           - size of pBuffer in bytes
+ * pCacheSize           - pointer to variable to receive the image size
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_WriteDLSCollectionCache (EAS_DLSLIB_HANDLE pDLS, EAS_I32 sourceSize, EAS_U32 sourceStamp, void *pBuffer, EAS_I32 bufferSize, EAS_I32 *pCacheSize);
+
+/*----------------------------------------------------------------------------
+ * EAS_LoadDLSCollectionCache()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Creates a collection handle, like EAS_LoadDLSCollectionHandle, from an
+ * image written by EAS_WriteDLSCollectionCache. The tables are used in
+ * place, so a memory-mapped image loads without parsing or copying.
+ *
+ * Returns EAS_ERROR_INCOMPATIBLE_VERSION when another build wrote the image,
+ * EAS_ERROR_DATA_INCONSISTENCY when the source file changed and
+ * EAS_ERROR_FILE_FORMAT when the image is damaged; the host should then
+ * load the source file and write a new image.
+ *
+ * Inputs:
+ * pEASData             - instance data handle, used only for memory
+ * pCache               - cache image, aligned to 8 bytes
+ * cacheSize            - size of the image in bytes
+ * pFileData            - source file contents, aligned to 2 bytes, needed
+ *                        when the image was written from a mapped collection
+ * sourceSize           - current size of the source file in bytes
+ * sourceStamp          - current host defined stamp of the source file
+ * ppDLS                - pointer to variable to receive the handle
+ *
+ * Outputs:
+ *
+ * Side Effects:
+ * pCache and pFileData must stay valid and unchanged until the collection
+ * is freed, that is until EAS_ReleaseDLSCollection has been called and no
+ * instance uses it
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_LoadDLSCollectionCache (EAS_DATA_HANDLE pEASData, const void *pCache, EAS_I32 cacheSize, const void *pFileData, EAS_I32 sourceSize, EAS_U32 sourceStamp, EAS_DLSLIB_HANDLE *ppDLS);
+
+/*----------------------------------------------------------------------------
+ * EAS_SetDLSCollection()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Uses a shared DLS collection for a stream, or for the whole instance
+ * when streamHandle is NULL, like EAS_LoadDLSCollection does.
+ *
+ * Inputs:
+ * pEASData             - instance data handle
+ * streamHandle         - file or stream handle, or NULL
+ * pDLS                 - handle from EAS_LoadDLSCollectionHandle,
+ *                        EAS_LoadDLSCollectionMapped or
+ *                        EAS_LoadDLSCollectionCache
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetDLSCollection (EAS_DATA_HANDLE pEASData, EAS_HANDLE streamHandle, EAS_DLSLIB_HANDLE pDLS);
+
+/*----------------------------------------------------------------------------
+ * EAS_ReleaseDLSCollection()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Releases the reference returned by EAS_LoadDLSCollectionHandle,
+ * EAS_LoadDLSCollectionMapped or EAS_LoadDLSCollectionCache. The instances
+ * using the collection keep it alive until they are shut down or switch to
+ * another collection.
+ *
+ * Inputs:
+ * pDLS                 - collection handle
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_ReleaseDLSCollection (EAS_DLSLIB_HANDLE pDLS);
+
 /*----------------------------------------------------------------------------
  * EAS_SetFrameBuffer()
  *----------------------------------------------------------------------------
@@ -40,7 +40,8 @@ typedef enum
     EAS_PARAM_CHORUS_DEPTH,
     EAS_PARAM_CHORUS_LEVEL,
     EAS_PARAM_CHORUS_DRY,
-    EAS_PARAM_CHORUS_OVERRIDE_CC
+    EAS_PARAM_CHORUS_OVERRIDE_CC,
+    EAS_PARAM_CHORUS_TAIL_SILENT        /* read only, nonzero once the tail has decayed */
 } E_CHORUS_PARAMS;
 
 typedef enum
@@ -148,6 +148,8 @@ extern EAS_VOID_PTR eas_SMFData;
 extern EAS_VOID_PTR eas_Data;
 extern EAS_VOID_PTR eas_MixBuffer;
 extern EAS_VOID_PTR eas_Synth;
+extern EAS_VOID_PTR eas_SynthBuffers;
+extern EAS_VOID_PTR eas_SynthVoices;
 extern EAS_VOID_PTR eas_MIDI;
 extern EAS_VOID_PTR eas_PCMData;
 extern EAS_VOID_PTR eas_MIDIData;
@@ -470,6 +472,16 @@ EAS_VOID_PTR EAS_CMEnumData (EAS_INT dataModule)
     case EAS_CM_SYNTH_DATA:
         return &eas_Synth;
 
+    /* block buffers for synth */
+    case EAS_CM_SYNTH_BUFFERS:
+        /*lint -e{545} lint doesn't like this because it sees the underlying type */
+        return &eas_SynthBuffers;
+
+    /* voice arrays for synth */
+    case EAS_CM_SYNTH_VOICES:
+        /*lint -e{545} lint doesn't like this because it sees the underlying type */
+        return &eas_SynthVoices;
+
     /* instance data for MIDI parser */
     case EAS_CM_MIDI_DATA:
         return &eas_MIDI;
@@ -64,7 +64,9 @@ typedef enum {
     EAS_CM_IMELODY_DATA,
     EAS_CM_RTTTL_DATA,
     EAS_CM_WAVE_DATA,
-    EAS_CM_CMF_DATA
+    EAS_CM_CMF_DATA,
+    EAS_CM_SYNTH_BUFFERS,
+    EAS_CM_SYNTH_VOICES
 } E_CM_DATA_MODULES;
 
 typedef struct
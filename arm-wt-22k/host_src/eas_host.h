@@ -77,6 +77,9 @@ extern EAS_RESULT EAS_HWVibrate(EAS_HW_DATA_HANDLE hwInstData, EAS_BOOL state);
 extern EAS_RESULT EAS_HWLED(EAS_HW_DATA_HANDLE hwInstData, EAS_BOOL state);
 extern EAS_RESULT EAS_HWBackLight(EAS_HW_DATA_HANDLE hwInstData, EAS_BOOL state);
 
+/* host monotonic clock in microseconds, wrapping at 32 bits */
+extern EAS_U32 EAS_HWGetMicroseconds(EAS_HW_DATA_HANDLE hwInstData);
+
 #ifdef __cplusplus
 } /* end extern "C" */
 #endif
@@ -52,6 +52,7 @@
 #include <fcntl.h>
 #include <limits.h>
 #include <errno.h>
+#include <time.h>
 #include <signal.h>
 #include <pthread.h>
 #include <media/MediaPlayerInterface.h>
@@ -627,3 +628,21 @@ EAS_BOOL EAS_HWYield (EAS_HW_DATA_HANDLE hwInstData)
     return EAS_FALSE;
 }
 
+
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWGetMicroseconds
+ *
+ * This function returns a monotonic time in microseconds. The EAS library
+ * only uses differences between two readings, so the value may wrap.
+ *
+ *----------------------------------------------------------------------------
+*/
+/*lint -esym(715, hwInstData) hwInstData available for customer use */
+EAS_U32 EAS_HWGetMicroseconds (EAS_HW_DATA_HANDLE hwInstData)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (EAS_U32) ((EAS_U32) now.tv_sec * 1000000 + (EAS_U32) (now.tv_nsec / 1000));
+}
@@ -33,5 +33,7 @@
 #cmakedefine _SF2_SUPPORT
 #cmakedefine _FLOAT_DCF
 #cmakedefine MP3_SUPPORT
+#cmakedefine _SIMD_KERNELS
+#cmakedefine _VOICE_PARALLEL
 
 #endif // EAS_OPTIONS_CMAKE
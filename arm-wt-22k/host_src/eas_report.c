@@ -39,11 +39,25 @@
 #include "eas_report.h"
 #include "eas_options.h"
 
-static int severityLevel = 9999;
+/* the debug settings are shared by all library instances and may be
+ * changed while other threads are rendering
+ */
+#ifndef __STDC_NO_ATOMICS__
+#include <stdatomic.h>
+#define REPORT_ATOMIC           _Atomic
+#define REPORT_LOAD(x)          atomic_load_explicit(&(x), memory_order_relaxed)
+#define REPORT_STORE(x, v)      atomic_store_explicit(&(x), (v), memory_order_relaxed)
+#else
+#define REPORT_ATOMIC           volatile
+#define REPORT_LOAD(x)          (x)
+#define REPORT_STORE(x, v)      ((x) = (v))
+#endif
+
+static int REPORT_ATOMIC severityLevel = 9999;
 
 /* debug file */
-static FILE *debugFile = NULL;
-int flush = 0;
+static FILE * REPORT_ATOMIC debugFile = NULL;
+static int REPORT_ATOMIC flush = 0;
 
 /* structure should have an #include for each error message header file */
 S_DEBUG_MESSAGES debugMessages[] =
@@ -143,10 +157,11 @@ S_DEBUG_MESSAGES debugMessages[] =
 EAS_PUBLIC void EAS_ReportEx (int severity, unsigned long hashCode, int serialNum, ...)
 {
     va_list vargs;
+    FILE *file;
     int i;
 
     /* check severity level */
-    if (severity > severityLevel)
+    if (severity > REPORT_LOAD(severityLevel))
         return;
 
     /* find the error message and output to stdout */
@@ -158,11 +173,12 @@ EAS_PUBLIC void EAS_ReportEx (int severity, unsigned long hashCode, int serialNu
         {
             /*lint -e{826} <allow variable args> */
             va_start(vargs, serialNum);
-            if (debugFile)
+            file = REPORT_LOAD(debugFile);
+            if (file)
             {
-                vfprintf(debugFile, debugMessages[i].m_pDebugMsg, vargs);
-                if (flush)
-                    fflush(debugFile);
+                vfprintf(file, debugMessages[i].m_pDebugMsg, vargs);
+                if (REPORT_LOAD(flush))
+                    fflush(file);
             }
             else
             {
@@ -185,18 +201,20 @@ EAS_PUBLIC void EAS_ReportEx (int severity, unsigned long hashCode, int serialNu
 EAS_PUBLIC void EAS_Report (int severity, const char *fmt, ...)
 {
     va_list vargs;
+    FILE *file;
 
     /* check severity level */
-    if (severity > severityLevel)
+    if (severity > REPORT_LOAD(severityLevel))
         return;
 
     /*lint -e{826} <allow variable args> */
     va_start(vargs, fmt);
-    if (debugFile)
+    file = REPORT_LOAD(debugFile);
+    if (file)
     {
-        vfprintf(debugFile, fmt, vargs);
-        if (flush)
-            fflush(debugFile);
+        vfprintf(file, fmt, vargs);
+        if (REPORT_LOAD(flush))
+            fflush(file);
     }
     else
     {
@@ -215,18 +233,20 @@ EAS_PUBLIC void EAS_Report (int severity, const char *fmt, ...)
 EAS_PUBLIC void EAS_ReportX (int severity, const char *fmt, ...)
 {
     va_list vargs;
+    FILE *file;
 
     /* check severity level */
-    if (severity > severityLevel)
+    if (severity > REPORT_LOAD(severityLevel))
         return;
 
     /*lint -e{826} <allow variable args> */
     va_start(vargs, fmt);
-    if (debugFile)
+    file = REPORT_LOAD(debugFile);
+    if (file)
     {
-        vfprintf(debugFile, fmt, vargs);
-        if (flush)
-            fflush(debugFile);
+        vfprintf(file, fmt, vargs);
+        if (REPORT_LOAD(flush))
+            fflush(file);
     }
     else
     {
@@ -244,7 +264,7 @@ EAS_PUBLIC void EAS_ReportX (int severity, const char *fmt, ...)
 
 EAS_PUBLIC void EAS_SetDebugLevel (int severity)
 {
-    severityLevel = severity;
+    REPORT_STORE(severityLevel, severity);
 } /* end EAS_SetDebugLevel */
 
 /*----------------------------------------------------------------------------
@@ -255,7 +275,7 @@ EAS_PUBLIC void EAS_SetDebugLevel (int severity)
 */
 EAS_PUBLIC void EAS_SetDebugFile (void *file, int flushAfterWrite)
 {
-    debugFile = (FILE*) file;
-    flush = flushAfterWrite;
+    REPORT_STORE(flush, flushAfterWrite);
+    REPORT_STORE(debugFile, (FILE*) file);
 } /* end EAS_SetDebugFile */
 
@@ -39,7 +39,8 @@ typedef enum
     EAS_PARAM_REVERB_PRESET,
     EAS_PARAM_REVERB_WET,
     EAS_PARAM_REVERB_DRY,
-    EAS_PARAM_REVERB_OVERRIDE_CC
+    EAS_PARAM_REVERB_OVERRIDE_CC,
+    EAS_PARAM_REVERB_TAIL_SILENT        /* read only, nonzero once the tail has decayed */
 } E_REVERB_PARAMS;
 
 
@@ -0,0 +1,31 @@
+// Reference counts for data shared between library instances on different threads
+
+#ifndef _EAS_ATOMIC_H
+#define _EAS_ATOMIC_H
+
+#if !defined(__STDC_NO_ATOMICS__)
+#include <stdatomic.h>
+
+typedef atomic_long EAS_ATOMIC_COUNT;
+
+#define EAS_AtomicIncrement(p)  (atomic_fetch_add_explicit((p), 1, memory_order_relaxed) + 1)
+#define EAS_AtomicDecrement(p)  (atomic_fetch_sub_explicit((p), 1, memory_order_acq_rel) - 1)
+
+#elif defined(_MSC_VER)
+#include <intrin.h>
+
+typedef volatile long EAS_ATOMIC_COUNT;
+
+#define EAS_AtomicIncrement(p)  _InterlockedIncrement(p)
+#define EAS_AtomicDecrement(p)  _InterlockedDecrement(p)
+
+#else
+/* no atomic operations, instances sharing data must run on one thread */
+typedef volatile long EAS_ATOMIC_COUNT;
+
+#define EAS_AtomicIncrement(p)  (++*(p))
+#define EAS_AtomicDecrement(p)  (--*(p))
+
+#endif
+
+#endif /* _EAS_ATOMIC_H */
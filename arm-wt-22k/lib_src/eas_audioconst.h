@@ -40,6 +40,12 @@
  * _OUTPUT_SAMPLE_RATE          compiled output sample rate
  * AUDIO_FRAME_LENGTH           length of an audio frame in 256ths of a millisecond (equals to bufsize/srate*1000*256)
  * SYNTH_UPDATE_PERIOD_IN_BITS  length of an audio frame (2^x samples)
+ *
+ * BUFFER_SIZE_IN_MONO_SAMPLES is the default block size and the native
+ * control period the sound library envelope and LFO rates are built for.
+ * An instance may select another power of two block size between
+ * MIN_BUFFER_SIZE_IN_MONO_SAMPLES and MAX_BUFFER_SIZE_IN_MONO_SAMPLES
+ * at EAS_InitEx() time.
  *----------------------------------------------------------------------------
 */
 
@@ -95,5 +101,9 @@
 #error "_SAMPLE_RATE_XXXXX must be defined to valid rate"
 #endif
 
+/* range of block sizes selectable at run time */
+#define MIN_BUFFER_SIZE_IN_MONO_SAMPLES     32
+#define MAX_BUFFER_SIZE_IN_MONO_SAMPLES     1024
+
 #endif /* #ifndef _EAS_AUDIOCONST_H */
 
@@ -40,6 +40,7 @@
 /* prototypes for effects interface */
 static EAS_RESULT ChorusInit (EAS_DATA_HANDLE pEASData, EAS_VOID_PTR *pInstData);
 static void ChorusProcess (EAS_VOID_PTR pInstData, EAS_PCM *pSrc, EAS_PCM *pDst, EAS_I32 numSamples);
+static void ChorusProcess32 (EAS_VOID_PTR pInstData, EAS_I32 *pSrc, EAS_I32 *pDst, EAS_I32 numSamples);
 static EAS_RESULT ChorusShutdown (EAS_DATA_HANDLE pEASData, EAS_VOID_PTR pInstData);
 static EAS_RESULT ChorusGetParam (EAS_VOID_PTR pInstData, EAS_I32 param, EAS_I32 *pValue);
 static EAS_RESULT ChorusSetParam (EAS_VOID_PTR pInstData, EAS_I32 param, EAS_I32 value);
@@ -51,7 +52,8 @@ const S_EFFECTS_INTERFACE EAS_Chorus =
     ChorusProcess,
     ChorusShutdown,
     ChorusGetParam,
-    ChorusSetParam
+    ChorusSetParam,
+    ChorusProcess32
 };
 
 
@@ -86,6 +88,9 @@ static EAS_RESULT ChorusInit (EAS_DATA_HANDLE pEASData, EAS_VOID_PTR *pInstData)
 {
     S_CHORUS_OBJECT *pChorusData;
     EAS_I32 index;
+    EAS_I32 rate;
+
+    rate = pEASData->sampleRate;
 
     /* check Configuration Module for data allocation */
     if (pEASData->staticMemoryModel)
@@ -93,7 +98,8 @@ static EAS_RESULT ChorusInit (EAS_DATA_HANDLE pEASData, EAS_VOID_PTR *pInstData)
 
     /* allocate dynamic memory */
     else
-        pChorusData = EAS_HWMalloc(pEASData->hwInstData, sizeof(S_CHORUS_OBJECT));
+        pChorusData = EAS_HWMalloc(pEASData->hwInstData, sizeof(S_CHORUS_OBJECT) +
+            (CHORUS_L_SIZE(rate) + CHORUS_R_SIZE(rate)) * (EAS_I32) sizeof(EAS_PCM));
 
     if (pChorusData == NULL)
     {
@@ -104,6 +110,12 @@ static EAS_RESULT ChorusInit (EAS_DATA_HANDLE pEASData, EAS_VOID_PTR *pInstData)
     /* clear the structure */
     EAS_HWMemSet(pChorusData, 0, sizeof(S_CHORUS_OBJECT));
 
+    /* the delay lines follow the object */
+    pChorusData->sampleRate = rate;
+    pChorusData->chorusDelaySize = (EAS_I16) CHORUS_L_SIZE(rate);
+    pChorusData->chorusDelayL = (EAS_PCM *) (pChorusData + 1);
+    pChorusData->chorusDelayR = pChorusData->chorusDelayL + CHORUS_L_SIZE(rate);
+
     ChorusReadInPresets(pChorusData);
 
     /* set some default values */
@@ -111,15 +123,18 @@ static EAS_RESULT ChorusInit (EAS_DATA_HANDLE pEASData, EAS_VOID_PTR *pInstData)
     pChorusData->m_nNextChorus = EAS_CHORUS_PRESET_DEFAULT;
 
     //zero delay memory for chorus
-    for (index = CHORUS_L_SIZE - 1; index >= 0; index--)
+    for (index = pChorusData->chorusDelaySize - 1; index >= 0; index--)
     {
         pChorusData->chorusDelayL[index] = 0;
     }
-    for (index = CHORUS_R_SIZE - 1; index >= 0; index--)
+    for (index = pChorusData->chorusDelaySize - 1; index >= 0; index--)
     {
         pChorusData->chorusDelayR[index] = 0;
     }
 
+    //the delay line holds no tail yet
+    pChorusData->silentSamples = pChorusData->chorusDelaySize;
+
     //init delay line index, these are used to implement circular delay buffer
     pChorusData->chorusIndexL = 0;
     pChorusData->chorusIndexR = 0;
@@ -130,8 +145,8 @@ static EAS_RESULT ChorusInit (EAS_DATA_HANDLE pEASData, EAS_VOID_PTR *pInstData)
     pChorusData->lfoRPhase = (CHORUS_SHAPE_SIZE << 16) >> 2; // 1/4 of total, i.e. 90 degrees out of phase;
 
     //init chorus delay position
-    //right now chorus delay is a compile-time value, as is sample rate
-    pChorusData->chorusTapPosition = (EAS_I16)((CHORUS_DELAY_MS * _OUTPUT_SAMPLE_RATE)/1000);
+    //right now chorus delay is a compile-time value, the sample rate is set per instance
+    pChorusData->chorusTapPosition = (EAS_I16)((CHORUS_DELAY_MS * rate)/1000);
 
     //now copy from the new preset into Chorus
     ChorusUpdate(pChorusData);
@@ -198,6 +213,105 @@ static EAS_I16 WeightedTap(const EAS_I16 *array, EAS_I16 indexReference, EAS_I32
     return(val1 + (EAS_I16)MULT_EG1_EG1(val2-val1,fraction));
 }
 
+/*----------------------------------------------------------------------------
+ * ChorusTap()
+ *----------------------------------------------------------------------------
+ * Purpose: feeds one sample into a chorus delay line and returns the chorus
+ * tap scaled by the chorus level
+ *
+ * Inputs:
+ * pDelay: the delay line of the channel
+ * pIndex: the delay line index of the channel, advanced by one sample
+ * pPhase: the lfo phase of the channel, advanced by one sample
+ * nInputSample: the input sample
+ *
+ * Outputs:
+ * The chorus output sample
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_INLINE EAS_I32 ChorusTap (S_CHORUS_OBJECT *pChorusData, EAS_PCM *pDelay, EAS_I16 *pIndex, EAS_I32 *pPhase, EAS_PCM nInputSample)
+{
+    EAS_I16 lfoValue;
+    EAS_I32 positionOffset;
+    EAS_PCM tap;
+
+    //feed input into chorus delay line
+    pDelay[*pIndex] = nInputSample;
+
+    //compute chorus lfo value using phase as fractional index into chorus shape table
+    //resulting value is between -1.0 and 1.0, expressed as signed 16 bit number
+    lfoValue = WeightedTap(EAS_chorusShape, 0, *pPhase, CHORUS_SHAPE_SIZE);
+
+    //scale chorus depth by lfo value to get relative fractional sample index
+    //index is expressed as 32 bit number with 16 bit fractional part
+    /*lint -e{703} use shift for performance */
+    positionOffset = pChorusData->m_nDepth * (((EAS_I32)lfoValue) << 1);
+
+    //add fixed chorus delay to get actual fractional sample index
+    positionOffset += ((EAS_I32)pChorusData->chorusTapPosition) << 16;
+
+    //get tap value from chorus delay using fractional sample index
+    tap = WeightedTap(pDelay, *pIndex, positionOffset, pChorusData->chorusDelaySize);
+
+    //increment chorus delay index and make it wrap as needed
+    //this implements circular buffer
+    if ((*pIndex += 1) >= pChorusData->chorusDelaySize)
+        *pIndex = 0;
+
+    //increment fractional lfo phase, and make it wrap as needed
+    *pPhase += pChorusData->m_nRate;
+    while (*pPhase >= (CHORUS_SHAPE_SIZE<<16))
+    {
+        *pPhase -= (CHORUS_SHAPE_SIZE<<16);
+    }
+
+    //scale by chorus level
+    return MULT_EG1_EG1(tap, pChorusData->m_nLevel);
+}
+
+/*----------------------------------------------------------------------------
+ * ChorusStartBlock()
+ *----------------------------------------------------------------------------
+ * Purpose: updates the chorus for a block and checks whether the block has
+ * to be processed
+ *
+ * Inputs:
+ * numSamples: the number of sample frames in the block
+ * silentInput: the input block is all zero
+ *
+ * Outputs:
+ * EAS_FALSE if the output is silent, the delay lines and the lfo have then
+ * been advanced already
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_BOOL ChorusStartBlock (S_CHORUS_OBJECT *pChorusData, EAS_I32 numSamples, EAS_BOOL silentInput)
+{
+    if (pChorusData->m_nNextChorus != pChorusData->m_nCurrentChorus)
+    {
+        ChorusUpdate(pChorusData);
+    }
+
+    //count the silent input, the delay line is all zero once it has been filled with it
+    if (!silentInput)
+        pChorusData->silentSamples = 0;
+
+    //silent input into a silent tail is silent output, just advance the delay lines and the lfo
+    else if (pChorusData->silentSamples >= pChorusData->chorusDelaySize)
+    {
+        pChorusData->chorusIndexL = (EAS_I16) ((pChorusData->chorusIndexL + numSamples) % pChorusData->chorusDelaySize);
+        pChorusData->chorusIndexR = (EAS_I16) ((pChorusData->chorusIndexR + numSamples) % pChorusData->chorusDelaySize);
+        pChorusData->lfoLPhase = (pChorusData->lfoLPhase + pChorusData->m_nRate * numSamples) % (CHORUS_SHAPE_SIZE << 16);
+        pChorusData->lfoRPhase = (pChorusData->lfoRPhase + pChorusData->m_nRate * numSamples) % (CHORUS_SHAPE_SIZE << 16);
+        return EAS_FALSE;
+    }
+    else
+        pChorusData->silentSamples += numSamples;
+
+    return EAS_TRUE;
+}
+
 /*----------------------------------------------------------------------------
  * ChorusProcess()
  *----------------------------------------------------------------------------
@@ -218,18 +332,8 @@ static EAS_I16 WeightedTap(const EAS_I16 *array, EAS_I16 indexReference, EAS_I32
 static void ChorusProcess (EAS_VOID_PTR pInstData, EAS_PCM *pSrc, EAS_PCM *pDst, EAS_I32 numSamples)
 {
     EAS_I32 ix;
-    EAS_I32 nChannelNumber;
-    EAS_I16 lfoValueLeft;
-    EAS_I16 lfoValueRight;
-    EAS_I32 positionOffsetL;
-    EAS_I32 positionOffsetR;
-    EAS_PCM tapL;
-    EAS_PCM tapR;
     EAS_I32 tempValue;
     EAS_PCM nInputSample;
-    EAS_I32 nOutputSample;
-    EAS_PCM *pIn;
-    EAS_PCM *pOut;
 
     S_CHORUS_OBJECT *pChorusData;
 
@@ -239,117 +343,101 @@ static void ChorusProcess (EAS_VOID_PTR pInstData, EAS_PCM *pSrc, EAS_PCM *pDst,
     if (pChorusData->bypass == EAS_TRUE || pChorusData->m_nLevel == 0)
     {
         if (pSrc != pDst)
-            EAS_HWMemCpy(pSrc, pDst, numSamples * NUM_OUTPUT_CHANNELS * (EAS_I32) sizeof(EAS_PCM));
+            EAS_HWMemCpy(pDst, pSrc, numSamples * NUM_OUTPUT_CHANNELS * (EAS_I32) sizeof(EAS_PCM));
         return;
     }
 
-    if (pChorusData->m_nNextChorus != pChorusData->m_nCurrentChorus)
+    for (ix = 0; ix < numSamples * NUM_OUTPUT_CHANNELS; ix++)
     {
-        ChorusUpdate(pChorusData);
+        if (pSrc[ix] != 0)
+            break;
+    }
+    if (!ChorusStartBlock(pChorusData, numSamples, ix == numSamples * NUM_OUTPUT_CHANNELS))
+    {
+        if (pSrc != pDst)
+            EAS_HWMemSet(pDst, 0, numSamples * NUM_OUTPUT_CHANNELS * (EAS_I32) sizeof(EAS_PCM));
+        return;
     }
 
-    for (nChannelNumber = 0; nChannelNumber < NUM_OUTPUT_CHANNELS; nChannelNumber++)
+    for (ix = 0; ix < numSamples; ix++)
     {
+        //scale the input by the dry level, then sum with the chorus and saturate
+        nInputSample = pSrc[0];
+        tempValue = ChorusTap(pChorusData, pChorusData->chorusDelayL, &pChorusData->chorusIndexL, &pChorusData->lfoLPhase, nInputSample);
+        nInputSample = MULT_EG1_EG1(nInputSample, pChorusData->m_nDry);
+        pDst[0] = (EAS_I16)SATURATE(tempValue + nInputSample);
+
+        nInputSample = pSrc[1];
+        tempValue = ChorusTap(pChorusData, pChorusData->chorusDelayR, &pChorusData->chorusIndexR, &pChorusData->lfoRPhase, nInputSample);
+        nInputSample = MULT_EG1_EG1(nInputSample, pChorusData->m_nDry);
+        pDst[1] = (EAS_I16)SATURATE(tempValue + nInputSample);
+
+        pSrc += NUM_OUTPUT_CHANNELS;
+        pDst += NUM_OUTPUT_CHANNELS;
+    }
+}  /* end ChorusProcess */
 
-        pIn = pSrc + nChannelNumber;
-        pOut = pDst + nChannelNumber;
+/*----------------------------------------------------------------------------
+ * ChorusProcess32()
+ *----------------------------------------------------------------------------
+ * Purpose: compute the chorus on a 32-bit input buffer, and mix into output
+ * buffer. The delay lines hold the input saturated to 16 bits, the dry
+ * path keeps the full input range.
+ *
+ * Inputs:
+ * src: pointer to input buffer of 32-bit values to be processed
+ * dst: pointer to output buffer of 32-bit values
+ * bufSize: the number of sample frames (i.e. stereo samples) in the buffer
+ *
+ * Outputs:
+ * None
+ *
+ *----------------------------------------------------------------------------
+*/
+static void ChorusProcess32 (EAS_VOID_PTR pInstData, EAS_I32 *pSrc, EAS_I32 *pDst, EAS_I32 numSamples)
+{
+    EAS_I32 ix;
+    EAS_I32 tempValue;
+    EAS_I32 nInputSample;
 
-        if(nChannelNumber==0)
-        {
-            for (ix = 0; ix < numSamples; ix++)
-            {
-                nInputSample = *pIn;
-                pIn += NUM_OUTPUT_CHANNELS;
-
-                //feed input into chorus delay line
-                pChorusData->chorusDelayL[pChorusData->chorusIndexL] = nInputSample;
-
-                //compute chorus lfo value using phase as fractional index into chorus shape table
-                //resulting value is between -1.0 and 1.0, expressed as signed 16 bit number
-                lfoValueLeft = WeightedTap(EAS_chorusShape, 0, pChorusData->lfoLPhase, CHORUS_SHAPE_SIZE);
-
-                //scale chorus depth by lfo value to get relative fractional sample index
-                //index is expressed as 32 bit number with 16 bit fractional part
-                /*lint -e{703} use shift for performance */
-                positionOffsetL = pChorusData->m_nDepth * (((EAS_I32)lfoValueLeft) << 1);
-
-                //add fixed chorus delay to get actual fractional sample index
-                positionOffsetL += ((EAS_I32)pChorusData->chorusTapPosition) << 16;
-
-                //get tap value from chorus delay using fractional sample index
-                tapL = WeightedTap(pChorusData->chorusDelayL, pChorusData->chorusIndexL, positionOffsetL, CHORUS_L_SIZE);
-
-                //scale by chorus level, then sum with input buffer contents and saturate
-                nInputSample = MULT_EG1_EG1(nInputSample, pChorusData->m_nDry);
-                tempValue = MULT_EG1_EG1(tapL, pChorusData->m_nLevel);
-                nOutputSample = SATURATE(tempValue + nInputSample);
-
-                *pOut = (EAS_I16)SATURATE(nOutputSample);
-                pOut += NUM_OUTPUT_CHANNELS;
-
-
-                //increment chorus delay index and make it wrap as needed
-                //this implements circular buffer
-                if ((pChorusData->chorusIndexL+=1) >= CHORUS_L_SIZE)
-                    pChorusData->chorusIndexL = 0;
-
-                //increment fractional lfo phase, and make it wrap as needed
-                pChorusData->lfoLPhase += pChorusData->m_nRate;
-                while (pChorusData->lfoLPhase >= (CHORUS_SHAPE_SIZE<<16))
-                {
-                    pChorusData->lfoLPhase -= (CHORUS_SHAPE_SIZE<<16);
-                }
-            }
-        }
-        else
-        {
-            for (ix = 0; ix < numSamples; ix++)
-            {
-                nInputSample = *pIn;
-                pIn += NUM_OUTPUT_CHANNELS;
-
-                //feed input into chorus delay line
-                pChorusData->chorusDelayR[pChorusData->chorusIndexR] = nInputSample;
-
-                //compute chorus lfo value using phase as fractional index into chorus shape table
-                //resulting value is between -1.0 and 1.0, expressed as signed 16 bit number
-                lfoValueRight = WeightedTap(EAS_chorusShape, 0, pChorusData->lfoRPhase, CHORUS_SHAPE_SIZE);
-
-                //scale chorus depth by lfo value to get relative fractional sample index
-                //index is expressed as 32 bit number with 16 bit fractional part
-                /*lint -e{703} use shift for performance */
-                positionOffsetR = pChorusData->m_nDepth * (((EAS_I32)lfoValueRight) << 1);
-
-                //add fixed chorus delay to get actual fractional sample index
-                positionOffsetR += ((EAS_I32)pChorusData->chorusTapPosition) << 16;
-
-                //get tap value from chorus delay using fractional sample index
-                tapR = WeightedTap(pChorusData->chorusDelayR, pChorusData->chorusIndexR, positionOffsetR, CHORUS_R_SIZE);
-
-                //scale by chorus level, then sum with output buffer contents and saturate
-                nInputSample = MULT_EG1_EG1(nInputSample, pChorusData->m_nDry);
-                tempValue = MULT_EG1_EG1(tapR, pChorusData->m_nLevel);
-                nOutputSample = SATURATE(tempValue + nInputSample);
-
-                *pOut = (EAS_I16)SATURATE(nOutputSample);
-                pOut += NUM_OUTPUT_CHANNELS;
-
-                //increment chorus delay index and make it wrap as needed
-                //this implements circular buffer
-                if ((pChorusData->chorusIndexR+=1) >= CHORUS_R_SIZE)
-                    pChorusData->chorusIndexR = 0;
-
-                //increment fractional lfo phase, and make it wrap as needed
-                pChorusData->lfoRPhase += pChorusData->m_nRate;
-                while (pChorusData->lfoRPhase >= (CHORUS_SHAPE_SIZE<<16))
-                {
-                    pChorusData->lfoRPhase -= (CHORUS_SHAPE_SIZE<<16);
-                }
-            }
-        }
+    S_CHORUS_OBJECT *pChorusData;
+
+    pChorusData = (S_CHORUS_OBJECT*) pInstData;
 
+    //if the chorus is disabled or turned all the way down
+    if (pChorusData->bypass == EAS_TRUE || pChorusData->m_nLevel == 0)
+    {
+        if (pSrc != pDst)
+            EAS_HWMemCpy(pDst, pSrc, numSamples * NUM_OUTPUT_CHANNELS * (EAS_I32) sizeof(EAS_I32));
+        return;
     }
-}  /* end ChorusProcess */
+
+    for (ix = 0; ix < numSamples * NUM_OUTPUT_CHANNELS; ix++)
+    {
+        if (pSrc[ix] != 0)
+            break;
+    }
+    if (!ChorusStartBlock(pChorusData, numSamples, ix == numSamples * NUM_OUTPUT_CHANNELS))
+    {
+        if (pSrc != pDst)
+            EAS_HWMemSet(pDst, 0, numSamples * NUM_OUTPUT_CHANNELS * (EAS_I32) sizeof(EAS_I32));
+        return;
+    }
+
+    for (ix = 0; ix < numSamples; ix++)
+    {
+        nInputSample = pSrc[0];
+        tempValue = ChorusTap(pChorusData, pChorusData->chorusDelayL, &pChorusData->chorusIndexL, &pChorusData->lfoLPhase, (EAS_PCM) SATURATE(nInputSample));
+        pDst[0] = tempValue + CHORUS_MULT_I32(nInputSample, pChorusData->m_nDry);
+
+        nInputSample = pSrc[1];
+        tempValue = ChorusTap(pChorusData, pChorusData->chorusDelayR, &pChorusData->chorusIndexR, &pChorusData->lfoRPhase, (EAS_PCM) SATURATE(nInputSample));
+        pDst[1] = tempValue + CHORUS_MULT_I32(nInputSample, pChorusData->m_nDry);
+
+        pSrc += NUM_OUTPUT_CHANNELS;
+        pDst += NUM_OUTPUT_CHANNELS;
+    }
+}  /* end ChorusProcess32 */
 
 
 
@@ -421,7 +509,10 @@ static EAS_RESULT ChorusGetParam (EAS_VOID_PTR pInstData, EAS_I32 param, EAS_I32
         case EAS_PARAM_CHORUS_DRY:
             *pValue = (EAS_I32) p->m_nDry;
             break;
-        
+        case EAS_PARAM_CHORUS_TAIL_SILENT:
+            *pValue = (EAS_I32) (p->silentSamples >= p->chorusDelaySize);
+            break;
+
         default:
             return EAS_ERROR_INVALID_PARAMETER;
     }
@@ -577,14 +668,14 @@ static EAS_RESULT ChorusUpdate(S_CHORUS_OBJECT *pChorusData)
     //computing it as below allows rate steps to be evenly spaced
     //uses 32 bit divide, but only once when new value is selected
     pChorusData->m_nRate = (EAS_I16)
-        ((((EAS_I32)CHORUS_SHAPE_SIZE<<16)/(20*(EAS_I32)_OUTPUT_SAMPLE_RATE)) * pChorusData->m_nRate);
+        ((((EAS_I32)CHORUS_SHAPE_SIZE<<16)/(20*pChorusData->sampleRate)) * pChorusData->m_nRate);
 
     //convert depth from steps of .05 ms, to samples, with 16 bit whole part, discard fraction
     //want to compute ((depth * sampleRate)/20000)
     //use the following approximation since 105/32 is roughly 65536/20000
     /*lint -e{704} use shift for performance */
     pChorusData->m_nDepth = (EAS_I16)
-        (((((EAS_I32)pChorusData->m_nDepth * _OUTPUT_SAMPLE_RATE)>>5) * 105) >> 16);
+        (((((EAS_I32)pChorusData->m_nDepth * pChorusData->sampleRate)>>5) * 105) >> 16);
 
     pChorusData->m_nCurrentChorus = pChorusData->m_nNextChorus;
 
@@ -30,5 +30,5 @@
 
 #include "eas_chorusdata.h"
 
-S_CHORUS_OBJECT eas_ChorusData;
+S_CHORUS_STATIC_DATA eas_ChorusData;
 
@@ -53,13 +53,17 @@
 #define EAS_CHORUS_DEPTH_MAX        60
 
 #define CHORUS_SIZE_MS 20
-#define CHORUS_L_SIZE ((CHORUS_SIZE_MS*_OUTPUT_SAMPLE_RATE)/1000)
-#define CHORUS_R_SIZE CHORUS_L_SIZE
+#define CHORUS_L_SIZE(rate) ((CHORUS_SIZE_MS*(rate))/1000)
+#define CHORUS_R_SIZE(rate) CHORUS_L_SIZE(rate)
 #define CHORUS_SHAPE_SIZE 128
 #define CHORUS_DELAY_MS 10
 
 #define CHORUS_MAX_TYPE         4   // any Chorus numbers larger than this are invalid
 
+//MULT_EG1_EG1 for a 32-bit x, split so that the product does not overflow
+#define CHORUS_MULT_I32(x, gain) \
+    ((((x) >> NUM_EG1_FRAC_BITS) * (gain)) + ((((x) & ((1 << NUM_EG1_FRAC_BITS) - 1)) * (gain)) >> NUM_EG1_FRAC_BITS))
+
 typedef struct
 {
     EAS_I16             m_nRate;
@@ -88,12 +92,18 @@ typedef struct
     EAS_I16 m_nLevel;
     EAS_I16 m_nDry;
 
+    EAS_I32 sampleRate;
+    EAS_I16 chorusDelaySize;
+
     //delay lines used by the chorus, longer would sound better
-    EAS_PCM chorusDelayL[CHORUS_L_SIZE];
-    EAS_PCM chorusDelayR[CHORUS_R_SIZE];
+    //they follow the object and hold CHORUS_SIZE_MS at the instance sample rate
+    EAS_PCM *chorusDelayL;
+    EAS_PCM *chorusDelayR;
 
     EAS_BOOL    bypass;
 
+    EAS_I32     silentSamples;              // samples of silent input, the tail is silent after a whole delay line
+
     EAS_I16     m_nCurrentChorus;           // preset number for current Chorus
     EAS_I16     m_nNextChorus;              // preset number for next Chorus
 
@@ -103,6 +113,14 @@ typedef struct
 
 } S_CHORUS_OBJECT;
 
+/* statically allocated chorus, with the delay lines for _OUTPUT_SAMPLE_RATE */
+typedef struct
+{
+    S_CHORUS_OBJECT     chorus;
+    EAS_PCM             delayL[CHORUS_L_SIZE(_OUTPUT_SAMPLE_RATE)];
+    EAS_PCM             delayR[CHORUS_R_SIZE(_OUTPUT_SAMPLE_RATE)];
+} S_CHORUS_STATIC_DATA;
+
 
 /*----------------------------------------------------------------------------
  * WeightedTap()
@@ -33,5 +33,7 @@
 // globals
 S_EAS_DATA eas_Data;
 S_VOICE_MGR eas_Synth;
+EAS_I32 eas_SynthBuffers[SYNTH_BUFFER_BYTES(BUFFER_SIZE_IN_MONO_SAMPLES) / sizeof(EAS_I32)];
+EAS_VOID_PTR eas_SynthVoices[SYNTH_VOICE_BYTES(MAX_SYNTH_VOICES) / sizeof(EAS_VOID_PTR) + 1];
 S_SYNTH eas_MIDI;
 
@@ -107,6 +107,14 @@ typedef struct s_eas_data_tag
 
     EAS_I32                         *pMixBuffer;
     EAS_PCM                         *pOutputAudioBuffer;
+    float                           *pOutputFloatBuffer[NUM_OUTPUT_CHANNELS];   /* float output, NULL for 16-bit */
+    EAS_I32                         outputFloatStride;  /* samples between frames in the float output */
+    EAS_BOOL                        mixBufferClear;     /* the mix buffer was left silent by the last block */
+
+    /* partial block kept between calls to EAS_RenderFrames */
+    EAS_PCM                         *pRenderFramesBuffer;
+    EAS_I32                         renderFramesOffset;
+    EAS_I32                         renderFramesPending;
 
 #ifdef AUX_MIXER
     S_EAS_AUX_MIXER                 auxMixer;
@@ -127,6 +135,14 @@ typedef struct s_eas_data_tag
 #endif
 
     EAS_U32                         renderTime;
+    EAS_I32                         frameLength;    /* length of a block in 256ths of a millisecond */
+    EAS_I32                         blockSize;      /* samples per block */
+    EAS_I32                         blockSizeBits;  /* blockSize = 2^blockSizeBits */
+    EAS_I32                         controlPeriod;  /* samples per voice update */
+    EAS_I32                         controlPeriodBits;
+    EAS_I32                         sampleRate;     /* output sample rate in Hz */
+    EAS_I32                         pitchOffset;    /* cents added to pitches, 0 at _OUTPUT_SAMPLE_RATE */
+    EAS_I32                         maxVoices;      /* voice capacity of the instance */
     EAS_I32                         masterGain;
     EAS_U8                          masterVolume;
     EAS_BOOL8                       staticMemoryModel;
@@ -0,0 +1,292 @@
+// Precompiled DLS/SF2 collection cache
+//
+// A cache image holds the finished tables of a parsed collection, so later
+// starts skip the parser. The image is relocatable: the tables are referenced
+// by offsets from its start and are used in place, so a memory-mapped image
+// costs no copy either. Sample data is either stored in the image or, when the
+// collection played its samples from the mapped source file, referenced in
+// that file.
+//
+// An image is only valid for the build that wrote it and for the source file
+// it was made from, identified by its size and a stamp chosen by the host,
+// such as its modification time or a hash.
+
+#include "eas_options.h"
+#include "eas_host.h"
+#include "eas_report.h"
+#include "eas_mdls.h"
+#include "eas_version.h"
+
+#define DLS_CACHE_MAGIC             0x43534145 /* 'EASC' */
+#define DLS_CACHE_VERSION           1
+#define DLS_CACHE_ALIGN             8
+
+/* sample offsets are positions in the source file instead of the image */
+#define DLS_CACHE_SAMPLES_IN_SOURCE 0x01
+
+typedef struct
+{
+    EAS_U32 magic;
+    EAS_U32 version;
+    EAS_U32 libVersion;
+    EAS_U32 layout;
+    EAS_U32 sourceSize;
+    EAS_U32 sourceStamp;
+    EAS_U32 flags;
+    EAS_U32 numPrograms;
+    EAS_U32 numRegions;
+    EAS_U32 numArticulations;
+    EAS_U32 numSamples;
+    EAS_U32 programsOffset;
+    EAS_U32 regionsOffset;
+    EAS_U32 articulationsOffset;
+    EAS_U32 sampleLenOffset;
+    EAS_U32 sampleOffsetsOffset;
+    EAS_U32 samplesOffset;
+    EAS_U32 samplesSize;
+    EAS_U32 size;
+} S_DLS_CACHE_HEADER;
+
+/* the tables depend on the structure layouts and the output rate of the build */
+#define DLS_CACHE_LAYOUT ((EAS_U32) \
+    ((sizeof(S_PROGRAM) << 24) ^ (sizeof(S_DLS_REGION) << 16) ^ (sizeof(S_DLS_ARTICULATION) << 8) ^ \
+     (sizeof(EAS_SAMPLE) << 4) ^ (EAS_U32) _OUTPUT_SAMPLE_RATE))
+
+/*----------------------------------------------------------------------------
+ * DLSCacheSection ()
+ *----------------------------------------------------------------------------
+ * Places a section of the image and returns its offset
+ *----------------------------------------------------------------------------
+*/
+static EAS_U32 DLSCacheSection (EAS_U32 *pSize, EAS_U32 sectionSize)
+{
+    EAS_U32 offset = (*pSize + DLS_CACHE_ALIGN - 1) & ~(EAS_U32) (DLS_CACHE_ALIGN - 1);
+    *pSize = offset + sectionSize;
+    return offset;
+}
+
+/*----------------------------------------------------------------------------
+ * DLSCacheSectionValid ()
+ *----------------------------------------------------------------------------
+ * Checks that a section lies within the image and is aligned
+ *----------------------------------------------------------------------------
+*/
+static EAS_BOOL DLSCacheSectionValid (EAS_U32 offset, EAS_U32 count, EAS_U32 itemSize, EAS_U32 imageSize)
+{
+    if ((offset & (DLS_CACHE_ALIGN - 1)) || (offset > imageSize))
+        return EAS_FALSE;
+    return (count <= (imageSize - offset) / itemSize);
+}
+
+/*----------------------------------------------------------------------------
+ * DLSWriteCache ()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Writes the cache image of a collection
+ *
+ * Inputs:
+ * pDLS - collection
+ * sourceSize - size of the source file
+ * sourceStamp - host defined stamp of the source file
+ * pBuffer - buffer for the image, or NULL to get its size only
+ * bufferSize - size of pBuffer
+ *
+ * Outputs:
+ * pCacheSize - size of the image
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT DLSWriteCache (const S_DLS *pDLS, EAS_U32 sourceSize, EAS_U32 sourceStamp, void *pBuffer, EAS_U32 bufferSize, EAS_U32 *pCacheSize)
+{
+    S_DLS_CACHE_HEADER header;
+    EAS_U8 *pImage;
+    EAS_U32 size;
+    EAS_U32 i;
+
+    EAS_HWMemSet(&header, 0, sizeof(header));
+    header.magic = DLS_CACHE_MAGIC;
+    header.version = DLS_CACHE_VERSION;
+    header.libVersion = LIB_VERSION;
+    header.layout = DLS_CACHE_LAYOUT;
+    header.sourceSize = sourceSize;
+    header.sourceStamp = sourceStamp;
+    header.numPrograms = pDLS->numDLSPrograms;
+    header.numRegions = pDLS->numDLSRegions;
+    header.numArticulations = pDLS->numDLSArticulations;
+    header.numSamples = pDLS->numDLSSamples;
+
+    /* samples played from the source file stay there */
+    if (pDLS->samplesMapped)
+        header.flags |= DLS_CACHE_SAMPLES_IN_SOURCE;
+    else
+    {
+        for (i = 0; i < header.numSamples; i++)
+        {
+            if (pDLS->pDLSSampleOffsets[i] + pDLS->pDLSSampleLen[i] > header.samplesSize)
+                header.samplesSize = pDLS->pDLSSampleOffsets[i] + pDLS->pDLSSampleLen[i];
+        }
+    }
+
+    size = sizeof(header);
+    header.programsOffset = DLSCacheSection(&size, header.numPrograms * sizeof(S_PROGRAM));
+    header.regionsOffset = DLSCacheSection(&size, header.numRegions * sizeof(S_DLS_REGION));
+    header.articulationsOffset = DLSCacheSection(&size, header.numArticulations * sizeof(S_DLS_ARTICULATION));
+    header.sampleLenOffset = DLSCacheSection(&size, header.numSamples * sizeof(EAS_U32));
+    header.sampleOffsetsOffset = DLSCacheSection(&size, header.numSamples * sizeof(EAS_U32));
+    header.samplesOffset = DLSCacheSection(&size, header.samplesSize);
+    header.size = size;
+
+    *pCacheSize = size;
+    if (pBuffer == NULL)
+        return EAS_SUCCESS;
+    if (bufferSize < size)
+        return EAS_ERROR_PARAMETER_RANGE;
+
+    pImage = (EAS_U8 *) pBuffer;
+    EAS_HWMemSet(pImage, 0, (EAS_I32) size);
+    EAS_HWMemCpy(pImage, &header, sizeof(header));
+    EAS_HWMemCpy(pImage + header.programsOffset, pDLS->pDLSPrograms, (EAS_I32) (header.numPrograms * sizeof(S_PROGRAM)));
+    EAS_HWMemCpy(pImage + header.regionsOffset, pDLS->pDLSRegions, (EAS_I32) (header.numRegions * sizeof(S_DLS_REGION)));
+    EAS_HWMemCpy(pImage + header.articulationsOffset, pDLS->pDLSArticulations, (EAS_I32) (header.numArticulations * sizeof(S_DLS_ARTICULATION)));
+    EAS_HWMemCpy(pImage + header.sampleLenOffset, pDLS->pDLSSampleLen, (EAS_I32) (header.numSamples * sizeof(EAS_U32)));
+    EAS_HWMemCpy(pImage + header.sampleOffsetsOffset, pDLS->pDLSSampleOffsets, (EAS_I32) (header.numSamples * sizeof(EAS_U32)));
+    EAS_HWMemCpy(pImage + header.samplesOffset, pDLS->pDLSSamples, (EAS_I32) header.samplesSize);
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * DLSReadCache ()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Creates a collection from a cache image, using the tables in place
+ *
+ * Inputs:
+ * hwInstData - host instance data
+ * pCache - cache image, aligned to 8 bytes
+ * cacheSize - size of the image
+ * pFileData - source file contents, needed when the samples are there
+ * sourceSize - current size of the source file
+ * sourceStamp - current host defined stamp of the source file
+ *
+ * Outputs:
+ * ppDLS - collection
+ *
+ * Side Effects:
+ * pCache and pFileData must remain valid until the collection is freed
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT DLSReadCache (EAS_HW_DATA_HANDLE hwInstData, const void *pCache, EAS_U32 cacheSize, const void *pFileData, EAS_U32 sourceSize, EAS_U32 sourceStamp, S_DLS **ppDLS)
+{
+    const S_DLS_CACHE_HEADER *pHeader = (const S_DLS_CACHE_HEADER *) pCache;
+    const EAS_U8 *pImage = (const EAS_U8 *) pCache;
+    const S_PROGRAM *pPrograms;
+    const S_DLS_REGION *pRegions;
+    const EAS_U32 *pSampleLen;
+    const EAS_U32 *pSampleOffsets;
+    const EAS_U8 *pSamples;
+    EAS_U32 samplesSize;
+    EAS_U32 guardLen;
+    EAS_U32 i;
+    S_DLS *pDLS;
+
+    *ppDLS = NULL;
+
+    if (((EAS_IPTR) pCache & (DLS_CACHE_ALIGN - 1)) || (cacheSize < sizeof(S_DLS_CACHE_HEADER)))
+        return EAS_ERROR_INVALID_PARAMETER;
+    if (pHeader->magic != DLS_CACHE_MAGIC)
+        return EAS_ERROR_FILE_FORMAT;
+    if ((pHeader->version != DLS_CACHE_VERSION) || (pHeader->libVersion != LIB_VERSION) || (pHeader->layout != DLS_CACHE_LAYOUT))
+    {
+        EAS_Report(_EAS_SEVERITY_WARNING, "DLS cache was written by another build\n");
+        return EAS_ERROR_INCOMPATIBLE_VERSION;
+    }
+    if ((pHeader->sourceSize != sourceSize) || (pHeader->sourceStamp != sourceStamp))
+    {
+        EAS_Report(_EAS_SEVERITY_WARNING, "DLS cache does not match the source file\n");
+        return EAS_ERROR_DATA_INCONSISTENCY;
+    }
+
+    /* the tables must lie within the image */
+    if ((pHeader->size > cacheSize)
+        || (pHeader->numPrograms > 0xffff) || (pHeader->numRegions > 0xffff)
+        || (pHeader->numArticulations > 0xffff) || (pHeader->numSamples > 0xffff)
+        || !DLSCacheSectionValid(pHeader->programsOffset, pHeader->numPrograms, sizeof(S_PROGRAM), pHeader->size)
+        || !DLSCacheSectionValid(pHeader->regionsOffset, pHeader->numRegions, sizeof(S_DLS_REGION), pHeader->size)
+        || !DLSCacheSectionValid(pHeader->articulationsOffset, pHeader->numArticulations, sizeof(S_DLS_ARTICULATION), pHeader->size)
+        || !DLSCacheSectionValid(pHeader->sampleLenOffset, pHeader->numSamples, sizeof(EAS_U32), pHeader->size)
+        || !DLSCacheSectionValid(pHeader->sampleOffsetsOffset, pHeader->numSamples, sizeof(EAS_U32), pHeader->size)
+        || !DLSCacheSectionValid(pHeader->samplesOffset, pHeader->samplesSize, 1, pHeader->size))
+        return EAS_ERROR_FILE_FORMAT;
+
+    pPrograms = (const S_PROGRAM *) (pImage + pHeader->programsOffset);
+    pRegions = (const S_DLS_REGION *) (pImage + pHeader->regionsOffset);
+    pSampleLen = (const EAS_U32 *) (pImage + pHeader->sampleLenOffset);
+    pSampleOffsets = (const EAS_U32 *) (pImage + pHeader->sampleOffsetsOffset);
+
+    /* samples are in the image or in the source file */
+    if (pHeader->flags & DLS_CACHE_SAMPLES_IN_SOURCE)
+    {
+        if ((pFileData == NULL) || ((EAS_IPTR) pFileData & (sizeof(EAS_SAMPLE) - 1)))
+            return EAS_ERROR_INVALID_PARAMETER;
+        pSamples = (const EAS_U8 *) pFileData;
+        samplesSize = sourceSize;
+    }
+    else
+    {
+        pSamples = pImage + pHeader->samplesOffset;
+        samplesSize = pHeader->samplesSize;
+    }
+
+    /* the indices the synthesizer follows must stay within the tables */
+    for (i = 0; i < pHeader->numPrograms; i++)
+    {
+        if ((pPrograms[i].regionIndex != INVALID_REGION_INDEX) && ((pPrograms[i].regionIndex & REGION_INDEX_MASK) >= pHeader->numRegions))
+            return EAS_ERROR_FILE_FORMAT;
+    }
+    /* copied samples hold one more sample after the loop, see Parse_rgn */
+    guardLen = (pHeader->flags & DLS_CACHE_SAMPLES_IN_SOURCE) ? 0 : sizeof(EAS_SAMPLE);
+    for (i = 0; i < pHeader->numRegions; i++)
+    {
+        const S_WT_REGION *pRegion = &pRegions[i].wtRegion;
+        if ((pRegion->waveIndex >= pHeader->numSamples) || (pRegion->artIndex >= pHeader->numArticulations))
+            return EAS_ERROR_FILE_FORMAT;
+
+        /* a loop must lie within the sample; Parse_rgn writes loopStart == loopEnd for no loop */
+        if (pRegion->loopStart > pRegion->loopEnd)
+            return EAS_ERROR_FILE_FORMAT;
+        if ((pRegion->loopStart != pRegion->loopEnd)
+            && ((pSampleLen[pRegion->waveIndex] < guardLen)
+                || (pRegion->loopEnd > (pSampleLen[pRegion->waveIndex] - guardLen) / sizeof(EAS_SAMPLE))))
+            return EAS_ERROR_FILE_FORMAT;
+    }
+    if ((pHeader->numRegions > 0) && !(pRegions[pHeader->numRegions - 1].wtRegion.region.keyGroupAndFlags & REGION_FLAG_LAST_REGION))
+        return EAS_ERROR_FILE_FORMAT;
+    for (i = 0; i < pHeader->numSamples; i++)
+    {
+        if ((pSampleOffsets[i] > samplesSize) || (pSampleLen[i] > samplesSize - pSampleOffsets[i]) || (pSampleOffsets[i] & (sizeof(EAS_SAMPLE) - 1)))
+            return EAS_ERROR_FILE_FORMAT;
+    }
+
+    /* only the collection structure is allocated */
+    pDLS = EAS_HWMalloc(hwInstData, sizeof(S_DLS));
+    if (pDLS == NULL)
+        return EAS_ERROR_MALLOC_FAILED;
+    EAS_HWMemSet(pDLS, 0, sizeof(S_DLS));
+    pDLS->pDLSPrograms = (S_PROGRAM *) pPrograms;
+    pDLS->pDLSRegions = (S_DLS_REGION *) pRegions;
+    pDLS->pDLSArticulations = (S_DLS_ARTICULATION *) (pImage + pHeader->articulationsOffset);
+    pDLS->pDLSSampleLen = (EAS_U32 *) pSampleLen;
+    pDLS->pDLSSampleOffsets = (EAS_U32 *) pSampleOffsets;
+    pDLS->pDLSSamples = (EAS_SAMPLE *) pSamples;
+    pDLS->numDLSPrograms = (EAS_U16) pHeader->numPrograms;
+    pDLS->numDLSRegions = (EAS_U16) pHeader->numRegions;
+    pDLS->numDLSArticulations = (EAS_U16) pHeader->numArticulations;
+    pDLS->numDLSSamples = (EAS_U16) pHeader->numSamples;
+    pDLS->refCount = 1;
+    pDLS->libType = DLSLIB_TYPE_CACHE;
+    pDLS->samplesMapped = (pHeader->flags & DLS_CACHE_SAMPLES_IN_SOURCE) ? EAS_TRUE : EAS_FALSE;
+    DLSBuildIndex(hwInstData, pDLS);
+
+    *ppDLS = pDLS;
+    return EAS_SUCCESS;
+}
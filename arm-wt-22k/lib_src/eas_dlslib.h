@@ -6,6 +6,7 @@
 #include "eas_types.h"
 #include "eas_synthcfg.h"
 #include "eas_sndlib.h"
+#include "eas_atomic.h"
 
 /*----------------------------------------------------------------------------
  * DLS envelope data structure
@@ -96,9 +97,18 @@ typedef struct s_dls_region_tag
 } S_DLS_REGION;
 
 
+/* 16-bit PCM sample data can be used in place: it needs no conversion, and
+ * the interpolator wraps before it reads past the loop end, so it does not
+ * need the loop start copied after the loop end
+ */
+#if defined(_16_BIT_SAMPLES)
+#define DLS_MAPPED_SAMPLES
+#endif
+
 enum {
     DLSLIB_TYPE_DLS = 0x00,
-    DLSLIB_TYPE_SF2 = 0x10
+    DLSLIB_TYPE_SF2 = 0x10,
+    DLSLIB_TYPE_CACHE = 0x20    /* tables in a host cache image, see eas_dlscache.c */
 };
 /*----------------------------------------------------------------------------
  * DLS data structure
@@ -112,6 +122,8 @@ enum {
  * numDLSRegions        number of DLS regions
  * numDLSArticulations  number of DLS articulations
  * numDLSSamples        number of DLS samples
+ * refCount             number of synths, streams and hosts using the collection
+ * samplesMapped        pDLSSamples points into the host's copy of the source file
  *----------------------------------------------------------------------------
 */
 typedef struct s_eas_dls_tag
@@ -126,9 +138,20 @@ typedef struct s_eas_dls_tag
     EAS_U16             numDLSRegions;
     EAS_U16             numDLSArticulations;
     EAS_U16             numDLSSamples;
-    EAS_U8              refCount;
+    EAS_U16             *pProgramIndex;     /* locale hash of program numbers, NULL to search the table */
+    EAS_U8              programIndexBits;   /* log2 of the number of hash slots */
+    EAS_U32             *pRegionNotes;      /* per region, offset of its program's note table in pNoteIndex */
+    EAS_U16             *pNoteIndex;        /* note tables, see DLSFindRegions */
+    EAS_ATOMIC_COUNT    refCount;
     EAS_U8              libType;
+    EAS_BOOL            samplesMapped;
 } S_DLS;
 
+/* empty slot in pProgramIndex */
+#define DLS_PROGRAM_INDEX_EMPTY     0xffff
+
+/* region without a note table in pRegionNotes */
+#define DLS_NOTE_INDEX_NONE         0xffffffff
+
 
 #endif
\ No newline at end of file
@@ -313,7 +313,7 @@ static void DLS_UpdateFilter (S_SYNTH_VOICE *pVoice, S_WT_VOICE *pWTVoice, S_WT_
         return;
     }
 
-    WT_SetFilterCoeffs(pIntFrame, cutoff, pDLSArt->filterQandFlags & FILTER_Q_MASK);
+    WT_SetFilterCoeffs(&pWTVoice->filter, pIntFrame, cutoff, pDLSArt->filterQandFlags & FILTER_Q_MASK);
 }
 
 /*----------------------------------------------------------------------------
@@ -385,6 +385,10 @@ EAS_RESULT DLS_StartVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH_VOIC
 #endif
     }
 
+    /* the filter of an articulation at the default cutoff is bypassed */
+    pWTVoice->pfProcess = WT_SelectVoiceKernel(pWTVoice,
+        (pDLSArt->filterCutoff != DEFAULT_DLS_FILTER_CUTOFF_FREQUENCY) ? EAS_TRUE : EAS_FALSE);
+
     return EAS_SUCCESS;
 }
 
@@ -414,6 +418,7 @@ EAS_BOOL DLS_UpdateVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH_VOICE
     const S_DLS_ARTICULATION *pDLSArt;
     S_WT_INT_FRAME intFrame;
     EAS_I32 temp;
+    EAS_I32 ticks;
     EAS_BOOL done = EAS_FALSE;
 
     /* establish pointers to critical data */
@@ -422,13 +427,16 @@ EAS_BOOL DLS_UpdateVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH_VOICE
     pChannel = &pSynth->channels[pVoice->channel & 15];
     pDLSArt = &pSynth->pDLS->pDLSArticulations[pWTVoice->artIndex];
 
-    /* update the envelopes */
-    DLS_UpdateEnvelope(pVoice, pChannel, &pDLSArt->eg1, &pWTVoice->eg1Value, &pWTVoice->eg1Increment, &pWTVoice->eg1State);
-    DLS_UpdateEnvelope(pVoice, pChannel, &pDLSArt->eg2, &pWTVoice->eg2Value, &pWTVoice->eg2Increment, &pWTVoice->eg2State);
+    /* update the envelopes and the LFOs once per native control period */
+    for (ticks = VMControlTicks(pVoiceMgr, pVoice); ticks > 0; ticks--)
+    {
+        DLS_UpdateEnvelope(pVoice, pChannel, &pDLSArt->eg1, &pWTVoice->eg1Value, &pWTVoice->eg1Increment, &pWTVoice->eg1State);
+        DLS_UpdateEnvelope(pVoice, pChannel, &pDLSArt->eg2, &pWTVoice->eg2Value, &pWTVoice->eg2Increment, &pWTVoice->eg2State);
 
-    /* update the LFOs using the EAS synth function */
-    WT_UpdateLFO(&pWTVoice->modLFO, pDLSArt->modLFO.lfoFreq);
-    WT_UpdateLFO(&pWTVoice->vibLFO, pDLSArt->vibLFO.lfoFreq);
+        /* update the LFOs using the EAS synth function */
+        WT_UpdateLFO(&pWTVoice->modLFO, pDLSArt->modLFO.lfoFreq);
+        WT_UpdateLFO(&pWTVoice->vibLFO, pDLSArt->vibLFO.lfoFreq);
+    }
 
     /* calculate base frequency */
     temp = pDLSArt->tuning + pChannel->staticPitch + pDLSRegion->wtRegion.tuning +
@@ -444,6 +452,29 @@ EAS_BOOL DLS_UpdateVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH_VOICE
     /* calculate gain including modulation effects */
     intFrame.frame.gainTarget = DLS_UpdateGain(pWTVoice, pDLSArt, pChannel, pDLSRegion->wtRegion.gain, pVoice->velocity);
     intFrame.prevGain = pVoice->gain;
+    intFrame.pitchOffset = pVoiceMgr->pitchOffset;
+#if defined(_FILTER_ENABLED) && defined(_FLOAT_DCF)
+    intFrame.pFilterTable = &pVoiceMgr->filterTable;
+#if defined(_REFERENCE_RENDER_PATHS)
+    intFrame.pFilterBatch = (pVoiceMgr->renderPaths & VM_PATH_FILTER_BATCH) ? &pVoiceMgr->filterBatch : NULL;
+#else
+    intFrame.pFilterBatch = &pVoiceMgr->filterBatch;
+#endif
+#endif
+#if defined(_VOICE_PARALLEL)
+#if defined(_REFERENCE_RENDER_PATHS)
+    intFrame.pVoiceBatches = (pVoiceMgr->renderPaths & VM_PATH_VOICE_BATCHES) ? pVoiceMgr->voiceBatches : NULL;
+#else
+    intFrame.pVoiceBatches = pVoiceMgr->voiceBatches;
+#endif
+#endif
+
+    /* a released voice that has faded below the output resolution is finished,
+     * and so is one sustaining at zero level */
+    if (((pWTVoice->eg1State == eEnvelopeStateRelease) ||
+        ((pWTVoice->eg1State == eEnvelopeStateSustain) && (pWTVoice->eg1Value == 0))) &&
+        (intFrame.prevGain <= SYNTH_CULL_GAIN) && (intFrame.frame.gainTarget <= SYNTH_CULL_GAIN))
+        pWTVoice->eg1State = eEnvelopeStateMuted;
 
     DLS_UpdateFilter(pVoice, pWTVoice, &intFrame, pChannel, pDLSArt);
 
@@ -451,6 +482,9 @@ EAS_BOOL DLS_UpdateVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH_VOICE
     intFrame.pAudioBuffer = pVoiceMgr->voiceBuffer;
     intFrame.pMixBuffer = pMixBuffer;
     intFrame.numSamples = numSamples;
+    intFrame.controlPeriod = pVoiceMgr->controlPeriod;
+    intFrame.controlPeriodBits = pVoiceMgr->controlPeriodBits;
+    intFrame.pfInterpolate = pVoiceMgr->pfInterpolate;
     if (numSamples < 0)
         return EAS_FALSE;
 
@@ -458,10 +492,10 @@ EAS_BOOL DLS_UpdateVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH_VOICE
     if ((pWTVoice->loopStart != WT_NOISE_GENERATOR) && (pWTVoice->loopStart == pWTVoice->loopEnd))
         done = WT_CheckSampleEnd(pWTVoice, &intFrame, EAS_FALSE);
 
-    if (intFrame.numSamples < BUFFER_SIZE_IN_MONO_SAMPLES)
-        memset(pMixBuffer + intFrame.numSamples * NUM_OUTPUT_CHANNELS, 0, (BUFFER_SIZE_IN_MONO_SAMPLES - intFrame.numSamples) * NUM_OUTPUT_CHANNELS * sizeof(EAS_I32));
+    if (intFrame.numSamples < intFrame.controlPeriod)
+        memset(pMixBuffer + intFrame.numSamples * NUM_OUTPUT_CHANNELS, 0, (intFrame.controlPeriod - intFrame.numSamples) * NUM_OUTPUT_CHANNELS * sizeof(EAS_I32));
 
-    WT_ProcessVoice(pWTVoice, &intFrame);
+    pWTVoice->pfProcess(pWTVoice, &intFrame);
 
     /* clear flag */
     pVoice->voiceFlags &= ~VOICE_FLAG_NO_SAMPLES_SYNTHESIZED_YET;
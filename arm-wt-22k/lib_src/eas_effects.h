@@ -39,6 +39,8 @@ typedef struct
     EAS_RESULT  (*pfShutdown)(EAS_DATA_HANDLE pEASData, EAS_VOID_PTR pInstData);
     EAS_RESULT  (*pFGetParam)(EAS_VOID_PTR pInstData, EAS_I32 param, EAS_I32 *pValue);
     EAS_RESULT  (*pFSetParam)(EAS_VOID_PTR pInstData, EAS_I32 param, EAS_I32 value);
+    /* same as pfProcess on 32-bit buffers, NULL if the effect only has 16-bit IO */
+    void        (*pfProcess32)(EAS_VOID_PTR pInstData, EAS_I32 *in, EAS_I32 *out, EAS_I32 numSamples);
 } S_EFFECTS_INTERFACE;
 
 typedef struct
@@ -62,11 +62,11 @@ void WT_VoiceFilter (S_FILTER_CONTROL *pFilter, S_WT_INT_FRAME *pWTIntFrame)
         ALOGE("b/26366256");
         android_errorWriteLog(0x534e4554, "26366256");
         return;
-    } else if (numSamples > BUFFER_SIZE_IN_MONO_SAMPLES) {
-        EAS_Report(_EAS_SEVERITY_ERROR, "%s: numSamples %d > %d BUFFER_SIZE_IN_MONO_SAMPLES\n", __func__, numSamples, BUFFER_SIZE_IN_MONO_SAMPLES);
-        ALOGE("b/317780080 clip numSamples %d -> %d", numSamples, BUFFER_SIZE_IN_MONO_SAMPLES);
+    } else if (numSamples > pWTIntFrame->controlPeriod) {
+        EAS_Report(_EAS_SEVERITY_ERROR, "%s: numSamples %d > %d controlPeriod\n", __func__, numSamples, pWTIntFrame->controlPeriod);
+        ALOGE("b/317780080 clip numSamples %d -> %d", numSamples, pWTIntFrame->controlPeriod);
         android_errorWriteLog(0x534e4554, "317780080");
-        numSamples = BUFFER_SIZE_IN_MONO_SAMPLES;
+        numSamples = pWTIntFrame->controlPeriod;
     }
     pAudioBuffer = pWTIntFrame->pAudioBuffer;
 
@@ -289,8 +289,10 @@ static const EAS_I16 n1g3[] =
  * Update the Filter parameters
  *
  * Inputs:
- * pVoice - ptr to the voice whose filter we want to update
- * pEASData - pointer to overall EAS data structure
+ * pFilter - filter of the voice, unused by the fixed point filter
+ * pIntFrame - frame of the voice whose filter we want to update
+ * cutoff - cutoff frequency in cents
+ * resonance - index of the resonance
  *
  * Outputs:
  *
@@ -298,11 +300,12 @@ static const EAS_I16 n1g3[] =
  * - updates Filter values for the given voice
  *----------------------------------------------------------------------------
 */
-void WT_SetFilterCoeffs (S_WT_INT_FRAME *pIntFrame, EAS_I32 cutoff, EAS_I32 resonance)
+void WT_SetFilterCoeffs (S_FILTER_CONTROL *pFilter, S_WT_INT_FRAME *pIntFrame, EAS_I32 cutoff, EAS_I32 resonance)
 {
     EAS_I32 temp;
 
     /* subtract the A5 offset and the sampling frequency */
+    cutoff += pIntFrame->pitchOffset;
     cutoff -= FILTER_CUTOFF_FREQ_ADJUST + A5_PITCH_OFFSET_IN_CENTS;
 
     /* limit the cutoff frequency */
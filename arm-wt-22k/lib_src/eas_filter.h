@@ -16,12 +16,46 @@ typedef struct s_filter_control_tag
     EAS_I32     y2;                             /* 2 sample delay output */
     EAS_I32     x1;                             /* 1 sample delay input */
     EAS_I32     x2;                             /* 2 sample delay input */
+    EAS_I32     cutoff;                         /* cutoff of the cached coefficients, with the pitch offset */
+    EAS_I32     resonance;                      /* resonance of the cached coefficients */
+    float       a1;                             /* cached coefficients, b02 is 0 if none are cached */
+    float       a2;
+    float       b02;
+    float       b1;
 #else
     EAS_I16     z1;                             /* 1 sample delay state variable */
     EAS_I16     z2;                             /* 2 sample delay state variable */
 #endif
 } S_FILTER_CONTROL;
 
+#ifdef _FLOAT_DCF
+/* the cutoff table spans the cutoff range of _OUTPUT_SAMPLE_RATE / 240 to
+ * _OUTPUT_SAMPLE_RATE / 2, which is 1200 * log2(120) = 8288.3 cents */
+#define FILTER_CUTOFF_TABLE_STEP        10
+#define FILTER_CUTOFF_TABLE_SIZE        (8289 / FILTER_CUTOFF_TABLE_STEP + 2)
+
+/* resonances are in 0.1 dB steps, higher ones than the table are computed */
+#define FILTER_RESONANCE_TABLE_SIZE     961
+
+/*----------------------------------------------------------------------------
+ * S_FILTER_TABLE data structure
+ *----------------------------------------------------------------------------
+*/
+typedef struct s_filter_table_tag
+{
+    float       minCutoff;                                  /* cutoff of the first entry in cents */
+    float       cutoffScale[FILTER_CUTOFF_TABLE_SIZE];      /* 1 / (2 * tan(theta / 2)) */
+    float       invQ[FILTER_RESONANCE_TABLE_SIZE];          /* 1 / Q */
+    float       gain[FILTER_RESONANCE_TABLE_SIZE];          /* resonance gain compensation */
+} S_FILTER_TABLE;
+
+/* voices filtered together by WT_VoiceFilterLanes */
+#define WT_FILTER_LANES                 4
+
+void WT_InitFilterTable (S_FILTER_TABLE *pTable);
+void WT_VoiceFilterLanes (S_FILTER_CONTROL *pFilters[], S_WT_INT_FRAME *pWTIntFrames[], const EAS_I16 *pPanGains, EAS_I32 numSamples);
+#endif
+
 void WT_VoiceFilter (S_FILTER_CONTROL* pFilter, S_WT_INT_FRAME *pWTIntFrame);
-void WT_SetFilterCoeffs (S_WT_INT_FRAME *pIntFrame, EAS_I32 cutoff, EAS_I32 resonance);
+void WT_SetFilterCoeffs (S_FILTER_CONTROL *pFilter, S_WT_INT_FRAME *pIntFrame, EAS_I32 cutoff, EAS_I32 resonance);
 #endif
@@ -8,9 +8,17 @@
 #include "eas_wtengine.h"
 #include "eas_report.h"
 #include "eas_audioconst.h"
+#include "eas_math.h"
 
 #if defined(_FILTER_ENABLED) && defined(_FLOAT_DCF)
 
+#if defined(_SIMD_KERNELS)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define FILTER_SSE2
+#include <emmintrin.h>
+#endif
+#endif
+
 /*----------------------------------------------------------------------------
  * WT_VoiceFilter
  *----------------------------------------------------------------------------
@@ -36,11 +44,11 @@ void WT_VoiceFilter (S_FILTER_CONTROL *pFilter, S_WT_INT_FRAME *pWTIntFrame)
         ALOGE("b/26366256");
         android_errorWriteLog(0x534e4554, "26366256");
         return;
-    } else if (numSamples > BUFFER_SIZE_IN_MONO_SAMPLES) {
-        EAS_Report(_EAS_SEVERITY_ERROR, "%s: numSamples %d > %d BUFFER_SIZE_IN_MONO_SAMPLES\n", __func__, numSamples, BUFFER_SIZE_IN_MONO_SAMPLES);
-        ALOGE("b/317780080 clip numSamples %d -> %d", numSamples, BUFFER_SIZE_IN_MONO_SAMPLES);
+    } else if (numSamples > pWTIntFrame->controlPeriod) {
+        EAS_Report(_EAS_SEVERITY_ERROR, "%s: numSamples %d > %d controlPeriod\n", __func__, numSamples, pWTIntFrame->controlPeriod);
+        ALOGE("b/317780080 clip numSamples %d -> %d", numSamples, pWTIntFrame->controlPeriod);
         android_errorWriteLog(0x534e4554, "317780080");
-        numSamples = BUFFER_SIZE_IN_MONO_SAMPLES;
+        numSamples = pWTIntFrame->controlPeriod;
     }
     EAS_PCM *pAudioBuffer = pWTIntFrame->pAudioBuffer;
 
@@ -83,55 +91,300 @@ void WT_VoiceFilter (S_FILTER_CONTROL *pFilter, S_WT_INT_FRAME *pWTIntFrame)
     pFilter->x2 = x2;
 }
 
-/* 
- * Compute filter coefficients for a 2nd-order (2-pole) low-pass IIR filter
+#if defined(FILTER_SSE2)
+/* low 32 bits of the lane products, which are the same signed or unsigned */
+static __m128i WT_MulLanesSSE2 (__m128i a, __m128i b)
+{
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+#endif
+
+/*----------------------------------------------------------------------------
+ * WT_VoiceFilterLanes
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Runs the filters of WT_FILTER_LANES voices together, one voice per SIMD
+ * lane. Each lane does the same float operations in the same order as
+ * WT_VoiceFilter, so the results are identical.
  *
- * General 2-pole IIR transfer function is:
- *  H(z) = (b0 + b1 * z^-1 + b2 * z^-2) / (1 + a1 * z^-1 + a2 * z^-2)
- * Its difference equation is:
- *  y[n] = b0 * x[n] + b1 * x[n-1] + b2 * x[n-2] - a1 * y[n-1] - a2 * y[n-2]
+ * With pan gains, the filtered samples stay in registers through the gain
+ * ramp and the pan of WT_VoiceGain and go straight to the mix buffer of
+ * each lane, otherwise they are written back to the voice buffers.
  *
- */
-void WT_SetFilterCoeffs(S_WT_INT_FRAME *pIntFrame, EAS_I32 cutoff, EAS_I32 resonance) {
-    double fc = pow(2.0, (cutoff - 6900.0) / 1200.0) * 440.0;
+ * The delay state is integer and the input is 16-bit, so no operand is ever
+ * denormal and the filter needs no flush-to-zero mode.
+ *
+ * Inputs:
+ * pFilters - filter state of each lane
+ * pWTIntFrames - coefficients, gains and buffers of each lane
+ * pPanGains - left and right gain of each lane, or NULL to only filter
+ * numSamples - samples to filter in every lane, at most controlPeriod
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void WT_VoiceFilterLanes (S_FILTER_CONTROL *pFilters[], S_WT_INT_FRAME *pWTIntFrames[], const EAS_I16 *pPanGains, EAS_I32 numSamples)
+{
+    EAS_PCM *pBuffers[WT_FILTER_LANES];
+    EAS_I32 *pMixBuffers[WT_FILTER_LANES];
+    EAS_I32 gain[WT_FILTER_LANES];
+    EAS_I32 gainIncrement[WT_FILTER_LANES];
+    EAS_INT lane;
+    EAS_I32 n;
+
+    for (lane = 0; lane < WT_FILTER_LANES; lane++)
+    {
+        pBuffers[lane] = pWTIntFrames[lane]->pAudioBuffer;
+        pMixBuffers[lane] = pWTIntFrames[lane]->pMixBuffer;
+
+        /* gain ramp of WT_VoiceGain */
+        gainIncrement[lane] = (pWTIntFrames[lane]->frame.gainTarget - pWTIntFrames[lane]->prevGain) * (1 << 16) / pWTIntFrames[lane]->controlPeriod;
+        if (gainIncrement[lane] < 0)
+            gainIncrement[lane]++;
+        gain[lane] = pWTIntFrames[lane]->prevGain * (1 << 16);
+    }
+
+#if defined(FILTER_SSE2)
+    const __m128 b1 = _mm_setr_ps(pWTIntFrames[0]->frame.b1, pWTIntFrames[1]->frame.b1,
+                                  pWTIntFrames[2]->frame.b1, pWTIntFrames[3]->frame.b1);
+    const __m128 b02 = _mm_setr_ps(pWTIntFrames[0]->frame.b02, pWTIntFrames[1]->frame.b02,
+                                   pWTIntFrames[2]->frame.b02, pWTIntFrames[3]->frame.b02);
+    const __m128 a1 = _mm_setr_ps(pWTIntFrames[0]->frame.a1, pWTIntFrames[1]->frame.a1,
+                                  pWTIntFrames[2]->frame.a1, pWTIntFrames[3]->frame.a1);
+    const __m128 a2 = _mm_setr_ps(pWTIntFrames[0]->frame.a2, pWTIntFrames[1]->frame.a2,
+                                  pWTIntFrames[2]->frame.a2, pWTIntFrames[3]->frame.a2);
+    const __m128 upper = _mm_set1_ps((1 << 15) - 1);
+    const __m128 lower = _mm_set1_ps(-(1 << 15));
+    const __m128i gainInc = _mm_loadu_si128((const __m128i *) gainIncrement);
+    __m128i gains = _mm_loadu_si128((const __m128i *) gain);
+    __m128i y1 = _mm_setr_epi32(pFilters[0]->y1, pFilters[1]->y1, pFilters[2]->y1, pFilters[3]->y1);
+    __m128i y2 = _mm_setr_epi32(pFilters[0]->y2, pFilters[1]->y2, pFilters[2]->y2, pFilters[3]->y2);
+    __m128i x1 = _mm_setr_epi32(pFilters[0]->x1, pFilters[1]->x1, pFilters[2]->x1, pFilters[3]->x1);
+    __m128i x2 = _mm_setr_epi32(pFilters[0]->x2, pFilters[1]->x2, pFilters[2]->x2, pFilters[3]->x2);
+#if (NUM_OUTPUT_CHANNELS == 2)
+    __m128i gainLeft = _mm_setzero_si128();
+    __m128i gainRight = _mm_setzero_si128();
+    __m128i left;
+    __m128i right;
+    __m128i pair;
+#endif
+    __m128i x;
+    __m128i smp;
+    __m128 acc0;
+    EAS_I32 out[WT_FILTER_LANES];
+
+#if (NUM_OUTPUT_CHANNELS == 2)
+    if (pPanGains != NULL)
+    {
+        gainLeft = _mm_setr_epi32(pPanGains[0], pPanGains[2], pPanGains[4], pPanGains[6]);
+        gainRight = _mm_setr_epi32(pPanGains[1], pPanGains[3], pPanGains[5], pPanGains[7]);
+    }
+#endif
+
+    for (n = 0; n < numSamples; n++)
+    {
+        x = _mm_setr_epi32(pBuffers[0][n], pBuffers[1][n], pBuffers[2][n], pBuffers[3][n]);
+
+        acc0 = _mm_mul_ps(b02, _mm_cvtepi32_ps(x));
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(b1, _mm_cvtepi32_ps(x1)));
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(b02, _mm_cvtepi32_ps(x2)));
+        acc0 = _mm_sub_ps(acc0, _mm_mul_ps(a1, _mm_cvtepi32_ps(y1)));
+        acc0 = _mm_sub_ps(acc0, _mm_mul_ps(a2, _mm_cvtepi32_ps(y2)));
+
+        // saturate
+        acc0 = _mm_max_ps(_mm_min_ps(acc0, upper), lower);
+
+        y2 = y1;
+        y1 = _mm_cvttps_epi32(acc0);
+        x2 = x1;
+        x1 = x;
+
+        if (pPanGains == NULL)
+        {
+            _mm_storeu_si128((__m128i *) out, y1);
+            for (lane = 0; lane < WT_FILTER_LANES; lane++)
+                pBuffers[lane][n] = (EAS_PCM) out[lane];
+            continue;
+        }
 
+        /* incremental gain step, gain / (1 << 16) rounds toward zero */
+        gains = _mm_add_epi32(gains, gainInc);
+        smp = _mm_add_epi32(gains, _mm_srli_epi32(_mm_srai_epi32(gains, 31), 16));
+        smp = _mm_srai_epi32(WT_MulLanesSSE2(y1, _mm_srai_epi32(smp, 16)), 15);
+
+#if (NUM_OUTPUT_CHANNELS == 2)
+        /* left and right channels, two lanes per store */
+        left = _mm_srai_epi32(WT_MulLanesSSE2(smp, gainLeft), NUM_EG1_FRAC_BITS);
+        right = _mm_srai_epi32(WT_MulLanesSSE2(smp, gainRight), NUM_EG1_FRAC_BITS);
+        pair = _mm_unpacklo_epi32(left, right);
+        _mm_storel_epi64((__m128i *) &pMixBuffers[0][n * 2], pair);
+        _mm_storel_epi64((__m128i *) &pMixBuffers[1][n * 2], _mm_srli_si128(pair, 8));
+        pair = _mm_unpackhi_epi32(left, right);
+        _mm_storel_epi64((__m128i *) &pMixBuffers[2][n * 2], pair);
+        _mm_storel_epi64((__m128i *) &pMixBuffers[3][n * 2], _mm_srli_si128(pair, 8));
+#else
+        /* mono output */
+        _mm_storeu_si128((__m128i *) out, smp);
+        for (lane = 0; lane < WT_FILTER_LANES; lane++)
+            pMixBuffers[lane][n] = out[lane];
+#endif
+    }
+
+    /* save delay values */
+    for (lane = 0; lane < WT_FILTER_LANES; lane++)
+    {
+        _mm_storeu_si128((__m128i *) out, y1);
+        pFilters[lane]->y1 = out[lane];
+        _mm_storeu_si128((__m128i *) out, y2);
+        pFilters[lane]->y2 = out[lane];
+        _mm_storeu_si128((__m128i *) out, x1);
+        pFilters[lane]->x1 = out[lane];
+        _mm_storeu_si128((__m128i *) out, x2);
+        pFilters[lane]->x2 = out[lane];
+    }
+
+#else
+    /* other CPUs, NEON included, filter the lanes one after the other */
+    for (lane = 0; lane < WT_FILTER_LANES; lane++)
+    {
+        S_WT_INT_FRAME intFrame = *pWTIntFrames[lane];
+        EAS_PCM *pInput = pBuffers[lane];
+        EAS_I32 *pOutput = pMixBuffers[lane];
+        EAS_I32 smp;
+
+        intFrame.numSamples = numSamples;
+        WT_VoiceFilter(pFilters[lane], &intFrame);
+        if (pPanGains == NULL)
+            continue;
+
+        for (n = 0; n < numSamples; n++)
+        {
+            gain[lane] += gainIncrement[lane];
+            smp = FMUL_15x15(pInput[n], gain[lane] / (1 << 16));
+#if (NUM_OUTPUT_CHANNELS == 2)
+            *pOutput++ = MULT_EG1_EG1(smp, pPanGains[lane * 2]);
+            *pOutput++ = MULT_EG1_EG1(smp, pPanGains[lane * 2 + 1]);
+#else
+            *pOutput++ = smp;
+#endif
+        }
+    }
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * WT_InitFilterTable
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Computes the cutoff and resonance terms of the filter coefficients for
+ * _OUTPUT_SAMPLE_RATE, other output rates are folded into the cutoff by the
+ * pitch offset
+ *
+ * Inputs:
+ * pTable - table to fill
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void WT_InitFilterTable (S_FILTER_TABLE *pTable)
+{
     const double fs = (double)_OUTPUT_SAMPLE_RATE;
     const double min_fc = fs / 240.0;
     const double max_fc = fs / 2.0;
-    fc = fmax(fmin(fc, max_fc), min_fc);
+    const double min_cents = 6900.0 + 1200.0 * log2(min_fc / 440.0);
+    EAS_I32 i;
 
-    // EAS's resonance is in 0.75dB steps
-    const double resonance_dB = fmax(resonance / 10.0, 0.0);
+    pTable->minCutoff = (float) min_cents;
+    for (i = 0; i < FILTER_CUTOFF_TABLE_SIZE; i++)
+    {
+        double fc = pow(2.0, (min_cents + i * FILTER_CUTOFF_TABLE_STEP - 6900.0) / 1200.0) * 440.0;
+        fc = fmin(fc, max_fc);
 
-    // filter pole angle
-    const double theta = 2.0 * M_PI * fc / fs;
+        // 1 / omega0T with the bilinear transform, goes to 0 at Nyquist
+        const double theta = 2.0 * M_PI * fc / fs;
+        pTable->cutoffScale[i] = (float) (1.0 / (2.0 * tan(theta / 2)));
+    }
 
-    const double T = 1.0 / _OUTPUT_SAMPLE_RATE;
-    const double omega0 = 2.0 * _OUTPUT_SAMPLE_RATE * tan(theta / 2);
-    double q;
-    if (resonance_dB < 1e-9) {
-        q = 1 / sqrt(2); // default Q for Butterworth filter
-    } else {
-        q = pow(10.0, resonance_dB / 20.0);
+    // EAS's resonance is in 0.1dB steps
+    for (i = 0; i < FILTER_RESONANCE_TABLE_SIZE; i++)
+    {
+        const double resonance_dB = i / 10.0;
+        if (i == 0) {
+            pTable->invQ[i] = (float) sqrt(2); // default Q for Butterworth filter
+        } else {
+            pTable->invQ[i] = (float) pow(10.0, -resonance_dB / 20.0);
+        }
+        pTable->gain[i] = (float) pow(10.0, -resonance_dB / 40.0);
     }
+}
 
-    const double omega0T = omega0 * T;
-    const double D = 4 + 2 * omega0T / q + omega0T * omega0T;
+/*
+ * Compute filter coefficients for a 2nd-order (2-pole) low-pass IIR filter
+ *
+ * General 2-pole IIR transfer function is:
+ *  H(z) = (b0 + b1 * z^-1 + b2 * z^-2) / (1 + a1 * z^-1 + a2 * z^-2)
+ * Its difference equation is:
+ *  y[n] = b0 * x[n] + b1 * x[n-1] + b2 * x[n-2] - a1 * y[n-1] - a2 * y[n-2]
+ *
+ * With u = 1 / omega0T from the cutoff table, the bilinear transform gives
+ *  D = 4u^2 + 2u/q + 1, a1 = (2 - 8u^2) / D, a2 = (4u^2 - 2u/q + 1) / D
+ *  b0 = b2 = 1 / D, b1 = 2 / D
+ * The coefficients are kept in the voice filter and only recomputed when the
+ * cutoff or the resonance change.
+ */
+void WT_SetFilterCoeffs(S_FILTER_CONTROL *pFilter, S_WT_INT_FRAME *pIntFrame, EAS_I32 cutoff, EAS_I32 resonance) {
+    const S_FILTER_TABLE *pTable = pIntFrame->pFilterTable;
+
+    // the pitch offset maps the cutoff relative to the output rate onto _OUTPUT_SAMPLE_RATE
+    cutoff += pIntFrame->pitchOffset;
+    if (resonance < 0) {
+        resonance = 0;
+    }
 
-    // compute filter coefficients
-    const double a1 = (-8 + 2 * (omega0T * omega0T)) / D;
-    const double a2 = (4 - 2 * omega0T / q + omega0T * omega0T) / D;
-    double b02 = omega0T * omega0T / D;
-    double b1 = 2 * (omega0T * omega0T) / D;
+    if ((pFilter->b02 == 0) || (cutoff != pFilter->cutoff) || (resonance != pFilter->resonance)) {
+        // interpolate the cutoff table, the ends are the cutoff limits
+        float u;
+        const float x = ((float) cutoff - pTable->minCutoff) * (1.0f / FILTER_CUTOFF_TABLE_STEP);
+        if (x <= 0) {
+            u = pTable->cutoffScale[0];
+        } else if (x >= FILTER_CUTOFF_TABLE_SIZE - 1) {
+            u = pTable->cutoffScale[FILTER_CUTOFF_TABLE_SIZE - 1];
+        } else {
+            const EAS_I32 index = (EAS_I32) x;
+            u = pTable->cutoffScale[index] +
+                (pTable->cutoffScale[index + 1] - pTable->cutoffScale[index]) * (x - (float) index);
+        }
 
-    // apply resonance gain compensation
-    const double g = pow(10.0, -resonance_dB / 40.0);
-    b02 *= g;
-    b1 *= g;
+        float invQ;
+        float g;
+        if (resonance < FILTER_RESONANCE_TABLE_SIZE) {
+            invQ = pTable->invQ[resonance];
+            g = pTable->gain[resonance];
+        } else {
+            const double resonance_dB = resonance / 10.0;
+            invQ = (float) pow(10.0, -resonance_dB / 20.0);
+            g = (float) pow(10.0, -resonance_dB / 40.0);
+        }
+
+        // compute filter coefficients with the resonance gain compensation
+        const float u2 = u * u;
+        const float invD = 1.0f / (4 * u2 + 2 * u * invQ + 1);
+        pFilter->a1 = (2 - 8 * u2) * invD;
+        pFilter->a2 = (4 * u2 - 2 * u * invQ + 1) * invD;
+        pFilter->b02 = g * invD;
+        pFilter->b1 = 2 * pFilter->b02;
+        pFilter->cutoff = cutoff;
+        pFilter->resonance = resonance;
+    }
 
-    pIntFrame->frame.b1 = b1;
-    pIntFrame->frame.b02 = b02;
-    pIntFrame->frame.a1 = a1;
-    pIntFrame->frame.a2 = a2;
+    pIntFrame->frame.b1 = pFilter->b1;
+    pIntFrame->frame.b02 = pFilter->b02;
+    pIntFrame->frame.a1 = pFilter->a1;
+    pIntFrame->frame.a2 = pFilter->a2;
 }
 #endif
@@ -42,8 +42,6 @@ extern const EAS_U8 fmScaleTable[16];
 #define _EAS_MAX_OUTPUT 32767
 #define _EAS_MIN_OUTPUT -32767
 
-static S_FM_ENG_VOICE voices[NUM_FM_VOICES];
-
 /* local prototypes */
 void FM_SynthMixVoice (S_FM_ENG_VOICE *p,  EAS_U16 gainTarget, EAS_I32 numSamplesToAdd, EAS_I32 *pInputBuffer, EAS_I32 *pBuffer);
 
@@ -290,7 +288,7 @@ void FM_Operator (
 
 	/* calculate gain increment */
 	/*lint -e{703} use shift for performance */
-	gainInc = ((EAS_I32) gainTarget - (EAS_I32) p->gain) * (1 << 16) / BUFFER_SIZE_IN_MONO_SAMPLES;
+	gainInc = ((EAS_I32) gainTarget - (EAS_I32) p->gain) * (1 << 16) / numSamplesToAdd;
 
 	/* establish local phase variables */
 	phase = p->phase;
@@ -398,7 +396,7 @@ void FM_NoiseOperator (
 
 	/* calculate gain increment */
 	/*lint -e{703} use shift for performance */
-	gainInc = ((EAS_I32) gainTarget - (EAS_I32) p->gain) * (1 << 16) / BUFFER_SIZE_IN_MONO_SAMPLES;
+	gainInc = ((EAS_I32) gainTarget - (EAS_I32) p->gain) * (1 << 16) / numSamplesToAdd;
 
 	/* establish local phase variables */
 	phase = p->phase;
@@ -467,7 +465,7 @@ void FM_NoiseOperator (
  * Receives parameters to start a new voice.
  *
  * Inputs:
- * voiceNum		- voice number to start
+ * pVoice		- engine state of the voice to start
  * vCfg			- configuration data
  * pMixBuffer	- pointer to host supplied buffer
  *
@@ -483,14 +481,10 @@ void FM_NoiseOperator (
  *----------------------------------------------------------------------------
 */
 /*lint -esym(715, pFrameBuffer) pFrameBuffer not used in test version - see above */
-void FM_ConfigVoice (EAS_I32 voiceNum, S_FM_VOICE_CONFIG *vCfg, EAS_FRAME_BUFFER_HANDLE pFrameBuffer)
+void FM_ConfigVoice (S_FM_ENG_VOICE *pVoice, S_FM_VOICE_CONFIG *vCfg, EAS_FRAME_BUFFER_HANDLE pFrameBuffer)
 {
-	S_FM_ENG_VOICE *pVoice;
 	EAS_INT i;
 
-	/* establish pointer to voice data */
-	pVoice = &voices[voiceNum];
-
 	/* save data */
 	pVoice->feedback = vCfg->feedback;
 	pVoice->flags = vCfg->flags;
@@ -525,6 +519,7 @@ void FM_ConfigVoice (EAS_I32 voiceNum, S_FM_VOICE_CONFIG *vCfg, EAS_FRAME_BUFFER
  * Synthesizes a buffer of samples based on calculated parameters.
  *
  * Inputs:
+ * p				- engine state of the voice
  * nNumSamplesToAdd - number of samples to synthesize
  * psEASData - pointer to overall EAS data structure
  *
@@ -541,7 +536,7 @@ void FM_ConfigVoice (EAS_I32 voiceNum, S_FM_VOICE_CONFIG *vCfg, EAS_FRAME_BUFFER
 */
 /*lint -esym(715, pOut) pOut not used in test version - see above */
 void FM_ProcessVoice (
-		EAS_I32 voiceNum,
+		S_FM_ENG_VOICE *p,
 		S_FM_VOICE_FRAME *pFrame,
 		EAS_I32 numSamplesToAdd, 
 		EAS_I32 *pTempBuffer, 
@@ -549,7 +544,6 @@ void FM_ProcessVoice (
 		EAS_I32 *pMixBuffer,
 		EAS_FRAME_BUFFER_HANDLE pFrameBuffer)
 {
-	S_FM_ENG_VOICE *p;
 	EAS_I32 *pOutBuf;
 	EAS_I32 *pMod;
 	EAS_BOOL mix;
@@ -557,8 +551,6 @@ void FM_ProcessVoice (
 	EAS_U8 feedback3;
 	EAS_U8 mode;
 
-	/* establish pointer to voice data */
-	p = &voices[voiceNum];
 	mode = p->flags & 0x07;
 
 	/* lookup feedback values */
@@ -743,7 +735,7 @@ void FM_SynthMixVoice(S_FM_ENG_VOICE *p,  EAS_U16 nGainTarget, EAS_I32 numSample
 
 	/* calculate gain increment */
 	/*lint -e{703} <use shift for performance> */
-	nGainInc = ((EAS_I32) nGainTarget - (EAS_I32) p->voiceGain) * (1 << 16) / BUFFER_SIZE_IN_MONO_SAMPLES;
+	nGainInc = ((EAS_I32) nGainTarget - (EAS_I32) p->voiceGain) * (1 << 16) / numSamplesToAdd;
 
 	/* mix the output buffer */
 	while (numSamplesToAdd--)
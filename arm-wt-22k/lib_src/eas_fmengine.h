@@ -113,8 +113,8 @@ extern EAS_BOOL FM_EndFrame (EAS_FRAME_BUFFER_HANDLE pFrameBuffe, EAS_I32 *pMixB
 #endif
 
 /* FM engine prototypes */
-extern void FM_ConfigVoice (EAS_I32 voiceNum, S_FM_VOICE_CONFIG *vCfg, EAS_FRAME_BUFFER_HANDLE pFrameBuffer);
-extern void FM_ProcessVoice (EAS_I32 voiceNum, S_FM_VOICE_FRAME *pFrame, EAS_I32 numSamplesToAdd, EAS_I32 *pTempBuffer, EAS_I32 *pBuffer, EAS_I32 *pMixBuffer, EAS_FRAME_BUFFER_HANDLE pFrameBuffer);
+extern void FM_ConfigVoice (S_FM_ENG_VOICE *pVoice, S_FM_VOICE_CONFIG *vCfg, EAS_FRAME_BUFFER_HANDLE pFrameBuffer);
+extern void FM_ProcessVoice (S_FM_ENG_VOICE *p, S_FM_VOICE_FRAME *pFrame, EAS_I32 numSamplesToAdd, EAS_I32 *pTempBuffer, EAS_I32 *pBuffer, EAS_I32 *pMixBuffer, EAS_FRAME_BUFFER_HANDLE pFrameBuffer);
 
 #endif
 /* #ifndef _FMENGINE_H */
@@ -535,7 +535,7 @@ static void FM_UpdateChannel (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 ch
 	temp = FMUL_15x15(temp, pChannel->pitchBendSensitivity);
 
 	/* include "magic number" compensation for sample rate and lookup table size */
-	temp += MAGIC_NUMBER;
+	temp += MAGIC_NUMBER + pVoiceMgr->pitchOffset;
 
 	/* if this is not a drum channel, then add in the per-channel tuning */
 	if (!(pChannel->channelFlags & CHANNEL_FLAG_RHYTHM_CHANNEL))
@@ -806,6 +806,7 @@ static EAS_BOOL FM_UpdateVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH
 	EAS_I32 temp;
 	EAS_INT oper;
 	EAS_U16 voiceGainTarget;
+	EAS_I32 ticks;
 	EAS_BOOL done;
 
 	/* setup some pointers */
@@ -813,6 +814,9 @@ static EAS_BOOL FM_UpdateVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH
 	pRegion = GetFMRegionPtr(pSynth, pVoice);
 	pFMVoice = GetFMVoicePtr(pVoiceMgr, voiceNum);
 
+	/* number of native control periods in this block */
+	ticks = VMControlTicks(pVoiceMgr, pVoice);
+
 	/* if the voice is just starting, get the voice configuration data */
 	if (pVoice->voiceFlags & VOICE_FLAG_NO_SAMPLES_SYNTHESIZED_YET)
 	{
@@ -848,17 +852,19 @@ static EAS_BOOL FM_UpdateVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH
 		}
 
 #ifdef FM_OFFBOARD		
-		FM_ConfigVoice(voiceNum, &vCfg, pVoiceMgr->pFrameBuffer);
+		FM_ConfigVoice(&pFMVoice->engine, &vCfg, pVoiceMgr->pFrameBuffer);
 #else
-		FM_ConfigVoice(voiceNum, &vCfg, NULL);
+		FM_ConfigVoice(&pFMVoice->engine, &vCfg, NULL);
 #endif
 		
 		/* clear startup flag */
 		pVoice->voiceFlags &= ~VOICE_FLAG_NO_SAMPLES_SYNTHESIZED_YET;
 	}
 
-	/* calculate new synthesis parameters */
-	done = FM_UpdateDynamic(pVoice, pFMVoice, pRegion, pChannel);
+	/* calculate new synthesis parameters once per native control period */
+	done = EAS_FALSE;
+	for (; ticks > 0; ticks--)
+		done = FM_UpdateDynamic(pVoice, pFMVoice, pRegion, pChannel);
 
 	/* calculate LFO gain modulation */
 	/*lint -e{702} <use shift for performance> */
@@ -900,9 +906,9 @@ static EAS_BOOL FM_UpdateVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH
 
 	/* synthesize samples */
 #ifdef FM_OFFBOARD	
-	FM_ProcessVoice(voiceNum, &vFrame, numSamples, pVoiceMgr->operMixBuffer, pVoiceMgr->voiceBuffer, pMixBuffer, pVoiceMgr->pFrameBuffer);
+	FM_ProcessVoice(&pFMVoice->engine, &vFrame, numSamples, pVoiceMgr->operMixBuffer, pVoiceMgr->voiceBuffer, pMixBuffer, pVoiceMgr->pFrameBuffer);
 #else
-	FM_ProcessVoice(voiceNum, &vFrame, numSamples, pVoiceMgr->operMixBuffer, pVoiceMgr->operOutputBuffer, pMixBuffer, NULL);
+	FM_ProcessVoice(&pFMVoice->engine, &vFrame, numSamples, pVoiceMgr->operMixBuffer, pVoiceMgr->operOutputBuffer, pMixBuffer, NULL);
 #endif
 
 	return done;
@@ -32,6 +32,8 @@
 
 #include "eas_types.h"
 #include "eas_synthcfg.h"
+#include "eas_audioconst.h"
+#include "eas_fmengine.h"
 
 #if defined (_FM_SYNTH)
 
@@ -70,6 +72,7 @@ typedef struct s_fm_voice_tag
 	EAS_U16				lfoDelay;		/* keeps track of elapsed delay time */
 	EAS_I8				pan;			/* stereo pan value (-64 to +64) */
 	EAS_I8				pad;			/* reserved to maintain alignment */
+	S_FM_ENG_VOICE		engine;			/* FM engine state */
 } S_FM_VOICE;
 
 #ifdef _FM_EDITOR
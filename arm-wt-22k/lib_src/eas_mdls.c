@@ -269,6 +269,8 @@ typedef struct
     EAS_U32             waveCount;
     EAS_U32             wavePoolSize;
     EAS_U32             wavePoolOffset;
+    const EAS_U8        *pFileData;
+    EAS_I32             fileDataSize;
     EAS_BOOL            bigEndian;
     EAS_BOOL            filterUsed;
 } SDLS_SYNTHESIZER_DATA;
@@ -476,6 +478,34 @@ void DumpDLS (S_DLS *pEAS);
  *----------------------------------------------------------------------------
 */
 EAS_RESULT DLSParser (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fileHandle, EAS_I32 offset, EAS_DLSLIB_HANDLE *ppDLS)
+{
+    return DLSParserMapped(hwInstData, fileHandle, offset, NULL, 0, ppDLS);
+}
+
+/*----------------------------------------------------------------------------
+ * DLSParserMapped ()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Parses a collection whose file contents are also available in memory.
+ * Sample data that can be played as stored is not copied, the collection
+ * points into pFileData instead. Otherwise this is the same as DLSParser.
+ *
+ * Inputs:
+ * pEASData - pointer to over EAS data instance
+ * fileHandle - file handle for input file
+ * offset - offset into file where DLS data starts
+ * pFileData - contents of the file, or NULL to copy the samples
+ * fileDataSize - size of pFileData in bytes
+ *
+ * Outputs:
+ * EAS_RESULT
+ * ppEAS - address of pointer to alternate EAS wavetable
+ *
+ * Side Effects:
+ * pFileData must remain valid until the collection is freed
+ *----------------------------------------------------------------------------
+*/
+EAS_RESULT DLSParserMapped (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fileHandle, EAS_I32 offset, const void *pFileData, EAS_I32 fileDataSize, EAS_DLSLIB_HANDLE *ppDLS)
 {
     EAS_RESULT result;
     SDLS_SYNTHESIZER_DATA dls;
@@ -504,6 +534,15 @@ EAS_RESULT DLSParser (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fileHandle,
     dls.hwInstData = hwInstData;
     dls.fileHandle = fileHandle;
 
+#ifdef DLS_MAPPED_SAMPLES
+    /* samples must be aligned to be used in place */
+    if (((EAS_IPTR) pFileData & (sizeof(EAS_SAMPLE) - 1)) == 0)
+    {
+        dls.pFileData = pFileData;
+        dls.fileDataSize = fileDataSize;
+    }
+#endif
+
     /* NULL return value in case of error */
     *ppDLS = NULL;
 
@@ -525,7 +564,10 @@ EAS_RESULT DLSParser (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fileHandle,
         if (temp == CHUNK_TYPE('s', 'f', 'b', 'k')) {
             // let SF2Parser takeover
 #ifdef _SF2_SUPPORT
-            return SF2Parser(hwInstData, fileHandle, offset, ppDLS);
+            result = SF2Parser(hwInstData, fileHandle, offset, dls.pFileData, dls.fileDataSize, ppDLS);
+            if (result == EAS_SUCCESS)
+                DLSBuildIndex(hwInstData, *ppDLS);
+            return result;
 #else
             EAS_Report(_EAS_SEVERITY_ERROR, "SF2 support is not enabled\n");
             return EAS_ERROR_FEATURE_NOT_AVAILABLE;
@@ -663,8 +705,10 @@ EAS_RESULT DLSParser (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fileHandle,
         /* calculate size of wave length and offset arrays */
         waveLenSize = (EAS_I32) (dls.waveCount * sizeof(EAS_U32));
 
-        /* calculate final memory size */
-        size = (EAS_I32) sizeof(S_DLS) + instSize + rgnPoolSize + artPoolSize + (2 * waveLenSize) + (EAS_I32) dls.wavePoolSize;
+        /* calculate final memory size, mapped samples stay in the file data */
+        size = (EAS_I32) sizeof(S_DLS) + instSize + rgnPoolSize + artPoolSize + (2 * waveLenSize);
+        if (dls.pFileData == NULL)
+            size += (EAS_I32) dls.wavePoolSize;
         if (size <= 0) {
             EAS_HWFree(dls.hwInstData, dls.wsmpData);
             return EAS_ERROR_FILE_FORMAT;
@@ -708,7 +752,14 @@ EAS_RESULT DLSParser (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fileHandle,
         p = PtrOfs(p, waveLenSize);
 
         /* setup pointer to wave pool */
-        dls.pDLS->pDLSSamples = p;
+        if (dls.pFileData != NULL)
+        {
+            /* sample offsets are file positions */
+            dls.pDLS->pDLSSamples = (EAS_SAMPLE *) dls.pFileData;
+            dls.pDLS->samplesMapped = EAS_TRUE;
+        }
+        else
+            dls.pDLS->pDLSSamples = p;
 
         /* clear filter flag */
         dls.filterUsed = EAS_FALSE;
@@ -735,6 +786,7 @@ EAS_RESULT DLSParser (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fileHandle,
     /* if successful, return a pointer to the EAS collection */
     if (result == EAS_SUCCESS)
     {
+        DLSBuildIndex(dls.hwInstData, dls.pDLS);
         *ppDLS = dls.pDLS;
 #ifdef _DEBUG_DLS
         DumpDLS(dls.pDLS);
@@ -765,21 +817,26 @@ EAS_RESULT DLSParser (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fileHandle,
 EAS_RESULT DLSCleanup (EAS_HW_DATA_HANDLE hwInstData, S_DLS *pDLS)
 {
 
-    /* free the allocated memory */
+    /* free the allocated memory when the last reference is released */
     if (pDLS)
     {
-        if (pDLS->refCount)
-        {
-            if (--pDLS->refCount == 0) {
-                if (pDLS->libType == DLSLIB_TYPE_DLS) {
-                    EAS_HWFree(hwInstData, pDLS);
+        if (EAS_AtomicDecrement(&pDLS->refCount) == 0) {
+            if (pDLS->pProgramIndex)
+                EAS_HWFree(hwInstData, pDLS->pProgramIndex);
+            if (pDLS->pRegionNotes)
+                EAS_HWFree(hwInstData, pDLS->pRegionNotes);
+            if (pDLS->pNoteIndex)
+                EAS_HWFree(hwInstData, pDLS->pNoteIndex);
+
+            /* parsed DLS collections are one block, cached ones use the tables in place */
+            if ((pDLS->libType == DLSLIB_TYPE_DLS) || (pDLS->libType == DLSLIB_TYPE_CACHE)) {
+                EAS_HWFree(hwInstData, pDLS);
 #ifdef _SF2_SUPPORT
-                } else if (pDLS->libType == DLSLIB_TYPE_SF2) {
-                    return SF2Cleanup(hwInstData, pDLS);
+            } else if (pDLS->libType == DLSLIB_TYPE_SF2) {
+                return SF2Cleanup(hwInstData, pDLS);
 #endif
-                } else {
-                    return EAS_ERROR_DATA_INCONSISTENCY;
-                }
+            } else {
+                return EAS_ERROR_DATA_INCONSISTENCY;
             }
         }
     }
@@ -795,7 +852,373 @@ EAS_RESULT DLSCleanup (EAS_HW_DATA_HANDLE hwInstData, S_DLS *pDLS)
 void DLSAddRef (S_DLS *pDLS)
 {
     if (pDLS)
-        pDLS->refCount++;
+        (void) EAS_AtomicIncrement(&pDLS->refCount);
+}
+
+/* hash slot of a locale for an index of 2^bits slots */
+#define DLS_PROGRAM_HASH(locale, bits) ((EAS_U32) ((locale) * 0x9E3779B1u) >> (32 - (bits)))
+
+/*----------------------------------------------------------------------------
+ * DLSIndexPrograms ()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Builds the locale hash used by DLSFindProgram, so that program changes
+ * do not search the program table. The index is an open addressed table
+ * of program numbers at most half full. When a locale is repeated the
+ * first program wins, as it did with the table search.
+ *
+ * Inputs:
+ * hwInstData - used only for memory allocation
+ * pDLS - collection to index
+ *
+ * Outputs:
+ * If the index cannot be allocated, the collection is left without one
+ * and lookups search the program table.
+ *----------------------------------------------------------------------------
+*/
+static void DLSIndexPrograms (EAS_HW_DATA_HANDLE hwInstData, S_DLS *pDLS)
+{
+    EAS_U32 numSlots;
+    EAS_U32 mask;
+    EAS_U32 slot;
+    EAS_U16 *pIndex;
+    EAS_U8 bits;
+    EAS_U16 i;
+
+    if ((pDLS == NULL) || (pDLS->numDLSPrograms == 0))
+        return;
+
+    for (bits = 4; (1u << bits) < 2u * pDLS->numDLSPrograms; bits++) {}
+    numSlots = 1u << bits;
+    mask = numSlots - 1;
+
+    pIndex = EAS_HWMalloc(hwInstData, (EAS_I32) (numSlots * sizeof(EAS_U16)));
+    if (pIndex == NULL)
+    {
+        EAS_Report(_EAS_SEVERITY_WARNING, "DLSIndexPrograms: no memory for index, programs will be searched\n");
+        return;
+    }
+    EAS_HWMemSet(pIndex, 0xff, (EAS_I32) (numSlots * sizeof(EAS_U16)));
+
+    for (i = 0; i < pDLS->numDLSPrograms; i++)
+    {
+        EAS_U32 locale = pDLS->pDLSPrograms[i].locale;
+        for (slot = DLS_PROGRAM_HASH(locale, bits); pIndex[slot] != DLS_PROGRAM_INDEX_EMPTY; slot = (slot + 1) & mask)
+        {
+            if (pDLS->pDLSPrograms[pIndex[slot]].locale == locale)
+                break;
+        }
+        if (pIndex[slot] == DLS_PROGRAM_INDEX_EMPTY)
+            pIndex[slot] = i;
+    }
+
+    pDLS->pProgramIndex = pIndex;
+    pDLS->programIndexBits = bits;
+}
+
+/*----------------------------------------------------------------------------
+ * DLSFindProgram ()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Looks up the region index of a program by locale
+ *
+ * Inputs:
+ * pDLS - collection
+ * locale - (bank << 8) | program, with 0x1000000 set for drum programs
+ *
+ * Outputs:
+ * Returns EAS_TRUE and sets *pRegionIndex if the program exists
+ *----------------------------------------------------------------------------
+*/
+EAS_BOOL DLSFindProgram (const S_DLS *pDLS, EAS_U32 locale, EAS_U16 *pRegionIndex)
+{
+    const S_PROGRAM *p;
+    EAS_U32 mask;
+    EAS_U32 slot;
+    EAS_U16 i;
+
+    if (pDLS->pProgramIndex != NULL)
+    {
+        mask = (1u << pDLS->programIndexBits) - 1;
+        for (slot = DLS_PROGRAM_HASH(locale, pDLS->programIndexBits); pDLS->pProgramIndex[slot] != DLS_PROGRAM_INDEX_EMPTY; slot = (slot + 1) & mask)
+        {
+            p = &pDLS->pDLSPrograms[pDLS->pProgramIndex[slot]];
+            if (p->locale == locale)
+            {
+                *pRegionIndex = p->regionIndex;
+                return EAS_TRUE;
+            }
+        }
+        return EAS_FALSE;
+    }
+
+    for (i = 0, p = pDLS->pDLSPrograms; i < pDLS->numDLSPrograms; i++, p++)
+    {
+        if (p->locale == locale)
+        {
+            *pRegionIndex = p->regionIndex;
+            return EAS_TRUE;
+        }
+    }
+    return EAS_FALSE;
+}
+
+/* limit on the total size of the note tables, in entries */
+#define DLS_NOTE_INDEX_MAX_SIZE     0x1000000
+
+/*----------------------------------------------------------------------------
+ * DLSNoteTable ()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Sizes or fills the note table of one program. The velocity range is
+ * split into zones wherever a region's velocity range starts or ends, so
+ * every region either sounds for a whole zone or not at all. The table
+ * holds, for each zone and key, the regions that sound, in region order:
+ *
+ * [0]                      number of zones
+ * [1..128]                 zone of each velocity, only with several zones
+ * [zone * 128 + key]       offset of the regions for the zone and key,
+ *                          followed by the offset of the end of the table
+ * ...                      region indices
+ *
+ * Offsets are from the start of the table.
+ *
+ * Inputs:
+ * pDLS - collection
+ * first - first region of the program
+ * last - last region of the program
+ * pTable - table to fill, or NULL to return its size only
+ *
+ * Outputs:
+ * Returns the size of the table in entries
+ *----------------------------------------------------------------------------
+*/
+static EAS_U32 DLSNoteTable (const S_DLS *pDLS, EAS_U16 first, EAS_U16 last, EAS_U16 *pTable)
+{
+    const S_DLS_REGION *pRgn;
+    EAS_U16 *pStarts;
+    EAS_U8 zoneOf[128];
+    EAS_U8 zoneVel[128];
+    EAS_U32 numZones;
+    EAS_U32 headerSize;
+    EAS_U32 numBuckets;
+    EAS_U32 count;
+    EAS_U32 offset;
+    EAS_INT rangeHigh;
+    EAS_INT r, z, key, vel;
+
+    /* find the velocity zones */
+    EAS_HWMemSet(zoneOf, 0, sizeof(zoneOf));
+    zoneOf[0] = 1;
+    for (r = first; r <= last; r++)
+    {
+        pRgn = &pDLS->pDLSRegions[r];
+        if (pRgn->velLow < 128)
+            zoneOf[pRgn->velLow] = 1;
+        if (pRgn->velHigh < 127)
+            zoneOf[pRgn->velHigh + 1] = 1;
+    }
+    numZones = 0;
+    for (vel = 0; vel < 128; vel++)
+    {
+        if (zoneOf[vel])
+            zoneVel[numZones++] = (EAS_U8) vel;
+        zoneOf[vel] = (EAS_U8) (numZones - 1);
+    }
+
+    headerSize = (numZones > 1) ? 129 : 1;
+    numBuckets = numZones * 128;
+    pStarts = (pTable != NULL) ? &pTable[headerSize] : NULL;
+    if (pStarts != NULL)
+        EAS_HWMemSet(pStarts, 0, (EAS_I32) ((numBuckets + 1) * sizeof(EAS_U16)));
+
+    /* count the regions sounding for each zone and key */
+    count = 0;
+    for (r = first; r <= last; r++)
+    {
+        pRgn = &pDLS->pDLSRegions[r];
+        rangeHigh = (pRgn->wtRegion.region.rangeHigh < 127) ? pRgn->wtRegion.region.rangeHigh : 127;
+        if (pRgn->wtRegion.region.rangeLow > rangeHigh)
+            continue;
+        for (z = 0; z < (EAS_INT) numZones; z++)
+        {
+            if ((zoneVel[z] < pRgn->velLow) || (zoneVel[z] > pRgn->velHigh))
+                continue;
+            count += (EAS_U32) (rangeHigh - pRgn->wtRegion.region.rangeLow + 1);
+            if (pStarts != NULL)
+            {
+                for (key = pRgn->wtRegion.region.rangeLow; key <= rangeHigh; key++)
+                    pStarts[z * 128 + key]++;
+            }
+        }
+    }
+    if (pTable == NULL)
+        return headerSize + numBuckets + 1 + count;
+
+    /* header */
+    pTable[0] = (EAS_U16) numZones;
+    if (numZones > 1)
+    {
+        for (vel = 0; vel < 128; vel++)
+            pTable[1 + vel] = zoneOf[vel];
+    }
+
+    /* turn the counts into bucket end offsets */
+    offset = headerSize + numBuckets + 1;
+    for (z = 0; z < (EAS_INT) numBuckets; z++)
+    {
+        offset += pStarts[z];
+        pStarts[z] = (EAS_U16) offset;
+    }
+    pStarts[numBuckets] = (EAS_U16) offset;
+
+    /* fill the buckets from the back, leaving each offset at its start */
+    for (r = last; r >= first; r--)
+    {
+        pRgn = &pDLS->pDLSRegions[r];
+        rangeHigh = (pRgn->wtRegion.region.rangeHigh < 127) ? pRgn->wtRegion.region.rangeHigh : 127;
+        for (z = 0; z < (EAS_INT) numZones; z++)
+        {
+            if ((zoneVel[z] < pRgn->velLow) || (zoneVel[z] > pRgn->velHigh))
+                continue;
+            for (key = pRgn->wtRegion.region.rangeLow; key <= rangeHigh; key++)
+                pTable[--pStarts[z * 128 + key]] = (EAS_U16) r;
+        }
+    }
+    return offset;
+}
+
+/*----------------------------------------------------------------------------
+ * DLSIndexNotes ()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Builds the note tables used by DLSFindRegions, one for each program,
+ * so that a note-on visits only the regions that sound.
+ *
+ * Inputs:
+ * hwInstData - used only for memory allocation
+ * pDLS - collection to index
+ *
+ * Outputs:
+ * Programs whose table would not fit, or all of them if the tables cannot
+ * be allocated, are left without one and note-on walks their regions.
+ *----------------------------------------------------------------------------
+*/
+static void DLSIndexNotes (EAS_HW_DATA_HANDLE hwInstData, S_DLS *pDLS)
+{
+    EAS_U32 *pRegionNotes;
+    EAS_U32 total;
+    EAS_U32 size;
+    EAS_U16 first;
+    EAS_U16 last;
+    EAS_U16 r;
+
+    if (pDLS->numDLSRegions == 0)
+        return;
+
+    pRegionNotes = EAS_HWMalloc(hwInstData, (EAS_I32) (pDLS->numDLSRegions * sizeof(EAS_U32)));
+    if (pRegionNotes == NULL)
+    {
+        EAS_Report(_EAS_SEVERITY_WARNING, "DLSIndexNotes: no memory for index, regions will be searched\n");
+        return;
+    }
+
+    /* size the table of each program, its regions end with the last region flag */
+    total = 0;
+    for (first = 0; first < pDLS->numDLSRegions; first = last + 1)
+    {
+        for (last = first; (last < pDLS->numDLSRegions - 1) && !(pDLS->pDLSRegions[last].wtRegion.region.keyGroupAndFlags & REGION_FLAG_LAST_REGION); last++) {}
+        for (r = first; r <= last; r++)
+            pRegionNotes[r] = DLS_NOTE_INDEX_NONE;
+        size = DLSNoteTable(pDLS, first, last, NULL);
+        if ((size <= 0xffff) && (total + size <= DLS_NOTE_INDEX_MAX_SIZE))
+        {
+            pRegionNotes[first] = total;
+            total += size;
+        }
+    }
+
+    pDLS->pNoteIndex = EAS_HWMalloc(hwInstData, (EAS_I32) (total * sizeof(EAS_U16)));
+    if (pDLS->pNoteIndex == NULL)
+    {
+        EAS_Report(_EAS_SEVERITY_WARNING, "DLSIndexNotes: no memory for index, regions will be searched\n");
+        EAS_HWFree(hwInstData, pRegionNotes);
+        return;
+    }
+
+    /* fill the tables */
+    for (first = 0; first < pDLS->numDLSRegions; first = last + 1)
+    {
+        for (last = first; (last < pDLS->numDLSRegions - 1) && !(pDLS->pDLSRegions[last].wtRegion.region.keyGroupAndFlags & REGION_FLAG_LAST_REGION); last++) {}
+        if (pRegionNotes[first] != DLS_NOTE_INDEX_NONE)
+            (void) DLSNoteTable(pDLS, first, last, &pDLS->pNoteIndex[pRegionNotes[first]]);
+    }
+    pDLS->pRegionNotes = pRegionNotes;
+}
+
+/*----------------------------------------------------------------------------
+ * DLSBuildIndex ()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Builds the program and note lookup tables of a loaded collection
+ *
+ * Inputs:
+ * hwInstData - used only for memory allocation
+ * pDLS - collection to index
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void DLSBuildIndex (EAS_HW_DATA_HANDLE hwInstData, S_DLS *pDLS)
+{
+    if (pDLS == NULL)
+        return;
+    DLSIndexPrograms(hwInstData, pDLS);
+    DLSIndexNotes(hwInstData, pDLS);
+}
+
+/*----------------------------------------------------------------------------
+ * DLSFindRegions ()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Looks up the regions of a program that sound for a note and velocity
+ *
+ * Inputs:
+ * pDLS - collection
+ * regionIndex - first region of the program, without flags
+ * note - key number
+ * velocity - note-on velocity
+ * ppRegions - receives a pointer to the region indices, without flags
+ *
+ * Outputs:
+ * Returns the number of regions, or -1 if the program has no note table
+ * and its regions must be searched
+ *----------------------------------------------------------------------------
+*/
+EAS_INT DLSFindRegions (const S_DLS *pDLS, EAS_U16 regionIndex, EAS_U8 note, EAS_U8 velocity, const EAS_U16 **ppRegions)
+{
+    const EAS_U16 *pTable;
+    const EAS_U16 *pStarts;
+    EAS_U32 bucket;
+
+    if ((pDLS->pRegionNotes == NULL) || (regionIndex >= pDLS->numDLSRegions) ||
+        (pDLS->pRegionNotes[regionIndex] == DLS_NOTE_INDEX_NONE) || (note > 127) || (velocity > 127))
+        return -1;
+
+    pTable = &pDLS->pNoteIndex[pDLS->pRegionNotes[regionIndex]];
+    if (pTable[0] > 1)
+    {
+        pStarts = &pTable[129];
+        bucket = pTable[1 + velocity] * 128u + note;
+    }
+    else
+    {
+        pStarts = &pTable[1];
+        bucket = note;
+    }
+    *ppRegions = &pTable[pStarts[bucket]];
+    return pStarts[bucket + 1] - pStarts[bucket];
 }
 
 /*----------------------------------------------------------------------------
@@ -1096,10 +1519,35 @@ static EAS_RESULT Parse_wave (SDLS_SYNTHESIZER_DATA *pDLSData, EAS_I32 pos, EAS_
 
     /* for first pass, add size to wave pool size and return */
     if (pDLSData->pDLS == NULL) {
+#ifdef DLS_MAPPED_SAMPLES
+        /* all samples are copied if any of them needs converting */
+        if ((p->fmtTag != WAVE_FORMAT_PCM) || (p->bitsPerSample != 16) || (dataPos & 1))
+            pDLSData->pFileData = NULL;
+#endif
         pDLSData->wavePoolSize += (EAS_U32) size;
         return EAS_SUCCESS;
     }
 
+#ifdef DLS_MAPPED_SAMPLES
+    /* mapped samples are used in place, without the copy of the loop start */
+    if (pDLSData->pFileData != NULL)
+    {
+        if (dataSize > pDLSData->fileDataSize - dataPos)
+        {
+            EAS_Report(_EAS_SEVERITY_ERROR, "DLS wave data exceeds the file data\n");
+            return EAS_ERROR_FILE_FORMAT;
+        }
+        if (p->loopLength && ((p->loopStart + p->loopLength) * sizeof(EAS_SAMPLE) > (EAS_U32) dataSize))
+        {
+            EAS_Report(_EAS_SEVERITY_ERROR, "wsmp contains invalid loop region\n");
+            return EAS_FAILURE;
+        }
+        pDLSData->pDLS->pDLSSampleOffsets[waveIndex] = (EAS_U32) dataPos;
+        pDLSData->pDLS->pDLSSampleLen[waveIndex] = (EAS_U32) dataSize;
+        return EAS_SUCCESS;
+    }
+#endif
+
     /* allocate memory and read in the sample data */
     pSample = (EAS_U8 *) pDLSData->pDLS->pDLSSamples + pDLSData->wavePoolOffset;
     pDLSData->pDLS->pDLSSampleOffsets[waveIndex] = pDLSData->wavePoolOffset;
@@ -2037,8 +2485,11 @@ static EAS_RESULT Parse_rgn (SDLS_SYNTHESIZER_DATA *pDLSData, EAS_I32 pos, EAS_I
         if (pWsmp->loopLength != 0)
         {
             EAS_U32 sampleLen = pDLSData->pDLS->pDLSSampleLen[waveIndex];
-            if (sampleLen < sizeof(EAS_SAMPLE)
-                || (pWsmp->loopStart + pWsmp->loopLength) * sizeof(EAS_SAMPLE) > sampleLen - sizeof(EAS_SAMPLE))
+
+            /* copied samples hold one more sample after the loop */
+            EAS_U32 guardLen = pDLSData->pDLS->samplesMapped ? 0 : sizeof(EAS_SAMPLE);
+            if (sampleLen < guardLen
+                || (pWsmp->loopStart + pWsmp->loopLength) * sizeof(EAS_SAMPLE) > sampleLen - guardLen)
             {
                 return EAS_FAILURE;
             }
@@ -274,8 +274,14 @@ typedef struct s_dls_params
 
 /* function prototypes */
 EAS_RESULT DLSParser (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fileHandle, EAS_I32 offset, S_DLS **pDLS);
+EAS_RESULT DLSParserMapped (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fileHandle, EAS_I32 offset, const void *pFileData, EAS_I32 fileDataSize, S_DLS **pDLS);
 EAS_RESULT DLSCleanup (EAS_HW_DATA_HANDLE hwInstData, S_DLS *pDLS);
+EAS_RESULT DLSWriteCache (const S_DLS *pDLS, EAS_U32 sourceSize, EAS_U32 sourceStamp, void *pBuffer, EAS_U32 bufferSize, EAS_U32 *pCacheSize);
+EAS_RESULT DLSReadCache (EAS_HW_DATA_HANDLE hwInstData, const void *pCache, EAS_U32 cacheSize, const void *pFileData, EAS_U32 sourceSize, EAS_U32 sourceStamp, S_DLS **ppDLS);
 void DLSAddRef (S_DLS *pDLS);
+void DLSBuildIndex (EAS_HW_DATA_HANDLE hwInstData, S_DLS *pDLS);
+EAS_BOOL DLSFindProgram (const S_DLS *pDLS, EAS_U32 locale, EAS_U16 *pRegionIndex);
+EAS_INT DLSFindRegions (const S_DLS *pDLS, EAS_U16 regionIndex, EAS_U8 note, EAS_U8 velocity, const EAS_U16 **ppRegions);
 EAS_I16 DLSConvertDelay (EAS_I32 timeCents);
 EAS_I16 DLSConvertRate (EAS_I32 timeCents);
 EAS_U16 DLSConvertQ (EAS_I32 q);
@@ -42,6 +42,24 @@
 #include "eas_config.h"
 #include "eas_report.h"
 
+#ifdef _REVERB_ENABLED
+#include "eas_reverb.h"
+#endif
+
+#ifdef _CHORUS_ENABLED
+#include "eas_chorus.h"
+#endif
+
+#if defined(_SIMD_KERNELS)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define MIX_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define MIX_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
 #ifdef _MAXIMIZER_ENABLED
 EAS_I32 MaximizerProcess (EAS_VOID_PTR pInstData, EAS_I32 *pSrc, EAS_I32 *pDst, EAS_I32 numSamples);
 #endif
@@ -54,6 +72,9 @@ EAS_I32 MaximizerProcess (EAS_VOID_PTR pInstData, EAS_I32 *pSrc, EAS_I32 *pDst,
 /* need to boost stereo by ~3dB to compensate for the panner */
 #define STEREO_3DB_GAIN_BOOST       512
 
+static EAS_BOOL EAS_MixEnginePCMEffects (S_EAS_DATA *pEASData);
+static EAS_BOOL EAS_MixEngineSilent (S_EAS_DATA *pEASData, EAS_I32 numSamples);
+
 /*----------------------------------------------------------------------------
  * EAS_MixEngineInit()
  *----------------------------------------------------------------------------
@@ -77,13 +98,24 @@ EAS_RESULT EAS_MixEngineInit (S_EAS_DATA *pEASData)
     if (pEASData->staticMemoryModel)
         pEASData->pMixBuffer = EAS_CMEnumData(EAS_CM_MIX_BUFFER);
     else
-        pEASData->pMixBuffer = EAS_HWMalloc(pEASData->hwInstData, BUFFER_SIZE_IN_MONO_SAMPLES * NUM_OUTPUT_CHANNELS * sizeof(EAS_I32));
+        pEASData->pMixBuffer = EAS_HWMalloc(pEASData->hwInstData, pEASData->blockSize * NUM_OUTPUT_CHANNELS * sizeof(EAS_I32));
     if (pEASData->pMixBuffer == NULL)
     {
         { /* dpp: EAS_ReportEx(_EAS_SEVERITY_FATAL, "Failed to allocate mix buffer memory\n"); */ }
         return EAS_ERROR_MALLOC_FAILED;
     }
-    EAS_HWMemSet((void *)(pEASData->pMixBuffer), 0, BUFFER_SIZE_IN_MONO_SAMPLES * NUM_OUTPUT_CHANNELS * sizeof(EAS_I32));
+    EAS_HWMemSet((void *)(pEASData->pMixBuffer), 0, pEASData->blockSize * NUM_OUTPUT_CHANNELS * sizeof(EAS_I32));
+    pEASData->mixBufferClear = EAS_TRUE;
+
+    /* holding buffer for EAS_RenderFrames, not available in the static memory model */
+    if (!pEASData->staticMemoryModel)
+    {
+        pEASData->pRenderFramesBuffer = EAS_HWMalloc(pEASData->hwInstData, pEASData->blockSize * NUM_OUTPUT_CHANNELS * sizeof(EAS_PCM));
+        if (pEASData->pRenderFramesBuffer == NULL)
+            return EAS_ERROR_MALLOC_FAILED;
+    }
+    pEASData->renderFramesOffset = 0;
+    pEASData->renderFramesPending = 0;
 
     return EAS_SUCCESS;
 }
@@ -107,11 +139,14 @@ EAS_RESULT EAS_MixEngineInit (S_EAS_DATA *pEASData)
 void EAS_MixEnginePrep (S_EAS_DATA *pEASData, EAS_I32 numSamples)
 {
 
-    /* clear the mix buffer */
+    /* clear the mix buffer, unless the last block left it silent */
+    if (pEASData->mixBufferClear)
+        pEASData->mixBufferClear = EAS_FALSE;
+    else
 #if (NUM_OUTPUT_CHANNELS == 2)
-    EAS_HWMemSet(pEASData->pMixBuffer, 0, numSamples * (EAS_I32) sizeof(EAS_I32) * 2);
+        EAS_HWMemSet(pEASData->pMixBuffer, 0, numSamples * (EAS_I32) sizeof(EAS_I32) * 2);
 #else
-    EAS_HWMemSet(pEASData->pMixBuffer, 0, (EAS_I32) numSamples * (EAS_I32) sizeof(EAS_I32));
+        EAS_HWMemSet(pEASData->pMixBuffer, 0, (EAS_I32) numSamples * (EAS_I32) sizeof(EAS_I32));
 #endif
 
     /* need to clear other side-chain effect buffers (chorus & reverb) */
@@ -135,9 +170,44 @@ void EAS_MixEnginePrep (S_EAS_DATA *pEASData, EAS_I32 numSamples)
 void EAS_MixEnginePost (S_EAS_DATA *pEASData, EAS_I32 numSamples)
 {
     EAS_I32 gain;
+    EAS_INT chan;
+    EAS_I32 i;
 
 //3 dls: Need to restore the mix engine metrics
 
+    /* nothing sounds and the effect tails have decayed, write silence */
+    if (EAS_MixEngineSilent(pEASData, numSamples))
+    {
+        if (pEASData->pOutputFloatBuffer[0] != NULL)
+        {
+            for (chan = 0; chan < NUM_OUTPUT_CHANNELS; chan++)
+                for (i = 0; i < numSamples; i++)
+                    pEASData->pOutputFloatBuffer[chan][i * pEASData->outputFloatStride] = 0.0f;
+        }
+        else
+            EAS_HWMemSet(pEASData->pOutputAudioBuffer, 0, numSamples * NUM_OUTPUT_CHANNELS * (EAS_I32) sizeof(EAS_PCM));
+
+        /* the reverb and chorus only run here when the voice manager could not take them as
+         * send effects, they skip silent input into a silent tail but keep their modulation
+         * running, the mix buffer is all zero and stays so */
+#ifdef _REVERB_ENABLED
+        if (pEASData->effectsModules[EAS_MODULE_REVERB].effectData && pEASData->pVoiceMgr->reverbModule.effectData == NULL)
+            (*pEASData->effectsModules[EAS_MODULE_REVERB].effect->pfProcess)
+                (pEASData->effectsModules[EAS_MODULE_REVERB].effectData,
+                (EAS_PCM*) pEASData->pMixBuffer, (EAS_PCM*) pEASData->pMixBuffer, numSamples);
+#endif
+#ifdef _CHORUS_ENABLED
+        if (pEASData->effectsModules[EAS_MODULE_CHORUS].effectData && pEASData->pVoiceMgr->chorusModule.effectData == NULL)
+            (*pEASData->effectsModules[EAS_MODULE_CHORUS].effect->pfProcess)
+                (pEASData->effectsModules[EAS_MODULE_CHORUS].effectData,
+                (EAS_PCM*) pEASData->pMixBuffer, (EAS_PCM*) pEASData->pMixBuffer, numSamples);
+#endif
+
+        /* the next block can skip clearing the mix buffer */
+        pEASData->mixBufferClear = EAS_TRUE;
+        return;
+    }
+
     /* calculate the gain multiplier */
 #ifdef _MAXIMIZER_ENABLED
     if (pEASData->effectsModules[EAS_MODULE_MAXIMIZER].effect)
@@ -156,6 +226,21 @@ void EAS_MixEnginePost (S_EAS_DATA *pEASData, EAS_I32 numSamples)
     gain = pEASData->masterGain;
 #endif
 
+    /* float output is scaled straight from the mix buffer unless a
+     * post-mix effect needs the 16-bit stage
+     */
+    if (pEASData->pOutputFloatBuffer[0] != NULL)
+    {
+        if (!EAS_MixEnginePCMEffects(pEASData))
+        {
+            SynthMasterGainFloat(pEASData->pMixBuffer, pEASData->pOutputFloatBuffer, pEASData->outputFloatStride, gain, numSamples);
+            return;
+        }
+
+        /* the 16-bit samples are written over the mix buffer they are read from */
+        pEASData->pOutputAudioBuffer = (EAS_PCM*) pEASData->pMixBuffer;
+    }
+
     /* convert 32-bit mix buffer to 16-bit output format */
 #if (NUM_OUTPUT_CHANNELS == 2)
     SynthMasterGain(pEASData->pMixBuffer, pEASData->pOutputAudioBuffer, gain, (EAS_U16) ((EAS_U16) numSamples * 2));
@@ -236,6 +321,133 @@ void EAS_MixEnginePost (S_EAS_DATA *pEASData, EAS_I32 numSamples)
             numSamples);
 #endif
 
+    /* convert the post-processed 16-bit samples to float */
+    if (pEASData->pOutputFloatBuffer[0] != NULL)
+        EAS_PCMToFloat(pEASData->pOutputAudioBuffer, pEASData->pOutputFloatBuffer, pEASData->outputFloatStride, numSamples);
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_MixEngineSilent
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns EAS_TRUE if the output of EAS_MixEnginePost is silent without
+ * running it: no voice is playing, the mix buffer is clear and the post-mix
+ * effects have no tail left. The send effects of the voice manager play
+ * out their tails into the mix buffer.
+ *
+ * Inputs:
+ * pEASData         - instance data
+ * numSamples       - number of sample frames in the mix buffer
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_BOOL EAS_MixEngineSilent (S_EAS_DATA *pEASData, EAS_I32 numSamples)
+{
+    EAS_I32 i;
+
+    /* voices, and PCM streams are mixed into the mix buffer */
+    if (pEASData->pVoiceMgr->numActiveVoiceList != 0)
+        return EAS_FALSE;
+    for (i = 0; i < numSamples * NUM_OUTPUT_CHANNELS; i++)
+    {
+        if (pEASData->pMixBuffer[i] != 0)
+            return EAS_FALSE;
+    }
+
+    /* these effects do not report their tail */
+#ifdef _MAXIMIZER_ENABLED
+    if (pEASData->effectsModules[EAS_MODULE_MAXIMIZER].effectData)
+        return EAS_FALSE;
+#endif
+#ifdef _ENHANCER_ENABLED
+    if (pEASData->effectsModules[EAS_MODULE_ENHANCER].effectData)
+        return EAS_FALSE;
+#endif
+#ifdef _GRAPHIC_EQ_ENABLED
+    if (pEASData->effectsModules[EAS_MODULE_GRAPHIC_EQ].effectData)
+        return EAS_FALSE;
+#endif
+#ifdef _COMPRESSOR_ENABLED
+    if (pEASData->effectsModules[EAS_MODULE_COMPRESSOR].effectData)
+        return EAS_FALSE;
+#endif
+#ifdef _WOW_ENABLED
+    if (pEASData->effectsModules[EAS_MODULE_WOW].effectData)
+        return EAS_FALSE;
+#endif
+#ifdef _TONECONTROLEQ_ENABLED
+    if (pEASData->effectsModules[EAS_MODULE_TONECONTROLEQ].effectData)
+        return EAS_FALSE;
+#endif
+
+#ifdef _REVERB_ENABLED
+    if (pEASData->effectsModules[EAS_MODULE_REVERB].effectData && pEASData->pVoiceMgr->reverbModule.effectData == NULL)
+    {
+        EAS_I32 tailSilent;
+        if (((*pEASData->effectsModules[EAS_MODULE_REVERB].effect->pFGetParam)
+            (pEASData->effectsModules[EAS_MODULE_REVERB].effectData, EAS_PARAM_REVERB_TAIL_SILENT, &tailSilent) != EAS_SUCCESS) || !tailSilent)
+            return EAS_FALSE;
+    }
+#endif
+#ifdef _CHORUS_ENABLED
+    if (pEASData->effectsModules[EAS_MODULE_CHORUS].effectData && pEASData->pVoiceMgr->chorusModule.effectData == NULL)
+    {
+        EAS_I32 tailSilent;
+        if (((*pEASData->effectsModules[EAS_MODULE_CHORUS].effect->pFGetParam)
+            (pEASData->effectsModules[EAS_MODULE_CHORUS].effectData, EAS_PARAM_CHORUS_TAIL_SILENT, &tailSilent) != EAS_SUCCESS) || !tailSilent)
+            return EAS_FALSE;
+    }
+#endif
+    return EAS_TRUE;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_MixEnginePCMEffects
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns EAS_TRUE if any effect runs on the 16-bit output of
+ * EAS_MixEnginePost.
+ *
+ * Inputs:
+ * pEASData         - instance data
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_BOOL EAS_MixEnginePCMEffects (S_EAS_DATA *pEASData)
+{
+#ifdef _ENHANCER_ENABLED
+    if (pEASData->effectsModules[EAS_MODULE_ENHANCER].effectData)
+        return EAS_TRUE;
+#endif
+#ifdef _GRAPHIC_EQ_ENABLED
+    if (pEASData->effectsModules[EAS_MODULE_GRAPHIC_EQ].effectData)
+        return EAS_TRUE;
+#endif
+#ifdef _COMPRESSOR_ENABLED
+    if (pEASData->effectsModules[EAS_MODULE_COMPRESSOR].effectData)
+        return EAS_TRUE;
+#endif
+#ifdef _WOW_ENABLED
+    if (pEASData->effectsModules[EAS_MODULE_WOW].effectData)
+        return EAS_TRUE;
+#endif
+#ifdef _TONECONTROLEQ_ENABLED
+    if (pEASData->effectsModules[EAS_MODULE_TONECONTROLEQ].effectData)
+        return EAS_TRUE;
+#endif
+#ifdef _REVERB_ENABLED
+    if (pEASData->effectsModules[EAS_MODULE_REVERB].effectData && pEASData->pVoiceMgr->reverbModule.effectData == NULL)
+        return EAS_TRUE;
+#endif
+#ifdef _CHORUS_ENABLED
+    if (pEASData->effectsModules[EAS_MODULE_CHORUS].effectData && pEASData->pVoiceMgr->chorusModule.effectData == NULL)
+        return EAS_TRUE;
+#endif
+    return EAS_FALSE;
 }
 
 #ifndef NATIVE_EAS_KERNEL
@@ -265,6 +477,177 @@ void SynthMasterGain(EAS_I32 *pInputBuffer,
 }
 #endif
 
+/*----------------------------------------------------------------------------
+ * SynthMasterGainFloat
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Mixes down audio from 32-bit to float target buffers without clipping.
+ * 16-bit full scale maps to +/-1.0.
+ *
+ * Inputs:
+ * pInputBuffer     - interleaved 32-bit mix buffer
+ * ppOutputBuffer   - output pointer for each channel
+ * stride           - samples between frames in the output
+ * nGain            - master gain
+ * numFrames        - number of frames
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void SynthMasterGainFloat (EAS_I32 *pInputBuffer, float * const *ppOutputBuffer, EAS_I32 stride, EAS_I32 nGain, EAS_I32 numFrames)
+{
+    const float scale = (float) nGain * (1.0f / (32768.0f * 32768.0f));
+    EAS_INT chan;
+    EAS_I32 i;
+
+    for (chan = 0; chan < NUM_OUTPUT_CHANNELS; chan++)
+    {
+        const EAS_I32 *pIn = pInputBuffer + chan;
+        float *pOut = ppOutputBuffer[chan];
+        for (i = 0; i < numFrames; i++)
+        {
+            *pOut = (float) *pIn * scale;
+            pIn += NUM_OUTPUT_CHANNELS;
+            pOut += stride;
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_PCMToFloat
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Converts interleaved 16-bit audio to float target buffers
+ *
+ * Inputs:
+ * pInputBuffer     - interleaved 16-bit buffer
+ * ppOutputBuffer   - output pointer for each channel
+ * stride           - samples between frames in the output
+ * numFrames        - number of frames
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void EAS_PCMToFloat (const EAS_PCM *pInputBuffer, float * const *ppOutputBuffer, EAS_I32 stride, EAS_I32 numFrames)
+{
+    EAS_INT chan;
+    EAS_I32 i;
+
+    for (chan = 0; chan < NUM_OUTPUT_CHANNELS; chan++)
+    {
+        const EAS_PCM *pIn = pInputBuffer + chan;
+        float *pOut = ppOutputBuffer[chan];
+        for (i = 0; i < numFrames; i++)
+        {
+            *pOut = (float) *pIn * (1.0f / 32768.0f);
+            pIn += NUM_OUTPUT_CHANNELS;
+            pOut += stride;
+        }
+    }
+}
+
+#if defined(MIX_SSE2)
+/* low 32 bits of the lane products, SSE2 has no signed 32-bit multiply */
+static __m128i EAS_MixMul32 (__m128i a, __m128i b)
+{
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+/* v * level / 128 as C computes it */
+static __m128i EAS_MixScaleSend (__m128i v, __m128i level)
+{
+    __m128i p = EAS_MixMul32(v, level);
+    return _mm_srai_epi32(_mm_add_epi32(p, _mm_srli_epi32(_mm_srai_epi32(p, 31), 25)), 7);
+}
+
+static void EAS_MixSendSSE2 (const EAS_I32 *pVoiceBuffer, EAS_I32 *pSendBuffer, __m128i level)
+{
+    _mm_storeu_si128((__m128i *) pSendBuffer,
+                     _mm_add_epi32(_mm_loadu_si128((const __m128i *) pSendBuffer), EAS_MixScaleSend(_mm_loadu_si128((const __m128i *) pVoiceBuffer), level)));
+    _mm_storeu_si128((__m128i *) (pSendBuffer + 4),
+                     _mm_add_epi32(_mm_loadu_si128((const __m128i *) (pSendBuffer + 4)), EAS_MixScaleSend(_mm_loadu_si128((const __m128i *) (pVoiceBuffer + 4)), level)));
+}
+#endif
+
+#if defined(MIX_NEON)
+/* v * level / 128 as C computes it */
+static int32x4_t EAS_MixScaleSend (int32x4_t v, int32x4_t level)
+{
+    int32x4_t p = vmulq_s32(v, level);
+    p = vaddq_s32(p, vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(vshrq_n_s32(p, 31)), 25)));
+    return vshrq_n_s32(p, 7);
+}
+#endif
+
+/*----------------------------------------------------------------------------
+ * EAS_MixVoice
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Adds a rendered voice to the mix buffer and, scaled by the send levels,
+ * to the 32-bit reverb and chorus send buffers in a single pass
+ *
+ * Inputs:
+ * pVoiceBuffer     - interleaved 32-bit voice output
+ * pMixBuffer       - interleaved 32-bit mix buffer
+ * pReverbBuffer    - reverb send buffer, NULL to skip
+ * reverbLevel      - reverb send level, 128 is unity
+ * pChorusBuffer    - chorus send buffer, NULL to skip
+ * chorusLevel      - chorus send level, 128 is unity
+ * numSamples       - number of samples (frames times channels)
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void EAS_MixVoice (const EAS_I32 *pVoiceBuffer, EAS_I32 *pMixBuffer, EAS_I32 *pReverbBuffer, EAS_I32 reverbLevel, EAS_I32 *pChorusBuffer, EAS_I32 chorusLevel, EAS_I32 numSamples)
+{
+    EAS_I32 i = 0;
+
+#if defined(MIX_SSE2)
+    const __m128i reverb = _mm_set1_epi32(reverbLevel);
+    const __m128i chorus = _mm_set1_epi32(chorusLevel);
+
+    for (; i + 8 <= numSamples; i += 8)
+    {
+        _mm_storeu_si128((__m128i *) &pMixBuffer[i],
+                         _mm_add_epi32(_mm_loadu_si128((const __m128i *) &pMixBuffer[i]), _mm_loadu_si128((const __m128i *) &pVoiceBuffer[i])));
+        _mm_storeu_si128((__m128i *) &pMixBuffer[i + 4],
+                         _mm_add_epi32(_mm_loadu_si128((const __m128i *) &pMixBuffer[i + 4]), _mm_loadu_si128((const __m128i *) &pVoiceBuffer[i + 4])));
+        if (pReverbBuffer)
+            EAS_MixSendSSE2(&pVoiceBuffer[i], &pReverbBuffer[i], reverb);
+        if (pChorusBuffer)
+            EAS_MixSendSSE2(&pVoiceBuffer[i], &pChorusBuffer[i], chorus);
+    }
+#elif defined(MIX_NEON)
+    const int32x4_t reverb = vdupq_n_s32(reverbLevel);
+    const int32x4_t chorus = vdupq_n_s32(chorusLevel);
+    int32x4_t v;
+
+    for (; i + 4 <= numSamples; i += 4)
+    {
+        v = vld1q_s32(&pVoiceBuffer[i]);
+        vst1q_s32(&pMixBuffer[i], vaddq_s32(vld1q_s32(&pMixBuffer[i]), v));
+        if (pReverbBuffer)
+            vst1q_s32(&pReverbBuffer[i], vaddq_s32(vld1q_s32(&pReverbBuffer[i]), EAS_MixScaleSend(v, reverb)));
+        if (pChorusBuffer)
+            vst1q_s32(&pChorusBuffer[i], vaddq_s32(vld1q_s32(&pChorusBuffer[i]), EAS_MixScaleSend(v, chorus)));
+    }
+#endif
+
+    for (; i < numSamples; i++)
+    {
+        pMixBuffer[i] += pVoiceBuffer[i];
+        if (pReverbBuffer)
+            pReverbBuffer[i] += pVoiceBuffer[i] * reverbLevel / 128;
+        if (pChorusBuffer)
+            pChorusBuffer[i] += pVoiceBuffer[i] * chorusLevel / 128;
+    }
+}
+
 /*----------------------------------------------------------------------------
  * EAS_MixEngineShutdown()
  *----------------------------------------------------------------------------
@@ -287,6 +670,11 @@ EAS_RESULT EAS_MixEngineShutdown (S_EAS_DATA *pEASData)
     /* check Configuration Module for static memory allocation */
     if (!pEASData->staticMemoryModel && (pEASData->pMixBuffer != NULL))
         EAS_HWFree(pEASData->hwInstData, pEASData->pMixBuffer);
+    if (pEASData->pRenderFramesBuffer != NULL)
+    {
+        EAS_HWFree(pEASData->hwInstData, pEASData->pRenderFramesBuffer);
+        pEASData->pRenderFramesBuffer = NULL;
+    }
 
     return EAS_SUCCESS;
 }
@@ -45,6 +45,25 @@ extern void SynthMasterGain(EAS_I32 *pInputBuffer,
                             EAS_I32 nGain,
                             EAS_U16 nNumLoopSamples);
 
+extern void SynthMasterGainFloat(EAS_I32 *pInputBuffer,
+                                 float * const *ppOutputBuffer,
+                                 EAS_I32 stride,
+                                 EAS_I32 nGain,
+                                 EAS_I32 numFrames);
+
+extern void EAS_PCMToFloat(const EAS_PCM *pInputBuffer,
+                           float * const *ppOutputBuffer,
+                           EAS_I32 stride,
+                           EAS_I32 numFrames);
+
+extern void EAS_MixVoice(const EAS_I32 *pVoiceBuffer,
+                         EAS_I32 *pMixBuffer,
+                         EAS_I32 *pReverbBuffer,
+                         EAS_I32 reverbLevel,
+                         EAS_I32 *pChorusBuffer,
+                         EAS_I32 chorusLevel,
+                         EAS_I32 numSamples);
+
 /*----------------------------------------------------------------------------
  * EAS_MixEngineInit()
  *----------------------------------------------------------------------------
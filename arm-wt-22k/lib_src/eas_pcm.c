@@ -85,7 +85,7 @@ static const S_DECODER_INTERFACE * const decoders[] =
  *----------------------------------------------------------------------------
 */
 
-#define SRC_RATE_MULTIPLER (0x40000000 / _OUTPUT_SAMPLE_RATE)
+#define SRC_RATE_MULTIPLER(outputRate) (0x40000000 / (outputRate))
 
 #ifdef _LOOKUP_SAMPLE_RATE
 static const EAS_U32 srcConvRate[][2] =
@@ -99,7 +99,7 @@ static const EAS_U32 srcConvRate[][2] =
     24000L, (24000L << 15) / _OUTPUT_SAMPLE_RATE,
     32000L, (32000L << 15) / _OUTPUT_SAMPLE_RATE
 };
-static EAS_U32 CalcBaseFreq (EAS_U32 sampleRate);
+static EAS_U32 CalcBaseFreq (EAS_U32 sampleRate, EAS_I32 outputRate);
 #define SRC_CONV_RATE_ENTRIES (sizeof(srcConvRate)/sizeof(EAS_U32)/2)
 #endif
 
@@ -371,7 +371,7 @@ EAS_RESULT EAS_PEOpenStream (S_EAS_DATA *pEASData, S_PCM_OPEN_PARAMS *pParams, E
     pState->sampleRate = (EAS_U16) pParams->sampleRate;
 
     /* set the base frequency */
-    pState->basefreq = (SRC_RATE_MULTIPLER * (EAS_U32) pParams->sampleRate) >> 15;
+    pState->basefreq = (SRC_RATE_MULTIPLER(pEASData->sampleRate) * (EAS_U32) pParams->sampleRate) >> 15;
 
     /* calculate shift for frequencies > 1.0 */
     pState->rateShift = 0;
@@ -877,6 +877,7 @@ static S_PCM_STATE *FindSlot (S_EAS_DATA *pEASData, EAS_FILE_HANDLE fileHandle,
  *
  * Inputs:
  * sampleRate       - sample rate in samples/sec
+ * outputRate       - output sample rate of the instance
  *
  * Outputs:
  * Returns fractional sample rate with a 15-bit fraction
@@ -885,12 +886,12 @@ static S_PCM_STATE *FindSlot (S_EAS_DATA *pEASData, EAS_FILE_HANDLE fileHandle,
  *
  *----------------------------------------------------------------------------
 */
-static EAS_U32 CalcBaseFreq (EAS_U32 sampleRate)
+static EAS_U32 CalcBaseFreq (EAS_U32 sampleRate, EAS_I32 outputRate)
 {
     EAS_INT i;
 
-    /* look up the conversion rate */
-    for (i = 0; i < (EAS_INT)(SRC_CONV_RATE_ENTRIES); i ++)
+    /* look up the conversion rate, the table is built for _OUTPUT_SAMPLE_RATE */
+    for (i = 0; (outputRate == _OUTPUT_SAMPLE_RATE) && (i < (EAS_INT)(SRC_CONV_RATE_ENTRIES)); i ++)
     {
         if (srcConvRate[i][0] == sampleRate)
             return srcConvRate[i][1];
@@ -899,7 +900,7 @@ static EAS_U32 CalcBaseFreq (EAS_U32 sampleRate)
     /* if not found in table, do it the long way */
     { /* dpp: EAS_ReportEx(_EAS_SEVERITY_WARNING, "Sample rate %u not in table, calculating by division\n", sampleRate); */ }
 
-    return (SRC_RATE_MULTIPLER * (EAS_U32) sampleRate) >> 15;
+    return (SRC_RATE_MULTIPLER(outputRate) * (EAS_U32) sampleRate) >> 15;
 }
 #endif
 
@@ -978,11 +979,15 @@ static EAS_RESULT RenderPCMStream (S_EAS_DATA *pEASData, S_PCM_STATE *pState, EA
     EAS_I32 *pOut;
     EAS_I32 temp;
     EAS_U32 utemp;
+    EAS_I32 gainShift;
 
 #if (NUM_OUTPUT_CHANNELS == 2)
     EAS_I32 gainRight, gainIncRight;
 #endif
 
+    /* gain ramps span one block */
+    gainShift = pEASData->blockSizeBits;
+
 #if 0
     printf("env data: AR = %d, DR = %d, SL = %d, SR = %d, RR = %d\n",
         ((pState->envData >> 12) & 0x0F),
@@ -1094,10 +1099,10 @@ static EAS_RESULT RenderPCMStream (S_EAS_DATA *pEASData, S_PCM_STATE *pState, EA
 
     /* gain to 32-bits to increase resolution on anti-zipper filter */
     /*lint -e{703} use shift for performance */
-    gainLeft = (EAS_I32) pState->currentGainLeft << SYNTH_UPDATE_PERIOD_IN_BITS;
+    gainLeft = (EAS_I32) pState->currentGainLeft << gainShift;
 #if (NUM_OUTPUT_CHANNELS == 2)
     /*lint -e{703} use shift for performance */
-    gainRight = (EAS_I32) pState->currentGainRight << SYNTH_UPDATE_PERIOD_IN_BITS;
+    gainRight = (EAS_I32) pState->currentGainRight << gainShift;
 #endif
 
     /* calculate a new gain increment, gain target is zero if pausing */
@@ -1147,14 +1152,14 @@ static EAS_RESULT RenderPCMStream (S_EAS_DATA *pEASData, S_PCM_STATE *pState, EA
 
         /* gain scale and mix */
         /*lint -e{704} use shift instead of division */
-        *pOut++ += (pState->decoderL.output * (gainLeft >> SYNTH_UPDATE_PERIOD_IN_BITS)) >> PCM_MIXER_GUARD_BITS;
+        *pOut++ += (pState->decoderL.output * (gainLeft >> gainShift)) >> PCM_MIXER_GUARD_BITS;
         gainLeft += gainIncLeft;
 
         /*lint -e{704} use shift instead of division */
         if (pState->flags & PCM_FLAGS_STEREO)
-            *pOut++ += (pState->decoderR.output * (gainRight >> SYNTH_UPDATE_PERIOD_IN_BITS)) >> PCM_MIXER_GUARD_BITS;
+            *pOut++ += (pState->decoderR.output * (gainRight >> gainShift)) >> PCM_MIXER_GUARD_BITS;
         else
-            *pOut++ += (pState->decoderL.output * (gainRight >> SYNTH_UPDATE_PERIOD_IN_BITS)) >> PCM_MIXER_GUARD_BITS;
+            *pOut++ += (pState->decoderL.output * (gainRight >> gainShift)) >> PCM_MIXER_GUARD_BITS;
 
         gainRight += gainIncRight;
 
@@ -1167,11 +1172,11 @@ static EAS_RESULT RenderPCMStream (S_EAS_DATA *pEASData, S_PCM_STATE *pState, EA
 
             /* for mono, sum stereo ADPCM to mono */
             /*lint -e{704} use shift instead of division */
-            *pOut++ += ((pState->decoderL.output + pState->decoderR.output) * (gainLeft >> SYNTH_UPDATE_PERIOD_IN_BITS)) >> PCM_MIXER_GUARD_BITS;
+            *pOut++ += ((pState->decoderL.output + pState->decoderR.output) * (gainLeft >> gainShift)) >> PCM_MIXER_GUARD_BITS;
         }
         else
             /*lint -e{704} use shift instead of division */
-            *pOut++ += (pState->decoderL.output * (gainLeft >> SYNTH_UPDATE_PERIOD_IN_BITS)) >> PCM_MIXER_GUARD_BITS;
+            *pOut++ += (pState->decoderL.output * (gainLeft >> gainShift)) >> PCM_MIXER_GUARD_BITS;
 
         gainLeft += gainIncLeft;
 #endif
@@ -1205,11 +1210,11 @@ static EAS_RESULT RenderPCMStream (S_EAS_DATA *pEASData, S_PCM_STATE *pState, EA
 
     /* save new gain */
     /*lint -e{704} use shift instead of division */
-    pState->currentGainLeft = (EAS_I16) (gainLeft >> SYNTH_UPDATE_PERIOD_IN_BITS);
+    pState->currentGainLeft = (EAS_I16) (gainLeft >> gainShift);
 
 #if (NUM_OUTPUT_CHANNELS == 2)
     /*lint -e{704} use shift instead of division */
-    pState->currentGainRight = (EAS_I16) (gainRight >> SYNTH_UPDATE_PERIOD_IN_BITS);
+    pState->currentGainRight = (EAS_I16) (gainRight >> gainShift);
 #endif
 
     /* if pausing, set new state and notify */
@@ -91,6 +91,23 @@ static const S_EAS_LIB_CONFIG easLibConfig =
     _BUILD_VERSION_
 };
 
+/* output sample rates selectable at init time and their pitch above 8 kHz, rounded to the nearest cent */
+static const EAS_I32 eas_SampleRates[][2] =
+{
+    { 8000, 0 },
+    { 11025, 555 },
+    { 16000, 1200 },
+    { 20000, 1586 },
+    { 22050, 1755 },
+    { 24000, 1902 },
+    { 32000, 2400 },
+    { 44100, 2955 },
+    { 48000, 3102 },
+    { 88200, 4155 },
+    { 96000, 4302 }
+};
+#define NUM_SAMPLE_RATES (sizeof(eas_SampleRates) / sizeof(eas_SampleRates[0]))
+
 /* local prototypes */
 static EAS_RESULT EAS_ParseEvents (S_EAS_DATA *pEASData, S_EAS_STREAM *pStream, EAS_U32 endTime, EAS_INT parseMode);
 
@@ -344,17 +361,36 @@ static EAS_INT EAS_AllocateStream (EAS_DATA_HANDLE pEASData)
  *
  *----------------------------------------------------------------------------
 */
-static void EAS_InitStream (S_EAS_STREAM *pStream, EAS_VOID_PTR pParserModule, EAS_VOID_PTR streamHandle)
+static void EAS_InitStream (S_EAS_DATA *pEASData, S_EAS_STREAM *pStream, EAS_VOID_PTR pParserModule, EAS_VOID_PTR streamHandle)
 {
     pStream->pParserModule = pParserModule;
     pStream->handle = streamHandle;
     pStream->time = 0;
-    pStream->frameLength = AUDIO_FRAME_LENGTH;
+    pStream->frameLength = pEASData->frameLength;
     pStream->repeatCount = 0;
     pStream->volume = DEFAULT_STREAM_VOLUME;
     pStream->streamFlags = 0;
 }
 
+/*----------------------------------------------------------------------------
+ * EAS_DiscardPendingFrames()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Drop the frames EAS_RenderFrames holds from a partially consumed block,
+ * they belong to the old position once a stream is opened, closed or moved
+ *
+ * Inputs:
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void EAS_DiscardPendingFrames (S_EAS_DATA *pEASData)
+{
+    pEASData->renderFramesOffset = 0;
+    pEASData->renderFramesPending = 0;
+}
+
 /*----------------------------------------------------------------------------
  * EAS_Config()
  *----------------------------------------------------------------------------
@@ -387,18 +423,131 @@ EAS_PUBLIC const S_EAS_LIB_CONFIG *EAS_Config (void)
  *----------------------------------------------------------------------------
 */
 EAS_PUBLIC EAS_RESULT EAS_Init (EAS_DATA_HANDLE *ppEASData)
+{
+    return EAS_InitEx(ppEASData, NULL);
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_SampleRatePitch()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Looks up a supported output sample rate
+ *
+ * Inputs:
+ *  sampleRate      - sample rate in Hz
+ *
+ * Outputs:
+ * pitch of the sample rate in cents above 8 kHz, -1 if not supported
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_I32 EAS_SampleRatePitch (EAS_I32 sampleRate)
+{
+    EAS_INT i;
+
+    for (i = 0; i < (EAS_INT) NUM_SAMPLE_RATES; i++)
+    {
+        if (eas_SampleRates[i][0] == sampleRate)
+            return eas_SampleRates[i][1];
+    }
+    return -1;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_InitEx()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Initialize the synthesizer library with per-instance settings
+ *
+ * Inputs:
+ *  ppEASData       - pointer to data handle variable for this instance
+ *  pConfig         - instance settings, NULL for the build defaults
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_InitEx (EAS_DATA_HANDLE *ppEASData, const S_EAS_INIT_CONFIG *pConfig)
 {
     EAS_HW_DATA_HANDLE pHWInstData;
     EAS_RESULT result;
     S_EAS_DATA *pEASData;
     EAS_INT module;
     EAS_BOOL staticMemoryModel;
+    EAS_I32 blockSize;
+    EAS_I32 blockSizeBits;
+    EAS_I32 controlPeriod;
+    EAS_I32 controlPeriodBits;
+    EAS_I32 sampleRate;
+    EAS_I32 pitchOffset;
+    EAS_I32 maxVoices;
 
     /* get the memory model */
     staticMemoryModel = EAS_CMStaticMemoryModel();
+    *ppEASData = NULL;
+
+    /* validate the block size, it must be a power of two within range */
+    blockSize = BUFFER_SIZE_IN_MONO_SAMPLES;
+    if ((pConfig != NULL) && (pConfig->blockSize != 0))
+        blockSize = pConfig->blockSize;
+    if ((blockSize < MIN_BUFFER_SIZE_IN_MONO_SAMPLES) || (blockSize > MAX_BUFFER_SIZE_IN_MONO_SAMPLES) ||
+        ((blockSize & (blockSize - 1)) != 0))
+    {
+        EAS_Report(_EAS_SEVERITY_ERROR, "EAS_InitEx: invalid block size %d\n", blockSize);
+        return EAS_ERROR_PARAMETER_RANGE;
+    }
+    if (staticMemoryModel && (blockSize != BUFFER_SIZE_IN_MONO_SAMPLES))
+    {
+        EAS_Report(_EAS_SEVERITY_ERROR, "EAS_InitEx: static memory model supports only %d samples per block\n", BUFFER_SIZE_IN_MONO_SAMPLES);
+        return EAS_BUFFER_SIZE_MISMATCH;
+    }
+    for (blockSizeBits = 0; (1 << blockSizeBits) < blockSize; blockSizeBits++) {}
+
+    /* validate the control period, it must be a power of two that divides the block */
+    controlPeriod = (blockSize < BUFFER_SIZE_IN_MONO_SAMPLES) ? blockSize : BUFFER_SIZE_IN_MONO_SAMPLES;
+    if ((pConfig != NULL) && (pConfig->controlPeriod != 0))
+        controlPeriod = pConfig->controlPeriod;
+    if ((controlPeriod < MIN_BUFFER_SIZE_IN_MONO_SAMPLES) || (controlPeriod > blockSize) ||
+        ((controlPeriod & (controlPeriod - 1)) != 0))
+    {
+        EAS_Report(_EAS_SEVERITY_ERROR, "EAS_InitEx: invalid control period %d for block size %d\n", controlPeriod, blockSize);
+        return EAS_ERROR_PARAMETER_RANGE;
+    }
+    for (controlPeriodBits = 0; (1 << controlPeriodBits) < controlPeriod; controlPeriodBits++) {}
+
+    /* validate the sample rate, the sound library pitches are relative to _OUTPUT_SAMPLE_RATE */
+    sampleRate = _OUTPUT_SAMPLE_RATE;
+    if ((pConfig != NULL) && (pConfig->sampleRate != 0))
+        sampleRate = pConfig->sampleRate;
+    pitchOffset = EAS_SampleRatePitch(sampleRate);
+    if (pitchOffset < 0)
+    {
+        EAS_Report(_EAS_SEVERITY_ERROR, "EAS_InitEx: unsupported sample rate %d\n", sampleRate);
+        return EAS_ERROR_PARAMETER_RANGE;
+    }
+    pitchOffset = EAS_SampleRatePitch(_OUTPUT_SAMPLE_RATE) - pitchOffset;
+    if (staticMemoryModel && (sampleRate != _OUTPUT_SAMPLE_RATE))
+    {
+        EAS_Report(_EAS_SEVERITY_ERROR, "EAS_InitEx: static memory model supports only %d Hz\n", _OUTPUT_SAMPLE_RATE);
+        return EAS_ERROR_PARAMETER_RANGE;
+    }
+
+    /* validate the voice capacity, the static memory model has room for MAX_SYNTH_VOICES */
+    maxVoices = MAX_SYNTH_VOICES;
+    if ((pConfig != NULL) && (pConfig->maxVoices != 0))
+        maxVoices = pConfig->maxVoices;
+    if ((maxVoices < 1) || (maxVoices > MAX_SYNTH_VOICES_LIMIT))
+    {
+        EAS_Report(_EAS_SEVERITY_ERROR, "EAS_InitEx: invalid voice capacity %d\n", maxVoices);
+        return EAS_ERROR_PARAMETER_RANGE;
+    }
+    if (staticMemoryModel && (maxVoices != MAX_SYNTH_VOICES))
+    {
+        EAS_Report(_EAS_SEVERITY_ERROR, "EAS_InitEx: static memory model supports only %d voices\n", MAX_SYNTH_VOICES);
+        return EAS_ERROR_PARAMETER_RANGE;
+    }
 
     /* initialize the host wrapper interface */
-    *ppEASData = NULL;
     if ((result = EAS_HWInit(&pHWInstData)) != EAS_SUCCESS)
         return result;
 
@@ -418,6 +567,16 @@ EAS_PUBLIC EAS_RESULT EAS_Init (EAS_DATA_HANDLE *ppEASData)
     pEASData->staticMemoryModel = (EAS_BOOL8) staticMemoryModel;
     pEASData->hwInstData = pHWInstData;
     pEASData->renderTime = 0;
+    pEASData->blockSize = blockSize;
+    pEASData->blockSizeBits = blockSizeBits;
+    pEASData->controlPeriod = controlPeriod;
+    pEASData->controlPeriodBits = controlPeriodBits;
+    pEASData->sampleRate = sampleRate;
+    pEASData->pitchOffset = pitchOffset;
+    pEASData->maxVoices = maxVoices;
+
+    /* block length in 256ths of a millisecond, matches AUDIO_FRAME_LENGTH for the default block size */
+    pEASData->frameLength = (blockSize * 256000L + sampleRate / 2) / sampleRate;
 
     /* set header search flag */
 #ifdef FILE_HEADER_SEARCH
@@ -478,6 +637,35 @@ EAS_PUBLIC EAS_RESULT EAS_Init (EAS_DATA_HANDLE *ppEASData)
     return EAS_SUCCESS;
 }
 
+/*----------------------------------------------------------------------------
+ * EAS_GetInitConfig()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the settings in effect for this instance
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  pConfig         - receives the instance settings
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_GetInitConfig (EAS_DATA_HANDLE pEASData, S_EAS_INIT_CONFIG *pConfig)
+{
+    if (pEASData == NULL)
+        return EAS_ERROR_HANDLE_INTEGRITY;
+    if (pConfig == NULL)
+        return EAS_ERROR_INVALID_PARAMETER;
+
+    EAS_HWMemSet(pConfig, 0, sizeof(S_EAS_INIT_CONFIG));
+    pConfig->blockSize = pEASData->blockSize;
+    pConfig->controlPeriod = pEASData->controlPeriod;
+    pConfig->sampleRate = pEASData->sampleRate;
+    pConfig->maxVoices = pEASData->maxVoices;
+    return EAS_SUCCESS;
+}
+
 /*----------------------------------------------------------------------------
  * EAS_Shutdown()
  *----------------------------------------------------------------------------
@@ -617,7 +805,7 @@ EAS_RESULT EAS_OpenJETStream (EAS_DATA_HANDLE pEASData, EAS_FILE_HANDLE fileHand
     /* parser recognized the file, return the handle */
     if (streamHandle)
     {
-        EAS_InitStream(&pEASData->streams[streamNum], pParserModule, streamHandle);
+        EAS_InitStream(pEASData, &pEASData->streams[streamNum], pParserModule, streamHandle);
         *ppStream = &pEASData->streams[streamNum];
         return EAS_SUCCESS;
     }
@@ -688,8 +876,9 @@ EAS_PUBLIC EAS_RESULT EAS_OpenFile (EAS_DATA_HANDLE pEASData, EAS_FILE_LOCATOR l
         {
 
             /* save the parser pointer and file handle */
-            EAS_InitStream(&pEASData->streams[streamNum], pParserModule, streamHandle);
+            EAS_InitStream(pEASData, &pEASData->streams[streamNum], pParserModule, streamHandle);
             *ppStream = &pEASData->streams[streamNum];
+            EAS_DiscardPendingFrames(pEASData);
             return EAS_SUCCESS;
         }
 
@@ -765,7 +954,7 @@ EAS_PUBLIC EAS_RESULT EAS_MMAPIToneControl (EAS_DATA_HANDLE pEASData, EAS_FILE_L
     {
 
         /* save the parser pointer and file handle */
-        EAS_InitStream(&pEASData->streams[streamNum], pParserModule, streamHandle);
+        EAS_InitStream(pEASData, &pEASData->streams[streamNum], pParserModule, streamHandle);
         *ppStream = &pEASData->streams[streamNum];
         return EAS_SUCCESS;
     }
@@ -869,14 +1058,14 @@ EAS_PUBLIC EAS_RESULT EAS_Prepare (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream)
 }
 
 /*----------------------------------------------------------------------------
- * EAS_Render()
+ * EAS_RenderBlock()
  *----------------------------------------------------------------------------
  * Purpose:
- * Parse the Midi data and render PCM audio data.
+ * Parse the Midi data and render one block of audio data into the output
+ * buffers selected by the caller.
  *
  * Inputs:
  *  pEASData        - buffer for internal EAS data
- *  pOut            - output buffer pointer
  *  nNumRequested   - requested num samples to generate
  *  pnNumGenerated  - actual number of samples generated
  *
@@ -885,11 +1074,12 @@ EAS_PUBLIC EAS_RESULT EAS_Prepare (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream)
  *
  *----------------------------------------------------------------------------
 */
-EAS_PUBLIC EAS_RESULT EAS_Render (EAS_DATA_HANDLE pEASData, EAS_PCM *pOut, EAS_I32 numRequested, EAS_I32 *pNumGenerated)
+static EAS_RESULT EAS_RenderBlock (EAS_DATA_HANDLE pEASData, EAS_I32 numRequested, EAS_I32 *pNumGenerated)
 {
     S_FILE_PARSER_INTERFACE *pParserModule;
     EAS_RESULT result;
     EAS_I32 voicesRendered;
+    EAS_U32 renderStart = 0;
     EAS_STATE parserState;
     EAS_INT streamNum;
 
@@ -897,14 +1087,22 @@ EAS_PUBLIC EAS_RESULT EAS_Render (EAS_DATA_HANDLE pEASData, EAS_PCM *pOut, EAS_I
     *pNumGenerated = 0;
     VMInitWorkload(pEASData->pVoiceMgr);
 
-    /* no support for other buffer sizes yet */
-    if (numRequested != BUFFER_SIZE_IN_MONO_SAMPLES)
+    /* the block size is fixed when the instance is initialized */
+    if (numRequested != pEASData->blockSize)
     {
-        { EAS_Report(_EAS_SEVERITY_ERROR, "This library supports only %d samples in buffer, host requested %d samples\n",
-            (EAS_I32) BUFFER_SIZE_IN_MONO_SAMPLES, numRequested); }
+        { EAS_Report(_EAS_SEVERITY_ERROR, "This instance supports only %d samples in buffer, host requested %d samples\n",
+            pEASData->blockSize, numRequested); }
         return EAS_BUFFER_SIZE_MISMATCH;
     }
 
+    /* a whole block would skip the frames EAS_RenderFrames still holds */
+    if (pEASData->renderFramesPending)
+    {
+        { EAS_Report(_EAS_SEVERITY_ERROR, "%d frames of the last EAS_RenderFrames call are pending, render them first\n",
+            pEASData->renderFramesPending); }
+        return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
+    }
+
 #ifdef _METRICS_ENABLED
     /* start performance counter */
     if (pEASData->pMetricsData)
@@ -920,10 +1118,6 @@ EAS_PUBLIC EAS_RESULT EAS_Render (EAS_DATA_HANDLE pEASData, EAS_PCM *pOut, EAS_I
     EAS_MixEnginePrep(pEASData, numRequested);
 #endif
 
-    /* save the output buffer pointer */
-    pEASData->pOutputAudioBuffer = pOut;
-
-
 #ifdef _METRICS_ENABLED
         /* start performance counter */
         if (pEASData->pMetricsData)
@@ -1023,12 +1217,16 @@ EAS_PUBLIC EAS_RESULT EAS_Render (EAS_DATA_HANDLE pEASData, EAS_PCM *pOut, EAS_I
         (*pEASData->pMetricsModule->pfStartTimer)(pEASData->pMetricsData, EAS_PM_RENDER_TIME);
 #endif
 
-    /* render audio */
-    if ((result = VMRender(pEASData->pVoiceMgr, BUFFER_SIZE_IN_MONO_SAMPLES, pEASData->pMixBuffer, &voicesRendered)) != EAS_SUCCESS)
+    /* render audio, timing it against the render budget */
+    if (pEASData->pVoiceMgr->renderBudget)
+        renderStart = EAS_HWGetMicroseconds(pEASData->hwInstData);
+    if ((result = VMRender(pEASData->pVoiceMgr, pEASData->blockSize, pEASData->pMixBuffer, &voicesRendered)) != EAS_SUCCESS)
     {
         EAS_Report(_EAS_SEVERITY_ERROR, "pfRender function returned error %ld\n", result);
         return result;
     }
+    if (pEASData->pVoiceMgr->renderBudget)
+        VMUpdateRenderBudget(pEASData->pVoiceMgr, (EAS_I32) (EAS_HWGetMicroseconds(pEASData->hwInstData) - renderStart), voicesRendered);
 
 #ifdef _METRICS_ENABLED
     /* stop the render timer */
@@ -1092,7 +1290,7 @@ EAS_PUBLIC EAS_RESULT EAS_Render (EAS_DATA_HANDLE pEASData, EAS_PCM *pOut, EAS_I
 #endif
 
     /* advance render time */
-    pEASData->renderTime += AUDIO_FRAME_LENGTH;
+    pEASData->renderTime += (EAS_U32) pEASData->frameLength;
 
 #if 0
     /* dump workload for debug */
@@ -1130,6 +1328,164 @@ EAS_PUBLIC EAS_RESULT EAS_Render (EAS_DATA_HANDLE pEASData, EAS_PCM *pOut, EAS_I
     return EAS_SUCCESS;
 }
 
+/*----------------------------------------------------------------------------
+ * EAS_Render()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Parse the Midi data and render PCM audio data.
+ *
+ * Inputs:
+ *  pEASData        - buffer for internal EAS data
+ *  pOut            - output buffer pointer
+ *  nNumRequested   - requested num samples to generate
+ *  pnNumGenerated  - actual number of samples generated
+ *
+ * Outputs:
+ *  EAS_SUCCESS if PCM data was successfully rendered
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_Render (EAS_DATA_HANDLE pEASData, EAS_PCM *pOut, EAS_I32 numRequested, EAS_I32 *pNumGenerated)
+{
+
+    /* save the output buffer pointer */
+    pEASData->pOutputAudioBuffer = pOut;
+    pEASData->pOutputFloatBuffer[0] = NULL;
+    return EAS_RenderBlock(pEASData, numRequested, pNumGenerated);
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_RenderFloat()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Parse the Midi data and render interleaved float audio data.
+ *
+ * Inputs:
+ *  pEASData        - buffer for internal EAS data
+ *  pOut            - output buffer pointer
+ *  numRequested    - requested num samples to generate
+ *  pNumGenerated   - actual number of samples generated
+ *
+ * Outputs:
+ *  EAS_SUCCESS if audio data was successfully rendered
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_RenderFloat (EAS_DATA_HANDLE pEASData, float *pOut, EAS_I32 numRequested, EAS_I32 *pNumGenerated)
+{
+    EAS_INT i;
+
+    /* the mix engine writes each channel with a stride of one frame */
+    pEASData->pOutputAudioBuffer = NULL;
+    for (i = 0; i < NUM_OUTPUT_CHANNELS; i++)
+        pEASData->pOutputFloatBuffer[i] = pOut + i;
+    pEASData->outputFloatStride = NUM_OUTPUT_CHANNELS;
+    return EAS_RenderBlock(pEASData, numRequested, pNumGenerated);
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_RenderFloatPlanar()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Parse the Midi data and render float audio data, one buffer per channel.
+ *
+ * Inputs:
+ *  pEASData        - buffer for internal EAS data
+ *  ppOut           - one output buffer pointer per channel
+ *  numRequested    - requested num samples to generate
+ *  pNumGenerated   - actual number of samples generated
+ *
+ * Outputs:
+ *  EAS_SUCCESS if audio data was successfully rendered
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_RenderFloatPlanar (EAS_DATA_HANDLE pEASData, float * const *ppOut, EAS_I32 numRequested, EAS_I32 *pNumGenerated)
+{
+    EAS_INT i;
+
+    pEASData->pOutputAudioBuffer = NULL;
+    for (i = 0; i < NUM_OUTPUT_CHANNELS; i++)
+        pEASData->pOutputFloatBuffer[i] = ppOut[i];
+    pEASData->outputFloatStride = 1;
+    return EAS_RenderBlock(pEASData, numRequested, pNumGenerated);
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_RenderFrames()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Render an arbitrary number of frames. Whole blocks are rendered directly
+ * into the caller's buffer. When the request does not end on a block
+ * boundary, the last block is rendered into an internal buffer and the
+ * frames that were not requested are returned first on the next call.
+ *
+ * Inputs:
+ *  pEASData        - buffer for internal EAS data
+ *  pOut            - output buffer pointer
+ *  numFrames       - requested number of frames to generate
+ *  pNumGenerated   - actual number of frames generated
+ *
+ * Outputs:
+ *  EAS_SUCCESS if PCM data was successfully rendered
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_RenderFrames (EAS_DATA_HANDLE pEASData, EAS_PCM *pOut, EAS_I32 numFrames, EAS_I32 *pNumGenerated)
+{
+    EAS_RESULT result;
+    EAS_I32 count;
+
+    *pNumGenerated = 0;
+    if (numFrames < 0)
+        return EAS_ERROR_PARAMETER_RANGE;
+
+    /* return frames left over from the previous call */
+    if (pEASData->renderFramesPending)
+    {
+        count = numFrames < pEASData->renderFramesPending ? numFrames : pEASData->renderFramesPending;
+        EAS_HWMemCpy(pOut, pEASData->pRenderFramesBuffer + pEASData->renderFramesOffset * NUM_OUTPUT_CHANNELS,
+            count * NUM_OUTPUT_CHANNELS * (EAS_I32) sizeof(EAS_PCM));
+        pEASData->renderFramesOffset += count;
+        pEASData->renderFramesPending -= count;
+        pOut += count * NUM_OUTPUT_CHANNELS;
+        numFrames -= count;
+        *pNumGenerated += count;
+    }
+
+    /* render whole blocks directly into the output buffer */
+    while (numFrames >= pEASData->blockSize)
+    {
+        if ((result = EAS_Render(pEASData, pOut, pEASData->blockSize, &count)) != EAS_SUCCESS)
+            return result;
+        if (count == 0)
+            return EAS_SUCCESS;
+        pOut += count * NUM_OUTPUT_CHANNELS;
+        numFrames -= count;
+        *pNumGenerated += count;
+    }
+
+    /* render the partial block and keep the remainder */
+    if (numFrames > 0)
+    {
+        if (pEASData->pRenderFramesBuffer == NULL)
+        {
+            { EAS_Report(_EAS_SEVERITY_ERROR, "EAS_RenderFrames: partial blocks require the dynamic memory model\n"); }
+            return EAS_BUFFER_SIZE_MISMATCH;
+        }
+        if ((result = EAS_Render(pEASData, pEASData->pRenderFramesBuffer, pEASData->blockSize, &count)) != EAS_SUCCESS)
+            return result;
+        if (count < numFrames)
+            numFrames = count;
+        EAS_HWMemCpy(pOut, pEASData->pRenderFramesBuffer, numFrames * NUM_OUTPUT_CHANNELS * (EAS_I32) sizeof(EAS_PCM));
+        pEASData->renderFramesOffset = numFrames;
+        pEASData->renderFramesPending = count - numFrames;
+        *pNumGenerated += numFrames;
+    }
+
+    return EAS_SUCCESS;
+}
+
 /*----------------------------------------------------------------------------
  * EAS_SetRepeat()
  *----------------------------------------------------------------------------
@@ -1203,9 +1559,9 @@ EAS_PUBLIC EAS_RESULT EAS_GetRepeat (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStrea
  *
  *----------------------------------------------------------------------------
 */
-/*lint -esym(715, pEASData) reserved for future use */
 EAS_PUBLIC EAS_RESULT EAS_SetPlaybackRate (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream, EAS_U32 rate)
 {
+    EAS_U32 frameLength;
 
     /* check range */
     if ((rate < (1 << 27)) || (rate > (1 << 29)))
@@ -1213,12 +1569,13 @@ EAS_PUBLIC EAS_RESULT EAS_SetPlaybackRate (EAS_DATA_HANDLE pEASData, EAS_HANDLE
 
     /* calculate new frame length
      *
-     * NOTE: The maximum frame length we can accomodate based on a
-     * maximum rate of 2.0 (2^28) is 2047 (2^13-1). To accomodate a
-     * longer frame length or a higher maximum rate, the fixed point
-     * divide below will need to be adjusted
+     * NOTE: Large block sizes give frame lengths well above 2047 (2^13-1),
+     * so the product (frameLength * rate) is split around bit 10 to stay
+     * within 32 bits. The result is identical to (frameLength * (rate >> 8)) >> 20.
      */
-    pStream->frameLength = (AUDIO_FRAME_LENGTH * (rate >> 8)) >> 20;
+    frameLength = (EAS_U32) pEASData->frameLength;
+    rate >>= 8;
+    pStream->frameLength = (EAS_I32) ((frameLength * (rate >> 10) + ((frameLength * (rate & 0x3ff)) >> 10)) >> 10);
 
     /* notify stream of new playback rate */
     EAS_SetStreamParameter(pEASData, pStream, PARSER_DATA_PLAYBACK_RATE, (EAS_I32) rate);
@@ -1540,6 +1897,7 @@ EAS_PUBLIC EAS_RESULT EAS_CloseFile (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStrea
     /* clear the handle and parser interface pointer */
     pStream->handle = NULL;
     pStream->pParserModule = NULL;
+    EAS_DiscardPendingFrames(pEASData);
     return result;
 }
 
@@ -1588,7 +1946,7 @@ EAS_PUBLIC EAS_RESULT EAS_OpenMIDIStream (EAS_DATA_HANDLE pEASData, EAS_HANDLE *
 
     /* zero the memory to insure complete initialization */
     EAS_HWMemSet(pMIDIStream, 0, sizeof(S_INTERACTIVE_MIDI));
-    EAS_InitStream(&pEASData->streams[streamNum], NULL, pMIDIStream);
+    EAS_InitStream(pEASData, &pEASData->streams[streamNum], NULL, pMIDIStream);
 
     /* instantiate a new synthesizer */
     if (streamHandle == NULL)
@@ -2014,6 +2372,55 @@ EAS_PUBLIC EAS_RESULT EAS_SetMaxLoad (EAS_DATA_HANDLE pEASData, EAS_I32 maxLoad)
     return EAS_SUCCESS;
 }
 
+/*----------------------------------------------------------------------------
+ * EAS_SetRenderBudget()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Sets the time the synthesizer may take to render a block. The time of
+ * each block is measured, and the polyphony is lowered when it runs over
+ * the budget and raised again when there is room.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *  budget          - microseconds per block, 0 to turn the budget off
+ *
+ * Outputs:
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetRenderBudget (EAS_DATA_HANDLE pEASData, EAS_I32 budget)
+{
+    if ((budget < 0) || (budget > MAX_RENDER_BUDGET))
+        return EAS_ERROR_PARAMETER_RANGE;
+    VMSetRenderBudget(pEASData->pVoiceMgr, budget);
+    return EAS_SUCCESS;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_GetBudgetPolyphony()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the number of voices that may currently play, as limited by the
+ * synthesizer polyphony and the render time budget.
+ *
+ * Inputs:
+ *  pEASData        - handle to data for this instance
+ *
+ * Outputs:
+ *  pPolyphonyCount - the polyphony in effect
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_GetBudgetPolyphony (EAS_DATA_HANDLE pEASData, EAS_I32 *pPolyphonyCount)
+{
+    *pPolyphonyCount = VMGetBudgetPolyphony(pEASData->pVoiceMgr);
+    return EAS_SUCCESS;
+}
+
 /*----------------------------------------------------------------------------
  * EAS_SetMaxPCMStreams()
  *----------------------------------------------------------------------------
@@ -2085,6 +2492,7 @@ EAS_PUBLIC EAS_RESULT EAS_Locate (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream,
 
     /* set the locate flag */
     pStream->streamFlags |= STREAM_FLAGS_LOCATE;
+    EAS_DiscardPendingFrames(pEASData);
 
     /* use the parser locate function, if available */
     if (pParserModule->pfLocate != NULL)
@@ -2524,6 +2932,54 @@ EAS_PUBLIC EAS_RESULT EAS_SetPlayMode (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStr
 }
 
 #ifdef DLS_SYNTHESIZER
+/*----------------------------------------------------------------------------
+ * EAS_AttachDLSCollection()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Points a stream, or the whole instance when no stream is given, to a
+ * DLS collection. The caller's reference to the collection is handed
+ * over, and released if the collection cannot be attached.
+ *
+ * Inputs:
+ * pEASData             - instance data handle
+ * pStream              - stream handle or NULL
+ * pDLS                 - DLS collection
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT EAS_AttachDLSCollection (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream, EAS_DLSLIB_HANDLE pDLS)
+{
+    EAS_RESULT result;
+
+    /* if a stream pStream is specified, point it to the DLS collection */
+    if (pStream != NULL)
+    {
+        if (pStream->pParserModule != NULL)
+        {
+            /* the synth takes its own reference */
+            result = EAS_IntSetStrmParam(pEASData, pStream, PARSER_DATA_DLS_COLLECTION, (EAS_IPTR) pDLS);
+            DLSCleanup(pEASData->hwInstData, pDLS);
+            return result;
+        }
+        else if (pStream->handle != NULL)
+        {
+            S_INTERACTIVE_MIDI *pMIDIStream = (S_INTERACTIVE_MIDI *) pStream->handle;
+            result = VMSetDLSLib(pMIDIStream->pSynth, pDLS);
+        }
+        else
+            result = EAS_FAILURE;
+    }
+    /* global DLS load */
+    else
+        result = VMSetGlobalDLSLib(pEASData, pDLS);
+
+    if (result != EAS_SUCCESS)
+        DLSCleanup(pEASData->hwInstData, pDLS);
+    return result;
+}
+
 /*----------------------------------------------------------------------------
  * EAS_LoadDLSCollection()
  *----------------------------------------------------------------------------
@@ -2543,7 +2999,6 @@ EAS_PUBLIC EAS_RESULT EAS_SetPlayMode (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStr
 */
 EAS_PUBLIC EAS_RESULT EAS_LoadDLSCollection (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream, EAS_FILE_LOCATOR locator)
 {
-    EAS_FILE_HANDLE fileHandle;
     EAS_RESULT result;
     EAS_DLSLIB_HANDLE pDLS;
 
@@ -2553,37 +3008,231 @@ EAS_PUBLIC EAS_RESULT EAS_LoadDLSCollection (EAS_DATA_HANDLE pEASData, EAS_HANDL
             return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
     }
 
+    if ((result = EAS_LoadDLSCollectionHandle(pEASData, locator, &pDLS)) != EAS_SUCCESS)
+        return result;
+    return EAS_AttachDLSCollection(pEASData, pStream, pDLS);
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_LoadDLSCollectionHandle()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Parses a DLS or SF2 collection into a handle that any number of
+ * instances can share.
+ *
+ * Inputs:
+ * pEASData             - instance data handle, used for file access
+ * locator              - file locator
+ * ppDLS                - pointer to variable to receive the handle
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_LoadDLSCollectionHandle (EAS_DATA_HANDLE pEASData, EAS_FILE_LOCATOR locator, EAS_DLSLIB_HANDLE *ppDLS)
+{
+    EAS_FILE_HANDLE fileHandle;
+    EAS_RESULT result;
+
+    *ppDLS = NULL;
+
     /* open the file */
     if ((result = EAS_HWOpenFile(pEASData->hwInstData, locator, &fileHandle, EAS_FILE_READ)) != EAS_SUCCESS)
         return result;
 
     /* parse the file */
-    result = DLSParser(pEASData->hwInstData, fileHandle, 0, &pDLS);
+    result = DLSParser(pEASData->hwInstData, fileHandle, 0, ppDLS);
     EAS_HWCloseFile(pEASData->hwInstData, fileHandle);
+    return result;
+}
 
-    if (result == EAS_SUCCESS)
+/* file contents already in memory, read through the host file functions while parsing */
+typedef struct
+{
+    const EAS_U8    *pData;
+    EAS_I32         size;
+} S_EAS_MEMORY_FILE;
+
+static int EAS_MemoryFileReadAt (void *handle, void *buf, int offset, int size)
+{
+    const S_EAS_MEMORY_FILE *pFile = (const S_EAS_MEMORY_FILE *) handle;
+
+    if ((offset < 0) || (size < 0) || (offset > pFile->size))
+        return 0;
+    if (size > pFile->size - offset)
+        size = pFile->size - offset;
+    EAS_HWMemCpy(buf, pFile->pData + offset, size);
+    return size;
+}
+
+static int EAS_MemoryFileSize (void *handle)
+{
+    return ((const S_EAS_MEMORY_FILE *) handle)->size;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_LoadDLSCollectionMapped()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Parses a DLS or SF2 collection from memory, usually a memory-mapped
+ * file, into a handle like EAS_LoadDLSCollectionHandle. 16-bit PCM sample
+ * data is played from that memory instead of being copied, which also lets
+ * processes mapping the same file share its pages.
+ *
+ * Inputs:
+ * pEASData             - instance data handle, used for file access
+ * pData                - file contents
+ * size                 - size of the file contents in bytes
+ * ppDLS                - pointer to variable to receive the handle
+ *
+ * Outputs:
+ *
+ * Side Effects:
+ * pData must stay valid and unchanged until the collection is released
+ * by the host and by every instance using it
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_LoadDLSCollectionMapped (EAS_DATA_HANDLE pEASData, const void *pData, EAS_I32 size, EAS_DLSLIB_HANDLE *ppDLS)
+{
+    S_EAS_MEMORY_FILE memoryFile;
+    EAS_FILE locator;
+    EAS_FILE_HANDLE fileHandle;
+    EAS_RESULT result;
+
+    *ppDLS = NULL;
+    if ((pData == NULL) || (size <= 0))
+        return EAS_ERROR_INVALID_PARAMETER;
+
+    memoryFile.pData = (const EAS_U8 *) pData;
+    memoryFile.size = size;
+    locator.handle = &memoryFile;
+    locator.readAt = EAS_MemoryFileReadAt;
+    locator.size = EAS_MemoryFileSize;
+
+    /* open the file */
+    if ((result = EAS_HWOpenFile(pEASData->hwInstData, &locator, &fileHandle, EAS_FILE_READ)) != EAS_SUCCESS)
+        return result;
+
+    /* parse the file */
+    result = DLSParserMapped(pEASData->hwInstData, fileHandle, 0, pData, size, ppDLS);
+    EAS_HWCloseFile(pEASData->hwInstData, fileHandle);
+    return result;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_WriteDLSCollectionCache()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Writes a precompiled image of a collection that EAS_LoadDLSCollectionCache
+ * can use on later starts instead of parsing the source file again.
+ *
+ * Inputs:
+ * pDLS                 - collection handle
+ * sourceSize           - size of the source file
+ * sourceStamp          - host defined stamp of the source file
+ * pBuffer              - buffer for the image, or NULL to query its size
+ * bufferSize           - size of pBuffer
+ * pCacheSize           - pointer to variable to receive the image size
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_WriteDLSCollectionCache (EAS_DLSLIB_HANDLE pDLS, EAS_I32 sourceSize, EAS_U32 sourceStamp, void *pBuffer, EAS_I32 bufferSize, EAS_I32 *pCacheSize)
+{
+    EAS_U32 cacheSize;
+    EAS_RESULT result;
+
+    if ((pDLS == NULL) || (sourceSize < 0) || (bufferSize < 0) || (pCacheSize == NULL))
+        return EAS_ERROR_INVALID_PARAMETER;
+
+    result = DLSWriteCache(pDLS, (EAS_U32) sourceSize, sourceStamp, pBuffer, (EAS_U32) bufferSize, &cacheSize);
+    *pCacheSize = (EAS_I32) cacheSize;
+    return result;
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_LoadDLSCollectionCache()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Creates a collection handle from an image written by
+ * EAS_WriteDLSCollectionCache, using its tables in place.
+ *
+ * Inputs:
+ * pEASData             - instance data handle, used only for memory
+ * pCache               - cache image, aligned to 8 bytes
+ * cacheSize            - size of the image
+ * pFileData            - source file contents when its samples were mapped
+ * sourceSize           - current size of the source file
+ * sourceStamp          - current host defined stamp of the source file
+ * ppDLS                - pointer to variable to receive the handle
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_LoadDLSCollectionCache (EAS_DATA_HANDLE pEASData, const void *pCache, EAS_I32 cacheSize, const void *pFileData, EAS_I32 sourceSize, EAS_U32 sourceStamp, EAS_DLSLIB_HANDLE *ppDLS)
+{
+    *ppDLS = NULL;
+    if ((pCache == NULL) || (cacheSize < 0) || (sourceSize < 0))
+        return EAS_ERROR_INVALID_PARAMETER;
+
+    return DLSReadCache(pEASData->hwInstData, pCache, (EAS_U32) cacheSize, pFileData, (EAS_U32) sourceSize, sourceStamp, ppDLS);
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_SetDLSCollection()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Points a stream, or the whole instance when no stream is given, to a
+ * shared DLS collection.
+ *
+ * Inputs:
+ * pEASData             - instance data handle
+ * pStream              - stream handle or NULL
+ * pDLS                 - handle from EAS_LoadDLSCollectionHandle
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_SetDLSCollection (EAS_DATA_HANDLE pEASData, EAS_HANDLE pStream, EAS_DLSLIB_HANDLE pDLS)
+{
+    if (pDLS == NULL)
+        return EAS_ERROR_INVALID_PARAMETER;
+
+    if (pStream != NULL && pStream->pParserModule != NULL)
     {
-      /* if a stream pStream is specified, point it to the DLS collection */
-      if (pStream != NULL)
-      {
-        if (pStream->pParserModule != NULL)
-        {
-          result = EAS_IntSetStrmParam(pEASData, pStream, PARSER_DATA_DLS_COLLECTION, (EAS_IPTR) pDLS);
-        }
-        else if (pStream->handle != NULL)
-        {
-          S_INTERACTIVE_MIDI *pMIDIStream = (S_INTERACTIVE_MIDI *) pStream->handle;
-          result = VMSetDLSLib(pMIDIStream->pSynth, pDLS);
-        }
-        else
-          result = EAS_FAILURE;
-      }
-      /* global DLS load */
-      else
-          result = VMSetGlobalDLSLib(pEASData, pDLS);
+        if (!EAS_StreamReady(pEASData, pStream))
+            return EAS_ERROR_NOT_VALID_IN_THIS_STATE;
     }
 
-    return result;
+    /* the instance keeps its own reference */
+    DLSAddRef(pDLS);
+    return EAS_AttachDLSCollection(pEASData, pStream, pDLS);
+}
+
+/*----------------------------------------------------------------------------
+ * EAS_ReleaseDLSCollection()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Releases the host's reference to a shared DLS collection. The
+ * collection is freed when no instance uses it anymore.
+ *
+ * Inputs:
+ * pDLS                 - handle from EAS_LoadDLSCollectionHandle
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_PUBLIC EAS_RESULT EAS_ReleaseDLSCollection (EAS_DLSLIB_HANDLE pDLS)
+{
+    if (pDLS == NULL)
+        return EAS_ERROR_INVALID_PARAMETER;
+
+    /* the host memory functions do not depend on the instance */
+    return DLSCleanup(NULL, pDLS);
 }
 #endif
 
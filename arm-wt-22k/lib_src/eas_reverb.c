@@ -45,9 +45,17 @@
 /* prototypes for effects interface */
 static EAS_RESULT ReverbInit (EAS_DATA_HANDLE pEASData, EAS_VOID_PTR *pInstData);
 static void ReverbProcess (EAS_VOID_PTR pInstData, EAS_PCM *pSrc, EAS_PCM *pDst, EAS_I32 numSamples);
+static void ReverbProcess32 (EAS_VOID_PTR pInstData, EAS_I32 *pSrc, EAS_I32 *pDst, EAS_I32 numSamples);
 static EAS_RESULT ReverbShutdown (EAS_DATA_HANDLE pEASData, EAS_VOID_PTR pInstData);
 static EAS_RESULT ReverbGetParam (EAS_VOID_PTR pInstData, EAS_I32 param, EAS_I32 *pValue);
 static EAS_RESULT ReverbSetParam (EAS_VOID_PTR pInstData, EAS_I32 param, EAS_I32 value);
+static EAS_BOOL ReverbIsBypassed (const S_REVERB_OBJECT *pReverbData);
+static EAS_BOOL ReverbStartBlock (S_REVERB_OBJECT *pReverbData, EAS_I32 numSamples, EAS_BOOL silentInput);
+static void ReverbTrackTail (S_REVERB_OBJECT *pReverbData, EAS_I32 numSamples, EAS_BOOL silent);
+static void ReverbEndBlock (S_REVERB_OBJECT *pReverbData, EAS_I32 numSamples);
+static EAS_BOOL ReverbIsSilent (const EAS_PCM *pBuffer, EAS_I32 numSamples, EAS_PCM level);
+static EAS_BOOL ReverbIsSilent32 (const EAS_I32 *pBuffer, EAS_I32 numSamples, EAS_I32 level);
+static void ReverbClearTail (S_REVERB_OBJECT *pReverbData);
 
 /* common effects interface for configuration module */
 const S_EFFECTS_INTERFACE EAS_Reverb =
@@ -56,7 +64,8 @@ const S_EFFECTS_INTERFACE EAS_Reverb =
     ReverbProcess,
     ReverbShutdown,
     ReverbGetParam,
-    ReverbSetParam
+    ReverbSetParam,
+    ReverbProcess32
 };
 
 
@@ -75,17 +84,23 @@ const S_EFFECTS_INTERFACE EAS_Reverb =
 static EAS_RESULT ReverbInit(EAS_DATA_HANDLE pEASData, EAS_VOID_PTR *pInstData)
 {
     EAS_I32 i;
+    EAS_I32 rate;
+    EAS_I32 nBufferSize;
     EAS_U16 nOffset;
 
     S_REVERB_OBJECT *pReverbData;
 
+    /* the delay line holds all sections at the instance sample rate */
+    rate = pEASData->sampleRate;
+    for (nBufferSize = 1; nBufferSize < DELAY1_IN(rate) + MAX_DELAY_SAMPLES(rate); nBufferSize <<= 1) {}
+
     /* check Configuration Module for data allocation */
     if (pEASData->staticMemoryModel)
         pReverbData = EAS_CMEnumFXData(EAS_MODULE_REVERB);
 
     /* allocate dynamic memory */
     else
-        pReverbData = EAS_HWMalloc(pEASData->hwInstData, sizeof(S_REVERB_OBJECT));
+        pReverbData = EAS_HWMalloc(pEASData->hwInstData, sizeof(S_REVERB_OBJECT) + nBufferSize * (EAS_I32) sizeof(EAS_PCM));
 
     if (pReverbData == NULL)
     {
@@ -96,6 +111,12 @@ static EAS_RESULT ReverbInit(EAS_DATA_HANDLE pEASData, EAS_VOID_PTR *pInstData)
     /* clear the structure */
     EAS_HWMemSet(pReverbData, 0, sizeof(S_REVERB_OBJECT));
 
+    pReverbData->m_nSampleRate = rate;
+    pReverbData->m_nDelayLine = (EAS_PCM *) (pReverbData + 1);
+    pReverbData->m_nBufferMask = (EAS_U16) (nBufferSize - 1);
+    pReverbData->m_zD0Out = (EAS_U16) DELAY0_OUT(rate);
+    pReverbData->m_zD1Out = (EAS_U16) DELAY1_OUT(rate);
+
     ReverbReadInPresets(pReverbData);
 
     pReverbData->m_nMinSamplesToAdd = REVERB_UPDATE_PERIOD_IN_SAMPLES;
@@ -104,16 +125,16 @@ static EAS_RESULT ReverbInit(EAS_DATA_HANDLE pEASData, EAS_VOID_PTR *pInstData)
     pReverbData->m_nRevOutFbkL = 0;
 
     pReverbData->m_sAp0.m_zApIn  = AP0_IN;
-    pReverbData->m_sAp0.m_zApOut = AP0_IN + DEFAULT_AP0_LENGTH;
+    pReverbData->m_sAp0.m_zApOut = AP0_IN + DEFAULT_AP0_LENGTH(rate);
     pReverbData->m_sAp0.m_nApGain = DEFAULT_AP0_GAIN;
 
-    pReverbData->m_zD0In = DELAY0_IN;
+    pReverbData->m_zD0In = DELAY0_IN(rate);
 
-    pReverbData->m_sAp1.m_zApIn  = AP1_IN;
-    pReverbData->m_sAp1.m_zApOut = AP1_IN + DEFAULT_AP1_LENGTH;
+    pReverbData->m_sAp1.m_zApIn  = AP1_IN(rate);
+    pReverbData->m_sAp1.m_zApOut = AP1_IN(rate) + DEFAULT_AP1_LENGTH(rate);
     pReverbData->m_sAp1.m_nApGain = DEFAULT_AP1_GAIN;
 
-    pReverbData->m_zD1In = DELAY1_IN;
+    pReverbData->m_zD1In = DELAY1_IN(rate);
 
     pReverbData->m_zLpf0    = 0;
     pReverbData->m_zLpf1    = 0;
@@ -126,10 +147,10 @@ static EAS_RESULT ReverbInit(EAS_DATA_HANDLE pEASData, EAS_VOID_PTR *pInstData)
     pReverbData->m_nCosIncrement    = 0;
 
     // set xfade parameters
-    pReverbData->m_nXfadeInterval = (EAS_U16)REVERB_XFADE_PERIOD_IN_SAMPLES;
+    pReverbData->m_nXfadeInterval = (EAS_U16)REVERB_XFADE_PERIOD_IN_SAMPLES(rate);
     pReverbData->m_nXfadeCounter = pReverbData->m_nXfadeInterval + 1;   // force update on first iteration
     pReverbData->m_nPhase = -32768;
-    pReverbData->m_nPhaseIncrement = REVERB_XFADE_PHASE_INCREMENT;
+    pReverbData->m_nPhaseIncrement = REVERB_XFADE_PHASE_INCREMENT(rate);
 
     pReverbData->m_nNoise = (EAS_I16)0xABCD;
 
@@ -140,25 +161,25 @@ static EAS_RESULT ReverbInit(EAS_DATA_HANDLE pEASData, EAS_VOID_PTR *pInstData)
                                     &pReverbData->m_nNoise );
 
     pReverbData->m_zD1Cross =
-        DELAY1_OUT - pReverbData->m_nMaxExcursion + nOffset;
+        pReverbData->m_zD1Out - pReverbData->m_nMaxExcursion + nOffset;
 
     nOffset = ReverbCalculateNoise( pReverbData->m_nMaxExcursion,
                                     &pReverbData->m_nNoise );
 
     pReverbData->m_zD0Cross =
-        DELAY1_OUT - pReverbData->m_nMaxExcursion - nOffset;
+        pReverbData->m_zD1Out - pReverbData->m_nMaxExcursion - nOffset;
 
     nOffset = ReverbCalculateNoise( pReverbData->m_nMaxExcursion,
                                     &pReverbData->m_nNoise );
 
     pReverbData->m_zD0Self  =
-        DELAY0_OUT - pReverbData->m_nMaxExcursion - nOffset;
+        pReverbData->m_zD0Out - pReverbData->m_nMaxExcursion - nOffset;
 
     nOffset = ReverbCalculateNoise( pReverbData->m_nMaxExcursion,
                                     &pReverbData->m_nNoise );
 
     pReverbData->m_zD1Self  =
-        DELAY1_OUT - pReverbData->m_nMaxExcursion + nOffset;
+        pReverbData->m_zD1Out - pReverbData->m_nMaxExcursion + nOffset;
 
     // for debugging purposes, allow noise generator
     pReverbData->m_bUseNoise = EAS_FALSE;
@@ -194,10 +215,11 @@ static EAS_RESULT ReverbInit(EAS_DATA_HANDLE pEASData, EAS_VOID_PTR *pInstData)
     }
 
     // clear the reverb delay line
-    for (i=0; i < REVERB_BUFFER_SIZE_IN_SAMPLES; i++)
+    for (i=0; i < nBufferSize; i++)
     {
         pReverbData->m_nDelayLine[i] = 0;
     }
+    pReverbData->m_bTailSilent = EAS_TRUE;
 
     ReverbUpdateRoom(pReverbData);
 
@@ -231,18 +253,104 @@ static EAS_RESULT ReverbInit(EAS_DATA_HANDLE pEASData, EAS_VOID_PTR *pInstData)
 static void ReverbProcess(EAS_VOID_PTR pInstData, EAS_PCM *pSrc, EAS_PCM *pDst, EAS_I32 numSamples)
 {
     S_REVERB_OBJECT *pReverbData;
+    EAS_BOOL silentInput;
 
     pReverbData = (S_REVERB_OBJECT*) pInstData;
 
     //if bypassed or the preset forces the signal to be completely dry
-    if (pReverbData->m_bBypass ||
-        (pReverbData->m_nWet == 0 && pReverbData->m_nDry == 32767))
+    if (ReverbIsBypassed(pReverbData))
+    {
+        if (pSrc != pDst)
+            EAS_HWMemCpy(pDst, pSrc, numSamples * NUM_OUTPUT_CHANNELS * (EAS_I32) sizeof(EAS_PCM));
+        return;
+    }
+
+    silentInput = ReverbIsSilent(pSrc, numSamples, 0);
+    if (ReverbStartBlock(pReverbData, numSamples, silentInput))
+    {
+        Reverb(pReverbData, numSamples, pDst, pSrc);
+        ReverbTrackTail(pReverbData, numSamples, silentInput && ReverbIsSilent(pDst, numSamples, REVERB_SILENCE_LEVEL));
+    }
+    ReverbEndBlock(pReverbData, numSamples);
+
+}   /* end ComputeReverb */
+
+/*----------------------------------------------------------------------------
+ * ReverbProcess32()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Reverberate the requested number of samples of a 32-bit send buffer
+ *
+ * Inputs:
+ * pSrc - src buffer
+ * pDst - dst buffer, the reverb is added to it without saturation
+ * numSamples - number of sample frames
+ *
+ * Outputs:
+ *
+ * Side Effects:
+ * - samples are added to the presently free buffer
+ *
+ *----------------------------------------------------------------------------
+*/
+static void ReverbProcess32 (EAS_VOID_PTR pInstData, EAS_I32 *pSrc, EAS_I32 *pDst, EAS_I32 numSamples)
+{
+    S_REVERB_OBJECT *pReverbData;
+    EAS_BOOL silentInput;
+
+    pReverbData = (S_REVERB_OBJECT*) pInstData;
+
+    if (ReverbIsBypassed(pReverbData))
     {
         if (pSrc != pDst)
-            EAS_HWMemCpy(pSrc, pDst, numSamples * NUM_OUTPUT_CHANNELS * (EAS_I32) sizeof(EAS_PCM));
+            EAS_HWMemCpy(pDst, pSrc, numSamples * NUM_OUTPUT_CHANNELS * (EAS_I32) sizeof(EAS_I32));
         return;
     }
 
+    silentInput = ReverbIsSilent32(pSrc, numSamples, 0);
+    if (ReverbStartBlock(pReverbData, numSamples, silentInput))
+    {
+        Reverb32(pReverbData, numSamples, pDst, pSrc);
+        ReverbTrackTail(pReverbData, numSamples, silentInput && ReverbIsSilent32(pDst, numSamples, REVERB_SILENCE_LEVEL));
+    }
+    ReverbEndBlock(pReverbData, numSamples);
+}
+
+/*----------------------------------------------------------------------------
+ * ReverbIsBypassed()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Checks if the reverb is bypassed or the preset forces the signal to be
+ * completely dry
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_BOOL ReverbIsBypassed (const S_REVERB_OBJECT *pReverbData)
+{
+    return (pReverbData->m_bBypass ||
+        (pReverbData->m_nWet == 0 && pReverbData->m_nDry == 32767));
+}
+
+/*----------------------------------------------------------------------------
+ * ReverbStartBlock()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Updates the room and the modulation for a block, and checks whether the
+ * block has to be reverberated
+ *
+ * Inputs:
+ * pReverbData - reverb instance
+ * numSamples - number of sample frames
+ * silentInput - the input block is all zero
+ *
+ * Outputs:
+ * EAS_FALSE if the block adds nothing to the output, its modulation has
+ * then been advanced already
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_BOOL ReverbStartBlock (S_REVERB_OBJECT *pReverbData, EAS_I32 numSamples, EAS_BOOL silentInput)
+{
     if (pReverbData->m_nNextRoom != pReverbData->m_nCurrentRoom)
     {
         ReverbUpdateRoom(pReverbData);
@@ -250,8 +358,63 @@ static void ReverbProcess(EAS_VOID_PTR pInstData, EAS_PCM *pSrc, EAS_PCM *pDst,
 
     ReverbUpdateXfade(pReverbData, numSamples);
 
-    Reverb(pReverbData, numSamples, pDst, pSrc);
+    //silent input into a decayed tail adds nothing to the output, only advance the modulation
+    if (silentInput && pReverbData->m_bTailSilent)
+    {
+        pReverbData->m_nBaseIndex = (EAS_U16) (pReverbData->m_nBaseIndex - numSamples);
+        pReverbData->m_nSin = (EAS_I16) (pReverbData->m_nSin + pReverbData->m_nSinIncrement * numSamples);
+        pReverbData->m_nCos = (EAS_I16) (pReverbData->m_nCos + pReverbData->m_nCosIncrement * numSamples);
+        return EAS_FALSE;
+    }
+
+    pReverbData->m_bTailSilent = EAS_FALSE;
+    return EAS_TRUE;
+}
 
+/*----------------------------------------------------------------------------
+ * ReverbTrackTail()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Tracks the decay of the tail after a reverberated block
+ *
+ * Inputs:
+ * pReverbData - reverb instance
+ * numSamples - number of sample frames
+ * silent - silent input gave a silent output
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void ReverbTrackTail (S_REVERB_OBJECT *pReverbData, EAS_I32 numSamples, EAS_BOOL silent)
+{
+    //the tail has decayed once the output stays silent for a whole delay line
+    if (silent)
+    {
+        pReverbData->m_nSilentSamples += numSamples;
+        if (pReverbData->m_nSilentSamples > (EAS_I32) pReverbData->m_nBufferMask)
+            ReverbClearTail(pReverbData);
+    }
+    else
+        pReverbData->m_nSilentSamples = 0;
+}
+
+/*----------------------------------------------------------------------------
+ * ReverbEndBlock()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Advances the update counter at the end of a block
+ *
+ * Inputs:
+ * pReverbData - reverb instance
+ * numSamples - number of sample frames
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void ReverbEndBlock (S_REVERB_OBJECT *pReverbData, EAS_I32 numSamples)
+{
     /* check if update counter needs to be reset */
     if (pReverbData->m_nUpdateCounter >= REVERB_MODULO_UPDATE_PERIOD_IN_SAMPLES)
     {
@@ -261,8 +424,84 @@ static void ReverbProcess(EAS_VOID_PTR pInstData, EAS_PCM *pSrc, EAS_PCM *pDst,
 
     /* increment update counter */
     pReverbData->m_nUpdateCounter += (EAS_I16)numSamples;
+}
 
-}   /* end ComputeReverb */
+/*----------------------------------------------------------------------------
+ * ReverbIsSilent()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Checks if a block of samples stays within the given level
+ *
+ * Inputs:
+ * pBuffer - interleaved samples
+ * numSamples - number of sample frames
+ * level - largest magnitude of a silent sample
+ *
+ * Outputs:
+ * EAS_TRUE if the block is silent
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_BOOL ReverbIsSilent (const EAS_PCM *pBuffer, EAS_I32 numSamples, EAS_PCM level)
+{
+    EAS_I32 i;
+
+    for (i = 0; i < numSamples * NUM_OUTPUT_CHANNELS; i++)
+    {
+        if ((pBuffer[i] > level) || (pBuffer[i] < -level))
+            return EAS_FALSE;
+    }
+    return EAS_TRUE;
+}
+
+/*----------------------------------------------------------------------------
+ * ReverbIsSilent32()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Checks if a block of 32-bit samples stays within the given level
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_BOOL ReverbIsSilent32 (const EAS_I32 *pBuffer, EAS_I32 numSamples, EAS_I32 level)
+{
+    EAS_I32 i;
+
+    for (i = 0; i < numSamples * NUM_OUTPUT_CHANNELS; i++)
+    {
+        if ((pBuffer[i] > level) || (pBuffer[i] < -level))
+            return EAS_FALSE;
+    }
+    return EAS_TRUE;
+}
+
+/*----------------------------------------------------------------------------
+ * ReverbClearTail()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Clears what is left of a decayed tail and marks it silent
+ *
+ * Inputs:
+ * pReverbData - reverb instance
+ *
+ * Outputs:
+ *
+ * Side Effects:
+ * - the delay line and the filter states are cleared
+ *
+ *----------------------------------------------------------------------------
+*/
+static void ReverbClearTail (S_REVERB_OBJECT *pReverbData)
+{
+    EAS_HWMemSet(pReverbData->m_nDelayLine, 0, ((EAS_I32) pReverbData->m_nBufferMask + 1) * (EAS_I32) sizeof(EAS_PCM));
+    pReverbData->m_nRevOutFbkR = 0;
+    pReverbData->m_nRevOutFbkL = 0;
+    pReverbData->m_zLpf0 = 0;
+    pReverbData->m_zLpf1 = 0;
+    pReverbData->m_sEarlyL.m_zLpf = 0;
+    pReverbData->m_sEarlyR.m_zLpf = 0;
+    pReverbData->m_nSilentSamples = 0;
+    pReverbData->m_bTailSilent = EAS_TRUE;
+}
 
 /*----------------------------------------------------------------------------
  * ReverbUpdateXfade
@@ -283,6 +522,7 @@ static void ReverbProcess(EAS_VOID_PTR pInstData, EAS_PCM *pSrc, EAS_PCM *pDst,
 */
 static EAS_RESULT ReverbUpdateXfade(S_REVERB_OBJECT *pReverbData, EAS_INT nNumSamplesToAdd)
 {
+    EAS_INT nBits;
     EAS_U16 nOffset;
     EAS_I16 tempCos;
     EAS_I16 tempSin;
@@ -307,12 +547,12 @@ static EAS_RESULT ReverbUpdateXfade(S_REVERB_OBJECT *pReverbData, EAS_INT nNumSa
             nOffset = ReverbCalculateNoise( pReverbData->m_nMaxExcursion, &pReverbData->m_nNoise );
 
             pReverbData->m_zD1Cross =
-                DELAY1_OUT - pReverbData->m_nMaxExcursion + nOffset;
+                pReverbData->m_zD1Out - pReverbData->m_nMaxExcursion + nOffset;
 
             nOffset = ReverbCalculateNoise( pReverbData->m_nMaxExcursion, &pReverbData->m_nNoise );
 
             pReverbData->m_zD0Cross =
-                DELAY0_OUT - pReverbData->m_nMaxExcursion - nOffset;
+                pReverbData->m_zD0Out - pReverbData->m_nMaxExcursion - nOffset;
         }
         else
         {
@@ -327,12 +567,12 @@ static EAS_RESULT ReverbUpdateXfade(S_REVERB_OBJECT *pReverbData, EAS_INT nNumSa
             nOffset = ReverbCalculateNoise( pReverbData->m_nMaxExcursion, &pReverbData->m_nNoise );
 
             pReverbData->m_zD0Self  =
-                DELAY0_OUT - pReverbData->m_nMaxExcursion - nOffset;
+                pReverbData->m_zD0Out - pReverbData->m_nMaxExcursion - nOffset;
 
             nOffset = ReverbCalculateNoise( pReverbData->m_nMaxExcursion, &pReverbData->m_nNoise );
 
             pReverbData->m_zD1Self  =
-                DELAY1_OUT - pReverbData->m_nMaxExcursion + nOffset;
+                pReverbData->m_zD1Out - pReverbData->m_nMaxExcursion + nOffset;
 
         }   // end if-else (pReverbData->m_nPhaseIncrement > 0)
 
@@ -343,8 +583,16 @@ static EAS_RESULT ReverbUpdateXfade(S_REVERB_OBJECT *pReverbData, EAS_INT nNumSa
 
     }   // end if counter >= update interval
 
+    // the phase increment is defined per REVERB_UPDATE_PERIOD_IN_SAMPLES,
+    // scale it to the (power of two) block size of this call
+    for (nBits = 0; (1 << nBits) < nNumSamplesToAdd; nBits++) {}
+
     //compute what phase will be next time
-    pReverbData->m_nPhase += pReverbData->m_nPhaseIncrement;
+    /*lint -e{702} shift for performance */
+    if (nBits >= REVERB_UPDATE_PERIOD_IN_BITS)
+        pReverbData->m_nPhase += (EAS_I16) (pReverbData->m_nPhaseIncrement * (1 << (nBits - REVERB_UPDATE_PERIOD_IN_BITS)));
+    else
+        pReverbData->m_nPhase += (EAS_I16) (pReverbData->m_nPhaseIncrement >> (REVERB_UPDATE_PERIOD_IN_BITS - nBits));
 
     //calculate what the new sin and cos need to reach by the next update
     ReverbCalculateSinCos(pReverbData->m_nPhase, &tempSin, &tempCos);
@@ -352,11 +600,11 @@ static EAS_RESULT ReverbUpdateXfade(S_REVERB_OBJECT *pReverbData, EAS_INT nNumSa
     //calculate the per-sample increment required to get there by the next update
     /*lint -e{702} shift for performance */
     pReverbData->m_nSinIncrement =
-            (tempSin - pReverbData->m_nSin) >> REVERB_UPDATE_PERIOD_IN_BITS;
+            (tempSin - pReverbData->m_nSin) >> nBits;
 
     /*lint -e{702} shift for performance */
     pReverbData->m_nCosIncrement =
-            (tempCos - pReverbData->m_nCos) >> REVERB_UPDATE_PERIOD_IN_BITS;
+            (tempCos - pReverbData->m_nCos) >> nBits;
 
 
     /* increment update counter */
@@ -461,272 +709,468 @@ static EAS_RESULT ReverbCalculateSinCos(EAS_I16 nPhase, EAS_I16 *pnSin, EAS_I16
 }   /* end ReverbCalculateSinCos */
 
 /*----------------------------------------------------------------------------
- * Reverb
+ * ReverbBlockSize
  *----------------------------------------------------------------------------
  * Purpose:
- * apply reverb to the given signal
+ * Returns how many samples can be processed as one block. Within a block
+ * the delay line is read for every sample before it is written, which
+ * gives the same result as the sample by sample order as long as no tap
+ * reads a position less than a block after it has been written.
  *
  * Inputs:
- * nNu
- * pnSin    - input old value, output new value
- * pnCos    - input old value, output new value
+ * pReverbData - reverb instance
  *
  * Outputs:
- * number of samples actually reverberated
- *
- * Side Effects:
+ * block size, 1 to REVERB_BLOCK_SIZE
  *
  *----------------------------------------------------------------------------
 */
-static EAS_RESULT Reverb(S_REVERB_OBJECT *pReverbData, EAS_INT nNumSamplesToAdd, EAS_PCM *pOutputBuffer, EAS_PCM *pInputBuffer)
+static EAS_INT ReverbBlockSize (const S_REVERB_OBJECT *pReverbData)
 {
-    EAS_I32 i;
-    EAS_I32 nDelayOut;
-    EAS_U16 nBase;
-
-    EAS_U32 nAddr;
-    EAS_I32 nTemp1;
-    EAS_I32 nTemp2;
-    EAS_I32 nApIn;
-    EAS_I32 nApOut;
-
-    EAS_I32 j;
-    EAS_I32 nEarlyOut;
-
-    EAS_I32 tempValue;
-
-
-    // get the base address
-    nBase = pReverbData->m_nBaseIndex;
-
-    for (i=0; i < nNumSamplesToAdd; i++)
+    EAS_U16 reads[6 + 2 * REVERB_MAX_NUM_REFLECTIONS];
+    EAS_U16 writes[4];
+    EAS_INT numReads;
+    EAS_INT nBlockSize;
+    EAS_INT nDistance;
+    EAS_INT i;
+    EAS_INT j;
+
+    writes[0] = pReverbData->m_sAp0.m_zApIn;
+    writes[1] = pReverbData->m_zD0In;
+    writes[2] = pReverbData->m_sAp1.m_zApIn;
+    writes[3] = pReverbData->m_zD1In;
+
+    reads[0] = pReverbData->m_sAp0.m_zApOut;
+    reads[1] = pReverbData->m_sAp1.m_zApOut;
+    reads[2] = pReverbData->m_zD0Self;
+    reads[3] = pReverbData->m_zD1Cross;
+    reads[4] = pReverbData->m_zD1Self;
+    reads[5] = pReverbData->m_zD0Cross;
+    numReads = 6;
+
+    // early reflections without gain are not computed
+    for (j = 0; j < REVERB_MAX_NUM_REFLECTIONS; j++)
     {
-        // ********** Left Allpass - start
-        // left input = (left dry/4) + right feedback from previous period
-        /*lint -e{702} use shift for performance */
-        nApIn = ((*pInputBuffer++)>>2) + pReverbData->m_nRevOutFbkR;
-//      nApIn = *pInputBuffer++;    // 1xxx test and debug ap
-
-        // fetch allpass delay line out
-        //nAddr = CIRCULAR(nBase, psAp0->m_zApOut, REVERB_BUFFER_MASK);
-        nAddr = CIRCULAR(nBase, pReverbData->m_sAp0.m_zApOut, REVERB_BUFFER_MASK);
-        nDelayOut = pReverbData->m_nDelayLine[nAddr];
+        if (pReverbData->m_sEarlyL.m_nGain[j] != 0)
+            reads[numReads++] = pReverbData->m_sEarlyL.m_zDelay[j];
+        if (pReverbData->m_sEarlyR.m_nGain[j] != 0)
+            reads[numReads++] = pReverbData->m_sEarlyR.m_zDelay[j];
+    }
 
-        // calculate allpass feedforward; subtract the feedforward result
-        nTemp1 = MULT_EG1_EG1(nApIn, pReverbData->m_sAp0.m_nApGain);
-        nApOut = SATURATE(nDelayOut - nTemp1);          // allpass output
+    // a position written at offset w is read at offset r (r - w) samples later
+    nBlockSize = REVERB_BLOCK_SIZE;
+    for (i = 0; i < 4; i++)
+    {
+        for (j = 0; j < numReads; j++)
+        {
+            nDistance = (reads[j] - writes[i]) & pReverbData->m_nBufferMask;
+            if (nDistance < nBlockSize)
+                nBlockSize = nDistance;
+        }
 
-        // calculate allpass feedback; add the feedback result
-        nTemp1 = MULT_EG1_EG1(nApOut, pReverbData->m_sAp0.m_nApGain);
-        nTemp1 = SATURATE(nApIn + nTemp1);
+        // and two writes must not land on the same position within a block
+        for (j = i + 1; j < 4; j++)
+        {
+            nDistance = (writes[j] - writes[i]) & pReverbData->m_nBufferMask;
+            if (nDistance < nBlockSize)
+                nBlockSize = nDistance;
+            nDistance = (writes[i] - writes[j]) & pReverbData->m_nBufferMask;
+            if (nDistance < nBlockSize)
+                nBlockSize = nDistance;
+        }
+    }
 
-        // inject into allpass delay
-        nAddr = CIRCULAR(nBase, pReverbData->m_sAp0.m_zApIn, REVERB_BUFFER_MASK);
-        pReverbData->m_nDelayLine[nAddr] = (EAS_PCM) nTemp1;
+    return (nBlockSize > 0) ? nBlockSize : 1;
+}
 
-        // inject allpass output into delay line
-        nAddr = CIRCULAR(nBase, pReverbData->m_zD0In, REVERB_BUFFER_MASK);
-        pReverbData->m_nDelayLine[nAddr] = (EAS_PCM) nApOut;
+/*----------------------------------------------------------------------------
+ * ReverbReadTap
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Reads a tap of the delay line for a block of samples. The base index
+ * decreases by one every sample, so the tap runs backwards through the
+ * delay line and wraps around at index 0.
+ *
+ * Inputs:
+ * pReverbData - reverb instance
+ * nBase - base index of the first sample
+ * nOffset - offset of the tap
+ * nNumSamples - number of samples
+ *
+ * Outputs:
+ * pTap - tap value of every sample
+ *
+ *----------------------------------------------------------------------------
+*/
+static void ReverbReadTap (const S_REVERB_OBJECT *pReverbData, EAS_U16 nBase, EAS_U16 nOffset, EAS_INT nNumSamples, EAS_PCM *pTap)
+{
+    const EAS_PCM *pDelayLine = pReverbData->m_nDelayLine;
+    EAS_INT nStart = CIRCULAR(nBase, nOffset, pReverbData->m_nBufferMask);
+    EAS_INT nSplit = (nStart + 1 < nNumSamples) ? nStart + 1 : nNumSamples;
+    EAS_INT i;
+
+    for (i = 0; i < nSplit; i++)
+        pTap[i] = pDelayLine[nStart - i];
+    pDelayLine += pReverbData->m_nBufferMask + 1;
+    for (; i < nNumSamples; i++)
+        pTap[i] = pDelayLine[nStart - i];
+}
 
-        // ********** Left Allpass - end
+/*----------------------------------------------------------------------------
+ * ReverbWriteTap
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Writes a tap of the delay line for a block of samples, see ReverbReadTap
+ *
+ * Inputs:
+ * pReverbData - reverb instance
+ * nBase - base index of the first sample
+ * nOffset - offset of the tap
+ * nNumSamples - number of samples
+ * pTap - tap value of every sample
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void ReverbWriteTap (S_REVERB_OBJECT *pReverbData, EAS_U16 nBase, EAS_U16 nOffset, EAS_INT nNumSamples, const EAS_PCM *pTap)
+{
+    EAS_PCM *pDelayLine = pReverbData->m_nDelayLine;
+    EAS_INT nStart = CIRCULAR(nBase, nOffset, pReverbData->m_nBufferMask);
+    EAS_INT nSplit = (nStart + 1 < nNumSamples) ? nStart + 1 : nNumSamples;
+    EAS_INT i;
+
+    for (i = 0; i < nSplit; i++)
+        pDelayLine[nStart - i] = pTap[i];
+    pDelayLine += pReverbData->m_nBufferMask + 1;
+    for (; i < nNumSamples; i++)
+        pDelayLine[nStart - i] = pTap[i];
+}
 
-        // ********** Right Allpass - start
-        // right input = (right dry/4) + left feedback from previous period
-        /*lint -e{702} use shift for performance */
-        nApIn = ((*pInputBuffer++)>>2) + pReverbData->m_nRevOutFbkL;
-//      nApIn = *pInputBuffer++;    // 1xxx test and debug ap
+/*----------------------------------------------------------------------------
+ * ReverbAllpass
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Runs one of the input allpass filters over a block
+ *
+ * Inputs:
+ * pInput - interleaved input, dry/4 in the 16-bit range
+ * pFeedback - feedback from the other channel, one sample late
+ * pDelayOut - allpass delay line output
+ * nGain - allpass gain
+ * nNumSamples - number of samples
+ *
+ * Outputs:
+ * pApIn - to write to the allpass delay line input
+ * pApOut - allpass output, to write to the delay line input
+ *
+ *----------------------------------------------------------------------------
+*/
+static void ReverbAllpass (const EAS_I32 *pInput, const EAS_I32 *pFeedback, const EAS_PCM *pDelayOut, EAS_I16 nGain, EAS_INT nNumSamples, EAS_PCM *pApIn, EAS_PCM *pApOut)
+{
+    EAS_I32 nApIn;
+    EAS_I32 nApOut;
+    EAS_INT i;
 
-        // fetch allpass delay line out
-        nAddr = CIRCULAR(nBase, pReverbData->m_sAp1.m_zApOut, REVERB_BUFFER_MASK);
-        nDelayOut = pReverbData->m_nDelayLine[nAddr];
+    for (i = 0; i < nNumSamples; i++)
+    {
+        // input + feedback from previous period
+        nApIn = pInput[i * NUM_OUTPUT_CHANNELS] + pFeedback[i];
 
         // calculate allpass feedforward; subtract the feedforward result
-        nTemp1 = MULT_EG1_EG1(nApIn, pReverbData->m_sAp1.m_nApGain);
-        nApOut = SATURATE(nDelayOut - nTemp1);          // allpass output
+        nApOut = SATURATE(pDelayOut[i] - REVERB_MULT(nApIn, nGain));
+        pApOut[i] = (EAS_PCM) nApOut;
 
         // calculate allpass feedback; add the feedback result
-        nTemp1 = MULT_EG1_EG1(nApOut, pReverbData->m_sAp1.m_nApGain);
-        nTemp1 = SATURATE(nApIn + nTemp1);
-
-        // inject into allpass delay
-        nAddr = CIRCULAR(nBase, pReverbData->m_sAp1.m_zApIn, REVERB_BUFFER_MASK);
-        pReverbData->m_nDelayLine[nAddr] = (EAS_PCM) nTemp1;
-
-        // inject allpass output into delay line
-        nAddr = CIRCULAR(nBase, pReverbData->m_zD1In, REVERB_BUFFER_MASK);
-        pReverbData->m_nDelayLine[nAddr] = (EAS_PCM) nApOut;
-
-        // ********** Right Allpass - end
-
-        // ********** D0 output - start
-        // fetch delay line self out
-        nAddr = CIRCULAR(nBase, pReverbData->m_zD0Self, REVERB_BUFFER_MASK);
-        nDelayOut = pReverbData->m_nDelayLine[nAddr];
-
-        // calculate delay line self out
-        nTemp1 = MULT_EG1_EG1(nDelayOut, pReverbData->m_nSin);
-
-        // fetch delay line cross out
-        nAddr = CIRCULAR(nBase, pReverbData->m_zD1Cross, REVERB_BUFFER_MASK);
-        nDelayOut = pReverbData->m_nDelayLine[nAddr];
-
-        // calculate delay line self out
-        nTemp2 = MULT_EG1_EG1(nDelayOut, pReverbData->m_nCos);
-
-        // calculate unfiltered delay out
-        nDelayOut = SATURATE(nTemp1 + nTemp2);
+        pApIn[i] = (EAS_PCM) SATURATE(nApIn + REVERB_MULT(nApOut, nGain));
+    }
+}
 
-        // calculate lowpass filter (mixer scale factor included in LPF feedforward)
-        nTemp1 = MULT_EG1_EG1(nDelayOut, pReverbData->m_nLpfFwd);
+/*----------------------------------------------------------------------------
+ * ReverbModulatedDelay
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Crossfades the self and the cross taps of a delay over a block and
+ * applies the feedforward part of its lowpass filter
+ *
+ * Inputs:
+ * pSelf - self tap
+ * pCross - cross tap
+ * nSin, nSinIncrement - self tap gain of the first sample and its increment
+ * nCos, nCosIncrement - cross tap gain of the first sample and its increment
+ * nLpfFwd - lowpass feedforward gain
+ * nNumSamples - number of samples
+ *
+ * Outputs:
+ * pOut - lowpass feedforward output
+ *
+ *----------------------------------------------------------------------------
+*/
+static void ReverbModulatedDelay (const EAS_PCM *pSelf, const EAS_PCM *pCross, EAS_I16 nSin, EAS_I16 nSinIncrement,
+    EAS_I16 nCos, EAS_I16 nCosIncrement, EAS_I16 nLpfFwd, EAS_INT nNumSamples, EAS_I32 *pOut)
+{
+    EAS_I32 nDelayOut;
+    EAS_INT i;
 
-        nTemp2 = MULT_EG1_EG1(pReverbData->m_zLpf0, pReverbData->m_nLpfFbk);
+    for (i = 0; i < nNumSamples; i++)
+    {
+        nDelayOut = SATURATE(REVERB_MULT(pSelf[i], (EAS_I16) (nSin + nSinIncrement * i)) +
+                             REVERB_MULT(pCross[i], (EAS_I16) (nCos + nCosIncrement * i)));
+        pOut[i] = REVERB_MULT(nDelayOut, nLpfFwd);
+    }
+}
 
-        // calculate filtered delay out and simultaneously update LPF state variable
-        // filtered delay output is stored in m_zLpf0
-        pReverbData->m_zLpf0 = (EAS_PCM) SATURATE(nTemp1 + nTemp2);
+/*----------------------------------------------------------------------------
+ * ReverbEarly
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Computes the lowpass filtered early reflections of one channel over a
+ * block
+ *
+ * Inputs:
+ * pReverbData - reverb instance
+ * psEarly - early reflections of the channel
+ * nBase - base index of the first sample
+ * nNumSamples - number of samples
+ *
+ * Outputs:
+ * pOut - early reflections
+ *
+ *----------------------------------------------------------------------------
+*/
+static void ReverbEarly (const S_REVERB_OBJECT *pReverbData, S_EARLY_REFLECTION_OBJECT *psEarly, EAS_U16 nBase, EAS_INT nNumSamples, EAS_I32 *pOut)
+{
+    EAS_PCM tap[REVERB_BLOCK_SIZE];
+    EAS_I32 nEarlyOut[REVERB_BLOCK_SIZE];
+    EAS_BOOL bSilent;
+    EAS_I32 i;
+    EAS_I32 j;
 
-        // ********** D0 output - end
+    bSilent = (psEarly->m_zLpf == 0);
+    for (i = 0; i < nNumSamples; i++)
+        nEarlyOut[i] = 0;
 
-        // ********** D1 output - start
-        // fetch delay line self out
-        nAddr = CIRCULAR(nBase, pReverbData->m_zD1Self, REVERB_BUFFER_MASK);
-        nDelayOut = pReverbData->m_nDelayLine[nAddr];
+    for (j = 0; j < REVERB_MAX_NUM_REFLECTIONS; j++)
+    {
+        // a reflection without gain adds nothing
+        if (psEarly->m_nGain[j] == 0)
+            continue;
+        bSilent = EAS_FALSE;
+
+        ReverbReadTap(pReverbData, nBase, psEarly->m_zDelay[j], nNumSamples, tap);
+        for (i = 0; i < nNumSamples; i++)
+            nEarlyOut[i] = SATURATE(nEarlyOut[i] + REVERB_MULT(tap[i], psEarly->m_nGain[j]));
+    }
 
-        // calculate delay line self out
-        nTemp1 = MULT_EG1_EG1(nDelayOut, pReverbData->m_nSin);
+    // no reflection into a settled lowpass
+    if (bSilent)
+    {
+        for (i = 0; i < nNumSamples; i++)
+            pOut[i] = 0;
+        return;
+    }
 
-        // fetch delay line cross out
-        nAddr = CIRCULAR(nBase, pReverbData->m_zD0Cross, REVERB_BUFFER_MASK);
-        nDelayOut = pReverbData->m_nDelayLine[nAddr];
+    // apply lowpass to early reflections
+    for (i = 0; i < nNumSamples; i++)
+    {
+        psEarly->m_zLpf = (EAS_PCM) SATURATE(REVERB_MULT(nEarlyOut[i], psEarly->m_nLpfFwd) +
+                                             REVERB_MULT(psEarly->m_zLpf, psEarly->m_nLpfFbk));
+        pOut[i] = psEarly->m_zLpf;
+    }
+}
 
-        // calculate delay line self out
-        nTemp2 = MULT_EG1_EG1(nDelayOut, pReverbData->m_nCos);
+/*----------------------------------------------------------------------------
+ * ReverbBlock
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Computes a block of reverb, see ReverbBlockSize. The taps are read for
+ * the whole block first, then the stages run one after the other over the
+ * block, and the delay line inputs are written last. Only the lowpass
+ * filters and the cross feedback run sample by sample.
+ *
+ * Inputs:
+ * pReverbData - reverb instance
+ * nNumSamples - number of sample frames, up to ReverbBlockSize()
+ * pInput - interleaved input, dry/4 in the 16-bit range
+ *
+ * Outputs:
+ * pOutput - interleaved reverb, scaled by the wet level
+ *
+ *----------------------------------------------------------------------------
+*/
+static void ReverbBlock (S_REVERB_OBJECT *pReverbData, EAS_INT nNumSamples, const EAS_I32 *pInput, EAS_I32 *pOutput)
+{
+    EAS_PCM apOut0[REVERB_BLOCK_SIZE];
+    EAS_PCM apOut1[REVERB_BLOCK_SIZE];
+    EAS_PCM tapSelf[REVERB_BLOCK_SIZE];
+    EAS_PCM tapCross[REVERB_BLOCK_SIZE];
+    EAS_PCM apIn[REVERB_BLOCK_SIZE];
+    EAS_PCM d0In[REVERB_BLOCK_SIZE];
+    EAS_PCM d1In[REVERB_BLOCK_SIZE];
+    EAS_I32 delay0[REVERB_BLOCK_SIZE];
+    EAS_I32 delay1[REVERB_BLOCK_SIZE];
+    EAS_I32 fbkL[REVERB_BLOCK_SIZE + 1];
+    EAS_I32 fbkR[REVERB_BLOCK_SIZE + 1];
+    EAS_I32 earlyL[REVERB_BLOCK_SIZE];
+    EAS_I32 earlyR[REVERB_BLOCK_SIZE];
+    EAS_I32 nWet;
+    EAS_I32 i;
+    EAS_U16 nBase;
 
-        // calculate unfiltered delay out
-        nDelayOut = SATURATE(nTemp1 + nTemp2);
+    nBase = pReverbData->m_nBaseIndex;
 
-        // calculate lowpass filter (mixer scale factor included in LPF feedforward)
-        nTemp1 = MULT_EG1_EG1(nDelayOut, pReverbData->m_nLpfFwd);
+    // ********** delay line reads
+    ReverbReadTap(pReverbData, nBase, pReverbData->m_sAp0.m_zApOut, nNumSamples, apOut0);
+    ReverbReadTap(pReverbData, nBase, pReverbData->m_sAp1.m_zApOut, nNumSamples, apOut1);
 
-        nTemp2 = MULT_EG1_EG1(pReverbData->m_zLpf1, pReverbData->m_nLpfFbk);
+    ReverbReadTap(pReverbData, nBase, pReverbData->m_zD0Self, nNumSamples, tapSelf);
+    ReverbReadTap(pReverbData, nBase, pReverbData->m_zD1Cross, nNumSamples, tapCross);
+    ReverbModulatedDelay(tapSelf, tapCross, pReverbData->m_nSin, pReverbData->m_nSinIncrement,
+        pReverbData->m_nCos, pReverbData->m_nCosIncrement, pReverbData->m_nLpfFwd, nNumSamples, delay0);
 
-        // calculate filtered delay out and simultaneously update LPF state variable
-        // filtered delay output is stored in m_zLpf1
-        pReverbData->m_zLpf1 = (EAS_PCM)SATURATE(nTemp1 + nTemp2);
+    ReverbReadTap(pReverbData, nBase, pReverbData->m_zD1Self, nNumSamples, tapSelf);
+    ReverbReadTap(pReverbData, nBase, pReverbData->m_zD0Cross, nNumSamples, tapCross);
+    ReverbModulatedDelay(tapSelf, tapCross, pReverbData->m_nSin, pReverbData->m_nSinIncrement,
+        pReverbData->m_nCos, pReverbData->m_nCosIncrement, pReverbData->m_nLpfFwd, nNumSamples, delay1);
 
-        // ********** D1 output - end
+    ReverbEarly(pReverbData, &pReverbData->m_sEarlyL, nBase, nNumSamples, earlyL);
+    ReverbEarly(pReverbData, &pReverbData->m_sEarlyR, nBase, nNumSamples, earlyR);
 
-        // ********** mixer and feedback - start
-        // sum is fedback to right input (R + L)
-        pReverbData->m_nRevOutFbkL =
-            (EAS_PCM)SATURATE((EAS_I32)pReverbData->m_zLpf1 + (EAS_I32)pReverbData->m_zLpf0);
+    // ********** lowpass filters and cross feedback, sample by sample
+    // feedback of the previous sample period comes first
+    fbkL[0] = pReverbData->m_nRevOutFbkL;
+    fbkR[0] = pReverbData->m_nRevOutFbkR;
+    for (i = 0; i < nNumSamples; i++)
+    {
+        // filtered delay outputs are stored in m_zLpf0 and m_zLpf1
+        pReverbData->m_zLpf0 = (EAS_PCM) SATURATE(delay0[i] + REVERB_MULT(pReverbData->m_zLpf0, pReverbData->m_nLpfFbk));
+        pReverbData->m_zLpf1 = (EAS_PCM) SATURATE(delay1[i] + REVERB_MULT(pReverbData->m_zLpf1, pReverbData->m_nLpfFbk));
 
-        // difference is feedback to left input (R - L)
+        // sum is fedback to right input (R + L), difference to left input (R - L)
         /*lint -e{685} lint complains that it can't saturate negative */
-        pReverbData->m_nRevOutFbkR =
-            (EAS_PCM)SATURATE((EAS_I32)pReverbData->m_zLpf1 - (EAS_I32)pReverbData->m_zLpf0);
-
-        // ********** mixer and feedback - end
-
-        // ********** start early reflection generator, left
-        //psEarly = &(pReverbData->m_sEarlyL);
-
-        nEarlyOut = 0;
-
-        for (j=0; j < REVERB_MAX_NUM_REFLECTIONS; j++)
-        {
-            // fetch delay line out
-            //nAddr = CIRCULAR(nBase, psEarly->m_zDelay[j], REVERB_BUFFER_MASK);
-            nAddr = CIRCULAR(nBase, pReverbData->m_sEarlyL.m_zDelay[j], REVERB_BUFFER_MASK);
-
-            nDelayOut = pReverbData->m_nDelayLine[nAddr];
-
-            // calculate reflection
-            //nTemp1 = MULT_EG1_EG1(nDelayOut, psEarly->m_nGain[j]);
-            nTemp1 = MULT_EG1_EG1(nDelayOut, pReverbData->m_sEarlyL.m_nGain[j]);
-
-            nEarlyOut = SATURATE(nEarlyOut + nTemp1);
+        fbkL[i + 1] = SATURATE((EAS_I32) pReverbData->m_zLpf1 + (EAS_I32) pReverbData->m_zLpf0);
+        fbkR[i + 1] = SATURATE((EAS_I32) pReverbData->m_zLpf1 - (EAS_I32) pReverbData->m_zLpf0);
+    }
+    pReverbData->m_nRevOutFbkL = (EAS_PCM) fbkL[nNumSamples];
+    pReverbData->m_nRevOutFbkR = (EAS_PCM) fbkR[nNumSamples];
 
-        }   // end for (j=0; j < REVERB_MAX_NUM_REFLECTIONS; j++)
+    // ********** combine early and late reflections, scaled by the wet level
+    /*lint -e{701} use shift for performance */
+    nWet = pReverbData->m_nWet << 1;
+    for (i = 0; i < nNumSamples; i++)
+    {
+        pOutput[i * NUM_OUTPUT_CHANNELS] = REVERB_MULT(SATURATE(earlyL[i] + fbkL[i + 1]), nWet);
+        pOutput[i * NUM_OUTPUT_CHANNELS + 1] = REVERB_MULT(SATURATE(earlyR[i] + fbkR[i + 1]), nWet);
+    }
 
-        // apply lowpass to early reflections
-        //nTemp1 = MULT_EG1_EG1(nEarlyOut, psEarly->m_nLpfFwd);
-        nTemp1 = MULT_EG1_EG1(nEarlyOut, pReverbData->m_sEarlyL.m_nLpfFwd);
+    // ********** input allpass filters and delay line writes
+    // left input = left dry/4 + right feedback, right input = right dry/4 + left feedback
+    ReverbAllpass(pInput, fbkR, apOut0, pReverbData->m_sAp0.m_nApGain, nNumSamples, apIn, d0In);
+    ReverbWriteTap(pReverbData, nBase, pReverbData->m_sAp0.m_zApIn, nNumSamples, apIn);
+    ReverbAllpass(pInput + 1, fbkL, apOut1, pReverbData->m_sAp1.m_nApGain, nNumSamples, apIn, d1In);
+    ReverbWriteTap(pReverbData, nBase, pReverbData->m_sAp1.m_zApIn, nNumSamples, apIn);
+    ReverbWriteTap(pReverbData, nBase, pReverbData->m_zD0In, nNumSamples, d0In);
+    ReverbWriteTap(pReverbData, nBase, pReverbData->m_zD1In, nNumSamples, d1In);
+
+    pReverbData->m_nBaseIndex = (EAS_U16) (nBase - nNumSamples);
+    pReverbData->m_nSin = (EAS_I16) (pReverbData->m_nSin + pReverbData->m_nSinIncrement * nNumSamples);
+    pReverbData->m_nCos = (EAS_I16) (pReverbData->m_nCos + pReverbData->m_nCosIncrement * nNumSamples);
+}
 
-        //nTemp2 = MULT_EG1_EG1(psEarly->m_zLpf, psEarly->m_nLpfFbk);
-        nTemp2 = MULT_EG1_EG1(pReverbData->m_sEarlyL.m_zLpf, pReverbData->m_sEarlyL.m_nLpfFbk);
+/*----------------------------------------------------------------------------
+ * Reverb
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * apply reverb to the given signal
+ *
+ * Inputs:
+ * nNumSamplesToAdd - number of sample frames
+ * pOutputBuffer    - the reverb is added to this buffer and saturated
+ * pInputBuffer     - input buffer
+ *
+ * Outputs:
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT Reverb(S_REVERB_OBJECT *pReverbData, EAS_INT nNumSamplesToAdd, EAS_PCM *pOutputBuffer, EAS_PCM *pInputBuffer)
+{
+    EAS_I32 input[REVERB_BLOCK_SIZE * NUM_OUTPUT_CHANNELS];
+    EAS_I32 output[REVERB_BLOCK_SIZE * NUM_OUTPUT_CHANNELS];
+    EAS_INT nBlockSize;
+    EAS_INT nCount;
+    EAS_INT i;
+
+    nBlockSize = ReverbBlockSize(pReverbData);
+    for (; nNumSamplesToAdd > 0; nNumSamplesToAdd -= nCount)
+    {
+        nCount = (nNumSamplesToAdd < nBlockSize) ? nNumSamplesToAdd : nBlockSize;
 
+        /*lint -e{702} use shift for performance */
+        for (i = 0; i < nCount * NUM_OUTPUT_CHANNELS; i++)
+            input[i] = pInputBuffer[i] >> 2;
 
-        // calculate filtered out and simultaneously update LPF state variable
-        // filtered output is stored in m_zLpf1
-        //psEarly->m_zLpf = SATURATE(nTemp1 + nTemp2);
-        pReverbData->m_sEarlyL.m_zLpf = (EAS_PCM) SATURATE(nTemp1 + nTemp2);
+        ReverbBlock(pReverbData, nCount, input, output);
 
-        // combine filtered early and late reflections for output
-        //*pOutputBuffer++ = inL;
-        //tempValue = SATURATE(psEarly->m_zLpf + pReverbData->m_nRevOutFbkL);
-        tempValue = SATURATE((EAS_I32)pReverbData->m_sEarlyL.m_zLpf + (EAS_I32)pReverbData->m_nRevOutFbkL);
-        //scale reverb output by wet level
-        /*lint -e{701} use shift for performance */
-        tempValue = MULT_EG1_EG1(tempValue, (pReverbData->m_nWet<<1));
         //sum with output buffer
-        tempValue += *pOutputBuffer;
-        *pOutputBuffer++ = (EAS_PCM)SATURATE(tempValue);
-
-        // ********** end early reflection generator, left
+        for (i = 0; i < nCount * NUM_OUTPUT_CHANNELS; i++)
+            pOutputBuffer[i] = (EAS_PCM) SATURATE(output[i] + pOutputBuffer[i]);
 
-        // ********** start early reflection generator, right
-        //psEarly = &(pReverbData->m_sEarlyR);
-
-        nEarlyOut = 0;
-
-        for (j=0; j < REVERB_MAX_NUM_REFLECTIONS; j++)
-        {
-            // fetch delay line out
-            nAddr = CIRCULAR(nBase, pReverbData->m_sEarlyR.m_zDelay[j], REVERB_BUFFER_MASK);
-            nDelayOut = pReverbData->m_nDelayLine[nAddr];
-
-            // calculate reflection
-            nTemp1 = MULT_EG1_EG1(nDelayOut, pReverbData->m_sEarlyR.m_nGain[j]);
-
-            nEarlyOut = SATURATE(nEarlyOut + nTemp1);
+        pInputBuffer += nCount * NUM_OUTPUT_CHANNELS;
+        pOutputBuffer += nCount * NUM_OUTPUT_CHANNELS;
+    }
 
-        }   // end for (j=0; j < REVERB_MAX_NUM_REFLECTIONS; j++)
+    return EAS_SUCCESS;
+}   /* end Reverb */
 
-        // apply lowpass to early reflections
-        nTemp1 = MULT_EG1_EG1(nEarlyOut, pReverbData->m_sEarlyR.m_nLpfFwd);
+/*----------------------------------------------------------------------------
+ * Reverb32
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * apply reverb to the given 32-bit signal, the input is saturated to the
+ * range of the delay line and the output is not saturated
+ *
+ * Inputs:
+ * nNumSamplesToAdd - number of sample frames
+ * pOutputBuffer    - the reverb is added to this buffer
+ * pInputBuffer     - input buffer
+ *
+ * Outputs:
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT Reverb32(S_REVERB_OBJECT *pReverbData, EAS_INT nNumSamplesToAdd, EAS_I32 *pOutputBuffer, EAS_I32 *pInputBuffer)
+{
+    EAS_I32 input[REVERB_BLOCK_SIZE * NUM_OUTPUT_CHANNELS];
+    EAS_I32 output[REVERB_BLOCK_SIZE * NUM_OUTPUT_CHANNELS];
+    EAS_INT nBlockSize;
+    EAS_INT nCount;
+    EAS_INT i;
+
+    nBlockSize = ReverbBlockSize(pReverbData);
+    for (; nNumSamplesToAdd > 0; nNumSamplesToAdd -= nCount)
+    {
+        nCount = (nNumSamplesToAdd < nBlockSize) ? nNumSamplesToAdd : nBlockSize;
 
-        nTemp2 = MULT_EG1_EG1(pReverbData->m_sEarlyR.m_zLpf, pReverbData->m_sEarlyR.m_nLpfFbk);
+        /*lint -e{702} use shift for performance */
+        for (i = 0; i < nCount * NUM_OUTPUT_CHANNELS; i++)
+            input[i] = SATURATE(pInputBuffer[i] >> 2);
 
-        // calculate filtered out and simultaneously update LPF state variable
-        // filtered output is stored in m_zLpf1
-        pReverbData->m_sEarlyR.m_zLpf = (EAS_PCM)SATURATE(nTemp1 + nTemp2);
+        ReverbBlock(pReverbData, nCount, input, output);
 
-        // combine filtered early and late reflections for output
-        //*pOutputBuffer++ = inR;
-        tempValue = SATURATE((EAS_I32)pReverbData->m_sEarlyR.m_zLpf + (EAS_I32)pReverbData->m_nRevOutFbkR);
-        //scale reverb output by wet level
-        /*lint -e{701} use shift for performance */
-        tempValue = MULT_EG1_EG1(tempValue, (pReverbData->m_nWet << 1));
         //sum with output buffer
-        tempValue = tempValue + *pOutputBuffer;
-        *pOutputBuffer++ = (EAS_PCM)SATURATE(tempValue);
-
-        // ********** end early reflection generator, right
-
-        // decrement base addr for next sample period
-        nBase--;
+        for (i = 0; i < nCount * NUM_OUTPUT_CHANNELS; i++)
+            pOutputBuffer[i] += output[i];
 
-        pReverbData->m_nSin += pReverbData->m_nSinIncrement;
-        pReverbData->m_nCos += pReverbData->m_nCosIncrement;
-
-    }   // end for (i=0; i < nNumSamplesToAdd; i++)
-
-    // store the most up to date version
-    pReverbData->m_nBaseIndex = nBase;
+        pInputBuffer += nCount * NUM_OUTPUT_CHANNELS;
+        pOutputBuffer += nCount * NUM_OUTPUT_CHANNELS;
+    }
 
     return EAS_SUCCESS;
-}   /* end Reverb */
+}   /* end Reverb32 */
 
 
 
@@ -792,6 +1236,9 @@ static EAS_RESULT ReverbGetParam (EAS_VOID_PTR pInstData, EAS_I32 param, EAS_I32
         case EAS_PARAM_REVERB_DRY:
             *pValue = p->m_nDry;
             break;
+        case EAS_PARAM_REVERB_TAIL_SILENT:
+            *pValue = (EAS_I32) p->m_bTailSilent;
+            break;
         default:
             return EAS_ERROR_INVALID_PARAMETER;
     }
@@ -886,21 +1333,21 @@ static EAS_RESULT ReverbUpdateRoom(S_REVERB_OBJECT *pReverbData)
     //stored as time based, convert to sample based
     temp = pPreset->m_nXfadeInterval;
     /*lint -e{702} shift for performance */
-    temp = (temp * _OUTPUT_SAMPLE_RATE) >> 16;
+    temp = (temp * pReverbData->m_nSampleRate) >> 16;
     pReverbData->m_nXfadeInterval = (EAS_U16) temp;
     //gpsReverbObject->m_nXfadeInterval = pPreset->m_nXfadeInterval;
     pReverbData->m_sAp0.m_nApGain = pPreset->m_nAp0_ApGain;
     //stored as time based, convert to absolute sample value
     temp = pPreset->m_nAp0_ApOut;
     /*lint -e{702} shift for performance */
-    temp = (temp * _OUTPUT_SAMPLE_RATE) >> 16;
+    temp = (temp * pReverbData->m_nSampleRate) >> 16;
     pReverbData->m_sAp0.m_zApOut = (EAS_U16) (pReverbData->m_sAp0.m_zApIn + temp);
     //gpsReverbObject->m_sAp0.m_zApOut = pPreset->m_nAp0_ApOut;
     pReverbData->m_sAp1.m_nApGain = pPreset->m_nAp1_ApGain;
     //stored as time based, convert to absolute sample value
     temp = pPreset->m_nAp1_ApOut;
     /*lint -e{702} shift for performance */
-    temp = (temp * _OUTPUT_SAMPLE_RATE) >> 16;
+    temp = (temp * pReverbData->m_nSampleRate) >> 16;
     pReverbData->m_sAp1.m_zApOut = (EAS_U16) (pReverbData->m_sAp1.m_zApIn + temp);
     //gpsReverbObject->m_sAp1.m_zApOut = pPreset->m_nAp1_ApOut;
 
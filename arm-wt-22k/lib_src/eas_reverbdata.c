@@ -30,5 +30,5 @@
 
 #include "eas_reverbdata.h"
 
-S_REVERB_OBJECT eas_ReverbData;
+S_REVERB_STATIC_DATA eas_ReverbData;
 
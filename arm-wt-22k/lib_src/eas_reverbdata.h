@@ -52,7 +52,8 @@ if the buffer size is a power of two.
             & size                                          \
                                             )
 
-/* reverb parameters are updated every 2^(REVERB_UPDATE_PERIOD_IN_BITS) samples */
+/* reverb parameters are updated every 2^(REVERB_UPDATE_PERIOD_IN_BITS) samples,
+ * REVERB_BUFFER_SIZE_IN_SAMPLES is the delay line size at _OUTPUT_SAMPLE_RATE */
 #if defined (_SAMPLE_RATE_8000)
 
 #define REVERB_UPDATE_PERIOD_IN_BITS        5
@@ -85,13 +86,15 @@ if the buffer size is a power of two.
 
 #endif
 
-// Define a mask for circular addressing, so that array index
-// can wraparound and stay in array boundary of 0, 1, ..., (buffer size -1)
+// The delay line size follows the instance sample rate, see ReverbInit().
+// Array indexes wrap around with a mask for circular addressing, so that
+// they stay in array boundary of 0, 1, ..., (buffer size -1)
 // The buffer size MUST be a power of two
-#define REVERB_BUFFER_MASK                  (REVERB_BUFFER_SIZE_IN_SAMPLES -1)
 
 #define REVERB_MAX_ROOM_TYPE            4   // any room numbers larger than this are invalid
 #define REVERB_MAX_NUM_REFLECTIONS      5   // max num reflections per channel
+#define REVERB_SILENCE_LEVEL            1   // the tail is silent once the output stays within this level
+#define REVERB_BLOCK_SIZE               32  // max num samples processed one stage at a time
 
 /* synth parameters are updated every SYNTH_UPDATE_PERIOD_IN_SAMPLES */
 #define REVERB_UPDATE_PERIOD_IN_SAMPLES (EAS_I32)(0x1L << REVERB_UPDATE_PERIOD_IN_BITS)
@@ -102,15 +105,12 @@ generate a 2^n modulo value
 */
 #define REVERB_MODULO_UPDATE_PERIOD_IN_SAMPLES  (EAS_I32)(REVERB_UPDATE_PERIOD_IN_SAMPLES -1)
 
-/* synth parameters are updated every SYNTH_UPDATE_PERIOD_IN_SECONDS seconds */
-#define REVERB_UPDATE_PERIOD_IN_SECONDS     (REVERB_UPDATE_PERIOD_IN_SAMPLES / _OUTPUT_SAMPLE_RATE)
-
 // xfade parameters
 #define REVERB_XFADE_PERIOD_IN_SECONDS      (100.0 / 1000.0)        // xfade once every this many seconds
 
-#define REVERB_XFADE_PERIOD_IN_SAMPLES      (REVERB_XFADE_PERIOD_IN_SECONDS * _OUTPUT_SAMPLE_RATE)
+#define REVERB_XFADE_PERIOD_IN_SAMPLES(rate)    (REVERB_XFADE_PERIOD_IN_SECONDS * (rate))
 
-#define REVERB_XFADE_PHASE_INCREMENT    (EAS_I16)(65536 / ((EAS_I16)REVERB_XFADE_PERIOD_IN_SAMPLES/(EAS_I16)REVERB_UPDATE_PERIOD_IN_SAMPLES))
+#define REVERB_XFADE_PHASE_INCREMENT(rate)  (EAS_I16)(65536 / ((EAS_I16)REVERB_XFADE_PERIOD_IN_SAMPLES(rate)/(EAS_I16)REVERB_UPDATE_PERIOD_IN_SAMPLES))
 
 /**********/
 /* the entire synth uses various flags in a bit field */
@@ -126,6 +126,16 @@ when we reset the synth (e.g., during GM ON)
 */
 #define DEFAULT_REVERB_FLAGS                    0x0
 
+/*
+the reverb multiplies truncate toward zero, the arithmetic shift of MULT_EG1_EG1
+rounds toward minus infinity and keeps a recirculating tail alive as a small
+negative limit cycle instead of letting it decay to silence
+*/
+#define REVERB_MULT(x,gain)     /*lint -e(704) <avoid divide for performance>*/ \
+            (EAS_I32)((((EAS_I32)(x) * (EAS_I32)(gain)) +                   \
+            ((((EAS_I32)(x) * (EAS_I32)(gain)) >> 31) & ((1 << NUM_EG1_FRAC_BITS) - 1))) \
+            >> NUM_EG1_FRAC_BITS)
+
 /* coefficients for generating sin, cos */
 #define REVERB_PAN_G2   4294940151          /* -0.82842712474619 = 2 - 4/sqrt(2) */
 /*
@@ -141,26 +151,26 @@ EAS_I32 nPanG1 = -1.0 for cos
 #define MAX_AP_TIME         (double) (20.0/1000.0)  // delay time in milliseconds
 #define MAX_DELAY_TIME      (double) (65.0/1000.0)  // delay time in milliseconds
 
-#define MAX_AP_SAMPLES      (int)(((double) MAX_AP_TIME)    * ((double) _OUTPUT_SAMPLE_RATE))
-#define MAX_DELAY_SAMPLES   (int)(((double) MAX_DELAY_TIME) * ((double) _OUTPUT_SAMPLE_RATE))
+#define MAX_AP_SAMPLES(rate)    (int)(((double) MAX_AP_TIME)    * ((double) (rate)))
+#define MAX_DELAY_SAMPLES(rate) (int)(((double) MAX_DELAY_TIME) * ((double) (rate)))
 
 #define AP0_IN              0
-#define AP1_IN              (AP0_IN     + MAX_AP_SAMPLES    + GUARD)
-#define DELAY0_IN           (AP1_IN     + MAX_AP_SAMPLES    + GUARD)
-#define DELAY1_IN           (DELAY0_IN  + MAX_DELAY_SAMPLES + GUARD)
+#define AP1_IN(rate)        (AP0_IN             + MAX_AP_SAMPLES(rate)      + GUARD)
+#define DELAY0_IN(rate)     (AP1_IN(rate)       + MAX_AP_SAMPLES(rate)      + GUARD)
+#define DELAY1_IN(rate)     (DELAY0_IN(rate)    + MAX_DELAY_SAMPLES(rate)   + GUARD)
 
 // Define the max offsets for the end points of each section
 // i.e., we don't expect a given section's taps to go beyond
 // the following limits
-#define AP0_OUT             (AP0_IN     + MAX_AP_SAMPLES    -1)
-#define AP1_OUT             (AP1_IN     + MAX_AP_SAMPLES    -1)
-#define DELAY0_OUT          (DELAY0_IN  + MAX_DELAY_SAMPLES -1)
-#define DELAY1_OUT          (DELAY1_IN  + MAX_DELAY_SAMPLES -1)
+#define AP0_OUT(rate)       (AP0_IN             + MAX_AP_SAMPLES(rate)      -1)
+#define AP1_OUT(rate)       (AP1_IN(rate)       + MAX_AP_SAMPLES(rate)      -1)
+#define DELAY0_OUT(rate)    (DELAY0_IN(rate)    + MAX_DELAY_SAMPLES(rate)   -1)
+#define DELAY1_OUT(rate)    (DELAY1_IN(rate)    + MAX_DELAY_SAMPLES(rate)   -1)
 
 #define REVERB_DEFAULT_ROOM_NUMBER      1       // default preset number
-#define DEFAULT_AP0_LENGTH              (int)(((double) (17.0/1000.0))  * ((double) _OUTPUT_SAMPLE_RATE))
+#define DEFAULT_AP0_LENGTH(rate)        (int)(((double) (17.0/1000.0))  * ((double) (rate)))
 #define DEFAULT_AP0_GAIN                19400
-#define DEFAULT_AP1_LENGTH              (int)(((double) (16.5/1000.0))  * ((double) _OUTPUT_SAMPLE_RATE))
+#define DEFAULT_AP1_LENGTH(rate)        (int)(((double) (16.5/1000.0))  * ((double) (rate)))
 #define DEFAULT_AP1_GAIN                -19400
 
 #define EAS_REVERB_WET_MAX              32767
@@ -281,6 +291,14 @@ typedef struct
 
     EAS_U16             m_nBaseIndex;                                   // base index for circular buffer
 
+    EAS_I32             m_nSampleRate;              // output sample rate in Hz
+
+    EAS_U16             m_nBufferMask;              // delay line size - 1
+
+    EAS_U16             m_zD0Out;                   // end of delay line D0 at this sample rate
+
+    EAS_U16             m_zD1Out;                   // end of delay line D1 at this sample rate
+
     // reverb delay line offsets, allpass parameters, etc:
 
     EAS_PCM             m_nRevOutFbkR;              // combine feedback reverb right out with dry left in
@@ -338,6 +356,10 @@ typedef struct
 
     EAS_BOOL            m_bBypass;                  // if EAS_TRUE, then bypass reverb and copy input to output
 
+    EAS_BOOL            m_bTailSilent;              // if EAS_TRUE, the delay line is clear and silent input is passed through
+
+    EAS_I32             m_nSilentSamples;           // samples of silent input that gave silent output
+
     EAS_I16             m_nCurrentRoom;             // preset number for current room
 
     EAS_I16             m_nNextRoom;                // preset number for next room
@@ -351,7 +373,7 @@ typedef struct
     S_EARLY_REFLECTION_OBJECT   m_sEarlyL;          // left channel early reflections
     S_EARLY_REFLECTION_OBJECT   m_sEarlyR;          // right channel early reflections
 
-    EAS_PCM             m_nDelayLine[REVERB_BUFFER_SIZE_IN_SAMPLES];    // one large delay line for all reverb elements
+    EAS_PCM             *m_nDelayLine;              // one large delay line for all reverb elements, follows the object
 
     S_REVERB_PRESET     pPreset;
 
@@ -359,6 +381,13 @@ typedef struct
 
 } S_REVERB_OBJECT;
 
+/* statically allocated reverb, with the delay line for _OUTPUT_SAMPLE_RATE */
+typedef struct
+{
+    S_REVERB_OBJECT     reverb;
+    EAS_PCM             delayLine[REVERB_BUFFER_SIZE_IN_SAMPLES];
+} S_REVERB_STATIC_DATA;
+
 
 /*------------------------------------
  * prototypes
@@ -444,6 +473,16 @@ static EAS_RESULT ReverbCalculateSinCos(EAS_I16 nPhase, EAS_I16 *pnSin, EAS_I16
 */
 static EAS_RESULT Reverb(S_REVERB_OBJECT* pReverbData, EAS_INT nNumSamplesToAdd, EAS_PCM *pOutputBuffer, EAS_PCM *pInputBuffer);
 
+/*----------------------------------------------------------------------------
+ * Reverb32
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * apply reverb to the given 32-bit signal
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_RESULT Reverb32(S_REVERB_OBJECT* pReverbData, EAS_INT nNumSamplesToAdd, EAS_I32 *pOutputBuffer, EAS_I32 *pInputBuffer);
+
 /*----------------------------------------------------------------------------
  * ReverbReadInPresets()
  *----------------------------------------------------------------------------
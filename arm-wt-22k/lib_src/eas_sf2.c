@@ -161,6 +161,8 @@ typedef struct S_SF2_PARSER
     EAS_FILE_HANDLE fileHandle;
     EAS_I32 fileOffset;
     EAS_U32 fileSize;
+    const EAS_U8* pFileData; // file contents when samples are used in place
+    EAS_U32 fileDataSize;
 
     S_DLS* pDLS;
 
@@ -331,6 +333,7 @@ static EAS_RESULT Parse_pdta(S_SF2_PARSER* pParser, EAS_I32 offset, EAS_U32 size
 static EAS_RESULT Parse_shdrs(S_SF2_PARSER* pParser, EAS_BOOL dryRun);
 
 static EAS_RESULT Parse_samples(S_SF2_PARSER* pParser, EAS_BOOL dryRun);
+static EAS_RESULT Map_samples(S_SF2_PARSER* pParser);
 
 // offset is file offset to the first bag record
 static EAS_RESULT Parse_ibags(S_SF2_PARSER* pParser, EAS_I32 offset, EAS_U32 bagCount);
@@ -375,7 +378,7 @@ static inline EAS_RESULT Check_gen(EAS_U16 genType, EAS_BOOL isInst)
     return EAS_SUCCESS;
 }
 
-EAS_RESULT SF2Parser (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fileHandle, EAS_I32 offset, S_DLS **ppDLS)
+EAS_RESULT SF2Parser (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fileHandle, EAS_I32 offset, const void *pFileData, EAS_I32 fileDataSize, S_DLS **ppDLS)
 {
     S_SF2_PARSER parser;
     EAS_RESULT result;
@@ -386,6 +389,8 @@ EAS_RESULT SF2Parser (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fileHandle,
     parser.hwInstData = hwInstData;
     parser.fileHandle = fileHandle;
     parser.fileOffset = offset;
+    parser.pFileData = pFileData;
+    parser.fileDataSize = (EAS_U32) fileDataSize;
 
     EAS_I32 nextChunkPos = offset;
     EAS_U32 temp;
@@ -579,17 +584,26 @@ EAS_RESULT SF2Parser (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fileHandle,
         return result;
     }
 
-    parser.pSampleDLS = EAS_HWMalloc(parser.hwInstData, parser.sampleDLSSize);
-    if (parser.pSampleDLS == NULL) {
-        EAS_Report(_EAS_SEVERITY_ERROR, "SF2Parser: Failed to allocate memory for sample data (%lu bytes)\n",
-                   (unsigned long)parser.sampleDLSSize);
-        return EAS_ERROR_MALLOC_FAILED;
-    }
+    if (parser.pFileData != NULL && (parser.smplOffset & 1) == 0) {
+        result = Map_samples(&parser);
+        if (result != EAS_SUCCESS) {
+            EAS_Report(_EAS_SEVERITY_ERROR, "SF2Parser: Failed to map samples: %ld\n", result);
+            return result;
+        }
+    } else {
+        parser.pFileData = NULL;
+        parser.pSampleDLS = EAS_HWMalloc(parser.hwInstData, parser.sampleDLSSize);
+        if (parser.pSampleDLS == NULL) {
+            EAS_Report(_EAS_SEVERITY_ERROR, "SF2Parser: Failed to allocate memory for sample data (%lu bytes)\n",
+                       (unsigned long)parser.sampleDLSSize);
+            return EAS_ERROR_MALLOC_FAILED;
+        }
 
-    result = Parse_samples(&parser, EAS_FALSE);
-    if (result != EAS_SUCCESS) {
-        EAS_Report(_EAS_SEVERITY_ERROR, "SF2Parser: Failed to parse samples: %ld\n", result);
-        return result;
+        result = Parse_samples(&parser, EAS_FALSE);
+        if (result != EAS_SUCCESS) {
+            EAS_Report(_EAS_SEVERITY_ERROR, "SF2Parser: Failed to parse samples: %ld\n", result);
+            return result;
+        }
     }
 
     // stage 6: copy everything to S_DLS
@@ -611,6 +625,7 @@ EAS_RESULT SF2Parser (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fileHandle,
     parser.pDLS->numDLSSamples = parser.sampleCount;
     parser.pDLS->refCount = 1;
     parser.pDLS->libType = DLSLIB_TYPE_SF2;
+    parser.pDLS->samplesMapped = (parser.pFileData != NULL);
 
     *ppDLS = parser.pDLS;
 
@@ -637,7 +652,9 @@ EAS_RESULT SF2Cleanup (EAS_HW_DATA_HANDLE hwInstData, S_DLS *pDLS)
     EAS_HWFree(hwInstData, pDLS->pDLSArticulations);
     EAS_HWFree(hwInstData, pDLS->pDLSSampleLen);
     EAS_HWFree(hwInstData, pDLS->pDLSSampleOffsets);
-    EAS_HWFree(hwInstData, pDLS->pDLSSamples);
+    if (!pDLS->samplesMapped) {
+        EAS_HWFree(hwInstData, pDLS->pDLSSamples);
+    }
     EAS_HWFree(hwInstData, pDLS);
     return EAS_SUCCESS;
 }
@@ -791,6 +808,30 @@ static EAS_RESULT Parse_samples(S_SF2_PARSER* pParser, EAS_BOOL dryRun)
     return EAS_SUCCESS;
 }
 
+// points the samples into the file data instead of copying them, the loop
+// start is not copied after the loop end since the interpolator does not read it
+static EAS_RESULT Map_samples(S_SF2_PARSER* pParser)
+{
+    if (pParser->smplOffset > pParser->fileDataSize || pParser->smplSize > pParser->fileDataSize - pParser->smplOffset) {
+        EAS_Report(_EAS_SEVERITY_ERROR, "SF2Parser: smpl chunk exceeds the file data\n");
+        return EAS_ERROR_FILE_FORMAT;
+    }
+
+    for (EAS_U32 i = 0; i < pParser->sampleCount; i++) {
+        struct S_SF2_SAMPLE* pShdr = &pParser->pShdrs[i];
+
+        if (pShdr->start > pShdr->end || pShdr->end > pParser->smplSize / 2) {
+            EAS_Report(_EAS_SEVERITY_ERROR, "SF2Parser: Sample %u [%u, %u) exceeds the smpl chunk\n", (unsigned)i, pShdr->start, pShdr->end);
+            return EAS_ERROR_FILE_FORMAT;
+        }
+        pParser->pSampleDLSOffsets[i] = pParser->smplOffset + pShdr->start * 2;
+        pParser->pSampleDLSLens[i] = (pShdr->end - pShdr->start) * 2;
+    }
+
+    pParser->pSampleDLS = (EAS_SAMPLE*)pParser->pFileData;
+    return EAS_SUCCESS;
+}
+
 static EAS_RESULT Parse_pdta(S_SF2_PARSER* pParser, EAS_I32 offset, EAS_U32 size)
 {
     EAS_RESULT result;
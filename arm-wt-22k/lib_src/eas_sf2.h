@@ -6,6 +6,7 @@
 
 #ifdef _SF2_SUPPORT
 // Usually it is not needed to directly call this function, DLSParser will invoke it
-EAS_RESULT SF2Parser (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fileHandle, EAS_I32 offset, S_DLS **pDLS);
+// pFileData is NULL, or the file contents of fileDataSize bytes to use the samples in place
+EAS_RESULT SF2Parser (EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE fileHandle, EAS_I32 offset, const void *pFileData, EAS_I32 fileDataSize, S_DLS **pDLS);
 EAS_RESULT SF2Cleanup (EAS_HW_DATA_HANDLE hwInstData, S_DLS *pDLS);
 #endif
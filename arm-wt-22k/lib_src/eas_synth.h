@@ -53,10 +53,23 @@
 #define NUM_OUTPUT_CHANNELS         2
 #endif
 
+/* default voice capacity of an instance, and the capacity in the static memory model */
 #ifndef MAX_SYNTH_VOICES
 #define MAX_SYNTH_VOICES            64
 #endif
 
+/* largest voice capacity EAS_InitEx accepts, voice numbers are 16 bits */
+#define MAX_SYNTH_VOICES_LIMIT      1024
+
+/* largest render time budget per block, in microseconds */
+#define MAX_RENDER_BUDGET           100000
+
+/* a releasing voice is culled once its gain is at or below this level, where
+ * FMUL_15x15 leaves at most the sign bit of a sample */
+#ifndef SYNTH_CULL_GAIN
+#define SYNTH_CULL_GAIN             1
+#endif
+
 #ifndef MAX_VIRTUAL_SYNTHESIZERS
 #define MAX_VIRTUAL_SYNTHESIZERS    4
 #endif
@@ -67,12 +80,90 @@
 
 /* use the following values to specify unassigned channels or voices */
 #define UNASSIGNED_SYNTH_CHANNEL    NUM_SYNTH_CHANNELS
-#define UNASSIGNED_SYNTH_VOICE      MAX_SYNTH_VOICES
+#define UNASSIGNED_SYNTH_VOICE      0xFFFF
+
+/* words in the free voice bit mask for n voices */
+#define NUM_VOICE_MASK_WORDS(n)     (((n) + 31) / 32)
+
+/* voice lists by channel and by note */
+#define NUM_VOICE_CHANNEL_LISTS     (MAX_VIRTUAL_SYNTHESIZERS * NUM_SYNTH_CHANNELS)
+#define NUM_VOICE_NOTE_LISTS        128
 
 
 // /* synth parameters are updated every SYNTH_UPDATE_PERIOD_IN_SAMPLES */
 // #define SYNTH_UPDATE_PERIOD_IN_SAMPLES  (EAS_I32)(0x1L << SYNTH_UPDATE_PERIOD_IN_BITS)
 
+/* render paths of the voice manager that can be turned off, so the output of the
+ * optimized paths can be compared with the generic code they replace. They are only
+ * built with _REFERENCE_RENDER_PATHS, which the tests build the library with */
+#if defined(_REFERENCE_RENDER_PATHS)
+#define VM_PATH_VOICE_BATCHES           0x01
+#define VM_PATH_FILTER_BATCH            0x02
+#define VM_PATH_FUSED_OUTPUT            0x08
+#define VM_PATH_VOICE_LIST              0x20
+#define VM_PATH_ALL                     0x2b
+#endif
+
+/* voices rendered together by VMAddSamples, so their filters run as one batch */
+#if defined(_WT_SYNTH) && defined(_FILTER_ENABLED) && defined(_FLOAT_DCF)
+#if defined(_VOICE_PARALLEL)
+/* enough voices to fill the lanes of both voice batches most of the time */
+#define SYNTH_VOICE_GROUP               (WT_FILTER_LANES * 4)
+#else
+#define SYNTH_VOICE_GROUP               WT_FILTER_LANES
+#endif
+#define SYNTH_FILTER_BUFFER_BYTES(n)    (WT_FILTER_LANES * (n) * (EAS_I32) sizeof(EAS_PCM))
+#define SYNTH_SPARE_MIX_BYTES(n)        (NUM_OUTPUT_CHANNELS * (n) * (EAS_I32) sizeof(EAS_I32))
+#else
+#define SYNTH_VOICE_GROUP               1
+#define SYNTH_FILTER_BUFFER_BYTES(n)    0
+#define SYNTH_SPARE_MIX_BYTES(n)        0
+#endif
+
+/* size in bytes of the block buffers owned by the voice manager */
+#if defined(_FM_SYNTH)
+#define SYNTH_FM_BUFFER_BYTES(n)        (2 * (n) * (EAS_I32) sizeof(EAS_I32))
+#else
+#define SYNTH_FM_BUFFER_BYTES(n)        0
+#endif
+#if defined(_CC_REVERB)
+#define SYNTH_REVERB_BUFFER_BYTES(n)    (NUM_OUTPUT_CHANNELS * (n) * (EAS_I32) sizeof(EAS_I32))
+#else
+#define SYNTH_REVERB_BUFFER_BYTES(n)    0
+#endif
+#if defined(_CC_CHORUS)
+#define SYNTH_CHORUS_BUFFER_BYTES(n)    (NUM_OUTPUT_CHANNELS * (n) * (EAS_I32) sizeof(EAS_I32))
+#else
+#define SYNTH_CHORUS_BUFFER_BYTES(n)    0
+#endif
+#define SYNTH_BUFFER_BYTES(n)           (SYNTH_VOICE_GROUP * NUM_OUTPUT_CHANNELS * (n) * (EAS_I32) sizeof(EAS_I32) + \
+                                         SYNTH_SPARE_MIX_BYTES(n) + \
+                                         SYNTH_FM_BUFFER_BYTES(n) + \
+                                         SYNTH_REVERB_BUFFER_BYTES(n) + \
+                                         SYNTH_CHORUS_BUFFER_BYTES(n) + \
+                                         (n) * (EAS_I32) sizeof(EAS_PCM) + \
+                                         SYNTH_FILTER_BUFFER_BYTES(n))
+
+/* size in bytes of the voice arrays for n voices, each array starts 8-byte aligned */
+#define SYNTH_VOICE_ALIGN(n)            (((n) + 7) & ~7)
+#if defined(_WT_SYNTH)
+#define SYNTH_WT_VOICE_BYTES(n)         SYNTH_VOICE_ALIGN(NUM_WT_VOICES(n) * (EAS_I32) sizeof(S_WT_VOICE))
+#else
+#define SYNTH_WT_VOICE_BYTES(n)         0
+#endif
+#if defined(_FM_SYNTH)
+#define SYNTH_FM_VOICE_BYTES(n)         SYNTH_VOICE_ALIGN(NUM_FM_VOICES(n) * (EAS_I32) sizeof(S_FM_VOICE))
+#else
+#define SYNTH_FM_VOICE_BYTES(n)         0
+#endif
+#define SYNTH_VOICE_BYTES(n)            (SYNTH_VOICE_ALIGN((n) * (EAS_I32) sizeof(S_SYNTH_VOICE)) + \
+                                         SYNTH_WT_VOICE_BYTES(n) + \
+                                         SYNTH_FM_VOICE_BYTES(n) + \
+                                         SYNTH_VOICE_ALIGN((n) * (EAS_I32) sizeof(EAS_I32)) + \
+                                         SYNTH_VOICE_ALIGN(NUM_VOICE_MASK_WORDS(n) * (EAS_I32) sizeof(EAS_U32)) + \
+                                         SYNTH_VOICE_ALIGN((n) * (EAS_I32) sizeof(S_VOICE_LINKS)) + \
+                                         SYNTH_VOICE_ALIGN(5 * (n) * (EAS_I32) sizeof(EAS_U16)))
+
 /* stealing weighting factors */
 #define NOTE_AGE_STEAL_WEIGHT           1
 #define NOTE_GAIN_STEAL_WEIGHT          4
@@ -250,6 +341,7 @@ typedef struct s_synth_voice_tag
     EAS_U8              nextChannel;        /* play stolen voice on this channel */
     EAS_U8              nextNote;           /* 12 <= key number <= 108 */
     EAS_U8              nextVelocity;       /* 0 <= velocity <= 127 */
+    EAS_I32             controlPhase;       /* time to the next native control period, see VMControlTicks */
 } S_SYNTH_VOICE;
 
 /*------------------------------------
@@ -297,8 +389,8 @@ typedef struct s_synth_tag
     EAS_U16                 numActiveVoices;
     EAS_U16                 masterVolume;
     EAS_U8                  channelsByPriority[NUM_SYNTH_CHANNELS];
-    EAS_U8                  poolCount[NUM_SYNTH_CHANNELS];
-    EAS_U8                  poolAlloc[NUM_SYNTH_CHANNELS];
+    EAS_U16                 poolCount[NUM_SYNTH_CHANNELS];
+    EAS_U16                 poolAlloc[NUM_SYNTH_CHANNELS];
     EAS_U8                  synthFlags;
     EAS_I8                  globalTranspose;
     EAS_U8                  vSynthNum;
@@ -313,6 +405,25 @@ typedef struct s_synth_tag
 #endif
 } S_SYNTH;
 
+/*------------------------------------
+ * S_VOICE_LINKS data structure
+ *
+ * Links an active voice into the list of voices
+ * on its channel and the list of voices playing
+ * its note. A stolen voice is listed under the
+ * channel and note it will play next.
+ *------------------------------------
+*/
+typedef struct s_voice_links_tag
+{
+    EAS_U16                 nextOnChannel;
+    EAS_U16                 prevOnChannel;
+    EAS_U16                 nextOnNote;
+    EAS_U16                 prevOnNote;
+    EAS_U8                  channel;
+    EAS_U8                  note;
+} S_VOICE_LINKS;
+
 /*------------------------------------
  * S_VOICE_MGR data structure
  *
@@ -322,28 +433,94 @@ typedef struct s_synth_tag
 typedef struct s_voice_mgr_tag
 {
     S_SYNTH                 *pSynth[MAX_VIRTUAL_SYNTHESIZERS];
-    EAS_PCM                 voiceBuffer[BUFFER_SIZE_IN_MONO_SAMPLES];
+
+    /* block buffers, sized for blockSize samples */
+    EAS_I32                 *synthBuffer;
+    EAS_PCM                 *voiceBuffer;
+    EAS_I32                 blockSize;
+
+    /* voices are updated and rendered once per control period */
+    EAS_I32                 controlPeriod;
+    EAS_I32                 controlPeriodBits;
+
+    /* control period and native control period in common time units */
+    EAS_I32                 controlUpdateLength;
+    EAS_I32                 controlTickLength;
+
+    /* output rate, pitches are corrected from _OUTPUT_SAMPLE_RATE by pitchOffset cents */
+    EAS_I32                 sampleRate;
+    EAS_I32                 pitchOffset;
+
+#ifdef _WT_SYNTH
+    /* interpolation kernel for this CPU */
+    WT_INTERPOLATE_KERNEL   pfInterpolate;
+#endif
+
+#if defined(_REFERENCE_RENDER_PATHS)
+    /* VM_PATH_ flags of the render paths in use */
+    EAS_U32                 renderPaths;
+#endif
+
+#if defined(_FILTER_ENABLED) && defined(_FLOAT_DCF)
+    /* filter coefficient table for _OUTPUT_SAMPLE_RATE */
+    S_FILTER_TABLE          filterTable;
+#endif
+
+#if defined(_WT_SYNTH) && defined(_FILTER_ENABLED) && defined(_FLOAT_DCF)
+    /* voices of the group being rendered that wait for their filter */
+    S_WT_FILTER_BATCH       filterBatch;
+#endif
+
+#if defined(_WT_SYNTH) && defined(_VOICE_PARALLEL)
+    /* voices of the group being rendered that wait for the others of their kernel */
+    S_WT_VOICE_BATCH        voiceBatches[WT_NUM_VOICE_BATCHES];
+#endif
 
 #ifdef _FM_SYNTH
-    EAS_I32                 operOutputBuffer[BUFFER_SIZE_IN_MONO_SAMPLES];
-    EAS_I32                 operMixBuffer[BUFFER_SIZE_IN_MONO_SAMPLES];
-    S_FM_VOICE              fmVoices[NUM_FM_VOICES];
+    EAS_I32                 *operOutputBuffer;
+    EAS_I32                 *operMixBuffer;
+    S_FM_VOICE              *fmVoices;
 #endif
 
 #ifdef _WT_SYNTH
-    S_WT_VOICE              wtVoices[NUM_WT_VOICES];
+    S_WT_VOICE              *wtVoices;
 #endif
 
 #ifdef _CC_REVERB
-    EAS_PCM                 reverbSendBuffer[NUM_OUTPUT_CHANNELS * BUFFER_SIZE_IN_MONO_SAMPLES];
+    EAS_I32                 *reverbSendBuffer;
     S_EFFECTS_MODULE        reverbModule;
 #endif
 
 #ifdef _CC_CHORUS
-    EAS_PCM                 chorusSendBuffer[NUM_OUTPUT_CHANNELS * BUFFER_SIZE_IN_MONO_SAMPLES];
+    EAS_I32                 *chorusSendBuffer;
     S_EFFECTS_MODULE        chorusModule;
 #endif
-    S_SYNTH_VOICE           voices[MAX_SYNTH_VOICES];
+
+    /* voice arrays, sized for numVoices voices, the first numPrimaryVoices play on the primary synth */
+    S_SYNTH_VOICE           *voices;
+    EAS_I32                 numVoices;
+    EAS_I32                 numPrimaryVoices;
+
+    /* voices that are not free, in no particular order, and the position of each in that list */
+    EAS_U16                 *activeVoiceList;
+    EAS_U16                 *activeVoicePos;
+    EAS_U16                 numActiveVoiceList;
+
+    /* free voices, one bit per voice */
+    EAS_U32                 *freeVoiceMask;
+
+    /* first active voice on each channel and playing each note */
+    EAS_U16                 channelVoices[NUM_VOICE_CHANNEL_LISTS];
+    EAS_U16                 noteVoices[NUM_VOICE_NOTE_LISTS];
+    S_VOICE_LINKS           *voiceLinks;
+
+    /* steal priority of each voice less the common age offset, and the tournament tree over them */
+    EAS_I32                 *stealKey;
+    EAS_U16                 *stealTree;
+    EAS_I32                 stealShift;
+
+    /* active list positions of the voices the render budget mutes, a heap of the loudest on top */
+    EAS_U16                 *muteHeap;
 
     EAS_SNDLIB_HANDLE       pGlobalEAS;
 
@@ -363,6 +540,20 @@ typedef struct s_voice_mgr_tag
     EAS_I32                 workload;
     EAS_I32                 maxWorkLoad;
 
+    /* render time budget per block in microseconds (0 when off), the polyphony it allows,
+     * and the blocks in a row that ran over it */
+    EAS_I32                 renderBudget;
+    EAS_U16                 budgetPolyphony;
+    EAS_U16                 budgetHoldoff;
+    EAS_U16                 budgetOverruns;
+
+    /* smoothed render time, its fixed part and its cost per voice, and the last block measured */
+    EAS_I32                 renderTime;
+    EAS_I32                 renderOverhead;
+    EAS_I32                 renderVoiceCost;
+    EAS_I32                 lastRenderTime;
+    EAS_I32                 lastVoicesRendered;
+
     EAS_U16                 activeVoices;
     EAS_U16                 maxPolyphony;
 
@@ -54,6 +54,17 @@ typedef struct
     void (* EAS_CONST pfUpdateChannel)(S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel);
 } S_SYNTH_INTERFACE;
 
+/*----------------------------------------------------------------------------
+ * VMControlTicks()
+ *----------------------------------------------------------------------------
+ * Returns the number of native control periods (BUFFER_SIZE_IN_MONO_SAMPLES
+ * at _OUTPUT_SAMPLE_RATE) the envelopes and LFOs of the voice must advance
+ * in this update. Updates shorter than the native period return 1 once per
+ * native period and 0 otherwise.
+ *----------------------------------------------------------------------------
+*/
+EAS_I32 VMControlTicks (S_VOICE_MGR *pVoiceMgr, S_SYNTH_VOICE *pVoice);
+
 #endif
 
 
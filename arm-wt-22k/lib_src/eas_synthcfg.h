@@ -77,25 +77,30 @@
 #error "Unrecognized architecture option"
 #endif
 
+/* split of an instance's n voices between the synthesizers */
 #if !defined(_HYBRID_SYNTH)
-#define NUM_PRIMARY_VOICES      MAX_SYNTH_VOICES
+#define SYNTH_PRIMARY_VOICES(n)     (n)
 #if defined(_WT_SYNTH)
-#define NUM_WT_VOICES           MAX_SYNTH_VOICES
+#define NUM_WT_VOICES(n)            (n)
 #endif
 #if defined(_FM_SYNTH)
-#define NUM_FM_VOICES           MAX_SYNTH_VOICES
+#define NUM_FM_VOICES(n)            (n)
 #endif
 #else // _HYBRID_SYNTH
-#if !defined(NUM_PRIMARY_VOICES)
-#define NUM_PRIMARY_VOICES      (MAX_SYNTH_VOICES / 2)
-#endif
-
-#if !defined(NUM_SECONDARY_VOICES)
-#define NUM_SECONDARY_VOICES    (MAX_SYNTH_VOICES - NUM_PRIMARY_VOICES)
+/* half the voices are primary, unless the build fixes NUM_PRIMARY_VOICES or
+ * NUM_SECONDARY_VOICES; an instance keeps at least one primary voice */
+#if defined(NUM_PRIMARY_VOICES)
+#define SYNTH_PRIMARY_SPLIT(n)      (NUM_PRIMARY_VOICES)
+#elif defined(NUM_SECONDARY_VOICES)
+#define SYNTH_PRIMARY_SPLIT(n)      ((n) - (NUM_SECONDARY_VOICES))
+#else
+#define SYNTH_PRIMARY_SPLIT(n)      ((n) / 2)
 #endif
-
-#define NUM_WT_VOICES           NUM_PRIMARY_VOICES
-#define NUM_FM_VOICES           NUM_SECONDARY_VOICES
+#define SYNTH_PRIMARY_VOICES(n)     ((SYNTH_PRIMARY_SPLIT(n) < 1) ? 1 : \
+                                     (SYNTH_PRIMARY_SPLIT(n) > (n)) ? (n) : SYNTH_PRIMARY_SPLIT(n))
+#define SYNTH_SECONDARY_VOICES(n)   ((n) - SYNTH_PRIMARY_VOICES(n))
+#define NUM_WT_VOICES(n)            SYNTH_PRIMARY_VOICES(n)
+#define NUM_FM_VOICES(n)            SYNTH_SECONDARY_VOICES(n)
 #endif
 
 #endif
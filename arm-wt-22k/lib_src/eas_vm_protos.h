@@ -260,6 +260,8 @@ void VMStopNote (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel, EAS_U8
  *----------------------------------------------------------------------------
  * Purpose:
  * Find an available voice and return the voice number if available.
+ * The lowest free voice in range is taken off the free voice mask and
+ * added to the active voice list, so the caller must start it.
  *
  * Inputs:
  * pnVoiceNumber - really an output, see below
@@ -680,7 +682,8 @@ void VMDeferredStopNote (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth);
  *----------------------------------------------------------------------------
  * Purpose:
  * Set the synth to a new polyphony value. Value must be >= 1 and
- * <= MAX_SYNTH_VOICES. This function will pin the polyphony at those limits
+ * <= the voice capacity of the instance. This function will pin the
+ * polyphony at those limits
  *
  * Inputs:
  * pVoiceMgr        pointer to synthesizer data
@@ -700,7 +703,8 @@ EAS_RESULT VMSetSynthPolyphony (S_VOICE_MGR *pVoiceMgr, EAS_I32 synth, EAS_I32 p
  *----------------------------------------------------------------------------
  * Purpose:
  * Set the synth to a new polyphony value. Value must be >= 1 and
- * <= MAX_SYNTH_VOICES. This function will pin the polyphony at those limits
+ * <= the voice capacity of the instance. This function will pin the
+ * polyphony at those limits
  *
  * Inputs:
  * pVoiceMgr        pointer to synthesizer data
@@ -976,6 +980,64 @@ void VMSetWorkload (S_VOICE_MGR *pVoiceMgr, EAS_I32 maxWorkLoad);
 */
 EAS_BOOL VMCheckWorkload (S_VOICE_MGR *pVoiceMgr);
 
+/*----------------------------------------------------------------------------
+ * VMSetRenderBudget()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Sets the time VMRender may take for a block, and restores the full
+ * polyphony.
+ *
+ * Inputs:
+ * pVoiceMgr            - pointer to instance data
+ * budget               - microseconds per block, 0 to turn the budget off
+ *
+ * Outputs:
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+void VMSetRenderBudget (S_VOICE_MGR *pVoiceMgr, EAS_I32 budget);
+
+/*----------------------------------------------------------------------------
+ * VMGetBudgetPolyphony()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the polyphony in effect, the lower of the polyphony setting and
+ * the polyphony the render time budget allows.
+ *
+ * Inputs:
+ * pVoiceMgr            - pointer to instance data
+ *
+ * Outputs:
+ * Returns the number of voices that may play
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_I32 VMGetBudgetPolyphony (S_VOICE_MGR *pVoiceMgr);
+
+/*----------------------------------------------------------------------------
+ * VMUpdateRenderBudget()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Adjusts the polyphony to the time VMRender took for the last block.
+ *
+ * Inputs:
+ * pVoiceMgr            - pointer to instance data
+ * renderTime           - microseconds VMRender took for the last block
+ * voicesRendered       - number of voices it rendered
+ *
+ * Outputs:
+ *
+ * Side Effects:
+ * mutes the quietest voices when the budget is exceeded
+ *
+ *----------------------------------------------------------------------------
+*/
+void VMUpdateRenderBudget (S_VOICE_MGR *pVoiceMgr, EAS_I32 renderTime, EAS_I32 voicesRendered);
+
 /*----------------------------------------------------------------------------
  * VMActiveVoices()
  *----------------------------------------------------------------------------
@@ -39,6 +39,7 @@
 #include "eas_synth_protos.h"
 #include "eas_vm_protos.h"
 #include "eas_math.h"
+#include "eas_mixer.h"
 
 #ifdef DLS_SYNTHESIZER
 #include "eas_mdls.h"
@@ -74,6 +75,17 @@
 #define WORKLOAD_AMOUNT_KEY_GROUP           10
 #define WORKLOAD_AMOUNT_POLY_LIMIT          10
 
+/* steal key of a free voice, and the age offset at which the steal keys are rebased */
+#define STEAL_KEY_NONE                      ((EAS_I32) 0x80000000)
+#define STEAL_SHIFT_LIMIT                   0x100000
+
+/* fraction bits and smoothing shift of the render times, the blocks skipped while muted voices fade out,
+ * and the consecutive blocks over the budget that lower the polyphony */
+#define RENDER_TIME_FRAC_BITS               4
+#define RENDER_TIME_SMOOTHING               3
+#define RENDER_BUDGET_HOLDOFF               2
+#define RENDER_BUDGET_OVERRUNS              4
+
 // The output gain logic of FM synth (FM_SynthMixVoice) is rewritten in #80
 // This factor is used to scale the FM ouput to match origial level
 // to balance FM and WT output for hybrid synth
@@ -170,10 +182,10 @@ EAS_INLINE const S_REGION* GetRegionPtr (S_SYNTH *pSynth, EAS_U16 regionIndex)
 }
 
 /*lint -esym(715, voiceNum) used in some implementation */
-EAS_INLINE const S_SYNTH_INTERFACE* GetSynthPtr (EAS_INT voiceNum)
+EAS_INLINE const S_SYNTH_INTERFACE* GetSynthPtr (const S_VOICE_MGR *pVoiceMgr, EAS_INT voiceNum)
 {
 #if defined(_HYBRID_SYNTH)
-    if (voiceNum < NUM_PRIMARY_VOICES)
+    if (voiceNum < pVoiceMgr->numPrimaryVoices)
         return pPrimarySynth;
     else
         return pSecondarySynth;
@@ -182,11 +194,11 @@ EAS_INLINE const S_SYNTH_INTERFACE* GetSynthPtr (EAS_INT voiceNum)
 #endif
 }
 
-EAS_INLINE EAS_INT GetAdjustedVoiceNum (EAS_INT voiceNum)
+EAS_INLINE EAS_INT GetAdjustedVoiceNum (const S_VOICE_MGR *pVoiceMgr, EAS_INT voiceNum)
 {
 #if defined(_HYBRID_SYNTH)
-    if (voiceNum >= NUM_PRIMARY_VOICES)
-        return voiceNum - NUM_PRIMARY_VOICES;
+    if (voiceNum >= pVoiceMgr->numPrimaryVoices)
+        return voiceNum - pVoiceMgr->numPrimaryVoices;
 #endif
     return voiceNum;
 }
@@ -213,6 +225,290 @@ void InitVoice (S_SYNTH_VOICE *pVoice)
     pVoice->age = DEFAULT_AGE;
     pVoice->voiceFlags = DEFAULT_VOICE_FLAGS;
     pVoice->voiceState = DEFAULT_VOICE_STATE;
+    pVoice->controlPhase = 0;
+}
+
+/*----------------------------------------------------------------------------
+ * VMStealByAge()
+ *----------------------------------------------------------------------------
+ * Returns true if the steal priority of a voice depends on its age and gain,
+ * false if it depends on the velocity of the note it is about to play
+ *----------------------------------------------------------------------------
+*/
+EAS_INLINE EAS_BOOL VMStealByAge (const S_SYNTH_VOICE *pVoice)
+{
+    return ((pVoice->voiceState != eVoiceStateStolen) && !(pVoice->voiceFlags & VOICE_FLAG_NO_SAMPLES_SYNTHESIZED_YET));
+}
+
+/*----------------------------------------------------------------------------
+ * VMStealPriority()
+ *----------------------------------------------------------------------------
+ * Steal priority of a voice without the SP-MIDI and note match terms,
+ * higher means better for stealing
+ *----------------------------------------------------------------------------
+*/
+static EAS_I32 VMStealPriority (const S_SYNTH_VOICE *pVoice)
+{
+    EAS_I32 priority;
+
+    /* if voice is stolen or just started, reduce the likelihood it will be stolen */
+    if (!VMStealByAge(pVoice))
+        return 128 - pVoice->nextVelocity;
+
+    /* use note age */
+    priority = (EAS_I32) pVoice->age << NOTE_AGE_STEAL_WEIGHT;
+
+    /* include note gain -higher gain is lower steal value */
+    /*lint -e{704} use shift for performance */
+    priority += ((32768 >> (12 - NOTE_GAIN_STEAL_WEIGHT)) + 256) -
+        ((EAS_I32) pVoice->gain >> (12 - NOTE_GAIN_STEAL_WEIGHT));
+    return priority;
+}
+
+/*----------------------------------------------------------------------------
+ * VMStealWinner()
+ *----------------------------------------------------------------------------
+ * Returns the voice with the higher steal key, or the higher voice number
+ * on a tie, as the linear search in VMStealVoice would pick it
+ *----------------------------------------------------------------------------
+*/
+static EAS_INT VMStealWinner (const S_VOICE_MGR *pVoiceMgr, EAS_INT voiceA, EAS_INT voiceB)
+{
+    if (voiceA == UNASSIGNED_SYNTH_VOICE)
+        return voiceB;
+    if (voiceB == UNASSIGNED_SYNTH_VOICE)
+        return voiceA;
+    if (pVoiceMgr->stealKey[voiceA] != pVoiceMgr->stealKey[voiceB])
+        return (pVoiceMgr->stealKey[voiceA] > pVoiceMgr->stealKey[voiceB]) ? voiceA : voiceB;
+    return (voiceA > voiceB) ? voiceA : voiceB;
+}
+
+/*----------------------------------------------------------------------------
+ * VMSetStealKey()
+ *----------------------------------------------------------------------------
+ * Sets the steal key of a voice and replays its path of the tournament tree
+ *----------------------------------------------------------------------------
+*/
+static void VMSetStealKey (S_VOICE_MGR *pVoiceMgr, EAS_INT voiceNum, EAS_I32 key)
+{
+    EAS_INT node;
+
+    if (pVoiceMgr->stealKey[voiceNum] == key)
+        return;
+
+    pVoiceMgr->stealKey[voiceNum] = key;
+    for (node = (pVoiceMgr->numVoices + voiceNum) >> 1; node > 0; node >>= 1)
+        pVoiceMgr->stealTree[node] = (EAS_U16) VMStealWinner(pVoiceMgr, pVoiceMgr->stealTree[2 * node], pVoiceMgr->stealTree[2 * node + 1]);
+}
+
+/*----------------------------------------------------------------------------
+ * VMUpdateStealKey()
+ *----------------------------------------------------------------------------
+ * Recomputes the steal key of an active voice after its state, flags, age
+ * or gain have changed. The keys are kept less a common age offset so that
+ * aging most of the voices at once only touches the others, see
+ * VMUpdateAllNotesAge.
+ *----------------------------------------------------------------------------
+*/
+static void VMUpdateStealKey (S_VOICE_MGR *pVoiceMgr, EAS_INT voiceNum)
+{
+    VMSetStealKey(pVoiceMgr, voiceNum, VMStealPriority(&pVoiceMgr->voices[voiceNum]) - (pVoiceMgr->stealShift << NOTE_AGE_STEAL_WEIGHT));
+}
+
+/*----------------------------------------------------------------------------
+ * VMFindStealCandidate()
+ *----------------------------------------------------------------------------
+ * Returns the voice in range with the highest steal key, or
+ * UNASSIGNED_SYNTH_VOICE if they are all free
+ *----------------------------------------------------------------------------
+*/
+static EAS_INT VMFindStealCandidate (const S_VOICE_MGR *pVoiceMgr, EAS_I32 lowVoice, EAS_I32 highVoice)
+{
+    EAS_INT best;
+    EAS_INT low;
+    EAS_INT high;
+
+    best = UNASSIGNED_SYNTH_VOICE;
+    for (low = pVoiceMgr->numVoices + lowVoice, high = pVoiceMgr->numVoices + highVoice + 1; low < high; low >>= 1, high >>= 1)
+    {
+        if (low & 1)
+            best = VMStealWinner(pVoiceMgr, best, pVoiceMgr->stealTree[low++]);
+        if (high & 1)
+            best = VMStealWinner(pVoiceMgr, best, pVoiceMgr->stealTree[--high]);
+    }
+
+    if ((best != UNASSIGNED_SYNTH_VOICE) && (pVoiceMgr->stealKey[best] == STEAL_KEY_NONE))
+        return UNASSIGNED_SYNTH_VOICE;
+    return best;
+}
+
+/*----------------------------------------------------------------------------
+ * VMInitVoiceLists()
+ *----------------------------------------------------------------------------
+ * Empties the active voice lists and marks every voice free
+ *----------------------------------------------------------------------------
+*/
+static void VMInitVoiceLists (S_VOICE_MGR *pVoiceMgr)
+{
+    EAS_INT i;
+
+    pVoiceMgr->numActiveVoiceList = 0;
+    for (i = 0; i < NUM_VOICE_MASK_WORDS(pVoiceMgr->numVoices); i++)
+        pVoiceMgr->freeVoiceMask[i] = 0;
+    for (i = 0; i < pVoiceMgr->numVoices; i++)
+        pVoiceMgr->freeVoiceMask[i >> 5] |= 1u << (i & 31);
+
+    for (i = 0; i < NUM_VOICE_CHANNEL_LISTS; i++)
+        pVoiceMgr->channelVoices[i] = UNASSIGNED_SYNTH_VOICE;
+    for (i = 0; i < NUM_VOICE_NOTE_LISTS; i++)
+        pVoiceMgr->noteVoices[i] = UNASSIGNED_SYNTH_VOICE;
+
+    /* no voice can be stolen, ties go to the higher voice number */
+    pVoiceMgr->stealShift = 0;
+    for (i = 0; i < pVoiceMgr->numVoices; i++)
+    {
+        pVoiceMgr->stealKey[i] = STEAL_KEY_NONE;
+        pVoiceMgr->stealTree[pVoiceMgr->numVoices + i] = (EAS_U16) i;
+    }
+    for (i = pVoiceMgr->numVoices - 1; i > 0; i--)
+        pVoiceMgr->stealTree[i] = (EAS_U16) VMStealWinner(pVoiceMgr, pVoiceMgr->stealTree[2 * i], pVoiceMgr->stealTree[2 * i + 1]);
+}
+
+/*----------------------------------------------------------------------------
+ * VMLinkVoice()
+ *----------------------------------------------------------------------------
+ * Adds a voice to the lists for its channel and note
+ *----------------------------------------------------------------------------
+*/
+static void VMLinkVoice (S_VOICE_MGR *pVoiceMgr, EAS_INT voiceNum, EAS_U8 channel, EAS_U8 note)
+{
+    S_VOICE_LINKS *pLinks = &pVoiceMgr->voiceLinks[voiceNum];
+    EAS_U16 *pHead;
+
+    pLinks->channel = channel;
+    pLinks->note = note & (NUM_VOICE_NOTE_LISTS - 1);
+
+    pHead = &pVoiceMgr->channelVoices[pLinks->channel];
+    pLinks->prevOnChannel = UNASSIGNED_SYNTH_VOICE;
+    pLinks->nextOnChannel = *pHead;
+    if (*pHead != UNASSIGNED_SYNTH_VOICE)
+        pVoiceMgr->voiceLinks[*pHead].prevOnChannel = (EAS_U16) voiceNum;
+    *pHead = (EAS_U16) voiceNum;
+
+    pHead = &pVoiceMgr->noteVoices[pLinks->note];
+    pLinks->prevOnNote = UNASSIGNED_SYNTH_VOICE;
+    pLinks->nextOnNote = *pHead;
+    if (*pHead != UNASSIGNED_SYNTH_VOICE)
+        pVoiceMgr->voiceLinks[*pHead].prevOnNote = (EAS_U16) voiceNum;
+    *pHead = (EAS_U16) voiceNum;
+}
+
+/*----------------------------------------------------------------------------
+ * VMUnlinkVoice()
+ *----------------------------------------------------------------------------
+ * Removes a voice from the lists for its channel and note
+ *----------------------------------------------------------------------------
+*/
+static void VMUnlinkVoice (S_VOICE_MGR *pVoiceMgr, EAS_INT voiceNum)
+{
+    S_VOICE_LINKS *pLinks = &pVoiceMgr->voiceLinks[voiceNum];
+
+    if (pLinks->prevOnChannel != UNASSIGNED_SYNTH_VOICE)
+        pVoiceMgr->voiceLinks[pLinks->prevOnChannel].nextOnChannel = pLinks->nextOnChannel;
+    else
+        pVoiceMgr->channelVoices[pLinks->channel] = pLinks->nextOnChannel;
+    if (pLinks->nextOnChannel != UNASSIGNED_SYNTH_VOICE)
+        pVoiceMgr->voiceLinks[pLinks->nextOnChannel].prevOnChannel = pLinks->prevOnChannel;
+
+    if (pLinks->prevOnNote != UNASSIGNED_SYNTH_VOICE)
+        pVoiceMgr->voiceLinks[pLinks->prevOnNote].nextOnNote = pLinks->nextOnNote;
+    else
+        pVoiceMgr->noteVoices[pLinks->note] = pLinks->nextOnNote;
+    if (pLinks->nextOnNote != UNASSIGNED_SYNTH_VOICE)
+        pVoiceMgr->voiceLinks[pLinks->nextOnNote].prevOnNote = pLinks->prevOnNote;
+}
+
+/*----------------------------------------------------------------------------
+ * VMRelinkVoice()
+ *----------------------------------------------------------------------------
+ * Moves a voice whose state has changed to the lists for the channel and
+ * note it plays. A stolen voice stays under the channel and note it will
+ * play next, one that is muted instead goes back under the channel and
+ * note it is still playing.
+ *----------------------------------------------------------------------------
+*/
+static void VMRelinkVoice (S_VOICE_MGR *pVoiceMgr, EAS_INT voiceNum)
+{
+    S_SYNTH_VOICE *pVoice = &pVoiceMgr->voices[voiceNum];
+    S_VOICE_LINKS *pLinks = &pVoiceMgr->voiceLinks[voiceNum];
+
+    if (pVoice->voiceState == eVoiceStateStolen)
+        return;
+    if ((pLinks->channel != pVoice->channel) || (pLinks->note != (pVoice->note & (NUM_VOICE_NOTE_LISTS - 1))))
+    {
+        VMUnlinkVoice(pVoiceMgr, voiceNum);
+        VMLinkVoice(pVoiceMgr, voiceNum, pVoice->channel, pVoice->note);
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * VMRemoveActiveVoice()
+ *----------------------------------------------------------------------------
+ * Moves a voice that is becoming free from the active voice lists to the
+ * free voice mask. The last voice in the active list takes its place.
+ *----------------------------------------------------------------------------
+*/
+static void VMRemoveActiveVoice (S_VOICE_MGR *pVoiceMgr, EAS_INT voiceNum)
+{
+    EAS_U16 pos;
+    EAS_U16 last;
+
+    pos = pVoiceMgr->activeVoicePos[voiceNum];
+    last = pVoiceMgr->activeVoiceList[--pVoiceMgr->numActiveVoiceList];
+    pVoiceMgr->activeVoiceList[pos] = last;
+    pVoiceMgr->activeVoicePos[last] = pos;
+    pVoiceMgr->freeVoiceMask[voiceNum >> 5] |= 1u << (voiceNum & 31);
+    VMUnlinkVoice(pVoiceMgr, voiceNum);
+    VMSetStealKey(pVoiceMgr, voiceNum, STEAL_KEY_NONE);
+}
+
+#if defined(_REFERENCE_RENDER_PATHS)
+/*----------------------------------------------------------------------------
+ * VMSortActiveVoices()
+ *----------------------------------------------------------------------------
+ * Sorts the active voice list by descending voice number, so VMAddSamples
+ * renders the voices in voice number order like the scan the list replaced.
+ * Used only with VM_PATH_VOICE_LIST off.
+ *----------------------------------------------------------------------------
+*/
+static void VMSortActiveVoices (S_VOICE_MGR *pVoiceMgr)
+{
+    EAS_INT voiceNum;
+    EAS_U16 pos;
+
+    pos = 0;
+    for (voiceNum = pVoiceMgr->numVoices - 1; voiceNum >= 0; voiceNum--)
+    {
+        if ((pVoiceMgr->freeVoiceMask[voiceNum >> 5] & (1u << (voiceNum & 31))) == 0)
+        {
+            pVoiceMgr->activeVoiceList[pos] = (EAS_U16) voiceNum;
+            pVoiceMgr->activeVoicePos[voiceNum] = pos++;
+        }
+    }
+}
+#endif
+
+/*----------------------------------------------------------------------------
+ * VMVoiceStateChanged()
+ *----------------------------------------------------------------------------
+ * Updates the lists and the steal key of an active voice after its state
+ * is changed outside of the render loop
+ *----------------------------------------------------------------------------
+*/
+static void VMVoiceStateChanged (S_VOICE_MGR *pVoiceMgr, EAS_INT voiceNum)
+{
+    VMRelinkVoice(pVoiceMgr, voiceNum);
+    VMUpdateStealKey(pVoiceMgr, voiceNum);
 }
 
 /*----------------------------------------------------------------------------
@@ -281,6 +577,128 @@ static void DecVoicePoolCount (S_VOICE_MGR *pVoiceMgr, S_SYNTH_VOICE *pVoice)
 #endif
 }
 
+/*----------------------------------------------------------------------------
+ * VMAssignBuffers()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Carves the block buffers out of a single allocation of
+ * SYNTH_BUFFER_BYTES(blockSize) bytes. The 32-bit buffers come first
+ * so that every buffer stays aligned. The synth buffer holds one block
+ * for each voice of a group, and the filter batch has a voice buffer for
+ * each of its lanes and a mix buffer for the lanes it does not use, which
+ * the voice batches share.
+ *
+ * Inputs:
+ * pVoiceMgr - pointer to voice manager, blockSize must be set
+ * pBuffers - start of the allocation
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void VMAssignBuffers (S_VOICE_MGR *pVoiceMgr, EAS_U8 *pBuffers)
+{
+    EAS_I32 blockSize = pVoiceMgr->blockSize;
+#if defined(_WT_SYNTH) && defined(_VOICE_PARALLEL)
+    EAS_INT batch;
+#endif
+
+    pVoiceMgr->synthBuffer = (EAS_I32*) pBuffers;
+    pBuffers += SYNTH_VOICE_GROUP * NUM_OUTPUT_CHANNELS * blockSize * (EAS_I32) sizeof(EAS_I32);
+
+#if defined(_WT_SYNTH) && defined(_FILTER_ENABLED) && defined(_FLOAT_DCF)
+    pVoiceMgr->filterBatch.pSpareMix = (EAS_I32*) pBuffers;
+    pBuffers += SYNTH_SPARE_MIX_BYTES(blockSize);
+#endif
+
+#ifdef _FM_SYNTH
+    pVoiceMgr->operOutputBuffer = (EAS_I32*) pBuffers;
+    pBuffers += blockSize * (EAS_I32) sizeof(EAS_I32);
+    pVoiceMgr->operMixBuffer = (EAS_I32*) pBuffers;
+    pBuffers += blockSize * (EAS_I32) sizeof(EAS_I32);
+#endif
+
+#ifdef _CC_REVERB
+    pVoiceMgr->reverbSendBuffer = (EAS_I32*) pBuffers;
+    pBuffers += NUM_OUTPUT_CHANNELS * blockSize * (EAS_I32) sizeof(EAS_I32);
+#endif
+
+#ifdef _CC_CHORUS
+    pVoiceMgr->chorusSendBuffer = (EAS_I32*) pBuffers;
+    pBuffers += NUM_OUTPUT_CHANNELS * blockSize * (EAS_I32) sizeof(EAS_I32);
+#endif
+
+    pVoiceMgr->voiceBuffer = (EAS_PCM*) pBuffers;
+    pBuffers += blockSize * (EAS_I32) sizeof(EAS_PCM);
+
+#if defined(_WT_SYNTH) && defined(_FILTER_ENABLED) && defined(_FLOAT_DCF)
+    pVoiceMgr->filterBatch.pBuffers = (EAS_PCM*) pBuffers;
+    pVoiceMgr->filterBatch.numLanes = 0;
+#if defined(_REFERENCE_RENDER_PATHS)
+    pVoiceMgr->filterBatch.fuseOutput = EAS_TRUE;
+#endif
+#endif
+
+#if defined(_WT_SYNTH) && defined(_VOICE_PARALLEL)
+    for (batch = 0; batch < WT_NUM_VOICE_BATCHES; batch++)
+    {
+        S_WT_VOICE_BATCH *pBatch = &pVoiceMgr->voiceBatches[batch];
+
+        pBatch->pSpareMix = pVoiceMgr->filterBatch.pSpareMix;
+        pBatch->lanes.looped = (batch == WT_VOICE_BATCH_LOOP) ? EAS_TRUE : EAS_FALSE;
+        pBatch->numLanes = 0;
+    }
+#endif
+}
+
+/*----------------------------------------------------------------------------
+ * VMAssignVoices()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Carves the voice arrays out of a single allocation of
+ * SYNTH_VOICE_BYTES(numVoices) bytes, starting with the voices. Every
+ * array starts 8-byte aligned.
+ *
+ * Inputs:
+ * pVoiceMgr - pointer to voice manager, numVoices must be set
+ * pVoices - start of the allocation
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void VMAssignVoices (S_VOICE_MGR *pVoiceMgr, EAS_U8 *pVoices)
+{
+    EAS_I32 numVoices = pVoiceMgr->numVoices;
+
+    pVoiceMgr->voices = (S_SYNTH_VOICE*) pVoices;
+    pVoices += SYNTH_VOICE_ALIGN(numVoices * (EAS_I32) sizeof(S_SYNTH_VOICE));
+
+#ifdef _WT_SYNTH
+    pVoiceMgr->wtVoices = (S_WT_VOICE*) pVoices;
+    pVoices += SYNTH_WT_VOICE_BYTES(numVoices);
+#endif
+
+#ifdef _FM_SYNTH
+    pVoiceMgr->fmVoices = (S_FM_VOICE*) pVoices;
+    pVoices += SYNTH_FM_VOICE_BYTES(numVoices);
+#endif
+
+    pVoiceMgr->stealKey = (EAS_I32*) pVoices;
+    pVoices += SYNTH_VOICE_ALIGN(numVoices * (EAS_I32) sizeof(EAS_I32));
+
+    pVoiceMgr->freeVoiceMask = (EAS_U32*) pVoices;
+    pVoices += SYNTH_VOICE_ALIGN(NUM_VOICE_MASK_WORDS(numVoices) * (EAS_I32) sizeof(EAS_U32));
+
+    pVoiceMgr->voiceLinks = (S_VOICE_LINKS*) pVoices;
+    pVoices += SYNTH_VOICE_ALIGN(numVoices * (EAS_I32) sizeof(S_VOICE_LINKS));
+
+    pVoiceMgr->activeVoiceList = (EAS_U16*) pVoices;
+    pVoiceMgr->activeVoicePos = pVoiceMgr->activeVoiceList + numVoices;
+    pVoiceMgr->stealTree = pVoiceMgr->activeVoicePos + numVoices;
+    pVoiceMgr->muteHeap = pVoiceMgr->stealTree + 2 * numVoices;
+}
+
 /*----------------------------------------------------------------------------
  * VMInitialize()
  *----------------------------------------------------------------------------
@@ -296,6 +714,8 @@ static void DecVoicePoolCount (S_VOICE_MGR *pVoiceMgr, S_SYNTH_VOICE *pVoice)
 EAS_RESULT VMInitialize (S_EAS_DATA *pEASData)
 {
     S_VOICE_MGR *pVoiceMgr;
+    EAS_U8 *pBuffers;
+    EAS_U8 *pVoices;
     EAS_INT i;
     EAS_RESULT result;
 
@@ -311,21 +731,71 @@ EAS_RESULT VMInitialize (S_EAS_DATA *pEASData)
     }
     EAS_HWMemSet(pVoiceMgr, 0, sizeof(S_VOICE_MGR));
 
+    /* allocate the block buffers for the instance block size */
+    pVoiceMgr->blockSize = pEASData->blockSize;
+    pVoiceMgr->controlPeriod = pEASData->controlPeriod;
+    pVoiceMgr->controlPeriodBits = pEASData->controlPeriodBits;
+    pVoiceMgr->sampleRate = pEASData->sampleRate;
+    pVoiceMgr->pitchOffset = pEASData->pitchOffset;
+    pVoiceMgr->controlUpdateLength = pVoiceMgr->controlPeriod * _OUTPUT_SAMPLE_RATE;
+    pVoiceMgr->controlTickLength = BUFFER_SIZE_IN_MONO_SAMPLES * pVoiceMgr->sampleRate;
+#ifdef _WT_SYNTH
+    pVoiceMgr->pfInterpolate = WT_SelectInterpolateKernel();
+#endif
+#if defined(_REFERENCE_RENDER_PATHS)
+    pVoiceMgr->renderPaths = VM_PATH_ALL;
+#endif
+#if defined(_FILTER_ENABLED) && defined(_FLOAT_DCF)
+    WT_InitFilterTable(&pVoiceMgr->filterTable);
+#endif
+    if (pEASData->staticMemoryModel)
+        pBuffers = EAS_CMEnumData(EAS_CM_SYNTH_BUFFERS);
+    else
+        pBuffers = EAS_HWMalloc(pEASData->hwInstData, SYNTH_BUFFER_BYTES(pVoiceMgr->blockSize));
+    if (!pBuffers)
+    {
+        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "VMInitialize: Failed to allocate synthesizer buffers\n"); */ }
+        result = EAS_ERROR_MALLOC_FAILED;
+        goto error_cleanup;
+    }
+    EAS_HWMemSet(pBuffers, 0, SYNTH_BUFFER_BYTES(pVoiceMgr->blockSize));
+    VMAssignBuffers(pVoiceMgr, pBuffers);
+
+    /* allocate the voices for the instance voice capacity */
+    pVoiceMgr->numVoices = pEASData->maxVoices;
+    pVoiceMgr->numPrimaryVoices = SYNTH_PRIMARY_VOICES(pVoiceMgr->numVoices);
+    if (pEASData->staticMemoryModel)
+        pVoices = EAS_CMEnumData(EAS_CM_SYNTH_VOICES);
+    else
+        pVoices = EAS_HWMalloc(pEASData->hwInstData, SYNTH_VOICE_BYTES(pVoiceMgr->numVoices));
+    if (!pVoices)
+    {
+        { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "VMInitialize: Failed to allocate synthesizer voices\n"); */ }
+        result = EAS_ERROR_MALLOC_FAILED;
+        goto error_cleanup;
+    }
+    EAS_HWMemSet(pVoices, 0, SYNTH_VOICE_BYTES(pVoiceMgr->numVoices));
+    VMAssignVoices(pVoiceMgr, pVoices);
+
     /* initialize non-zero variables */
     pVoiceMgr->pGlobalEAS = EAS_GetSoundLibrary(pEASData, EAS_GetDefaultSoundLibrary(EAS_SNDLIB_DEFAULT));
-    pVoiceMgr->maxPolyphony = MAX_SYNTH_VOICES;
+    pVoiceMgr->maxPolyphony = (EAS_U16) pVoiceMgr->numVoices;
 
 #if defined(_HYBRID_SYNTH) || defined(EAS_SPLIT_WT_SYNTH)
-    pVoiceMgr->maxPolyphonyPrimary = NUM_PRIMARY_VOICES;
-    pVoiceMgr->maxPolyphonySecondary = NUM_SECONDARY_VOICES;
+    pVoiceMgr->maxPolyphonyPrimary = (EAS_U16) pVoiceMgr->numPrimaryVoices;
+    pVoiceMgr->maxPolyphonySecondary = (EAS_U16) (pVoiceMgr->numVoices - pVoiceMgr->numPrimaryVoices);
 #endif
 
     /* set max workload to zero */
     pVoiceMgr->maxWorkLoad = 0;
 
+    /* no render time budget */
+    pVoiceMgr->budgetPolyphony = (EAS_U16) pVoiceMgr->numVoices;
+
     /* initialize the voice manager parameters */
-    for (i = 0; i < MAX_SYNTH_VOICES; i++)
+    for (i = 0; i < pVoiceMgr->numVoices; i++)
         InitVoice(&pVoiceMgr->voices[i]);
+    VMInitVoiceLists(pVoiceMgr);
 
     /* initialize the synth */
     /*lint -e{522} return unused at this time */
@@ -350,6 +820,8 @@ EAS_RESULT VMInitialize (S_EAS_DATA *pEASData)
 
 error_cleanup:
     if (!pEASData->staticMemoryModel) {
+        if (pVoiceMgr->synthBuffer)
+            EAS_HWFree(pEASData->hwInstData, pVoiceMgr->synthBuffer);
         EAS_HWFree(pEASData->hwInstData, pVoiceMgr);
     }
     return result;
@@ -375,6 +847,12 @@ EAS_RESULT VMInitReverb(S_EAS_DATA *pEASData, S_VOICE_MGR *pVoiceMgr)
         pVoiceMgr->reverbModule.effect = NULL;
         return EAS_ERROR_INVALID_HANDLE;
     }
+    if (pVoiceMgr->reverbModule.effect->pfProcess32 == NULL)
+    {
+        EAS_Report(_EAS_SEVERITY_ERROR, "VMInitReverb: Reverb module has no 32-bit processing for the send buffer\n");
+        pVoiceMgr->reverbModule.effect = NULL;
+        return EAS_ERROR_INVALID_MODULE;
+    }
 
     // TODO: a reset function may be needed to reinitialize the effect
 
@@ -416,6 +894,12 @@ EAS_RESULT VMInitChorus(S_EAS_DATA *pEASData, S_VOICE_MGR *pVoiceMgr)
         pVoiceMgr->chorusModule.effect = NULL;
         return EAS_ERROR_INVALID_HANDLE;
     }
+    if (pVoiceMgr->chorusModule.effect->pfProcess32 == NULL)
+    {
+        EAS_Report(_EAS_SEVERITY_ERROR, "VMInitChorus: Chorus module has no 32-bit processing for the send buffer\n");
+        pVoiceMgr->chorusModule.effect = NULL;
+        return EAS_ERROR_INVALID_MODULE;
+    }
 
     // TODO: a reset function may be needed to reinitialize the effect
 
@@ -515,7 +999,7 @@ EAS_RESULT VMInitMIDI (S_EAS_DATA *pEASData, S_SYNTH **ppSynth)
     pSynth->masterVolume = DEFAULT_SYNTH_MASTER_VOLUME;
     pSynth->refCount = 1;
     pSynth->priority = DEFAULT_SYNTH_PRIORITY;
-    pSynth->poolAlloc[0] = (EAS_U8) pEASData->pVoiceMgr->maxPolyphony;
+    pSynth->poolAlloc[0] = (EAS_U16) pEASData->pVoiceMgr->maxPolyphony;
 
 #ifdef _CC_REVERB
     pSynth->reverbEnabled = EAS_TRUE;
@@ -603,9 +1087,9 @@ void VMReset (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_BOOL force)
 
         /* set polyphony */
         if (pSynth->maxPolyphony < pVoiceMgr->maxPolyphony)
-            pSynth->poolAlloc[0] = (EAS_U8) pVoiceMgr->maxPolyphony;
+            pSynth->poolAlloc[0] = (EAS_U16) pVoiceMgr->maxPolyphony;
         else
-            pSynth->poolAlloc[0] = (EAS_U8) pSynth->maxPolyphony;
+            pSynth->poolAlloc[0] = (EAS_U16) pSynth->maxPolyphony;
 
         /* clear reset flag */
         pSynth->synthFlags &= ~SYNTH_FLAG_RESET_IS_REQUESTED;
@@ -722,18 +1206,24 @@ void VMInitializeAllVoices (S_VOICE_MGR *pVoiceMgr, EAS_INT vSynthNum)
     EAS_INT i;
 
     /* initialize the voice manager parameters */
-    for (i = 0; i < MAX_SYNTH_VOICES; i++)
+    for (i = 0; i < pVoiceMgr->numVoices; i++)
     {
+        if (pVoiceMgr->voices[i].voiceState == eVoiceStateFree)
+            continue;
+
         if (pVoiceMgr->voices[i].voiceState != eVoiceStateStolen)
         {
-            if (GET_VSYNTH(pVoiceMgr->voices[i].channel) == vSynthNum)
-                InitVoice(&pVoiceMgr->voices[i]);
+            if (GET_VSYNTH(pVoiceMgr->voices[i].channel) != vSynthNum)
+                continue;
         }
         else
         {
-            if (GET_VSYNTH(pVoiceMgr->voices[i].nextChannel) == vSynthNum)
-                InitVoice(&pVoiceMgr->voices[i]);
+            if (GET_VSYNTH(pVoiceMgr->voices[i].nextChannel) != vSynthNum)
+                continue;
         }
+
+        VMRemoveActiveVoice(pVoiceMgr, i);
+        InitVoice(&pVoiceMgr->voices[i]);
     }
 }
 
@@ -757,9 +1247,9 @@ void VMMuteVoice (S_VOICE_MGR *pVoiceMgr, EAS_I32 voiceNum)
     DecVoicePoolCount(pVoiceMgr, pVoice);
 
     pSynth = pVoiceMgr->pSynth[GET_VSYNTH(pVoice->channel)];
-    GetSynthPtr(voiceNum)->pfMuteVoice(pVoiceMgr, pSynth, pVoice, GetAdjustedVoiceNum(voiceNum));
+    GetSynthPtr(pVoiceMgr, voiceNum)->pfMuteVoice(pVoiceMgr, pSynth, pVoice, GetAdjustedVoiceNum(pVoiceMgr, voiceNum));
     pVoice->voiceState = eVoiceStateMuting;
-
+    VMVoiceStateChanged(pVoiceMgr, voiceNum);
 }
 
 /*----------------------------------------------------------------------------
@@ -783,7 +1273,7 @@ void VMReleaseVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_I32 voiceNum)
         VMMuteVoice(pVoiceMgr, voiceNum);
 
     /* release this voice */
-    GetSynthPtr(voiceNum)->pfReleaseVoice(pVoiceMgr, pSynth, &pVoiceMgr->voices[voiceNum], GetAdjustedVoiceNum(voiceNum));
+    GetSynthPtr(pVoiceMgr, voiceNum)->pfReleaseVoice(pVoiceMgr, pSynth, &pVoiceMgr->voices[voiceNum], GetAdjustedVoiceNum(pVoiceMgr, voiceNum));
     pVoice->voiceState = eVoiceStateRelease;
 }
 
@@ -873,7 +1363,7 @@ void VMMIPUpdateChannelMuting (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth)
     }
 
     /* mute any voices on muted channels, and count unmuted voices */
-    for (i = 0; i < MAX_SYNTH_VOICES; i++)
+    for (i = 0; i < pVoiceMgr->numVoices; i++)
     {
 
         /* ignore free voices */
@@ -904,7 +1394,10 @@ void VMMIPUpdateChannelMuting (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth)
         {
             /* mute stolen voices scheduled to play on this channel */
             if (pVoiceMgr->voices[i].voiceState == eVoiceStateStolen)
+            {
                 pVoiceMgr->voices[i].voiceState = eVoiceStateMuting;
+                VMVoiceStateChanged(pVoiceMgr, i);
+            }
 
             /* release voices that aren't already muting */
             else if (pVoiceMgr->voices[i].voiceState != eVoiceStateMuting)
@@ -976,7 +1469,7 @@ void VMUpdateMIPTable (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth)
         else
         {
             currentPool++;
-            pSynth->poolAlloc[currentPool] = (EAS_U8) (pChannel->mip - currentMIP);
+            pSynth->poolAlloc[currentPool] = (EAS_U16) (pChannel->mip - currentMIP);
             currentMIP = pChannel->mip;
         }
     }
@@ -1013,7 +1506,7 @@ void VMMuteAllVoices (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth)
     { /* dpp: EAS_ReportEx(_EAS_SEVERITY_INFO, "VMMuteAllVoices: about to mute all voices!!\n"); */ }
 #endif
 
-    for (i = 0; i < MAX_SYNTH_VOICES; i++)
+    for (i = 0; i < pVoiceMgr->numVoices; i++)
     {
         /* for stolen voices, check new channel */
         if (pVoiceMgr->voices[i].voiceState == eVoiceStateStolen)
@@ -1061,7 +1554,7 @@ void VMReleaseAllVoices (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth)
     }
 
     /* release all voices */
-    for (i = 0; i < MAX_SYNTH_VOICES; i++)
+    for (i = 0; i < pVoiceMgr->numVoices; i++)
     {
 
         switch (pVoiceMgr->voices[i].voiceState)
@@ -1114,6 +1607,7 @@ void VMReleaseAllVoices (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth)
 void VMAllNotesOff (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel)
 {
     EAS_INT voiceNum;
+    EAS_INT nextVoice;
     S_SYNTH_VOICE *pVoice;
 
 #ifdef _DEBUG_VM
@@ -1128,21 +1622,16 @@ void VMAllNotesOff (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel)
     /* increment workload */
     pVoiceMgr->workload += WORKLOAD_AMOUNT_SMALL_INCREMENT;
 
-    /* check each voice */
+    /* check each voice assigned to the requested channel */
     channel = VSynthToChannel(pSynth, channel);
-    for (voiceNum = 0; voiceNum < MAX_SYNTH_VOICES; voiceNum++)
+    for (voiceNum = pVoiceMgr->channelVoices[channel]; voiceNum != UNASSIGNED_SYNTH_VOICE; voiceNum = nextVoice)
     {
+        /* a stolen voice moves to the list of the channel it is still playing on */
+        nextVoice = pVoiceMgr->voiceLinks[voiceNum].nextOnChannel;
         pVoice = &pVoiceMgr->voices[voiceNum];
-        if (pVoice->voiceState != eVoiceStateFree)
-        {
-            if (((pVoice->voiceState != eVoiceStateStolen) && (channel == pVoice->channel)) ||
-                ((pVoice->voiceState == eVoiceStateStolen) && (channel == pVoice->nextChannel)))
-            {
-                /* this voice is assigned to the requested channel */
-                GetSynthPtr(voiceNum)->pfMuteVoice(pVoiceMgr, pSynth, pVoice, GetAdjustedVoiceNum(voiceNum));
-                pVoice->voiceState = eVoiceStateMuting;
-            }
-        }
+        GetSynthPtr(pVoiceMgr, voiceNum)->pfMuteVoice(pVoiceMgr, pSynth, pVoice, GetAdjustedVoiceNum(pVoiceMgr, voiceNum));
+        pVoice->voiceState = eVoiceStateMuting;
+        VMVoiceStateChanged(pVoiceMgr, voiceNum);
     }
 }
 
@@ -1166,15 +1655,17 @@ void VMAllNotesOff (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel)
 */
 void VMDeferredStopNote (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth)
 {
+    EAS_INT i;
     EAS_INT voiceNum;
     EAS_INT channel;
     EAS_BOOL deferredNoteOff;
 
     deferredNoteOff = EAS_FALSE;
 
-    /* check each voice to see if it requires a deferred note off */
-    for (voiceNum=0; voiceNum < MAX_SYNTH_VOICES; voiceNum++)
+    /* check each active voice to see if it requires a deferred note off */
+    for (i = 0; i < pVoiceMgr->numActiveVoiceList; i++)
     {
+        voiceNum = pVoiceMgr->activeVoiceList[i];
         if (pVoiceMgr->voices[voiceNum].voiceFlags & VOICE_FLAG_DEFER_MIDI_NOTE_OFF)
         {
             /* check if this voice was stolen */
@@ -1230,7 +1721,7 @@ void VMDeferredStopNote (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth)
                 /* check if sustain pedal is on */
                 if (pSynth->channels[channel].channelFlags & CHANNEL_FLAG_SUSTAIN_PEDAL)
                 {
-                    GetSynthPtr(voiceNum)->pfSustainPedal(pVoiceMgr, pSynth, &pVoiceMgr->voices[voiceNum], &pSynth->channels[channel], GetAdjustedVoiceNum(voiceNum));
+                    GetSynthPtr(pVoiceMgr, voiceNum)->pfSustainPedal(pVoiceMgr, pSynth, &pVoiceMgr->voices[voiceNum], &pSynth->channels[channel], GetAdjustedVoiceNum(pVoiceMgr, voiceNum));
                 }
 
                 /* release this voice */
@@ -1275,6 +1766,7 @@ void VMReleaseAllDeferredNoteOffs (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_
 {
     S_SYNTH_VOICE *pVoice;
     EAS_INT voiceNum;
+    EAS_INT nextVoice;
 
 #ifdef _DEBUG_VM
     if (channel >= NUM_SYNTH_CHANNELS)
@@ -1290,23 +1782,20 @@ void VMReleaseAllDeferredNoteOffs (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_
 
     /* find all the voices assigned to this channel */
     channel = VSynthToChannel(pSynth, channel);
-    for (voiceNum = 0; voiceNum < MAX_SYNTH_VOICES; voiceNum++)
+    for (voiceNum = pVoiceMgr->channelVoices[channel]; voiceNum != UNASSIGNED_SYNTH_VOICE; voiceNum = nextVoice)
     {
-
+        /* releasing a stolen voice moves it to another list */
+        nextVoice = pVoiceMgr->voiceLinks[voiceNum].nextOnChannel;
         pVoice = &pVoiceMgr->voices[voiceNum];
-        if (channel == pVoice->channel)
-        {
-
-            /* does this voice have a deferred note off? */
-            if (pVoice->voiceFlags & VOICE_FLAG_SUSTAIN_PEDAL_DEFER_NOTE_OFF)
-            {
-                /* release voice */
-                VMReleaseVoice(pVoiceMgr, pSynth, voiceNum);
 
-                /* use exor to flip bit, clear the flag */
-                pVoice->voiceFlags &= ~VOICE_FLAG_SUSTAIN_PEDAL_DEFER_NOTE_OFF;
+        /* does this voice have a deferred note off? */
+        if (pVoice->voiceFlags & VOICE_FLAG_SUSTAIN_PEDAL_DEFER_NOTE_OFF)
+        {
+            /* release voice */
+            VMReleaseVoice(pVoiceMgr, pSynth, voiceNum);
 
-            }
+            /* use exor to flip bit, clear the flag */
+            pVoice->voiceFlags &= ~VOICE_FLAG_SUSTAIN_PEDAL_DEFER_NOTE_OFF;
 
         }
     }
@@ -1349,13 +1838,10 @@ void VMCatchNotesForSustainPedal (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U
     channel = VSynthToChannel(pSynth, channel);
 
     /* find all the voices assigned to this channel */
-    for (voiceNum = 0; voiceNum < MAX_SYNTH_VOICES; voiceNum++)
+    for (voiceNum = pVoiceMgr->channelVoices[channel]; voiceNum != UNASSIGNED_SYNTH_VOICE; voiceNum = pVoiceMgr->voiceLinks[voiceNum].nextOnChannel)
     {
-        if (channel == pVoiceMgr->voices[voiceNum].channel)
-        {
-            if (eVoiceStateRelease == pVoiceMgr->voices[voiceNum].voiceState)
-                GetSynthPtr(voiceNum)->pfSustainPedal(pVoiceMgr, pSynth, &pVoiceMgr->voices[voiceNum], &pSynth->channels[channel], GetAdjustedVoiceNum(voiceNum));
-        }
+        if (eVoiceStateRelease == pVoiceMgr->voices[voiceNum].voiceState)
+            GetSynthPtr(pVoiceMgr, voiceNum)->pfSustainPedal(pVoiceMgr, pSynth, &pVoiceMgr->voices[voiceNum], &pSynth->channels[channel], GetAdjustedVoiceNum(pVoiceMgr, voiceNum));
     }
 }
 
@@ -1376,13 +1862,47 @@ void VMCatchNotesForSustainPedal (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U
 */
 void VMUpdateAllNotesAge (S_VOICE_MGR *pVoiceMgr, EAS_U16 age)
 {
+    S_SYNTH_VOICE *pVoice;
     EAS_INT i;
+    EAS_INT voiceNum;
+    EAS_INT numOlder;
+    EAS_BOOL older;
+    EAS_BOOL shift;
 
-    for (i = 0; i < MAX_SYNTH_VOICES; i++)
+    /* free voices get a new age when they start */
+    numOlder = 0;
+    for (i = 0; i < pVoiceMgr->numActiveVoiceList; i++)
     {
-        if (age - pVoiceMgr->voices[i].age > 0)
-            pVoiceMgr->voices[i].age++;
-     }
+        if (age - pVoiceMgr->voices[pVoiceMgr->activeVoiceList[i]].age > 0)
+            numOlder++;
+    }
+
+    /*
+     * the steal keys of the older notes go up with their age, if they are
+     * the majority raise the common offset instead and correct the others
+    */
+    shift = (numOlder * 2 > pVoiceMgr->numActiveVoiceList) ? EAS_TRUE : EAS_FALSE;
+    if (shift)
+        pVoiceMgr->stealShift++;
+
+    for (i = 0; i < pVoiceMgr->numActiveVoiceList; i++)
+    {
+        voiceNum = pVoiceMgr->activeVoiceList[i];
+        pVoice = &pVoiceMgr->voices[voiceNum];
+        older = (age - pVoice->age > 0) ? EAS_TRUE : EAS_FALSE;
+        if (older)
+            pVoice->age++;
+        if ((older != shift) || !VMStealByAge(pVoice))
+            VMUpdateStealKey(pVoiceMgr, voiceNum);
+    }
+
+    /* rebase the keys long before the offset can overflow them */
+    if (pVoiceMgr->stealShift >= STEAL_SHIFT_LIMIT)
+    {
+        pVoiceMgr->stealShift = 0;
+        for (i = 0; i < pVoiceMgr->numActiveVoiceList; i++)
+            VMUpdateStealKey(pVoiceMgr, pVoiceMgr->activeVoiceList[i]);
+    }
 }
 
 /*----------------------------------------------------------------------------
@@ -1410,7 +1930,7 @@ static void VMStolenVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_I32 voic
     DecVoicePoolCount(pVoiceMgr, pVoice);
 
     /* mute the sound that is currently playing */
-    GetSynthPtr(voiceNum)->pfMuteVoice(pVoiceMgr, pVoiceMgr->pSynth[GET_VSYNTH(pVoice->channel)], &pVoiceMgr->voices[voiceNum], GetAdjustedVoiceNum(voiceNum));
+    GetSynthPtr(pVoiceMgr, voiceNum)->pfMuteVoice(pVoiceMgr, pVoiceMgr->pSynth[GET_VSYNTH(pVoice->channel)], &pVoiceMgr->voices[voiceNum], GetAdjustedVoiceNum(pVoiceMgr, voiceNum));
     pVoice->voiceState = eVoiceStateStolen;
 
     /* set new note data */
@@ -1419,6 +1939,10 @@ static void VMStolenVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_I32 voic
     pVoice->nextVelocity = velocity;
     pVoice->nextRegionIndex = regionIndex;
 
+    /* list the voice under the note it will play */
+    VMUnlinkVoice(pVoiceMgr, voiceNum);
+    VMLinkVoice(pVoiceMgr, voiceNum, pVoice->nextChannel, note);
+
     /* one more voice in new pool */
     IncVoicePoolCount(pVoiceMgr, pVoice);
 
@@ -1433,6 +1957,7 @@ static void VMStolenVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_I32 voic
 
     /* assign current age to this note and increment for the next note */
     pVoice->age = pVoiceMgr->age++;
+    VMUpdateStealKey(pVoiceMgr, voiceNum);
 }
 
 /*----------------------------------------------------------------------------
@@ -1471,6 +1996,7 @@ static void VMFreeVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH_VOICE
     /* return to free voice pool */
     pVoiceMgr->activeVoices--;
     pSynth->numActiveVoices--;
+    VMRemoveActiveVoice(pVoiceMgr, (EAS_INT) (pVoice - pVoiceMgr->voices));
     InitVoice(pVoice);
 
 #ifdef _DEBUG_VM
@@ -1555,7 +2081,7 @@ static EAS_BOOL VMRetargetStolenVoice (S_VOICE_MGR *pVoiceMgr, EAS_I32 voiceNum)
     pVoice->voiceState = eVoiceStateStart;
 
     /*lint -e{522} return not used at this time */
-    GetSynthPtr(voiceNum)->pfStartVoice(pVoiceMgr, pNextSynth, &pVoiceMgr->voices[voiceNum], GetAdjustedVoiceNum(voiceNum), pVoice->regionIndex);
+    GetSynthPtr(pVoiceMgr, voiceNum)->pfStartVoice(pVoiceMgr, pNextSynth, &pVoiceMgr->voices[voiceNum], GetAdjustedVoiceNum(pVoiceMgr, voiceNum), pVoice->regionIndex);
 
     /* did the new note already receive a MIDI note-off request? */
     if (flags & VOICE_FLAG_DEFER_MIDI_NOTE_OFF)
@@ -1582,62 +2108,37 @@ void VMCheckKeyGroup (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U16 keyGroup,
 {
     const S_REGION *pRegion;
     EAS_INT voiceNum;
+    EAS_INT nextVoice;
 
     /* increment frame workload */
     pVoiceMgr->workload += WORKLOAD_AMOUNT_KEY_GROUP;
 
-    /* need to check all voices in case this is a layered sound */
+    /* need to check all voices on the channel in case this is a layered sound */
     channel = VSynthToChannel(pSynth, channel);
-    for (voiceNum = 0; voiceNum < MAX_SYNTH_VOICES; voiceNum++)
+    for (voiceNum = pVoiceMgr->channelVoices[channel]; voiceNum != UNASSIGNED_SYNTH_VOICE; voiceNum = nextVoice)
     {
-        if (pVoiceMgr->voices[voiceNum].voiceState != eVoiceStateStolen)
-        {
-            /* voice must be on the same channel */
-            if (channel == pVoiceMgr->voices[voiceNum].channel)
-            {
-                /* check key group */
-                pRegion = GetRegionPtr(pSynth, pVoiceMgr->voices[voiceNum].regionIndex);
-                if (keyGroup == (pRegion->keyGroupAndFlags & REGION_KEY_GROUP_MASK))
-                {
-#ifdef _DEBUG_VM
-                    { /* dpp: EAS_ReportEx(_EAS_SEVERITY_INFO, "VMCheckKeyGroup: voice %d matches key group %d\n", voiceNum, keyGroup >> 8); */ }
-#endif
-
-                    /* if this voice was just started, set it to mute on the next buffer */
-                    if (pVoiceMgr->voices[voiceNum].voiceFlags & VOICE_FLAG_NO_SAMPLES_SYNTHESIZED_YET)
-                        pVoiceMgr->voices[voiceNum].voiceFlags |= VOICE_FLAG_DEFER_MUTE;
-
-                    /* mute immediately */
-                    else
-                        VMMuteVoice(pVoiceMgr, voiceNum);
-                }
-            }
-        }
+        /* muting a stolen voice moves it to another list */
+        nextVoice = pVoiceMgr->voiceLinks[voiceNum].nextOnChannel;
 
-        /* for stolen voice, check new values */
+        /* check key group, for stolen voice check new values */
+        if (pVoiceMgr->voices[voiceNum].voiceState != eVoiceStateStolen)
+            pRegion = GetRegionPtr(pSynth, pVoiceMgr->voices[voiceNum].regionIndex);
         else
+            pRegion = GetRegionPtr(pSynth, pVoiceMgr->voices[voiceNum].nextRegionIndex);
+
+        if (keyGroup == (pRegion->keyGroupAndFlags & REGION_KEY_GROUP_MASK))
         {
-            /* voice must be on the same channel */
-            if (channel == pVoiceMgr->voices[voiceNum].nextChannel)
-            {
-                /* check key group */
-                pRegion = GetRegionPtr(pSynth, pVoiceMgr->voices[voiceNum].nextRegionIndex);
-                if (keyGroup == (pRegion->keyGroupAndFlags & REGION_KEY_GROUP_MASK))
-                {
 #ifdef _DEBUG_VM
-                    { /* dpp: EAS_ReportEx(_EAS_SEVERITY_INFO, "VMCheckKeyGroup: voice %d matches key group %d\n", voiceNum, keyGroup >> 8); */ }
+            { /* dpp: EAS_ReportEx(_EAS_SEVERITY_INFO, "VMCheckKeyGroup: voice %d matches key group %d\n", voiceNum, keyGroup >> 8); */ }
 #endif
 
-                    /* if this voice was just started, set it to mute on the next buffer */
-                    if (pVoiceMgr->voices[voiceNum].voiceFlags & VOICE_FLAG_NO_SAMPLES_SYNTHESIZED_YET)
-                        pVoiceMgr->voices[voiceNum].voiceFlags |= VOICE_FLAG_DEFER_MUTE;
-
-                    /* mute immediately */
-                    else
-                        VMMuteVoice(pVoiceMgr, voiceNum);
-                }
-            }
+            /* if this voice was just started, set it to mute on the next buffer */
+            if (pVoiceMgr->voices[voiceNum].voiceFlags & VOICE_FLAG_NO_SAMPLES_SYNTHESIZED_YET)
+                pVoiceMgr->voices[voiceNum].voiceFlags |= VOICE_FLAG_DEFER_MUTE;
 
+            /* mute immediately */
+            else
+                VMMuteVoice(pVoiceMgr, voiceNum);
         }
     }
 }
@@ -1677,7 +2178,7 @@ EAS_BOOL VMCheckPolyphonyLimiting (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_
     pVoiceMgr->workload += WORKLOAD_AMOUNT_POLY_LIMIT;
 
     numVoicesPlayingNote = 0;
-    oldestVoiceNum = MAX_SYNTH_VOICES;
+    oldestVoiceNum = UNASSIGNED_SYNTH_VOICE;
     oldestNoteAge = 0;
     channel = VSynthToChannel(pSynth, channel);
 
@@ -1719,7 +2220,7 @@ EAS_BOOL VMCheckPolyphonyLimiting (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_
         return EAS_FALSE;
 
     /* make sure we have a voice to steal */
-    if (oldestVoiceNum != MAX_SYNTH_VOICES)
+    if (oldestVoiceNum != UNASSIGNED_SYNTH_VOICE)
     {
 #ifdef _DEBUG_VM
         { /* dpp: EAS_ReportEx(_EAS_SEVERITY_INFO, "VMCheckPolyphonyLimiting: voice %d has the oldest note\n", oldestVoiceNum); */ }
@@ -1763,17 +2264,17 @@ void VMStartVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel, EAS_
 #endif
         {
             lowVoice = 0;
-            highVoice = NUM_PRIMARY_VOICES - 1;
+            highVoice = pVoiceMgr->numPrimaryVoices - 1;
         }
         else
         {
-            lowVoice = NUM_PRIMARY_VOICES;
-            highVoice = MAX_SYNTH_VOICES - 1;
+            lowVoice = pVoiceMgr->numPrimaryVoices;
+            highVoice = pVoiceMgr->numVoices - 1;
         }
     }
 #else
     lowVoice = 0;
-    highVoice = MAX_SYNTH_VOICES - 1;
+    highVoice = pVoiceMgr->numVoices - 1;
 #endif
 
     /* keep track of the note-start related workload */
@@ -1804,6 +2305,7 @@ void VMStartVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel, EAS_
 
     /* any free voices? */
     if ((pVoiceMgr->activeVoices < pVoiceMgr->maxPolyphony) &&
+        (pVoiceMgr->activeVoices < pVoiceMgr->budgetPolyphony) &&
         (pSynth->numActiveVoices < maxSynthPoly) &&
         (EAS_SUCCESS == VMFindAvailableVoice(pVoiceMgr, &voiceNum, lowVoice, highVoice)))
     {
@@ -1826,6 +2328,7 @@ void VMStartVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel, EAS_
         pVoiceMgr->voices[voiceNum].channel = VSynthToChannel(pSynth, channel);
         pVoiceMgr->voices[voiceNum].note = note;
         pVoiceMgr->voices[voiceNum].velocity = velocity;
+        VMLinkVoice(pVoiceMgr, voiceNum, pVoiceMgr->voices[voiceNum].channel, note);
 
         /* establish note age for voice stealing */
         pVoiceMgr->voices[voiceNum].age = pVoiceMgr->age++;
@@ -1838,7 +2341,8 @@ void VMStartVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel, EAS_
 
         /* start voice on correct synth */
         /*lint -e{522} return not used at this time */
-        GetSynthPtr(voiceNum)->pfStartVoice(pVoiceMgr, pSynth, &pVoiceMgr->voices[voiceNum], GetAdjustedVoiceNum(voiceNum), regionIndex);
+        GetSynthPtr(pVoiceMgr, voiceNum)->pfStartVoice(pVoiceMgr, pSynth, &pVoiceMgr->voices[voiceNum], GetAdjustedVoiceNum(pVoiceMgr, voiceNum), regionIndex);
+        VMUpdateStealKey(pVoiceMgr, voiceNum);
         return;
     }
 
@@ -1928,25 +2432,38 @@ void VMStartNote (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel, EAS_U
 #if defined(DLS_SYNTHESIZER)
     if (regionIndex & FLAG_RGN_IDX_DLS_SYNTH)
     {
-        /* DLS voice */
-        for (;;)
-        {
-            /*lint -e{740,826} cast OK, we know this is actually a DLS region */
-            const S_DLS_REGION *pDLSRegion = (S_DLS_REGION*) GetRegionPtr(pSynth, regionIndex);
+        const EAS_U16 *pRegions;
+        EAS_INT numRegions;
 
-            /* check key against this region's key and velocity range */
-            if (((adjustedNote >= pDLSRegion->wtRegion.region.rangeLow) && (adjustedNote <= pDLSRegion->wtRegion.region.rangeHigh)) &&
-                ((velocity >= pDLSRegion->velLow) && (velocity <= pDLSRegion->velHigh)))
+        /* DLS voice, start the regions the note index lists for this key and velocity */
+        numRegions = DLSFindRegions(pSynth->pDLS, regionIndex & REGION_INDEX_MASK, (EAS_U8) adjustedNote, velocity, &pRegions);
+        if (numRegions >= 0)
+        {
+            while (numRegions--)
+                VMStartVoice(pVoiceMgr, pSynth, channel, note, velocity, *pRegions++ | FLAG_RGN_IDX_DLS_SYNTH);
+        }
+        else
+        {
+            /* without an index, check each region of the program */
+            for (;;)
             {
-                VMStartVoice(pVoiceMgr, pSynth, channel, note, velocity, regionIndex);
-            }
+                /*lint -e{740,826} cast OK, we know this is actually a DLS region */
+                const S_DLS_REGION *pDLSRegion = (S_DLS_REGION*) GetRegionPtr(pSynth, regionIndex);
 
-            /* last region in program? */
-            if (pDLSRegion->wtRegion.region.keyGroupAndFlags & REGION_FLAG_LAST_REGION)
-                break;
+                /* check key against this region's key and velocity range */
+                if (((adjustedNote >= pDLSRegion->wtRegion.region.rangeLow) && (adjustedNote <= pDLSRegion->wtRegion.region.rangeHigh)) &&
+                    ((velocity >= pDLSRegion->velLow) && (velocity <= pDLSRegion->velHigh)))
+                {
+                    VMStartVoice(pVoiceMgr, pSynth, channel, note, velocity, regionIndex);
+                }
 
-            /* advance to next region */
-            regionIndex++;
+                /* last region in program? */
+                if (pDLSRegion->wtRegion.region.keyGroupAndFlags & REGION_FLAG_LAST_REGION)
+                    break;
+
+                /* advance to next region */
+                regionIndex++;
+            }
         }
     }
     else
@@ -2022,47 +2539,45 @@ void VMStopNote (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel, EAS_U8
 
     channel = VSynthToChannel(pSynth, channel);
 
-    for (voiceNum=0; voiceNum < MAX_SYNTH_VOICES; voiceNum++)
+    /* check the voices playing this note */
+    for (voiceNum = pVoiceMgr->noteVoices[note & (NUM_VOICE_NOTE_LISTS - 1)]; voiceNum != UNASSIGNED_SYNTH_VOICE; voiceNum = pVoiceMgr->voiceLinks[voiceNum].nextOnNote)
     {
+        /* channel and key number must match, stolen voices are listed under their new ones */
+        if ((channel != pVoiceMgr->voiceLinks[voiceNum].channel) || (note != pVoiceMgr->voiceLinks[voiceNum].note))
+            continue;
 
         /* stolen notes are handled separately */
         if (eVoiceStateStolen != pVoiceMgr->voices[voiceNum].voiceState)
         {
-
-            /* channel and key number must match */
-            if ((channel == pVoiceMgr->voices[voiceNum].channel) && (note == pVoiceMgr->voices[voiceNum].note))
-            {
 #ifdef _DEBUG_VM
-                { /* dpp: EAS_ReportEx(_EAS_SEVERITY_INFO, "VMStopNote: voice %d channel %d note %d\n",
-                    voiceNum, channel, note); */ }
+            { /* dpp: EAS_ReportEx(_EAS_SEVERITY_INFO, "VMStopNote: voice %d channel %d note %d\n",
+                voiceNum, channel, note); */ }
 #endif
 
-                /* if sustain pedal is down, set deferred note-off flag */
-                if (pChannel->channelFlags & CHANNEL_FLAG_SUSTAIN_PEDAL)
-                {
-                    pVoiceMgr->voices[voiceNum].voiceFlags |= VOICE_FLAG_SUSTAIN_PEDAL_DEFER_NOTE_OFF;
-                    continue;
-                }
+            /* if sustain pedal is down, set deferred note-off flag */
+            if (pChannel->channelFlags & CHANNEL_FLAG_SUSTAIN_PEDAL)
+            {
+                pVoiceMgr->voices[voiceNum].voiceFlags |= VOICE_FLAG_SUSTAIN_PEDAL_DEFER_NOTE_OFF;
+                continue;
+            }
 
-                /* if this note just started, wait before we stop it */
-                if (pVoiceMgr->voices[voiceNum].voiceFlags & VOICE_FLAG_NO_SAMPLES_SYNTHESIZED_YET)
-                {
+            /* if this note just started, wait before we stop it */
+            if (pVoiceMgr->voices[voiceNum].voiceFlags & VOICE_FLAG_NO_SAMPLES_SYNTHESIZED_YET)
+            {
 #ifdef _DEBUG_VM
-                    { /* dpp: EAS_ReportEx(_EAS_SEVERITY_INFO, "\tDeferred: Not started yet\n"); */ }
+                { /* dpp: EAS_ReportEx(_EAS_SEVERITY_INFO, "\tDeferred: Not started yet\n"); */ }
 #endif
-                    pVoiceMgr->voices[voiceNum].voiceFlags |= VOICE_FLAG_DEFER_MIDI_NOTE_OFF;
-                    pSynth->synthFlags |= SYNTH_FLAG_DEFERRED_MIDI_NOTE_OFF_PENDING;
-                }
-
-                /* release voice */
-                else
-                    VMReleaseVoice(pVoiceMgr, pSynth, voiceNum);
-
+                pVoiceMgr->voices[voiceNum].voiceFlags |= VOICE_FLAG_DEFER_MIDI_NOTE_OFF;
+                pSynth->synthFlags |= SYNTH_FLAG_DEFERRED_MIDI_NOTE_OFF_PENDING;
             }
+
+            /* release voice */
+            else
+                VMReleaseVoice(pVoiceMgr, pSynth, voiceNum);
         }
 
-        /* process stolen notes, new channel and key number must match */
-        else if ((channel == pVoiceMgr->voices[voiceNum].nextChannel) && (note == pVoiceMgr->voices[voiceNum].nextNote))
+        /* process stolen notes */
+        else
         {
 
 #ifdef _DEBUG_VM
@@ -2079,6 +2594,8 @@ void VMStopNote (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel, EAS_U8
  *----------------------------------------------------------------------------
  * Purpose:
  * Find an available voice and return the voice number if available.
+ * The lowest free voice in range is taken off the free voice mask and
+ * added to the active voice list, so the caller must start it.
  *
  * Inputs:
  * pnVoiceNumber - really an output, returns the voice number found
@@ -2091,19 +2608,62 @@ void VMStopNote (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel, EAS_U8
 */
 EAS_RESULT VMFindAvailableVoice (S_VOICE_MGR *pVoiceMgr, EAS_INT *pVoiceNumber, EAS_I32 lowVoice, EAS_I32 highVoice)
 {
+    /* bit position of an isolated bit, by de Bruijn multiplication */
+    static const EAS_U8 bitPosition[32] =
+    {
+        0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+        31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9
+    };
     EAS_INT voiceNum;
+    EAS_INT word;
+    EAS_U32 bits;
+
+    /* take the lowest free voice in range, as the voice stealer expects */
+    voiceNum = UNASSIGNED_SYNTH_VOICE;
+#if defined(_REFERENCE_RENDER_PATHS)
+    /* the test build can check each voice to see if it has been assigned to a synth channel */
+    if ((pVoiceMgr->renderPaths & VM_PATH_VOICE_LIST) == 0)
+    {
+        for (voiceNum = lowVoice; voiceNum <= highVoice; voiceNum++)
+        {
+            if (pVoiceMgr->voices[voiceNum].voiceState == eVoiceStateFree)
+                break;
+        }
+        if (voiceNum > highVoice)
+            voiceNum = UNASSIGNED_SYNTH_VOICE;
+    }
+    else
+#endif
 
-    /* Check each voice to see if it has been assigned to a synth channel */
-    for (voiceNum = lowVoice; voiceNum <= highVoice; voiceNum++)
+    /* braces here for #if clause */
     {
-        /* check if this voice has been assigned to a synth channel */
-        if ( pVoiceMgr->voices[voiceNum].voiceState == eVoiceStateFree)
+        for (word = lowVoice >> 5; word <= (highVoice >> 5); word++)
         {
-            *pVoiceNumber = voiceNum;       /* this voice is available */
-            return EAS_SUCCESS;
+            bits = pVoiceMgr->freeVoiceMask[word];
+            if (word == (lowVoice >> 5))
+                bits &= ~0u << (lowVoice & 31);
+            if (word == (highVoice >> 5))
+                bits &= ~0u >> (31 - (highVoice & 31));
+            if (bits != 0)
+            {
+                bits &= ~bits + 1;
+                voiceNum = (word << 5) + bitPosition[(bits * 0x077CB531u) >> 27];
+                break;
+            }
         }
     }
 
+    if (voiceNum != UNASSIGNED_SYNTH_VOICE)
+    {
+        /* move it from the free voice mask to the active voice list */
+        pVoiceMgr->freeVoiceMask[voiceNum >> 5] &= ~(1u << (voiceNum & 31));
+        pVoiceMgr->activeVoicePos[voiceNum] = pVoiceMgr->numActiveVoiceList;
+        pVoiceMgr->activeVoiceList[pVoiceMgr->numActiveVoiceList++] = (EAS_U16) voiceNum;
+
+        *pVoiceNumber = voiceNum;       /* this voice is available */
+        return EAS_SUCCESS;
+    }
+
     /* if we reach here, we have not found a free voice */
     *pVoiceNumber = UNASSIGNED_SYNTH_VOICE;
 
@@ -2152,83 +2712,114 @@ EAS_RESULT VMStealVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_INT *pVoic
     EAS_U8 currNote;
     EAS_I32 bestPriority;
     EAS_I32 currentPriority;
+    EAS_BOOL useStealTree;
+    EAS_INT i;
 
     /* determine which voice to steal */
     bestPriority = 0;
-    bestCandidate = MAX_SYNTH_VOICES;
+    bestCandidate = UNASSIGNED_SYNTH_VOICE;
 
-    for (voiceNum = lowVoice; voiceNum <= highVoice; voiceNum++)
+    /*
+     * without SP-MIDI or a higher priority virtual synth, the priority of
+     * a voice only depends on the voice and on whether it plays the same
+     * note, so the tournament tree finds the best one
+    */
+    useStealTree = EAS_TRUE;
+    if (pSynth->synthFlags & SYNTH_FLAG_SP_MIDI_ON)
+        useStealTree = EAS_FALSE;
+    for (i = 0; i < MAX_VIRTUAL_SYNTHESIZERS; i++)
+    {
+        if ((pVoiceMgr->pSynth[i] != NULL) && (pSynth->priority > pVoiceMgr->pSynth[i]->priority))
+            useStealTree = EAS_FALSE;
+    }
+
+    if (useStealTree)
+    {
+        voiceNum = VMFindStealCandidate(pVoiceMgr, lowVoice, highVoice);
+        if (voiceNum != UNASSIGNED_SYNTH_VOICE)
+        {
+            bestCandidate = voiceNum;
+            bestPriority = pVoiceMgr->stealKey[voiceNum];
+        }
+
+        /* voices playing the same note get the match penalty */
+        for (voiceNum = pVoiceMgr->noteVoices[note & 127]; voiceNum != UNASSIGNED_SYNTH_VOICE; voiceNum = pVoiceMgr->voiceLinks[voiceNum].nextOnNote)
+        {
+            if ((voiceNum < lowVoice) || (voiceNum > highVoice) ||
+                (pVoiceMgr->voiceLinks[voiceNum].channel != channel) ||
+                (pVoiceMgr->voiceLinks[voiceNum].note != note))
+                continue;
+
+            currentPriority = pVoiceMgr->stealKey[voiceNum] + NOTE_MATCH_PENALTY;
+            if ((currentPriority > bestPriority) || ((currentPriority == bestPriority) && (voiceNum > bestCandidate)))
+            {
+                bestPriority = currentPriority;
+                bestCandidate = voiceNum;
+            }
+        }
+    }
+
+    else
     {
-        pCurrVoice = &pVoiceMgr->voices[voiceNum];
+        for (voiceNum = lowVoice; voiceNum <= highVoice; voiceNum++)
+        {
+            pCurrVoice = &pVoiceMgr->voices[voiceNum];
 
-        /* ignore free voices */
-        if (pCurrVoice->voiceState == eVoiceStateFree)
-            continue;
+            /* ignore free voices */
+            if (pCurrVoice->voiceState == eVoiceStateFree)
+                continue;
 
-        /* for stolen voices, use the new parameters, not the old */
-        if (pCurrVoice->voiceState == eVoiceStateStolen)
-        {
-            pCurrSynth = pVoiceMgr->pSynth[GET_VSYNTH(pCurrVoice->nextChannel)];
-            currChannel = pCurrVoice->nextChannel;
-            currNote = pCurrVoice->nextNote;
-        }
-        else
-        {
-            pCurrSynth = pVoiceMgr->pSynth[GET_VSYNTH(pCurrVoice->channel)];
-            currChannel = pCurrVoice->channel;
-            currNote = pCurrVoice->note;
-        }
+            /* for stolen voices, use the new parameters, not the old */
+            if (pCurrVoice->voiceState == eVoiceStateStolen)
+            {
+                pCurrSynth = pVoiceMgr->pSynth[GET_VSYNTH(pCurrVoice->nextChannel)];
+                currChannel = pCurrVoice->nextChannel;
+                currNote = pCurrVoice->nextNote;
+            }
+            else
+            {
+                pCurrSynth = pVoiceMgr->pSynth[GET_VSYNTH(pCurrVoice->channel)];
+                currChannel = pCurrVoice->channel;
+                currNote = pCurrVoice->note;
+            }
 
-        /* ignore voices that are higher priority */
-        if (pSynth->priority > pCurrSynth->priority)
-            continue;
+            /* ignore voices that are higher priority */
+            if (pSynth->priority > pCurrSynth->priority)
+                continue;
 #ifdef _DEBUG_VM
-//      { /* dpp: EAS_ReportEx(_EAS_SEVERITY_INFO, "VMStealVoice: New priority = %d exceeds old priority = %d\n", pSynth->priority, pCurrSynth->priority); */ }
+//          { /* dpp: EAS_ReportEx(_EAS_SEVERITY_INFO, "VMStealVoice: New priority = %d exceeds old priority = %d\n", pSynth->priority, pCurrSynth->priority); */ }
 #endif
 
-        /* if voice is stolen or just started, reduce the likelihood it will be stolen */
-        if (( pCurrVoice->voiceState == eVoiceStateStolen) || (pCurrVoice->voiceFlags & VOICE_FLAG_NO_SAMPLES_SYNTHESIZED_YET))
-        {
-            currentPriority = 128 - pCurrVoice->nextVelocity;
-        }
-        else
-        {
             /* compute the priority of this voice, higher means better for stealing */
-            /* use not age */
-            currentPriority = (EAS_I32) pCurrVoice->age << NOTE_AGE_STEAL_WEIGHT;
-
-            /* include note gain -higher gain is lower steal value */
-            /*lint -e{704} use shift for performance */
-            currentPriority += ((32768 >> (12 - NOTE_GAIN_STEAL_WEIGHT)) + 256) -
-                ((EAS_I32) pCurrVoice->gain >> (12 - NOTE_GAIN_STEAL_WEIGHT));
-        }
+            currentPriority = VMStealPriority(pCurrVoice);
 
-        /* in SP-MIDI mode, include over poly allocation and channel priority */
-        if (pSynth->synthFlags & SYNTH_FLAG_SP_MIDI_ON)
-        {
-            S_SYNTH_CHANNEL *pChannel = &pCurrSynth->channels[GET_CHANNEL(currChannel)];
-            /*lint -e{701} use shift for performance */
-            if (pSynth->poolCount[pChannel->pool] >= pSynth->poolAlloc[pChannel->pool])
-                currentPriority += (pSynth->poolCount[pChannel->pool] -pSynth->poolAlloc[pChannel->pool] + 1) << CHANNEL_POLY_STEAL_WEIGHT;
+            /* in SP-MIDI mode, include over poly allocation and channel priority */
+            if (pSynth->synthFlags & SYNTH_FLAG_SP_MIDI_ON)
+            {
+                S_SYNTH_CHANNEL *pChannel = &pCurrSynth->channels[GET_CHANNEL(currChannel)];
+                /*lint -e{701} use shift for performance */
+                if (pSynth->poolCount[pChannel->pool] >= pSynth->poolAlloc[pChannel->pool])
+                    currentPriority += (pSynth->poolCount[pChannel->pool] -pSynth->poolAlloc[pChannel->pool] + 1) << CHANNEL_POLY_STEAL_WEIGHT;
 
-            /* include channel priority */
-            currentPriority += (EAS_I32)(pChannel->pool << CHANNEL_PRIORITY_STEAL_WEIGHT);
-        }
+                /* include channel priority */
+                currentPriority += (EAS_I32)(pChannel->pool << CHANNEL_PRIORITY_STEAL_WEIGHT);
+            }
 
-        /* if a note is already playing that matches this note, consider stealing it more readily */
-        if ((note == currNote) && (channel == currChannel))
-            currentPriority += NOTE_MATCH_PENALTY;
+            /* if a note is already playing that matches this note, consider stealing it more readily */
+            if ((note == currNote) && (channel == currChannel))
+                currentPriority += NOTE_MATCH_PENALTY;
 
-        /* is this the best choice so far? */
-        if (currentPriority >= bestPriority)
-        {
-            bestPriority = currentPriority;
-            bestCandidate = voiceNum;
+            /* is this the best choice so far? */
+            if (currentPriority >= bestPriority)
+            {
+                bestPriority = currentPriority;
+                bestCandidate = voiceNum;
+            }
         }
     }
 
     /* may happen if all voices are allocated to a higher priority virtual synth */
-    if (bestCandidate == MAX_SYNTH_VOICES)
+    if (bestCandidate == UNASSIGNED_SYNTH_VOICE)
     {
         { /* dpp: EAS_ReportEx(_EAS_SEVERITY_INFO, "VMStealVoice: Unable to allocate a voice\n"); */ }
         return EAS_ERROR_NO_VOICE_ALLOCATED;
@@ -2763,9 +3354,9 @@ static EAS_RESULT VMFindProgram (const S_EAS *pEAS, EAS_U32 bank, EAS_U8 program
  * VMFindDLSProgram()
  *----------------------------------------------------------------------------
  * Purpose:
- * Look up an individual program in sound library. This function
- * searches the bank list for a program, then the individual program
- * list.
+ * Look up an individual program in a DLS collection. If it is missing,
+ * the substitutes are tried in order. Each step is one lookup in the
+ * program index built when the collection was loaded.
  *
  * Inputs:
  *
@@ -2775,8 +3366,6 @@ static EAS_RESULT VMFindProgram (const S_EAS *pEAS, EAS_U32 bank, EAS_U8 program
 static EAS_RESULT VMFindDLSProgram (const S_DLS *pDLS, EAS_U32 bank, EAS_U8 programNum, EAS_U16 *pRegionIndex)
 {
     EAS_U32 locale;
-    const S_PROGRAM *p;
-    EAS_U16 i;
 
     /* make sure we have a valid sound library */
     if (pDLS == NULL)
@@ -2786,14 +3375,8 @@ static EAS_RESULT VMFindDLSProgram (const S_DLS *pDLS, EAS_U32 bank, EAS_U8 prog
     locale = (bank << 8) | programNum;
 
     /* search for program */
-    for (i = 0, p = pDLS->pDLSPrograms; i < pDLS->numDLSPrograms; i++, p++)
-    {
-        if (p->locale == locale)
-        {
-            *pRegionIndex = p->regionIndex;
-            return EAS_SUCCESS;
-        }
-    }
+    if (DLSFindProgram(pDLS, locale, pRegionIndex))
+        return EAS_SUCCESS;
 
     // used later for subst
     EAS_U8 program = programNum;
@@ -2802,15 +3385,8 @@ subst:
     if ((bank & 0x1FF00) == DEFAULT_MELODY_BANK_NUMBER || (bank & 0x1FF00) == (0x10000 | DEFAULT_RHYTHM_BANK_NUMBER))
     {
         locale = ((bank & 0x100FF) << 8) | program;
-
-        for (i = 0, p = pDLS->pDLSPrograms; i < pDLS->numDLSPrograms; i++, p++)
-        {
-            if (p->locale == locale)
-            {
-                *pRegionIndex = p->regionIndex;
-                goto subst_success;
-            }
-        }
+        if (DLSFindProgram(pDLS, locale, pRegionIndex))
+            goto subst_success;
     }
 
     // 2. bank to DEFAULT_MELODY_BANK_NUMBER or DEFAULT_RHYTHM_BANK_NUMBER (lsb to 0)
@@ -2820,29 +3396,15 @@ subst:
         } else {
             locale = (DEFAULT_MELODY_BANK_NUMBER << 8) | program;
         }
-
-        for (i = 0, p = pDLS->pDLSPrograms; i < pDLS->numDLSPrograms; i++, p++)
-        {
-            if (p->locale == locale)
-            {
-                *pRegionIndex = p->regionIndex;
-                goto subst_success;
-            }
-        }
+        if (DLSFindProgram(pDLS, locale, pRegionIndex))
+            goto subst_success;
     }
 
     // 3. bank to 0
     if ((bank & 0xFFFF) != 0) {
         locale = ((bank & 0x10000) << 8) | program;
-
-        for (i = 0, p = pDLS->pDLSPrograms; i < pDLS->numDLSPrograms; i++, p++)
-        {
-            if (p->locale == locale)
-            {
-                *pRegionIndex = p->regionIndex;
-                goto subst_success;
-            }
-        }
+        if (DLSFindProgram(pDLS, locale, pRegionIndex))
+            goto subst_success;
     }
 
     // 4. for drums, pc to 0
@@ -2993,6 +3555,73 @@ match_success:
     return;
 }
 
+/*----------------------------------------------------------------------------
+ * VMControlTicks()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * The envelope and LFO rates in the sound libraries are expressed per
+ * native control period of BUFFER_SIZE_IN_MONO_SAMPLES samples at
+ * _OUTPUT_SAMPLE_RATE. Each update advances the controls by the number of
+ * native periods that start within it, the first one starting with the
+ * first update the voice renders. Time is counted in units of
+ * 1/(_OUTPUT_SAMPLE_RATE * sampleRate) seconds so no error accumulates.
+ *
+ * Inputs:
+ * pVoiceMgr - pointer to voice manager
+ * pVoice - pointer to voice being rendered
+ *
+ * Outputs:
+ * number of control periods to advance in this update
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_I32 VMControlTicks (S_VOICE_MGR *pVoiceMgr, S_SYNTH_VOICE *pVoice)
+{
+    EAS_I32 ticks;
+
+    if (pVoice->voiceFlags & VOICE_FLAG_NO_SAMPLES_SYNTHESIZED_YET)
+        pVoice->controlPhase = 0;
+
+    ticks = 0;
+    if (pVoice->controlPhase < pVoiceMgr->controlUpdateLength)
+    {
+        ticks = (pVoiceMgr->controlUpdateLength - pVoice->controlPhase + pVoiceMgr->controlTickLength - 1) / pVoiceMgr->controlTickLength;
+        pVoice->controlPhase += ticks * pVoiceMgr->controlTickLength;
+    }
+    pVoice->controlPhase -= pVoiceMgr->controlUpdateLength;
+    return ticks;
+}
+
+#if defined(_CC_CHORUS) || defined(_CC_REVERB)
+/*----------------------------------------------------------------------------
+ * VMEffectTail()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns EAS_TRUE if a send effect of the voice manager has a tail left to
+ * play out, so it keeps running after the voices stop sending to it
+ *
+ * Inputs:
+ * pModule - reverb or chorus module of the voice manager
+ * param - EAS_PARAM_REVERB_TAIL_SILENT or EAS_PARAM_CHORUS_TAIL_SILENT
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static EAS_BOOL VMEffectTail (const S_EFFECTS_MODULE *pModule, EAS_INT param)
+{
+    EAS_I32 tailSilent;
+
+    if (pModule->effectData == NULL)
+        return EAS_FALSE;
+
+    /* an effect that does not report its tail always has one */
+    if (pModule->effect->pFGetParam(pModule->effectData, param, &tailSilent) != EAS_SUCCESS)
+        return EAS_TRUE;
+    return tailSilent ? EAS_FALSE : EAS_TRUE;
+}
+#endif
+
 /*----------------------------------------------------------------------------
  * VMAddSamples()
  *----------------------------------------------------------------------------
@@ -3015,92 +3644,172 @@ EAS_I32 VMAddSamples (S_VOICE_MGR *pVoiceMgr, EAS_I32 *pMixBuffer, EAS_I32 numSa
 {
     S_SYNTH *pSynth;
     EAS_INT voicesRendered;
+    EAS_INT listIndex;
     EAS_INT voiceNum;
+    EAS_I32 offset;
     EAS_BOOL done;
+    EAS_INT numGroup;
+    EAS_INT lane;
+    EAS_INT voiceGroup[SYNTH_VOICE_GROUP];
+    EAS_BOOL voiceDone[SYNTH_VOICE_GROUP];
+    EAS_I32 *pVoiceBuffer;
+#if defined(_WT_SYNTH) && defined(_VOICE_PARALLEL)
+    EAS_INT batch;
+#endif
 
-    EAS_I32 synthBuffer[NUM_OUTPUT_CHANNELS * BUFFER_SIZE_IN_MONO_SAMPLES];
+    EAS_I32 *synthBuffer = pVoiceMgr->synthBuffer;
     EAS_BOOL reverbProcess = EAS_FALSE;
     EAS_BOOL chorusProcess = EAS_FALSE;
 
     EAS_U16 sendLevel;
+    EAS_I32 *pReverbSend;
+    EAS_I32 *pChorusSend;
+    EAS_I32 reverbLevel;
+    EAS_I32 chorusLevel;
+
+#ifdef _CC_CHORUS
+    chorusProcess = VMEffectTail(&pVoiceMgr->chorusModule, EAS_PARAM_CHORUS_TAIL_SILENT);
+#endif
+#ifdef _CC_REVERB
+    reverbProcess = VMEffectTail(&pVoiceMgr->reverbModule, EAS_PARAM_REVERB_TAIL_SILENT);
+#endif
+
+    /* no voice to render and no tail to play out, the send buffers and the effects are not used */
+    if ((pVoiceMgr->numActiveVoiceList == 0) && !chorusProcess && !reverbProcess)
+        return 0;
 
 #ifdef _CC_CHORUS
-    EAS_HWMemSet(pVoiceMgr->chorusSendBuffer, 0, sizeof(pVoiceMgr->chorusSendBuffer));
+    EAS_HWMemSet(pVoiceMgr->chorusSendBuffer, 0, NUM_OUTPUT_CHANNELS * numSamples * (EAS_I32) sizeof(EAS_I32));
 #endif
 
 #ifdef _CC_REVERB
-    EAS_HWMemSet(pVoiceMgr->reverbSendBuffer, 0, sizeof(pVoiceMgr->reverbSendBuffer));
+    EAS_HWMemSet(pVoiceMgr->reverbSendBuffer, 0, NUM_OUTPUT_CHANNELS * numSamples * (EAS_I32) sizeof(EAS_I32));
+#endif
+
+#if defined(_REFERENCE_RENDER_PATHS)
+    /* without the voice list path, render in voice number order */
+    if ((pVoiceMgr->renderPaths & VM_PATH_VOICE_LIST) == 0)
+        VMSortActiveVoices(pVoiceMgr);
 #endif
 
+    /*
+     * walk the active voice list from the end, a voice that is freed is
+     * replaced by the last one in the list, which has already been rendered
+    */
     voicesRendered = 0;
-    for (voiceNum = 0; voiceNum < MAX_SYNTH_VOICES; voiceNum++)
+    for (listIndex = pVoiceMgr->numActiveVoiceList - 1; listIndex >= 0; listIndex -= numGroup)
     {
-        S_SYNTH_VOICE* pSynthVoice = &pVoiceMgr->voices[voiceNum];
-        const EAS_U8 channel = pSynthVoice->channel;
+        /* take the next group of voices, each renders into its own synth buffer */
+        numGroup = (listIndex < SYNTH_VOICE_GROUP) ? listIndex + 1 : SYNTH_VOICE_GROUP;
+        for (lane = 0; lane < numGroup; lane++)
+            voiceGroup[lane] = pVoiceMgr->activeVoiceList[listIndex - lane];
 
         /* retarget stolen voices */
-        // TODO: do we really need gain <= 0
-        if ((pSynthVoice->voiceState == eVoiceStateStolen) && (pSynthVoice->gain <= 0))
-            VMRetargetStolenVoice(pVoiceMgr, voiceNum);
+        for (lane = 0; lane < numGroup; lane++)
+        {
+            voiceNum = voiceGroup[lane];
+            // TODO: do we really need gain <= 0
+            if ((pVoiceMgr->voices[voiceNum].voiceState == eVoiceStateStolen) && (pVoiceMgr->voices[voiceNum].gain <= 0))
+                VMRetargetStolenVoice(pVoiceMgr, voiceNum);
+            voiceDone[lane] = EAS_FALSE;
+        }
+
+        /* render the group one control period at a time, so the filters of its voices run together */
+        for (offset = 0; offset < numSamples; offset += pVoiceMgr->controlPeriod)
+        {
+            for (lane = 0; lane < numGroup; lane++)
+            {
+                voiceNum = voiceGroup[lane];
+                if (pVoiceMgr->voices[voiceNum].voiceState == eVoiceStateFree)
+                    continue;
 
-        /* get pointer to virtual synth */
-        pSynth = pVoiceMgr->pSynth[channel >> 4];
+                /* voice finished early, silence the rest of the block */
+                pVoiceBuffer = synthBuffer + (lane * pVoiceMgr->blockSize + offset) * NUM_OUTPUT_CHANNELS;
+                if (voiceDone[lane] == EAS_TRUE)
+                    EAS_HWMemSet(pVoiceBuffer, 0, pVoiceMgr->controlPeriod * NUM_OUTPUT_CHANNELS * (EAS_I32) sizeof(EAS_I32));
+                else
+                    voiceDone[lane] = GetSynthPtr(pVoiceMgr, voiceNum)->pfUpdateVoice(pVoiceMgr, pVoiceMgr->pSynth[pVoiceMgr->voices[voiceNum].channel >> 4], &pVoiceMgr->voices[voiceNum], GetAdjustedVoiceNum(pVoiceMgr, voiceNum), pVoiceBuffer, pVoiceMgr->controlPeriod);
+            }
+#if defined(_WT_SYNTH) && defined(_VOICE_PARALLEL)
+            for (batch = 0; batch < WT_NUM_VOICE_BATCHES; batch++)
+                WT_RenderBatch(&pVoiceMgr->voiceBatches[batch]);
+#endif
+#if defined(_WT_SYNTH) && defined(_FILTER_ENABLED) && defined(_FLOAT_DCF)
+            WT_FilterBatch(&pVoiceMgr->filterBatch);
+#endif
+        }
 
-        /* synthesize active voices */
-        if (pSynthVoice->voiceState != eVoiceStateFree)
+        /* mix the group */
+        for (lane = 0; lane < numGroup; lane++)
         {
-            done = GetSynthPtr(voiceNum)->pfUpdateVoice(pVoiceMgr, pSynth, &pVoiceMgr->voices[voiceNum], GetAdjustedVoiceNum(voiceNum), synthBuffer, numSamples);
+            voiceNum = voiceGroup[lane];
+            S_SYNTH_VOICE* pSynthVoice = &pVoiceMgr->voices[voiceNum];
+            const EAS_U8 channel = pSynthVoice->channel;
+
+            if (pSynthVoice->voiceState == eVoiceStateFree)
+                continue;
+
+            /* get pointer to virtual synth */
+            pSynth = pVoiceMgr->pSynth[channel >> 4];
+            pVoiceBuffer = synthBuffer + lane * pVoiceMgr->blockSize * NUM_OUTPUT_CHANNELS;
+            done = voiceDone[lane];
             voicesRendered++;
 
-            // add the samples to the mix buffer and reverb and chorus buffer
-            for (EAS_INT i = 0; i < BUFFER_SIZE_IN_MONO_SAMPLES * NUM_OUTPUT_CHANNELS; i++) {
 #if defined(_HYBRID_SYNTH)
-                // The attenuation here goes in two directions
-                if (pSynth->isHybridLibrary && voiceNum < NUM_PRIMARY_VOICES) {
-                    if (voiceNum < NUM_PRIMARY_VOICES) { // WT voice
-                        synthBuffer[i] <<= FM_OUTPUT_GAIN_ATTEN / 2;
+            // The attenuation here goes in two directions
+            if (pSynth->isHybridLibrary && voiceNum < pVoiceMgr->numPrimaryVoices) {
+                for (EAS_INT i = 0; i < numSamples * NUM_OUTPUT_CHANNELS; i++) {
+                    if (voiceNum < pVoiceMgr->numPrimaryVoices) { // WT voice
+                        pVoiceBuffer[i] <<= FM_OUTPUT_GAIN_ATTEN / 2;
                     } else { // FM voice
-                        synthBuffer[i] >>= FM_OUTPUT_GAIN_ATTEN / 2;
+                        pVoiceBuffer[i] >>= FM_OUTPUT_GAIN_ATTEN / 2;
                     }
                 }
+            }
 #endif
-                pMixBuffer[i] += synthBuffer[i];
 
-                // these effect modules have 16bit IO
+            // the send levels are constant over the block, so compute them once per voice
+            pReverbSend = pChorusSend = NULL;
+            reverbLevel = chorusLevel = 0;
+
 #ifdef _CC_REVERB
 #if defined(DLS_SYNTHESIZER)
-                if (pSynthVoice->regionIndex & FLAG_RGN_IDX_DLS_SYNTH) {
-                    const S_DLS_ARTICULATION* pDLSArt = &pSynth->pDLS->pDLSArticulations[pVoiceMgr->wtVoices[voiceNum].artIndex];
-                    sendLevel = pDLSArt->reverbSend * 128 / 1000;
-                    sendLevel += pSynth->reverbSendLevels[channel & 15] * pDLSArt->cc91ToReverbSend / 1000;
-                } else 
+            if (pSynthVoice->regionIndex & FLAG_RGN_IDX_DLS_SYNTH) {
+                const S_DLS_ARTICULATION* pDLSArt = &pSynth->pDLS->pDLSArticulations[pVoiceMgr->wtVoices[voiceNum].artIndex];
+                sendLevel = pDLSArt->reverbSend * 128 / 1000;
+                sendLevel += pSynth->reverbSendLevels[channel & 15] * pDLSArt->cc91ToReverbSend / 1000;
+            } else 
 #endif
-                {
-                    sendLevel = pSynth->reverbSendLevels[channel & 15];
-                }
-                if (pSynth->reverbEnabled && sendLevel != 0) {
-                    pVoiceMgr->reverbSendBuffer[i] += synthBuffer[i] * sendLevel / 128;
-                    reverbProcess = EAS_TRUE;
-                }
+            {
+                sendLevel = pSynth->reverbSendLevels[channel & 15];
+            }
+            if (pSynth->reverbEnabled && sendLevel != 0) {
+                pReverbSend = pVoiceMgr->reverbSendBuffer;
+                reverbLevel = sendLevel;
+                reverbProcess = EAS_TRUE;
+            }
 #endif
 
 #ifdef _CC_CHORUS
 #if defined(DLS_SYNTHESIZER)
-                if (pSynthVoice->regionIndex & FLAG_RGN_IDX_DLS_SYNTH) {
-                    const S_DLS_ARTICULATION* pDLSArt = &pSynth->pDLS->pDLSArticulations[pVoiceMgr->wtVoices[voiceNum].artIndex];
-                    sendLevel = pDLSArt->chorusSend * 128 / 1000;
-                    sendLevel += pSynth->chorusSendLevels[channel & 15] * pDLSArt->cc93ToChorusSend / 1000;
-                } else 
-#endif
-                {
-                    sendLevel = pSynth->chorusSendLevels[channel & 15];
-                }
-                if (pSynth->chorusEnabled && sendLevel != 0) {
-                    pVoiceMgr->chorusSendBuffer[i] += synthBuffer[i] * sendLevel / 128;
-                    chorusProcess = EAS_TRUE;
-                }
+            if (pSynthVoice->regionIndex & FLAG_RGN_IDX_DLS_SYNTH) {
+                const S_DLS_ARTICULATION* pDLSArt = &pSynth->pDLS->pDLSArticulations[pVoiceMgr->wtVoices[voiceNum].artIndex];
+                sendLevel = pDLSArt->chorusSend * 128 / 1000;
+                sendLevel += pSynth->chorusSendLevels[channel & 15] * pDLSArt->cc93ToChorusSend / 1000;
+            } else 
 #endif
+            {
+                sendLevel = pSynth->chorusSendLevels[channel & 15];
             }
+            if (pSynth->chorusEnabled && sendLevel != 0) {
+                pChorusSend = pVoiceMgr->chorusSendBuffer;
+                chorusLevel = sendLevel;
+                chorusProcess = EAS_TRUE;
+            }
+#endif
+
+            // add the samples to the mix buffer and reverb and chorus buffer in one pass
+            EAS_MixVoice(pVoiceBuffer, pMixBuffer, pReverbSend, reverbLevel, pChorusSend, chorusLevel, numSamples * NUM_OUTPUT_CHANNELS);
 
             /* voice is finished */
             if (done == EAS_TRUE)
@@ -3124,13 +3833,17 @@ EAS_I32 VMAddSamples (S_VOICE_MGR *pVoiceMgr, EAS_I32 *pMixBuffer, EAS_I32 numSa
             /* if voice just started, advance state to play */
             if (pSynthVoice->voiceState == eVoiceStateStart)
                 pSynthVoice->voiceState = eVoiceStatePlay;
+
+            /* rendering changes the gain and clears the new voice flag */
+            if (pSynthVoice->voiceState != eVoiceStateFree)
+                VMUpdateStealKey(pVoiceMgr, voiceNum);
         }
     }
 
 #if defined (_CC_CHORUS)
     if (chorusProcess && pVoiceMgr->chorusModule.effectData != NULL) {
-        pVoiceMgr->chorusModule.effect->pfProcess(pVoiceMgr->chorusModule.effectData, pVoiceMgr->chorusSendBuffer, pVoiceMgr->chorusSendBuffer, numSamples);
-        for (EAS_INT i = 0; i < BUFFER_SIZE_IN_MONO_SAMPLES * NUM_OUTPUT_CHANNELS; i++) {
+        pVoiceMgr->chorusModule.effect->pfProcess32(pVoiceMgr->chorusModule.effectData, pVoiceMgr->chorusSendBuffer, pVoiceMgr->chorusSendBuffer, numSamples);
+        for (EAS_INT i = 0; i < numSamples * NUM_OUTPUT_CHANNELS; i++) {
             pMixBuffer[i] = pMixBuffer[i] + pVoiceMgr->chorusSendBuffer[i];
         }
     }
@@ -3139,8 +3852,8 @@ EAS_I32 VMAddSamples (S_VOICE_MGR *pVoiceMgr, EAS_I32 *pMixBuffer, EAS_I32 numSa
     // but where is its CC controller
 #if defined (_CC_REVERB)
     if (reverbProcess && pVoiceMgr->reverbModule.effectData != NULL) {
-        pVoiceMgr->reverbModule.effect->pfProcess(pVoiceMgr->reverbModule.effectData, pVoiceMgr->reverbSendBuffer, pVoiceMgr->reverbSendBuffer, numSamples);
-        for (EAS_INT i = 0; i < BUFFER_SIZE_IN_MONO_SAMPLES * NUM_OUTPUT_CHANNELS; i++) {
+        pVoiceMgr->reverbModule.effect->pfProcess32(pVoiceMgr->reverbModule.effectData, pVoiceMgr->reverbSendBuffer, pVoiceMgr->reverbSendBuffer, numSamples);
+        for (EAS_INT i = 0; i < numSamples * NUM_OUTPUT_CHANNELS; i++) {
             pMixBuffer[i] = pMixBuffer[i] + pVoiceMgr->reverbSendBuffer[i];
         }
     }
@@ -3183,6 +3896,11 @@ EAS_RESULT VMRender (S_VOICE_MGR *pVoiceMgr, EAS_I32 numSamples, EAS_I32 *pMixBu
             VMUpdateStaticChannelParameters(pVoiceMgr, pVoiceMgr->pSynth[i]);
     }
 
+#if defined(_REFERENCE_RENDER_PATHS) && defined(_WT_SYNTH) && defined(_FILTER_ENABLED) && defined(_FLOAT_DCF)
+    /* the render paths can change between buffers */
+    pVoiceMgr->filterBatch.fuseOutput = (pVoiceMgr->renderPaths & VM_PATH_FUSED_OUTPUT) ? EAS_TRUE : EAS_FALSE;
+#endif
+
     /* synthesize a buffer of audio */
     *pVoicesRendered = VMAddSamples(pVoiceMgr, pMixBuffer, numSamples);
 
@@ -3297,6 +4015,280 @@ EAS_BOOL VMCheckWorkload (S_VOICE_MGR *pVoiceMgr)
     return EAS_FALSE;
 }
 
+/*----------------------------------------------------------------------------
+ * VMSetRenderBudget()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Sets the time VMRender may take for a block, and restores the full
+ * polyphony.
+ *
+ * Inputs:
+ * pVoiceMgr            - pointer to instance data
+ * budget               - microseconds per block, 0 to turn the budget off
+ *
+ * Outputs:
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+void VMSetRenderBudget (S_VOICE_MGR *pVoiceMgr, EAS_I32 budget)
+{
+    pVoiceMgr->renderBudget = budget;
+    pVoiceMgr->budgetPolyphony = (EAS_U16) pVoiceMgr->numVoices;
+    pVoiceMgr->budgetHoldoff = 0;
+    pVoiceMgr->budgetOverruns = 0;
+    pVoiceMgr->renderTime = 0;
+    pVoiceMgr->renderOverhead = 0;
+    pVoiceMgr->renderVoiceCost = 0;
+    pVoiceMgr->lastVoicesRendered = 0;
+}
+
+/*----------------------------------------------------------------------------
+ * VMGetBudgetPolyphony()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the polyphony in effect, the lower of the polyphony setting and
+ * the polyphony the render time budget allows.
+ *
+ * Inputs:
+ * pVoiceMgr            - pointer to instance data
+ *
+ * Outputs:
+ * Returns the number of voices that may play
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+EAS_I32 VMGetBudgetPolyphony (S_VOICE_MGR *pVoiceMgr)
+{
+    if (pVoiceMgr->budgetPolyphony < pVoiceMgr->maxPolyphony)
+        return pVoiceMgr->budgetPolyphony;
+    return pVoiceMgr->maxPolyphony;
+}
+
+/*----------------------------------------------------------------------------
+ * VMMuteFirst()
+ *----------------------------------------------------------------------------
+ * Returns true if VMMuteQuietestVoices mutes the voice at position posA of
+ * the active voice list before the one at posB: the lower gain goes first,
+ * with stolen voices and voices that have not played yet last, then the
+ * lower position
+ *----------------------------------------------------------------------------
+*/
+static EAS_BOOL VMMuteFirst (const S_VOICE_MGR *pVoiceMgr, EAS_U16 posA, EAS_U16 posB)
+{
+    const S_SYNTH_VOICE *pVoice;
+    EAS_I32 gainA;
+    EAS_I32 gainB;
+
+    pVoice = &pVoiceMgr->voices[pVoiceMgr->activeVoiceList[posA]];
+    gainA = ((pVoice->voiceState == eVoiceStateStolen) || (pVoice->voiceFlags & VOICE_FLAG_NO_SAMPLES_SYNTHESIZED_YET)) ? 0x8000 : pVoice->gain;
+    pVoice = &pVoiceMgr->voices[pVoiceMgr->activeVoiceList[posB]];
+    gainB = ((pVoice->voiceState == eVoiceStateStolen) || (pVoice->voiceFlags & VOICE_FLAG_NO_SAMPLES_SYNTHESIZED_YET)) ? 0x8000 : pVoice->gain;
+    if (gainA != gainB)
+        return (gainA < gainB) ? EAS_TRUE : EAS_FALSE;
+    return (posA < posB) ? EAS_TRUE : EAS_FALSE;
+}
+
+/*----------------------------------------------------------------------------
+ * VMMuteQuietestVoices()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Mutes the voices with the lowest gain until no more than limit voices
+ * are playing. Stolen voices and voices that have not played yet go last.
+ * One pass over the active voices keeps the ones to mute in a heap with
+ * the loudest of them on top, so muting k of n voices takes O(n log k).
+ *
+ * Inputs:
+ * pVoiceMgr            - pointer to instance data
+ * limit                - number of voices that may keep playing
+ *
+ * Outputs:
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void VMMuteQuietestVoices (S_VOICE_MGR *pVoiceMgr, EAS_INT limit)
+{
+    EAS_U16 *pHeap = pVoiceMgr->muteHeap;
+    EAS_INT numToMute;
+    EAS_INT numHeap;
+    EAS_INT parent;
+    EAS_INT child;
+    EAS_U16 pos;
+
+    /* count the voices that are not already muting */
+    numToMute = -limit;
+    for (pos = 0; pos < pVoiceMgr->numActiveVoiceList; pos++)
+    {
+        if (pVoiceMgr->voices[pVoiceMgr->activeVoiceList[pos]].voiceState != eVoiceStateMuting)
+            numToMute++;
+    }
+    if (numToMute <= 0)
+        return;
+
+    numHeap = 0;
+    for (pos = 0; pos < pVoiceMgr->numActiveVoiceList; pos++)
+    {
+        if (pVoiceMgr->voices[pVoiceMgr->activeVoiceList[pos]].voiceState == eVoiceStateMuting)
+            continue;
+
+        /* add the voice while the heap is not full */
+        if (numHeap < numToMute)
+        {
+            for (child = numHeap++; child > 0; child = parent)
+            {
+                parent = (child - 1) >> 1;
+                if (VMMuteFirst(pVoiceMgr, pos, pHeap[parent]) == EAS_FALSE)
+                    break;
+                pHeap[child] = pHeap[parent];
+            }
+            pHeap[child] = pos;
+            continue;
+        }
+
+        /* or let it take the place of the loudest voice to mute if it goes first */
+        if (VMMuteFirst(pVoiceMgr, pos, pHeap[0]) == EAS_FALSE)
+            continue;
+        for (parent = 0; (child = 2 * parent + 1) < numHeap; parent = child)
+        {
+            if ((child + 1 < numHeap) && VMMuteFirst(pVoiceMgr, pHeap[child], pHeap[child + 1]))
+                child++;
+            if (VMMuteFirst(pVoiceMgr, pHeap[child], pos))
+                break;
+            pHeap[parent] = pHeap[child];
+        }
+        pHeap[parent] = pos;
+    }
+
+    /* muting a voice leaves it in its place in the active voice list */
+    while (numHeap > 0)
+        VMMuteVoice(pVoiceMgr, pVoiceMgr->activeVoiceList[pHeap[--numHeap]]);
+}
+
+/*----------------------------------------------------------------------------
+ * VMUpdateRenderBudget()
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Adjusts the polyphony to the time VMRender took for the last block.
+ *
+ * The time of a block that renders voices is modeled as a fixed part, for
+ * the channel updates and the effects, plus a cost per voice. The cost per
+ * voice is learned from the change in time between blocks that render a
+ * different number of voices. After RENDER_BUDGET_OVERRUNS consecutive
+ * blocks over budget, the polyphony drops to the number of voices the
+ * budget pays for and the quietest voices are muted, so a block or two
+ * delayed by the host does not cut voices. While there is room for
+ * another voice, the polyphony rises by one.
+ *
+ * Inputs:
+ * pVoiceMgr            - pointer to instance data
+ * renderTime           - microseconds VMRender took for the last block
+ * voicesRendered       - number of voices it rendered
+ *
+ * Outputs:
+ *
+ * Side Effects:
+ *
+ *----------------------------------------------------------------------------
+*/
+void VMUpdateRenderBudget (S_VOICE_MGR *pVoiceMgr, EAS_I32 renderTime, EAS_I32 voicesRendered)
+{
+    EAS_I32 budget;
+    EAS_I32 voiceCost;
+    EAS_I32 deltaVoices;
+    EAS_I32 limit;
+
+    if (pVoiceMgr->renderBudget <= 0)
+        return;
+
+    /* the voices muted by the last reduction still render while they fade out */
+    if (pVoiceMgr->budgetHoldoff)
+    {
+        pVoiceMgr->budgetHoldoff--;
+        pVoiceMgr->lastVoicesRendered = 0;
+        return;
+    }
+
+    /* a block the host preempted counts as twice the budget, so it does not skew the model */
+    budget = pVoiceMgr->renderBudget << RENDER_TIME_FRAC_BITS;
+    if ((renderTime < 0) || (renderTime > (pVoiceMgr->renderBudget << 1)))
+        renderTime = pVoiceMgr->renderBudget << 1;
+    renderTime <<= RENDER_TIME_FRAC_BITS;
+    pVoiceMgr->renderTime += (renderTime - pVoiceMgr->renderTime) >> RENDER_TIME_SMOOTHING;
+
+    /* count the blocks over the budget in a row */
+    if (renderTime > budget)
+    {
+        if (pVoiceMgr->budgetOverruns < RENDER_BUDGET_OVERRUNS)
+            pVoiceMgr->budgetOverruns++;
+    }
+    else
+        pVoiceMgr->budgetOverruns = 0;
+
+    /* the fixed part only applies to blocks that render voices */
+    if (voicesRendered <= 0)
+    {
+        pVoiceMgr->lastVoicesRendered = 0;
+        if (pVoiceMgr->budgetPolyphony < pVoiceMgr->numVoices)
+            pVoiceMgr->budgetPolyphony++;
+        return;
+    }
+
+    /* learn the cost per voice, it is no more than the average time per voice */
+    voiceCost = pVoiceMgr->renderTime / voicesRendered;
+    if ((pVoiceMgr->lastVoicesRendered > 0) && (pVoiceMgr->renderVoiceCost > 0))
+    {
+        deltaVoices = voicesRendered - pVoiceMgr->lastVoicesRendered;
+        if (deltaVoices != 0)
+        {
+            EAS_I32 sample = (renderTime - pVoiceMgr->lastRenderTime) / deltaVoices;
+            if (sample < 0)
+                sample = 0;
+            pVoiceMgr->renderVoiceCost += (sample - pVoiceMgr->renderVoiceCost) >> RENDER_TIME_SMOOTHING;
+        }
+    }
+    if ((pVoiceMgr->renderVoiceCost == 0) || (pVoiceMgr->renderVoiceCost > voiceCost))
+        pVoiceMgr->renderVoiceCost = voiceCost;
+    if (pVoiceMgr->renderVoiceCost < 1)
+        pVoiceMgr->renderVoiceCost = 1;
+    pVoiceMgr->lastRenderTime = renderTime;
+    pVoiceMgr->lastVoicesRendered = voicesRendered;
+
+    /* what remains of the time once the voices are paid for */
+    pVoiceMgr->renderOverhead += (renderTime - voicesRendered * pVoiceMgr->renderVoiceCost - pVoiceMgr->renderOverhead) >> RENDER_TIME_SMOOTHING;
+    if (pVoiceMgr->renderOverhead < 0)
+        pVoiceMgr->renderOverhead = 0;
+
+    if (pVoiceMgr->budgetOverruns >= RENDER_BUDGET_OVERRUNS)
+    {
+        /* as many voices as the budget pays for, at least one less than now */
+        limit = 0;
+        if (budget > pVoiceMgr->renderOverhead)
+            limit = (budget - pVoiceMgr->renderOverhead) / pVoiceMgr->renderVoiceCost;
+        if (limit >= voicesRendered)
+            limit = voicesRendered - 1;
+        if (limit >= pVoiceMgr->budgetPolyphony)
+            limit = pVoiceMgr->budgetPolyphony - 1;
+        if (limit < 1)
+            limit = 1;
+
+        pVoiceMgr->budgetPolyphony = (EAS_U16) limit;
+        VMMuteQuietestVoices(pVoiceMgr, limit);
+
+        /* expect the time of the remaining voices */
+        pVoiceMgr->renderTime = pVoiceMgr->renderOverhead + limit * pVoiceMgr->renderVoiceCost;
+        pVoiceMgr->budgetHoldoff = RENDER_BUDGET_HOLDOFF;
+        pVoiceMgr->budgetOverruns = 0;
+    }
+    else if ((pVoiceMgr->renderTime + pVoiceMgr->renderVoiceCost <= budget - (budget >> 3)) &&
+        (pVoiceMgr->budgetPolyphony < pVoiceMgr->numVoices))
+        pVoiceMgr->budgetPolyphony++;
+}
+
 /*----------------------------------------------------------------------------
  * VMActiveVoices()
  *----------------------------------------------------------------------------
@@ -3323,7 +4315,8 @@ EAS_I32 VMActiveVoices (S_SYNTH *pSynth)
  *----------------------------------------------------------------------------
  * Purpose:
  * Set the synth to a new polyphony value. Value must be >= 1 and
- * <= MAX_SYNTH_VOICES. This function will pin the polyphony at those limits
+ * <= the voice capacity of the instance. This function will pin the
+ * polyphony at those limits
  *
  * Inputs:
  * pVoiceMgr        pointer to synthesizer data
@@ -3350,16 +4343,16 @@ EAS_RESULT VMSetSynthPolyphony (S_VOICE_MGR *pVoiceMgr, EAS_I32 synth, EAS_I32 p
 #if defined(_HYBRID_SYNTH) || defined(EAS_SPLIT_WT_SYNTH)
     if (synth == EAS_MCU_SYNTH)
     {
-        if (polyphonyCount > NUM_PRIMARY_VOICES)
-            polyphonyCount = NUM_PRIMARY_VOICES;
+        if (polyphonyCount > pVoiceMgr->numPrimaryVoices)
+            polyphonyCount = pVoiceMgr->numPrimaryVoices;
         if (pVoiceMgr->maxPolyphonyPrimary == polyphonyCount)
             return EAS_SUCCESS;
         pVoiceMgr->maxPolyphonyPrimary = (EAS_U16) polyphonyCount;
     }
     else if (synth == EAS_DSP_SYNTH)
     {
-        if (polyphonyCount > NUM_SECONDARY_VOICES)
-            polyphonyCount = NUM_SECONDARY_VOICES;
+        if (polyphonyCount > pVoiceMgr->numVoices - pVoiceMgr->numPrimaryVoices)
+            polyphonyCount = pVoiceMgr->numVoices - pVoiceMgr->numPrimaryVoices;
         if (pVoiceMgr->maxPolyphonySecondary == polyphonyCount)
             return EAS_SUCCESS;
         pVoiceMgr->maxPolyphonySecondary = (EAS_U16) polyphonyCount;
@@ -3376,8 +4369,8 @@ EAS_RESULT VMSetSynthPolyphony (S_VOICE_MGR *pVoiceMgr, EAS_I32 synth, EAS_I32 p
         return EAS_ERROR_PARAMETER_RANGE;
 
     /* pin desired value to possible limits */
-    if (polyphonyCount > MAX_SYNTH_VOICES)
-        polyphonyCount = MAX_SYNTH_VOICES;
+    if (polyphonyCount > pVoiceMgr->numVoices)
+        polyphonyCount = pVoiceMgr->numVoices;
 
     /* set polyphony, if value is different than current value */
     if (pVoiceMgr->maxPolyphony == polyphonyCount)
@@ -3394,7 +4387,7 @@ EAS_RESULT VMSetSynthPolyphony (S_VOICE_MGR *pVoiceMgr, EAS_I32 synth, EAS_I32 p
             if (pVoiceMgr->pSynth[i]->synthFlags & SYNTH_FLAG_SP_MIDI_ON)
                 VMMIPUpdateChannelMuting(pVoiceMgr, pVoiceMgr->pSynth[i]);
             else
-                pVoiceMgr->pSynth[i]->poolAlloc[0] = (EAS_U8) polyphonyCount;
+                pVoiceMgr->pSynth[i]->poolAlloc[0] = (EAS_U16) polyphonyCount;
         }
     }
 
@@ -3404,7 +4397,7 @@ EAS_RESULT VMSetSynthPolyphony (S_VOICE_MGR *pVoiceMgr, EAS_I32 synth, EAS_I32 p
 
     /* count the number of active voices */
     activeVoices = 0;
-    for (i = 0; i < MAX_SYNTH_VOICES; i++)
+    for (i = 0; i < pVoiceMgr->numVoices; i++)
     {
 
         /* is voice active? */
@@ -3422,7 +4415,7 @@ EAS_RESULT VMSetSynthPolyphony (S_VOICE_MGR *pVoiceMgr, EAS_I32 synth, EAS_I32 p
 
         /* find the lowest priority voice */
         bestPriority = bestCandidate = -1;
-        for (i = 0; i < MAX_SYNTH_VOICES; i++)
+        for (i = 0; i < pVoiceMgr->numVoices; i++)
         {
 
             pVoice = &pVoiceMgr->voices[i];
@@ -3547,7 +4540,7 @@ EAS_RESULT VMSetPolyphony (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_I32 poly
         return EAS_ERROR_PARAMETER_RANGE;
 
     /* zero is max polyphony */
-    if ((polyphonyCount == 0) || (polyphonyCount > MAX_SYNTH_VOICES))
+    if ((polyphonyCount == 0) || (polyphonyCount > pVoiceMgr->numVoices))
     {
         pSynth->maxPolyphony = 0;
         return EAS_SUCCESS;
@@ -3564,7 +4557,7 @@ EAS_RESULT VMSetPolyphony (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_I32 poly
     if (pSynth->synthFlags & SYNTH_FLAG_SP_MIDI_ON)
         VMMIPUpdateChannelMuting(pVoiceMgr, pSynth);
     else
-        pSynth->poolAlloc[0] = (EAS_U8) polyphonyCount;
+        pSynth->poolAlloc[0] = (EAS_U16) polyphonyCount;
 
     /* are we under polyphony limit? */
     if (pSynth->numActiveVoices <= polyphonyCount)
@@ -3572,7 +4565,7 @@ EAS_RESULT VMSetPolyphony (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_I32 poly
 
     /* count the number of active voices */
     activeVoices = 0;
-    for (i = 0; i < MAX_SYNTH_VOICES; i++)
+    for (i = 0; i < pVoiceMgr->numVoices; i++)
     {
         /* this synth? */
         if (GET_VSYNTH(pVoiceMgr->voices[i].nextChannel) != pSynth->vSynthNum)
@@ -3592,7 +4585,7 @@ EAS_RESULT VMSetPolyphony (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_I32 poly
 
         /* find the lowest priority voice */
         bestPriority = bestCandidate = -1;
-        for (i = 0; i < MAX_SYNTH_VOICES; i++)
+        for (i = 0; i < pVoiceMgr->numVoices; i++)
         {
             pVoice = &pVoiceMgr->voices[i];
 
@@ -4063,7 +5056,12 @@ void VMShutdown (S_EAS_DATA *pEASData)
 
     /* check Configuration Module for static memory allocation */
     if (!pEASData->staticMemoryModel)
+    {
+        /* the block buffers and the voice arrays are single allocations starting at synthBuffer and voices */
+        EAS_HWFree(pEASData->hwInstData, pEASData->pVoiceMgr->synthBuffer);
+        EAS_HWFree(pEASData->hwInstData, pEASData->pVoiceMgr->voices);
         EAS_HWFree(pEASData->hwInstData, pEASData->pVoiceMgr);
+    }
     pEASData->pVoiceMgr = NULL;
 }
 
@@ -4180,7 +5178,7 @@ EAS_RESULT VMSanityCheck (EAS_DATA_HANDLE pEASData)
     freeVoices = activeVoices = playingVoices = stolenVoices = releasingVoices = mutingVoices = 0;
 
     /* iterate through all voices */
-    for (i = 0; i < MAX_SYNTH_VOICES; i++)
+    for (i = 0; i < pVoiceMgr->numVoices; i++)
     {
         pVoice = &pEASData->pVoiceMgr->voices[i];
         if (pVoice->voiceState != eVoiceStateFree)
@@ -4262,7 +5260,7 @@ EAS_RESULT VMSanityCheck (EAS_DATA_HANDLE pEASData)
             continue;
 
         { /* dpp: EAS_ReportEx(_EAS_SEVERITY_DETAIL, "Synth %d numActiveVoices: %d\n", i, pEASData->pVoiceMgr->pSynth[i]->numActiveVoices); */ }
-        if (pEASData->pVoiceMgr->pSynth[i]->numActiveVoices > MAX_SYNTH_VOICES)
+        if (pEASData->pVoiceMgr->pSynth[i]->numActiveVoices > pEASData->pVoiceMgr->numVoices)
         {
             { /* dpp: EAS_ReportEx(_EAS_SEVERITY_ERROR, "VMSanityCheck: Synth %d illegal count for numActiveVoices: %d\n", i, pEASData->pVoiceMgr->pSynth[i]->numActiveVoices); */ }
             result = EAS_FAILURE;
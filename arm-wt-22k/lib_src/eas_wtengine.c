@@ -104,16 +104,16 @@ void WT_VoiceGain (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame)
         ALOGE("b/26366256");
         android_errorWriteLog(0x534e4554, "26366256");
         return;
-    } else if (numSamples > BUFFER_SIZE_IN_MONO_SAMPLES) {
-        EAS_Report(_EAS_SEVERITY_ERROR, "%s: numSamples %d > %d BUFFER_SIZE_IN_MONO_SAMPLES\n", __func__, numSamples, BUFFER_SIZE_IN_MONO_SAMPLES);
-        ALOGE("b/317780080 clip numSamples %d -> %d", numSamples, BUFFER_SIZE_IN_MONO_SAMPLES);
+    } else if (numSamples > pWTIntFrame->controlPeriod) {
+        EAS_Report(_EAS_SEVERITY_ERROR, "%s: numSamples %d > %d controlPeriod\n", __func__, numSamples, pWTIntFrame->controlPeriod);
+        ALOGE("b/317780080 clip numSamples %d -> %d", numSamples, pWTIntFrame->controlPeriod);
         android_errorWriteLog(0x534e4554, "317780080");
-        numSamples = BUFFER_SIZE_IN_MONO_SAMPLES;
+        numSamples = pWTIntFrame->controlPeriod;
     }
     pMixBuffer = pWTIntFrame->pMixBuffer;
     pInputBuffer = pWTIntFrame->pAudioBuffer;
 
-    gainIncrement = (pWTIntFrame->frame.gainTarget - pWTIntFrame->prevGain) * (1 << 16) / BUFFER_SIZE_IN_MONO_SAMPLES;
+    gainIncrement = (pWTIntFrame->frame.gainTarget - pWTIntFrame->prevGain) * (1 << 16) / pWTIntFrame->controlPeriod;
     // EAS_Report(_EAS_SEVERITY_DETAIL, "%s: prevGain %ld, gainTarget %ld\n", __func__, (long)pWTIntFrame->prevGain, (long)pWTIntFrame->frame.gainTarget);
     if (gainIncrement < 0)
         gainIncrement++;
@@ -146,6 +146,41 @@ void WT_VoiceGain (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame)
 }
 #endif
 
+#if defined(_SIMD_KERNELS) && !defined(_OPTIMIZED_MONO)
+/* largest phase increment handed to a kernel, keeps its phase sums in 31 bits */
+#define WT_KERNEL_MAX_PHASE_INC     (1L << 24)
+#define WT_KERNEL_MAX_PHASE         (1L << 30)
+
+/*----------------------------------------------------------------------------
+ * WT_KernelRun
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns how many outputs the interpolator produces from pSamples before
+ * it advances to a sample whose successor is at or past pEnd, that is the
+ * number of outputs a kernel can produce without loop or end checks.
+ *
+ * Inputs:
+ *
+ * Outputs:
+ * At least 1 and at most numSamples
+ *----------------------------------------------------------------------------
+*/
+static EAS_I32 WT_KernelRun (const EAS_SAMPLE *pSamples, const EAS_SAMPLE *pEnd, EAS_I32 phaseFrac, EAS_I32 phaseInc, EAS_I32 numSamples)
+{
+    int64_t limit;
+    int64_t count;
+
+    /* output n reads the samples at (phaseFrac + n * phaseInc) >> NUM_PHASE_FRAC_BITS */
+    limit = ((int64_t) (pEnd - pSamples - 1) << NUM_PHASE_FRAC_BITS) - phaseFrac;
+    if (limit <= 0)
+        return 1;
+    if (limit > WT_KERNEL_MAX_PHASE)
+        limit = WT_KERNEL_MAX_PHASE;
+    count = (limit - 1) / phaseInc + 1;
+    return (count < numSamples) ? (EAS_I32) count : numSamples;
+}
+#endif
+
 #if !defined(NATIVE_EAS_KERNEL) || defined(_16_BIT_SAMPLES)
 /*----------------------------------------------------------------------------
  * WT_Interpolate
@@ -178,11 +213,11 @@ void WT_Interpolate (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame)
         ALOGE("b/26366256");
         android_errorWriteLog(0x534e4554, "26366256");
         return;
-    } else if (numSamples > BUFFER_SIZE_IN_MONO_SAMPLES) {
-        EAS_Report(_EAS_SEVERITY_ERROR, "%s: numSamples %d > %d BUFFER_SIZE_IN_MONO_SAMPLES\n", __func__, numSamples, BUFFER_SIZE_IN_MONO_SAMPLES);
-        ALOGE("b/317780080 clip numSamples %d -> %d", numSamples, BUFFER_SIZE_IN_MONO_SAMPLES);
+    } else if (numSamples > pWTIntFrame->controlPeriod) {
+        EAS_Report(_EAS_SEVERITY_ERROR, "%s: numSamples %d > %d controlPeriod\n", __func__, numSamples, pWTIntFrame->controlPeriod);
+        ALOGE("b/317780080 clip numSamples %d -> %d", numSamples, pWTIntFrame->controlPeriod);
         android_errorWriteLog(0x534e4554, "317780080");
-        numSamples = BUFFER_SIZE_IN_MONO_SAMPLES;
+        numSamples = pWTIntFrame->controlPeriod;
     }
     pOutputBuffer = pWTIntFrame->pAudioBuffer;
 
@@ -192,6 +227,34 @@ void WT_Interpolate (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame)
     phaseFrac = pWTVoice->phaseFrac & PHASE_FRAC_MASK;
     phaseInc = pWTIntFrame->frame.phaseIncrement;
 
+#if defined(_SIMD_KERNELS) && !defined(_OPTIMIZED_MONO)
+    /* vector kernel between loop wraps */
+    if ((pWTIntFrame->pfInterpolate != NULL) && (phaseInc > 0) && (phaseInc < WT_KERNEL_MAX_PHASE_INC))
+    {
+        while (numSamples > 0)
+        {
+            EAS_I32 count = WT_KernelRun(pSamples, loopEnd, phaseFrac, phaseInc, numSamples);
+            pWTIntFrame->pfInterpolate(pSamples, phaseFrac, phaseInc, pOutputBuffer, count);
+            pOutputBuffer += count;
+            numSamples -= count;
+
+            /* advance past the run, wrapping like the C loop below */
+            phaseFrac += phaseInc * count;
+            if (phaseFrac >> NUM_PHASE_FRAC_BITS)
+            {
+                pSamples += phaseFrac >> NUM_PHASE_FRAC_BITS;
+                phaseFrac = phaseFrac & PHASE_FRAC_MASK;
+                while (&pSamples[1] >= loopEnd) {
+                    pSamples -= (loopEnd - pWTVoice->loopStart);
+                }
+            }
+        }
+        pWTVoice->phaseAccum = pSamples;
+        pWTVoice->phaseFrac = (EAS_U32) phaseFrac;
+        return;
+    }
+#endif
+
     /* fetch adjacent samples */
 #if defined(_8_BIT_SAMPLES)
     /*lint -e{701} <avoid multiply for performance>*/
@@ -285,11 +348,11 @@ void WT_InterpolateNoLoop (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame)
         ALOGE("b/26366256");
         android_errorWriteLog(0x534e4554, "26366256");
         return;
-    } else if (numSamples > BUFFER_SIZE_IN_MONO_SAMPLES) {
-        EAS_Report(_EAS_SEVERITY_ERROR, "%s: numSamples %d > %d BUFFER_SIZE_IN_MONO_SAMPLES\n", __func__, numSamples, BUFFER_SIZE_IN_MONO_SAMPLES);
-        ALOGE("b/317780080 clip numSamples %d -> %d", numSamples, BUFFER_SIZE_IN_MONO_SAMPLES);
+    } else if (numSamples > pWTIntFrame->controlPeriod) {
+        EAS_Report(_EAS_SEVERITY_ERROR, "%s: numSamples %d > %d controlPeriod\n", __func__, numSamples, pWTIntFrame->controlPeriod);
+        ALOGE("b/317780080 clip numSamples %d -> %d", numSamples, pWTIntFrame->controlPeriod);
         android_errorWriteLog(0x534e4554, "317780080");
-        numSamples = BUFFER_SIZE_IN_MONO_SAMPLES;
+        numSamples = pWTIntFrame->controlPeriod;
     }
     pOutputBuffer = pWTIntFrame->pAudioBuffer;
 
@@ -298,6 +361,40 @@ void WT_InterpolateNoLoop (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame)
     pSamples = pWTVoice->phaseAccum;
     phaseFrac = (EAS_I32)(pWTVoice->phaseFrac & PHASE_FRAC_MASK);
 
+#if defined(_SIMD_KERNELS) && !defined(_OPTIMIZED_MONO)
+    /* vector kernel up to the end of the sample */
+    if ((pWTIntFrame->pfInterpolate != NULL) && (phaseInc > 0) && (phaseInc < WT_KERNEL_MAX_PHASE_INC))
+    {
+        while (numSamples > 0)
+        {
+            EAS_I32 count = WT_KernelRun(pSamples, bufferEndP1, phaseFrac, phaseInc, numSamples);
+            EAS_I32 nextSamplePhaseInc;
+            pWTIntFrame->pfInterpolate(pSamples, phaseFrac, phaseInc, pOutputBuffer, count);
+            pOutputBuffer += count;
+            numSamples -= count;
+
+            /* move to the last output of the run */
+            phaseFrac += phaseInc * (count - 1);
+            pSamples += phaseFrac >> NUM_PHASE_FRAC_BITS;
+            phaseFrac = (EAS_I32)((EAS_U32)phaseFrac & PHASE_FRAC_MASK);
+
+            /* then step like the C loop below, stopping at the end */
+            phaseFrac += phaseInc;
+            nextSamplePhaseInc = phaseFrac >> NUM_PHASE_FRAC_BITS;
+            if (nextSamplePhaseInc > 0) {
+                if ( &pSamples[nextSamplePhaseInc+1] >= bufferEndP1) {
+                    break;
+                }
+                pSamples += nextSamplePhaseInc;
+                phaseFrac = (EAS_I32)((EAS_U32)phaseFrac & PHASE_FRAC_MASK);
+            }
+        }
+        pWTVoice->phaseAccum = pSamples;
+        pWTVoice->phaseFrac = phaseFrac;
+        return;
+    }
+#endif
+
     /* fetch adjacent samples */
 #if defined(_8_BIT_SAMPLES)
     /*lint -e{701} <avoid multiply for performance>*/
@@ -398,11 +495,11 @@ void WT_InterpolateNoLoop (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame)
         ALOGE("b/26366256");
         android_errorWriteLog(0x534e4554, "26366256");
         return;
-    } else if (numSamples > BUFFER_SIZE_IN_MONO_SAMPLES) {
-        EAS_Report(_EAS_SEVERITY_ERROR, "%s: numSamples %d > %d BUFFER_SIZE_IN_MONO_SAMPLES\n", __func__, numSamples, BUFFER_SIZE_IN_MONO_SAMPLES);
-        ALOGE("b/317780080 clip numSamples %d -> %d", numSamples, BUFFER_SIZE_IN_MONO_SAMPLES);
+    } else if (numSamples > pWTIntFrame->controlPeriod) {
+        EAS_Report(_EAS_SEVERITY_ERROR, "%s: numSamples %d > %d controlPeriod\n", __func__, numSamples, pWTIntFrame->controlPeriod);
+        ALOGE("b/317780080 clip numSamples %d -> %d", numSamples, pWTIntFrame->controlPeriod);
         android_errorWriteLog(0x534e4554, "317780080");
-        numSamples = BUFFER_SIZE_IN_MONO_SAMPLES;
+        numSamples = pWTIntFrame->controlPeriod;
     }
     pOutputBuffer = pWTIntFrame->pAudioBuffer;
     phaseInc = pWTIntFrame->frame.phaseIncrement;
@@ -434,47 +531,20 @@ void WT_InterpolateNoLoop (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame)
 
 #ifndef _OPTIMIZED_MONO
 /*----------------------------------------------------------------------------
- * WT_ProcessVoice
+ * WT_VoiceOutput
  *----------------------------------------------------------------------------
  * Purpose:
- * This routine does the block processing for one voice. It is isolated
- * from the main synth code to allow for various implementation-specific
- * optimizations. It calls the interpolator, filter, and gain routines
- * appropriate for a particular configuration.
+ * Applies the gain to the filtered samples of a voice and writes them to
+ * its mix buffer
  *
  * Inputs:
  *
  * Outputs:
  *
- * Notes:
  *----------------------------------------------------------------------------
 */
-void WT_ProcessVoice (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame)
+static void WT_VoiceOutput (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame)
 {
-
-    /* use noise generator */
-    if (pWTVoice->loopStart == WT_NOISE_GENERATOR)
-        WT_NoiseGenerator(pWTVoice, pWTIntFrame);
-
-    /* generate interpolated samples for looped waves */
-    else if (pWTVoice->loopStart != pWTVoice->loopEnd)
-        WT_Interpolate(pWTVoice, pWTIntFrame);
-
-    /* generate interpolated samples for unlooped waves */
-    else
-    {
-        WT_InterpolateNoLoop(pWTVoice, pWTIntFrame);
-    }
-
-#ifdef _FILTER_ENABLED
-#ifdef _FLOAT_DCF
-    if (pWTIntFrame->frame.b02 != 0.0f)
-#else
-    if (pWTIntFrame->frame.k != 0)
-#endif
-        { WT_VoiceFilter(&pWTVoice->filter, pWTIntFrame); }
-#endif
-
 //2 TEST NEW MIXER FUNCTION
 #ifdef UNIFIED_MIXER
     {
@@ -485,11 +555,11 @@ void WT_ProcessVoice (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame)
 #endif
 
         gainLeft = (pWTIntFrame->prevGain * pWTVoice->gainLeft) << 1;
-        gainIncLeft = (((pWTIntFrame->frame.gainTarget * pWTVoice->gainLeft) << 1) - gainLeft) >> SYNTH_UPDATE_PERIOD_IN_BITS;
+        gainIncLeft = (((pWTIntFrame->frame.gainTarget * pWTVoice->gainLeft) << 1) - gainLeft) >> pWTIntFrame->controlPeriodBits;
 
 #if (NUM_OUTPUT_CHANNELS == 2)
         gainRight = (pWTIntFrame->prevGain * pWTVoice->gainRight) << 1;
-        gainIncRight = (((pWTIntFrame->frame.gainTarget * pWTVoice->gainRight) << 1) - gainRight) >> SYNTH_UPDATE_PERIOD_IN_BITS;
+        gainIncRight = (((pWTIntFrame->frame.gainTarget * pWTVoice->gainRight) << 1) - gainRight) >> pWTIntFrame->controlPeriodBits;
         EAS_MixStream(
             pWTIntFrame->pAudioBuffer,
             pWTIntFrame->pMixBuffer,
@@ -518,6 +588,504 @@ void WT_ProcessVoice (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame)
     WT_VoiceGain(pWTVoice, pWTIntFrame);
 #endif
 }
+
+/* the kinds of wave a voice kernel interpolates */
+#define WT_KIND_NOISE       0
+#define WT_KIND_LOOP        1
+#define WT_KIND_NO_LOOP     2
+
+#if defined(_VOICE_PARALLEL) && defined(_FILTER_ENABLED) && !defined(UNIFIED_MIXER)
+/*----------------------------------------------------------------------------
+ * WT_JoinVoiceBatch
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Puts a filtered voice in the batch of its kind of kernel, where it waits
+ * to be rendered with the other voices of the batch. Only voices whose
+ * filter is not bypassed and that render the whole control period with a
+ * phase increment the SIMD interpolator takes can join.
+ *
+ * Inputs:
+ * kind - WT_KIND_LOOP or WT_KIND_NO_LOOP
+ *
+ * Outputs:
+ * EAS_TRUE if the voice joined a batch
+ *----------------------------------------------------------------------------
+*/
+static EAS_BOOL WT_JoinVoiceBatch (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame, EAS_INT kind)
+{
+    S_WT_VOICE_BATCH *pBatch;
+    S_WT_VOICE_LANES *pLanes;
+    EAS_I32 phaseInc;
+    EAS_INT lane;
+
+    phaseInc = pWTIntFrame->frame.phaseIncrement;
+    if ((pWTIntFrame->frame.b02 == 0.0f) || (pWTIntFrame->pVoiceBatches == NULL) ||
+        (phaseInc <= 0) || (phaseInc >= WT_KERNEL_MAX_PHASE_INC) ||
+        (pWTIntFrame->numSamples != pWTIntFrame->controlPeriod))
+        return EAS_FALSE;
+
+    pBatch = &pWTIntFrame->pVoiceBatches[(kind == WT_KIND_LOOP) ? WT_VOICE_BATCH_LOOP : WT_VOICE_BATCH_NO_LOOP];
+    pLanes = &pBatch->lanes;
+    lane = pBatch->numLanes;
+
+    /* the state of the voice goes into its lane */
+    pLanes->pSamples[lane] = pWTVoice->phaseAccum;
+    pLanes->pLoopStart[lane] = pWTVoice->loopStart;
+    pLanes->pLoopEnd[lane] = pWTVoice->loopEnd + 1;
+    pLanes->phaseFrac[lane] = (EAS_I32) (pWTVoice->phaseFrac & PHASE_FRAC_MASK);
+    pLanes->phaseInc[lane] = phaseInc;
+    pLanes->active[lane] = EAS_TRUE;
+
+    /* gain ramp of WT_VoiceGain */
+    pLanes->gainIncrement[lane] = (pWTIntFrame->frame.gainTarget - pWTIntFrame->prevGain) * (1 << 16) / pWTIntFrame->controlPeriod;
+    if (pLanes->gainIncrement[lane] < 0)
+        pLanes->gainIncrement[lane]++;
+    pLanes->gain[lane] = pWTIntFrame->prevGain * (1 << 16);
+#if (NUM_OUTPUT_CHANNELS == 2)
+    pLanes->panGains[lane * 2] = pWTVoice->gainLeft;
+    pLanes->panGains[lane * 2 + 1] = pWTVoice->gainRight;
+#endif
+
+    pLanes->pMixBuffers[lane] = pWTIntFrame->pMixBuffer;
+
+    /* filter delay values and coefficients */
+    pLanes->y1[lane] = pWTVoice->filter.y1;
+    pLanes->y2[lane] = pWTVoice->filter.y2;
+    pLanes->x1[lane] = pWTVoice->filter.x1;
+    pLanes->x2[lane] = pWTVoice->filter.x2;
+    pLanes->b1[lane] = pWTIntFrame->frame.b1;
+    pLanes->b02[lane] = pWTIntFrame->frame.b02;
+    pLanes->a1[lane] = pWTIntFrame->frame.a1;
+    pLanes->a2[lane] = pWTIntFrame->frame.a2;
+
+    pBatch->pWTVoices[lane] = pWTVoice;
+    pBatch->numSamples = pWTIntFrame->numSamples;
+    if (++pBatch->numLanes == WT_FILTER_LANES)
+        WT_RenderBatch(pBatch);
+    return EAS_TRUE;
+}
+#endif
+
+/*----------------------------------------------------------------------------
+ * WT_RenderVoice
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Calls the interpolator, filter, and gain routines for one voice. The
+ * voice kernels call it with constant arguments, so each one is compiled
+ * without the branches on the kind of wave and the filter.
+ *
+ * Inputs:
+ * kind - WT_KIND_NOISE, WT_KIND_LOOP or WT_KIND_NO_LOOP
+ * filtered - the voice has a filter, its coefficients may still bypass it
+ *
+ * Outputs:
+ *
+ * Notes:
+ * With a filter batch, a filtered voice is interpolated into a lane of the
+ * batch and WT_FilterBatch finishes it.
+ * With voice batches, a filtered voice that renders the whole control
+ * period waits in the batch of its kind of kernel instead, and
+ * WT_RenderBatch renders it.
+ *----------------------------------------------------------------------------
+*/
+EAS_INLINE void WT_RenderVoice (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame, EAS_INT kind, EAS_BOOL filtered)
+{
+#if defined(_FILTER_ENABLED) && defined(_FLOAT_DCF)
+    S_WT_FILTER_BATCH *pBatch;
+
+#if defined(_VOICE_PARALLEL) && !defined(UNIFIED_MIXER)
+    /* wait for the other voices with the same kind of kernel */
+    if (filtered && (kind != WT_KIND_NOISE) && WT_JoinVoiceBatch(pWTVoice, pWTIntFrame, kind))
+        return;
+#endif
+
+    pBatch = filtered ? pWTIntFrame->pFilterBatch : NULL;
+    if ((pBatch != NULL) && (pWTIntFrame->frame.b02 != 0.0f) &&
+        (pWTIntFrame->numSamples > 0) && (pWTIntFrame->numSamples <= pWTIntFrame->controlPeriod))
+        pWTIntFrame->pAudioBuffer = pBatch->pBuffers + pBatch->numLanes * pWTIntFrame->controlPeriod;
+    else
+        pBatch = NULL;
+#endif
+
+    /* use noise generator */
+    if (kind == WT_KIND_NOISE)
+        WT_NoiseGenerator(pWTVoice, pWTIntFrame);
+
+    /* generate interpolated samples for looped waves */
+    else if (kind == WT_KIND_LOOP)
+        WT_Interpolate(pWTVoice, pWTIntFrame);
+
+    /* generate interpolated samples for unlooped waves */
+    else
+    {
+        WT_InterpolateNoLoop(pWTVoice, pWTIntFrame);
+    }
+
+#ifdef _FILTER_ENABLED
+    if (filtered)
+    {
+#ifdef _FLOAT_DCF
+        /* wait for the other voices of the group */
+        if (pBatch != NULL)
+        {
+            pBatch->pWTVoices[pBatch->numLanes] = pWTVoice;
+            pBatch->intFrames[pBatch->numLanes] = *pWTIntFrame;
+            if (++pBatch->numLanes == WT_FILTER_LANES)
+                WT_FilterBatch(pBatch);
+            return;
+        }
+        if (pWTIntFrame->frame.b02 != 0.0f)
+#else
+        if (pWTIntFrame->frame.k != 0)
+#endif
+            { WT_VoiceFilter(&pWTVoice->filter, pWTIntFrame); }
+    }
+#endif
+
+    WT_VoiceOutput(pWTVoice, pWTIntFrame);
+}
+
+/* the voice kernels */
+static void WT_ProcessNoise (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame)
+{
+    WT_RenderVoice(pWTVoice, pWTIntFrame, WT_KIND_NOISE, EAS_FALSE);
+}
+
+static void WT_ProcessLoop (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame)
+{
+    WT_RenderVoice(pWTVoice, pWTIntFrame, WT_KIND_LOOP, EAS_FALSE);
+}
+
+static void WT_ProcessNoLoop (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame)
+{
+    WT_RenderVoice(pWTVoice, pWTIntFrame, WT_KIND_NO_LOOP, EAS_FALSE);
+}
+
+#ifdef _FILTER_ENABLED
+static void WT_ProcessNoiseFilter (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame)
+{
+    WT_RenderVoice(pWTVoice, pWTIntFrame, WT_KIND_NOISE, EAS_TRUE);
+}
+
+static void WT_ProcessLoopFilter (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame)
+{
+    WT_RenderVoice(pWTVoice, pWTIntFrame, WT_KIND_LOOP, EAS_TRUE);
+}
+
+static void WT_ProcessNoLoopFilter (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame)
+{
+    WT_RenderVoice(pWTVoice, pWTIntFrame, WT_KIND_NO_LOOP, EAS_TRUE);
+}
+#endif
+
+/*----------------------------------------------------------------------------
+ * WT_SelectVoiceKernel
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the kernel for a voice whose wave has been set up
+ *
+ * Inputs:
+ * pWTVoice - voice, loopStart and loopEnd give the kind of wave
+ * filtered - the articulation of the voice uses the filter
+ *
+ * Outputs:
+ * Kernel
+ *----------------------------------------------------------------------------
+*/
+WT_VOICE_KERNEL WT_SelectVoiceKernel (const S_WT_VOICE *pWTVoice, EAS_BOOL filtered)
+{
+#ifdef _FILTER_ENABLED
+    if (filtered)
+    {
+        if (pWTVoice->loopStart == WT_NOISE_GENERATOR)
+            return WT_ProcessNoiseFilter;
+        if (pWTVoice->loopStart != pWTVoice->loopEnd)
+            return WT_ProcessLoopFilter;
+        return WT_ProcessNoLoopFilter;
+    }
+#else
+    (void) filtered;
+#endif
+
+    if (pWTVoice->loopStart == WT_NOISE_GENERATOR)
+        return WT_ProcessNoise;
+    if (pWTVoice->loopStart != pWTVoice->loopEnd)
+        return WT_ProcessLoop;
+    return WT_ProcessNoLoop;
+}
+
+#if defined(_FILTER_ENABLED) && defined(_FLOAT_DCF)
+/*----------------------------------------------------------------------------
+ * WT_FilterBatch
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Filters the voices waiting in the batch together and finishes them
+ *
+ * Inputs:
+ * pBatch - batch to empty
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void WT_FilterBatch (S_WT_FILTER_BATCH *pBatch)
+{
+    S_FILTER_CONTROL *pFilters[WT_FILTER_LANES];
+    S_WT_INT_FRAME *pIntFrames[WT_FILTER_LANES];
+    S_WT_INT_FRAME spareFrame;
+    S_WT_INT_FRAME tailFrame;
+    EAS_I16 panGains[WT_FILTER_LANES * 2];
+    EAS_BOOL fused;
+    EAS_I32 numSamples;
+    EAS_INT lane;
+
+    if (pBatch->numLanes == 0)
+        return;
+
+    /* the lanes run together up to the shortest voice */
+    numSamples = pBatch->intFrames[0].numSamples;
+    for (lane = 1; lane < pBatch->numLanes; lane++)
+    {
+        if (pBatch->intFrames[lane].numSamples < numSamples)
+            numSamples = pBatch->intFrames[lane].numSamples;
+    }
+
+    /* when all the voices are as long, the gain and pan run in the filter loop */
+#ifdef UNIFIED_MIXER
+    fused = EAS_FALSE;
+#else
+#if defined(_REFERENCE_RENDER_PATHS)
+    fused = pBatch->fuseOutput;
+#else
+    fused = EAS_TRUE;
+#endif
+    for (lane = 0; lane < pBatch->numLanes; lane++)
+    {
+        if (pBatch->intFrames[lane].numSamples != numSamples)
+            fused = EAS_FALSE;
+    }
+#endif
+
+    /* the unused lanes filter the buffer of the last lane, which is free, into the spare mix buffer */
+    spareFrame = pBatch->intFrames[0];
+    spareFrame.pAudioBuffer = pBatch->pBuffers + (WT_FILTER_LANES - 1) * spareFrame.controlPeriod;
+    spareFrame.pMixBuffer = pBatch->pSpareMix;
+    for (lane = 0; lane < WT_FILTER_LANES; lane++)
+    {
+        if (lane < pBatch->numLanes)
+        {
+            pFilters[lane] = &pBatch->pWTVoices[lane]->filter;
+            pIntFrames[lane] = &pBatch->intFrames[lane];
+#if (NUM_OUTPUT_CHANNELS == 2)
+            panGains[lane * 2] = pBatch->pWTVoices[lane]->gainLeft;
+            panGains[lane * 2 + 1] = pBatch->pWTVoices[lane]->gainRight;
+#endif
+        }
+        else
+        {
+            pFilters[lane] = &pBatch->spareFilter;
+            pIntFrames[lane] = &spareFrame;
+            panGains[lane * 2] = 0;
+            panGains[lane * 2 + 1] = 0;
+        }
+    }
+
+    if (fused)
+    {
+        if (numSamples > 0)
+            WT_VoiceFilterLanes(pFilters, pIntFrames, panGains, numSamples);
+        pBatch->numLanes = 0;
+        return;
+    }
+    WT_VoiceFilterLanes(pFilters, pIntFrames, NULL, numSamples);
+    for (lane = 0; lane < pBatch->numLanes; lane++)
+    {
+        /* filter the rest of the longer voices on their own */
+        if (pBatch->intFrames[lane].numSamples > numSamples)
+        {
+            tailFrame = pBatch->intFrames[lane];
+            tailFrame.pAudioBuffer += numSamples;
+            tailFrame.numSamples -= numSamples;
+            WT_VoiceFilter(pFilters[lane], &tailFrame);
+        }
+        WT_VoiceOutput(pBatch->pWTVoices[lane], &pBatch->intFrames[lane]);
+    }
+    pBatch->numLanes = 0;
+}
+#endif
+
+#if defined(_VOICE_PARALLEL)
+/*----------------------------------------------------------------------------
+ * WT_RenderLanes
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Renders the voices of a group together, one voice per SIMD lane.
+ * A looped lane wraps inside the block when its phase from the current
+ * sample to the loop end fits the kernel. Otherwise the lanes run in blocks
+ * up to the first boundary of such a lane, which then steps over it like
+ * WT_Interpolate and WT_InterpolateNoLoop, so the outputs are identical.
+ *
+ * Inputs:
+ * pLanes - state of the lanes, a lane that is not active outputs silence
+ * numSamples - samples to render in every lane
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+static void WT_RenderLanes (S_WT_VOICE_LANES *pLanes, EAS_I32 numSamples)
+{
+    static const EAS_SAMPLE silence[2] = { 0, 0 };
+    S_WT_LANE_BLOCK block;
+    const EAS_SAMPLE *pSamples;
+    EAS_I32 nextSamplePhaseInc;
+    EAS_I32 count;
+    EAS_I32 run;
+    EAS_I32 offset;
+    EAS_INT lane;
+
+    for (offset = 0; offset < numSamples; offset += count)
+    {
+        /* the lanes run together up to the first boundary they cannot wrap over */
+        count = numSamples - offset;
+        for (lane = 0; lane < WT_FILTER_LANES; lane++)
+        {
+            block.phaseLimit[lane] = 0x7fffffff;
+            block.loopLength[lane] = 0;
+            if (!pLanes->active[lane])
+            {
+                block.pSources[lane] = silence;
+                block.phase[lane] = 0;
+                block.phaseInc[lane] = 0;
+                continue;
+            }
+
+            pSamples = pLanes->pSamples[lane];
+            block.pSources[lane] = pSamples;
+            block.phase[lane] = pLanes->phaseFrac[lane];
+            block.phaseInc[lane] = pLanes->phaseInc[lane];
+            if (pLanes->looped &&
+                (pLanes->pLoopEnd[lane] - pSamples > 1) &&
+                (pLanes->pLoopEnd[lane] - pSamples <= (WT_KERNEL_MAX_PHASE >> NUM_PHASE_FRAC_BITS)) &&
+                (pLanes->pLoopEnd[lane] - pLanes->pLoopStart[lane] <= (WT_KERNEL_MAX_PHASE >> NUM_PHASE_FRAC_BITS)) &&
+                (pLanes->phaseInc[lane] < (EAS_I32) (pLanes->pLoopEnd[lane] - pLanes->pLoopStart[lane]) << NUM_PHASE_FRAC_BITS))
+            {
+                /* wraps when the sample after it is at the loop end, like WT_Interpolate */
+                block.phaseLimit[lane] = (EAS_I32) (pLanes->pLoopEnd[lane] - pSamples - 1) << NUM_PHASE_FRAC_BITS;
+                block.loopLength[lane] = (EAS_I32) (pLanes->pLoopEnd[lane] - pLanes->pLoopStart[lane]) << NUM_PHASE_FRAC_BITS;
+                continue;
+            }
+
+            run = WT_KernelRun(pSamples, pLanes->pLoopEnd[lane], pLanes->phaseFrac[lane], pLanes->phaseInc[lane], count);
+            if (run < count)
+                count = run;
+        }
+        WT_RenderLanesBlock(&block, pLanes, offset, count);
+
+        /* advance the lanes past the block */
+        for (lane = 0; lane < WT_FILTER_LANES; lane++)
+        {
+            if (!pLanes->active[lane])
+                continue;
+            pSamples = pLanes->pSamples[lane];
+
+            if (block.loopLength[lane] != 0)
+            {
+                /* the lane has already wrapped */
+                pSamples += block.phase[lane] >> NUM_PHASE_FRAC_BITS;
+                pLanes->phaseFrac[lane] = block.phase[lane] & PHASE_FRAC_MASK;
+            }
+            else if (pLanes->looped)
+            {
+                /* wrap like WT_Interpolate */
+                pLanes->phaseFrac[lane] += pLanes->phaseInc[lane] * count;
+                if (pLanes->phaseFrac[lane] >> NUM_PHASE_FRAC_BITS)
+                {
+                    pSamples += pLanes->phaseFrac[lane] >> NUM_PHASE_FRAC_BITS;
+                    pLanes->phaseFrac[lane] &= PHASE_FRAC_MASK;
+                    while (&pSamples[1] >= pLanes->pLoopEnd[lane]) {
+                        pSamples -= (pLanes->pLoopEnd[lane] - pLanes->pLoopStart[lane]);
+                    }
+                }
+            }
+            else
+            {
+                /* move to the last output of the block, then step like WT_InterpolateNoLoop */
+                pLanes->phaseFrac[lane] += pLanes->phaseInc[lane] * (count - 1);
+                pSamples += pLanes->phaseFrac[lane] >> NUM_PHASE_FRAC_BITS;
+                pLanes->phaseFrac[lane] = (EAS_I32)((EAS_U32)pLanes->phaseFrac[lane] & PHASE_FRAC_MASK);
+
+                pLanes->phaseFrac[lane] += pLanes->phaseInc[lane];
+                nextSamplePhaseInc = pLanes->phaseFrac[lane] >> NUM_PHASE_FRAC_BITS;
+                if (nextSamplePhaseInc > 0) {
+                    /* the lane stops at the end of the sample */
+                    if ( &pSamples[nextSamplePhaseInc+1] >= pLanes->pLoopEnd[lane]) {
+                        pLanes->pSamples[lane] = pSamples;
+                        pLanes->active[lane] = EAS_FALSE;
+                        continue;
+                    }
+                    pSamples += nextSamplePhaseInc;
+                    pLanes->phaseFrac[lane] = (EAS_I32)((EAS_U32)pLanes->phaseFrac[lane] & PHASE_FRAC_MASK);
+                }
+            }
+            pLanes->pSamples[lane] = pSamples;
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------
+ * WT_RenderBatch
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Renders the voices waiting in the batch together: the interpolator, the
+ * filter, and the gain and pan, each in SIMD lanes
+ *
+ * Inputs:
+ * pBatch - batch to empty
+ *
+ * Outputs:
+ *
+ *----------------------------------------------------------------------------
+*/
+void WT_RenderBatch (S_WT_VOICE_BATCH *pBatch)
+{
+    S_WT_VOICE_LANES *pLanes;
+    EAS_INT lane;
+
+    if (pBatch->numLanes == 0)
+        return;
+    pLanes = &pBatch->lanes;
+
+    /* the unused lanes are silent */
+    for (lane = pBatch->numLanes; lane < WT_FILTER_LANES; lane++)
+    {
+        pLanes->active[lane] = EAS_FALSE;
+        pLanes->gain[lane] = 0;
+        pLanes->gainIncrement[lane] = 0;
+        pLanes->panGains[lane * 2] = 0;
+        pLanes->panGains[lane * 2 + 1] = 0;
+        pLanes->pMixBuffers[lane] = pBatch->pSpareMix;
+        pLanes->y1[lane] = pLanes->y2[lane] = pLanes->x1[lane] = pLanes->x2[lane] = 0;
+        pLanes->b1[lane] = pLanes->b02[lane] = pLanes->a1[lane] = pLanes->a2[lane] = 0.0f;
+    }
+
+    WT_RenderLanes(pLanes, pBatch->numSamples);
+
+    /* save pointer, phase and filter delay values */
+    for (lane = 0; lane < pBatch->numLanes; lane++)
+    {
+        S_WT_VOICE *pWTVoice = pBatch->pWTVoices[lane];
+
+        pWTVoice->phaseAccum = pLanes->pSamples[lane];
+        pWTVoice->phaseFrac = (EAS_U32) pLanes->phaseFrac[lane];
+        pWTVoice->filter.y1 = pLanes->y1[lane];
+        pWTVoice->filter.y2 = pLanes->y2[lane];
+        pWTVoice->filter.x1 = pLanes->x1[lane];
+        pWTVoice->filter.x2 = pLanes->x2[lane];
+    }
+    pBatch->numLanes = 0;
+}
+#endif
 #endif
 
 #if defined(_OPTIMIZED_MONO) && !defined(NATIVE_EAS_KERNEL)
@@ -556,16 +1124,16 @@ void WT_InterpolateMono (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame)
         ALOGE("b/26366256");
         android_errorWriteLog(0x534e4554, "26366256");
         return;
-    } else if (numSamples > BUFFER_SIZE_IN_MONO_SAMPLES) {
-        EAS_Report(_EAS_SEVERITY_ERROR, "%s: numSamples %d > %d BUFFER_SIZE_IN_MONO_SAMPLES\n", __func__, numSamples, BUFFER_SIZE_IN_MONO_SAMPLES);
-        ALOGE("b/317780080 clip numSamples %d -> %d", numSamples, BUFFER_SIZE_IN_MONO_SAMPLES);
+    } else if (numSamples > pWTIntFrame->controlPeriod) {
+        EAS_Report(_EAS_SEVERITY_ERROR, "%s: numSamples %d > %d controlPeriod\n", __func__, numSamples, pWTIntFrame->controlPeriod);
+        ALOGE("b/317780080 clip numSamples %d -> %d", numSamples, pWTIntFrame->controlPeriod);
         android_errorWriteLog(0x534e4554, "317780080");
-        numSamples = BUFFER_SIZE_IN_MONO_SAMPLES;
+        numSamples = pWTIntFrame->controlPeriod;
     }
     pMixBuffer = pWTIntFrame->pMixBuffer;
 
     /* calculate gain increment */
-    gainIncrement = (pWTIntFrame->gainTarget - pWTIntFrame->prevGain) * (1 << (16 - SYNTH_UPDATE_PERIOD_IN_BITS));
+    gainIncrement = (pWTIntFrame->gainTarget - pWTIntFrame->prevGain) * (1 << (16 - pWTIntFrame->controlPeriodBits));
     if (gainIncrement < 0)
         gainIncrement++;
     gain = pWTIntFrame->prevGain * (1 << 16);
@@ -596,7 +1164,7 @@ InterpolationLoop:
     currentPhaseFrac = tmp2 & PHASE_FRAC_MASK;
 
     gain += gainIncrement;
-    tmp2 = (gain >> SYNTH_UPDATE_PERIOD_IN_BITS);
+    tmp2 = (gain >> pWTIntFrame->controlPeriodBits);
 
     tmp0 = *pMixBuffer;
     tmp2 = tmp1 * tmp2;
@@ -611,7 +1179,7 @@ InterpolationLoop:
     pWTVoice->pPhaseAccum = pCurrentPhaseInt;
     pWTVoice->phaseFrac = currentPhaseFrac;
     /*lint -e{702} <avoid divide>*/
-    pWTVoice->gain = (EAS_I16)(gain >> SYNTH_UPDATE_PERIOD_IN_BITS);
+    pWTVoice->gain = (EAS_I16)(gain >> pWTIntFrame->controlPeriodBits);
 }
 #endif
 
@@ -650,5 +1218,18 @@ void WT_ProcessVoice (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame)
         WT_InterpolateMono(pWTVoice, pWTIntFrame);
     }
 }
+
+/*----------------------------------------------------------------------------
+ * WT_SelectVoiceKernel
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * The optimized mono engine has a single kernel
+ *----------------------------------------------------------------------------
+*/
+/*lint -esym(715, pWTVoice, filtered) not used in this configuration */
+WT_VOICE_KERNEL WT_SelectVoiceKernel (const S_WT_VOICE *pWTVoice, EAS_BOOL filtered)
+{
+    return WT_ProcessVoice;
+}
 #endif
 
@@ -54,6 +54,15 @@
  *----------------------------------------------------------------------------
 */
 
+/*----------------------------------------------------------------------------
+ * WT_INTERPOLATE_KERNEL
+ *
+ * Interpolates numSamples outputs starting at pSamples, without loop or end
+ * checks. The caller limits numSamples so no output reads past the loop end.
+ *----------------------------------------------------------------------------
+*/
+typedef void (*WT_INTERPOLATE_KERNEL) (const EAS_SAMPLE *pSamples, EAS_I32 phaseFrac, EAS_I32 phaseInc, EAS_PCM *pOutput, EAS_I32 numSamples);
+
 /*----------------------------------------------------------------------------
  * S_WT_INT_FRAME
  *
@@ -68,9 +77,31 @@ typedef struct s_wt_int_frame_tag
     EAS_I32         *pMixBuffer;
     EAS_I32         numSamples;
     EAS_I32         prevGain;
+    EAS_I32         controlPeriod;      /* samples per update, length of the gain ramp */
+    EAS_I32         controlPeriodBits;  /* controlPeriod = 2^controlPeriodBits */
+    EAS_I32         pitchOffset;        /* output sample rate correction in cents */
+    WT_INTERPOLATE_KERNEL pfInterpolate; /* SIMD interpolator, NULL for the C loop */
+#if defined(_FILTER_ENABLED) && defined(_FLOAT_DCF)
+    const S_FILTER_TABLE *pFilterTable; /* filter coefficient table of the voice manager */
+    struct s_wt_filter_batch_tag *pFilterBatch; /* batch the filter joins, NULL to filter at once */
+#endif
+#if defined(_VOICE_PARALLEL)
+    struct s_wt_voice_batch_tag *pVoiceBatches; /* batches by kind of kernel, NULL to render at once */
+#endif
 } S_WT_INT_FRAME;
 
 
+/*----------------------------------------------------------------------------
+ * WT_VOICE_KERNEL
+ *
+ * Renders one control period of a voice: the interpolator for its kind of
+ * wave, the filter if it has one, and the gain. WT_SelectVoiceKernel picks
+ * one for each voice when it starts.
+ *----------------------------------------------------------------------------
+*/
+struct s_wt_voice_tag;
+typedef void (*WT_VOICE_KERNEL) (struct s_wt_voice_tag *pWTVoice, S_WT_INT_FRAME *pWTIntFrame);
+
 /*------------------------------------
  * S_LFO_CONTROL data structure
  *------------------------------------
@@ -126,6 +157,7 @@ typedef struct s_wt_voice_tag
         EAS_I32 prngTmp0;
     };
     EAS_U32             phaseFrac;              /* fractional portion of phase */
+    WT_VOICE_KERNEL     pfProcess;              /* renders the voice, set when it starts */
 
 #if (NUM_OUTPUT_CHANNELS == 2)
     EAS_I16             gainLeft;               /* current gain, left ch  */
@@ -154,12 +186,123 @@ typedef struct s_wt_voice_tag
 
 } S_WT_VOICE;
 
+#if defined(_FILTER_ENABLED) && defined(_FLOAT_DCF)
+/*----------------------------------------------------------------------------
+ * S_WT_FILTER_BATCH
+ *
+ * Filtered voices wait here between the interpolator and the filter, so
+ * that WT_FilterBatch can run the filters of a group of voices together.
+ * Each lane has a voice buffer of controlPeriod samples. The lanes that no
+ * voice uses write their output to the spare mix buffer.
+ *----------------------------------------------------------------------------
+*/
+typedef struct s_wt_filter_batch_tag
+{
+    EAS_PCM             *pBuffers;                      /* WT_FILTER_LANES voice buffers */
+    EAS_I32             *pSpareMix;                     /* mix buffer of the unused lanes */
+    EAS_INT             numLanes;                       /* voices waiting */
+#if defined(_REFERENCE_RENDER_PATHS)
+    EAS_BOOL            fuseOutput;                     /* gain and pan may run in the filter loop */
+#endif
+    S_WT_VOICE          *pWTVoices[WT_FILTER_LANES];
+    S_WT_INT_FRAME      intFrames[WT_FILTER_LANES];
+    S_FILTER_CONTROL    spareFilter;                    /* state of the unused lanes */
+} S_WT_FILTER_BATCH;
+#endif
+
+#if defined(_VOICE_PARALLEL)
+/* the voice batches, one for each kind of filtered kernel */
+#define WT_VOICE_BATCH_LOOP             0
+#define WT_VOICE_BATCH_NO_LOOP          1
+#define WT_NUM_VOICE_BATCHES            2
+
+/*----------------------------------------------------------------------------
+ * S_WT_VOICE_LANES
+ *
+ * The hot state of a group of voices as a structure of arrays, one voice
+ * per lane, so the interpolator, the filter and the gain of the group run
+ * in SIMD lanes.
+ *----------------------------------------------------------------------------
+*/
+typedef struct s_wt_voice_lanes_tag
+{
+    const EAS_SAMPLE    *pSamples[WT_FILTER_LANES];     /* integer part of the phase */
+    const EAS_SAMPLE    *pLoopStart[WT_FILTER_LANES];
+    const EAS_SAMPLE    *pLoopEnd[WT_FILTER_LANES];     /* one sample past the loop end */
+    EAS_I32             phaseFrac[WT_FILTER_LANES];
+    EAS_I32             phaseInc[WT_FILTER_LANES];
+    EAS_I32             gain[WT_FILTER_LANES];          /* gain ramp, 16 fractional bits */
+    EAS_I32             gainIncrement[WT_FILTER_LANES];
+    EAS_I16             panGains[WT_FILTER_LANES * 2];  /* left and right gain */
+    EAS_I32             *pMixBuffers[WT_FILTER_LANES];
+
+    /* filter delay values and coefficients, see WT_VoiceFilter */
+    EAS_I32             y1[WT_FILTER_LANES];
+    EAS_I32             y2[WT_FILTER_LANES];
+    EAS_I32             x1[WT_FILTER_LANES];
+    EAS_I32             x2[WT_FILTER_LANES];
+    float               b1[WT_FILTER_LANES];
+    float               b02[WT_FILTER_LANES];
+    float               a1[WT_FILTER_LANES];
+    float               a2[WT_FILTER_LANES];
+
+    EAS_BOOL            active[WT_FILTER_LANES];        /* the lane has not reached the end of its sample */
+    EAS_BOOL            looped;
+} S_WT_VOICE_LANES;
+
+/*----------------------------------------------------------------------------
+ * S_WT_LANE_BLOCK
+ *
+ * Where each lane interpolates in a block of outputs. The phase is a fixed
+ * point position from pSources, and drops by loopLength when it reaches
+ * phaseLimit, so looped lanes wrap inside the block.
+ *----------------------------------------------------------------------------
+*/
+typedef struct s_wt_lane_block_tag
+{
+    const EAS_SAMPLE    *pSources[WT_FILTER_LANES];
+    EAS_I32             phase[WT_FILTER_LANES];
+    EAS_I32             phaseInc[WT_FILTER_LANES];
+    EAS_I32             phaseLimit[WT_FILTER_LANES];
+    EAS_I32             loopLength[WT_FILTER_LANES];
+} S_WT_LANE_BLOCK;
+
+/*----------------------------------------------------------------------------
+ * S_WT_VOICE_BATCH
+ *
+ * Filtered voices that render a whole control period with the same kind
+ * of kernel wait here, so that WT_RenderBatch can render them together
+ * straight to their mix buffers. The lanes that no voice uses write to the
+ * spare mix buffer.
+ *----------------------------------------------------------------------------
+*/
+typedef struct s_wt_voice_batch_tag
+{
+    S_WT_VOICE_LANES    lanes;
+    EAS_I32             *pSpareMix;                     /* mix buffer of the unused lanes */
+    EAS_INT             numLanes;                       /* voices waiting */
+    EAS_I32             numSamples;
+    S_WT_VOICE          *pWTVoices[WT_FILTER_LANES];
+} S_WT_VOICE_BATCH;
+#endif
+
 /*----------------------------------------------------------------------------
  * prototypes
  *----------------------------------------------------------------------------
 */
 EAS_BOOL WT_CheckSampleEnd (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame, EAS_BOOL update);
+#if defined(_OPTIMIZED_MONO)
 void WT_ProcessVoice (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame);
+#endif
+WT_VOICE_KERNEL WT_SelectVoiceKernel (const S_WT_VOICE *pWTVoice, EAS_BOOL filtered);
+WT_INTERPOLATE_KERNEL WT_SelectInterpolateKernel (void);
+#if defined(_FILTER_ENABLED) && defined(_FLOAT_DCF)
+void WT_FilterBatch (S_WT_FILTER_BATCH *pBatch);
+#endif
+#if defined(_VOICE_PARALLEL)
+void WT_RenderBatch (S_WT_VOICE_BATCH *pBatch);
+void WT_RenderLanesBlock (S_WT_LANE_BLOCK *pBlock, S_WT_VOICE_LANES *pLanes, EAS_I32 offset, EAS_I32 numSamples);
+#endif
 
 #ifdef EAS_SPLIT_WT_SYNTH
 void WTE_ConfigVoice (EAS_I32 voiceNum, S_WT_CONFIG *pWTConfig, EAS_FRAME_BUFFER_HANDLE pFrameBuffer);
@@ -0,0 +1,426 @@
+// SIMD wavetable interpolation kernels
+//
+// Each kernel computes the phase of a group of outputs at once, fetches the
+// sample pair under each phase and interpolates them in parallel. They do no
+// loop or end checks: WT_Interpolate and WT_InterpolateNoLoop only pass them
+// runs of outputs that stay before the loop end, and handle the boundary with
+// the C code.
+//
+// The results are bit-identical to the C interpolator. With f the phase
+// fraction, s1 + (((s2 - s1) * f) >> 15) equals
+// (s1 * (32767 - f) + s2 * f + s1) >> 15, which is a single multiply-add of
+// the sample pair as it is stored in memory.
+//
+// The kernel is chosen when an instance is initialized, by the features of
+// the CPU it runs on, so generic builds still use AVX2 where available.
+
+#include "eas_options.h"
+#include "eas_types.h"
+#include "eas_math.h"
+#include "eas_wtengine.h"
+
+#include <string.h>
+
+#if defined(_SIMD_KERNELS)
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define WT_SSE2
+#endif
+#define WT_AVX2
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#if defined(__GNUC__) || defined(__clang__)
+#define WT_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define WT_TARGET_AVX2
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define WT_NEON
+#include <arm_neon.h>
+#endif
+
+/* one output of the C interpolator */
+#define WT_INTERPOLATE_ONE(pSamples, phase) \
+    (EAS_PCM) ((pSamples)[(phase) >> NUM_PHASE_FRAC_BITS] + \
+    ((((pSamples)[((phase) >> NUM_PHASE_FRAC_BITS) + 1] - (pSamples)[(phase) >> NUM_PHASE_FRAC_BITS]) * \
+    ((phase) & (EAS_I32) PHASE_FRAC_MASK)) >> NUM_PHASE_FRAC_BITS))
+
+/* the sample pair at pSamples, s1 in the low half on little-endian CPUs */
+static EAS_I32 WT_LoadPair (const EAS_SAMPLE *pSamples)
+{
+    EAS_I32 pair;
+    memcpy(&pair, pSamples, sizeof(pair));
+    return pair;
+}
+
+#if defined(WT_SSE2)
+/*----------------------------------------------------------------------------
+ * WT_InterpolateSSE2
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Four outputs per iteration
+ *----------------------------------------------------------------------------
+*/
+static void WT_InterpolateSSE2 (const EAS_SAMPLE *pSamples, EAS_I32 phaseFrac, EAS_I32 phaseInc, EAS_PCM *pOutput, EAS_I32 numSamples)
+{
+    const __m128i fracMask = _mm_set1_epi32((EAS_I32) PHASE_FRAC_MASK);
+    const __m128i fracOne = _mm_set1_epi32((EAS_I32) PHASE_FRAC_MASK);
+    const __m128i step = _mm_set1_epi32(phaseInc * 4);
+    __m128i phase;
+    __m128i pairs;
+    __m128i frac;
+    __m128i coefs;
+    __m128i acc;
+    EAS_I32 index[4];
+    EAS_I32 n;
+
+    phase = _mm_setr_epi32(phaseFrac, phaseFrac + phaseInc, phaseFrac + phaseInc * 2, phaseFrac + phaseInc * 3);
+    for (n = 0; n + 4 <= numSamples; n += 4)
+    {
+        _mm_storeu_si128((__m128i *) index, _mm_srli_epi32(phase, NUM_PHASE_FRAC_BITS));
+        pairs = _mm_setr_epi32(WT_LoadPair(&pSamples[index[0]]), WT_LoadPair(&pSamples[index[1]]),
+                               WT_LoadPair(&pSamples[index[2]]), WT_LoadPair(&pSamples[index[3]]));
+
+        /* (32767 - f) in the low half and f in the high half of each lane */
+        frac = _mm_and_si128(phase, fracMask);
+        coefs = _mm_or_si128(_mm_slli_epi32(frac, 16), _mm_sub_epi32(fracOne, frac));
+
+        acc = _mm_madd_epi16(pairs, coefs);
+        acc = _mm_add_epi32(acc, _mm_srai_epi32(_mm_slli_epi32(pairs, 16), 16));
+        acc = _mm_srai_epi32(acc, NUM_PHASE_FRAC_BITS);
+        _mm_storel_epi64((__m128i *) &pOutput[n], _mm_packs_epi32(acc, acc));
+
+        phase = _mm_add_epi32(phase, step);
+    }
+
+    for (phaseFrac += phaseInc * n; n < numSamples; n++, phaseFrac += phaseInc)
+        pOutput[n] = WT_INTERPOLATE_ONE(pSamples, phaseFrac);
+}
+#endif
+
+#if defined(WT_AVX2)
+/*----------------------------------------------------------------------------
+ * WT_InterpolateAVX2
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Eight outputs per iteration, the sample pairs are gathered
+ *----------------------------------------------------------------------------
+*/
+static WT_TARGET_AVX2 void WT_InterpolateAVX2 (const EAS_SAMPLE *pSamples, EAS_I32 phaseFrac, EAS_I32 phaseInc, EAS_PCM *pOutput, EAS_I32 numSamples)
+{
+    const __m256i fracMask = _mm256_set1_epi32((EAS_I32) PHASE_FRAC_MASK);
+    const __m256i fracOne = _mm256_set1_epi32((EAS_I32) PHASE_FRAC_MASK);
+    const __m256i step = _mm256_set1_epi32(phaseInc * 8);
+    __m256i phase;
+    __m256i pairs;
+    __m256i frac;
+    __m256i coefs;
+    __m256i acc;
+    EAS_I32 n;
+
+    phase = _mm256_add_epi32(_mm256_set1_epi32(phaseFrac),
+                             _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(phaseInc)));
+    for (n = 0; n + 8 <= numSamples; n += 8)
+    {
+        pairs = _mm256_i32gather_epi32((const int *) pSamples, _mm256_srli_epi32(phase, NUM_PHASE_FRAC_BITS), sizeof(EAS_SAMPLE));
+
+        /* (32767 - f) in the low half and f in the high half of each lane */
+        frac = _mm256_and_si256(phase, fracMask);
+        coefs = _mm256_or_si256(_mm256_slli_epi32(frac, 16), _mm256_sub_epi32(fracOne, frac));
+
+        acc = _mm256_madd_epi16(pairs, coefs);
+        acc = _mm256_add_epi32(acc, _mm256_srai_epi32(_mm256_slli_epi32(pairs, 16), 16));
+        acc = _mm256_srai_epi32(acc, NUM_PHASE_FRAC_BITS);
+        _mm_storeu_si128((__m128i *) &pOutput[n],
+                         _mm_packs_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1)));
+
+        phase = _mm256_add_epi32(phase, step);
+    }
+
+    for (phaseFrac += phaseInc * n; n < numSamples; n++, phaseFrac += phaseInc)
+        pOutput[n] = WT_INTERPOLATE_ONE(pSamples, phaseFrac);
+}
+
+/* AVX2 needs support from both the CPU and the OS */
+static EAS_BOOL WT_HasAVX2 (void)
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return EAS_FALSE;
+    __cpuid(info, 1);
+    /* OSXSAVE and AVX, then the OS saves the YMM registers */
+    if ((info[2] & 0x18000000) != 0x18000000)
+        return EAS_FALSE;
+    if ((_xgetbv(0) & 6) != 6)
+        return EAS_FALSE;
+    __cpuidex(info, 7, 0);
+    return (info[1] & 0x20) ? EAS_TRUE : EAS_FALSE;
+#elif defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? EAS_TRUE : EAS_FALSE;
+#else
+    return EAS_FALSE;
+#endif
+}
+#endif
+
+#if defined(WT_NEON)
+/*----------------------------------------------------------------------------
+ * WT_InterpolateNEON
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Four outputs per iteration
+ *----------------------------------------------------------------------------
+*/
+static void WT_InterpolateNEON (const EAS_SAMPLE *pSamples, EAS_I32 phaseFrac, EAS_I32 phaseInc, EAS_PCM *pOutput, EAS_I32 numSamples)
+{
+    const int32x4_t fracMask = vdupq_n_s32((EAS_I32) PHASE_FRAC_MASK);
+    const int32x4_t step = vdupq_n_s32(phaseInc * 4);
+    const EAS_I32 lanes[4] = { 0, 1, 2, 3 };
+    int32x4_t phase;
+    int32x4_t acc;
+    int16x4_t samp1;
+    int16x4_t samp2;
+    EAS_I32 index[4];
+    EAS_I32 n;
+
+    phase = vmlaq_s32(vdupq_n_s32(phaseFrac), vld1q_s32(lanes), vdupq_n_s32(phaseInc));
+    samp1 = samp2 = vdup_n_s16(0);
+    for (n = 0; n + 4 <= numSamples; n += 4)
+    {
+        vst1q_s32(index, vshrq_n_s32(phase, NUM_PHASE_FRAC_BITS));
+        samp1 = vld1_lane_s16(&pSamples[index[0]], samp1, 0);
+        samp1 = vld1_lane_s16(&pSamples[index[1]], samp1, 1);
+        samp1 = vld1_lane_s16(&pSamples[index[2]], samp1, 2);
+        samp1 = vld1_lane_s16(&pSamples[index[3]], samp1, 3);
+        samp2 = vld1_lane_s16(&pSamples[index[0] + 1], samp2, 0);
+        samp2 = vld1_lane_s16(&pSamples[index[1] + 1], samp2, 1);
+        samp2 = vld1_lane_s16(&pSamples[index[2] + 1], samp2, 2);
+        samp2 = vld1_lane_s16(&pSamples[index[3] + 1], samp2, 3);
+
+        acc = vmulq_s32(vsubl_s16(samp2, samp1), vandq_s32(phase, fracMask));
+        acc = vaddq_s32(vmovl_s16(samp1), vshrq_n_s32(acc, NUM_PHASE_FRAC_BITS));
+        vst1_s16(&pOutput[n], vmovn_s32(acc));
+
+        phase = vaddq_s32(phase, step);
+    }
+
+    for (phaseFrac += phaseInc * n; n < numSamples; n++, phaseFrac += phaseInc)
+        pOutput[n] = WT_INTERPOLATE_ONE(pSamples, phaseFrac);
+}
+#endif
+
+#if defined(_VOICE_PARALLEL)
+#if defined(WT_SSE2)
+/* low 32 bits of the lane products, which are the same signed or unsigned */
+static __m128i WT_MulLanesSSE2 (__m128i a, __m128i b)
+{
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+#endif
+
+/*----------------------------------------------------------------------------
+ * WT_RenderLanesBlock
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Renders outputs offset to offset + numSamples - 1 of a group of voices,
+ * one voice per lane, without end checks. Each output is interpolated,
+ * goes through the filter of WT_VoiceFilter, then through the gain ramp
+ * and the pan of WT_VoiceGain to the mix buffer of its lane, all in
+ * registers.
+ *
+ * The filter does the same float operations in the same order as
+ * WT_VoiceFilter, and its recurrence is what bounds the loop, so the
+ * interpolation and the gain run in its shadow.
+ *
+ * Inputs:
+ * pBlock - where each lane interpolates
+ * pLanes - filters, buffers and gains of the lanes
+ *
+ * Outputs:
+ * The phases, the filters and the gain ramps of the lanes are advanced
+ *----------------------------------------------------------------------------
+*/
+void WT_RenderLanesBlock (S_WT_LANE_BLOCK *pBlock, S_WT_VOICE_LANES *pLanes, EAS_I32 offset, EAS_I32 numSamples)
+{
+    const EAS_SAMPLE **pSources = pBlock->pSources;
+    EAS_I32 n;
+
+#if defined(WT_SSE2)
+    const __m128i fracMask = _mm_set1_epi32((EAS_I32) PHASE_FRAC_MASK);
+    const __m128i fracOne = _mm_set1_epi32((EAS_I32) PHASE_FRAC_MASK);
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i step = _mm_loadu_si128((const __m128i *) pBlock->phaseInc);
+    const __m128i limit = _mm_sub_epi32(_mm_loadu_si128((const __m128i *) pBlock->phaseLimit), one);
+    const __m128i loopLength = _mm_loadu_si128((const __m128i *) pBlock->loopLength);
+    const __m128i gainInc = _mm_loadu_si128((const __m128i *) pLanes->gainIncrement);
+    const __m128 b1 = _mm_loadu_ps(pLanes->b1);
+    const __m128 b02 = _mm_loadu_ps(pLanes->b02);
+    const __m128 a1 = _mm_loadu_ps(pLanes->a1);
+    const __m128 a2 = _mm_loadu_ps(pLanes->a2);
+    const __m128 upper = _mm_set1_ps((1 << 15) - 1);
+    const __m128 lower = _mm_set1_ps(-(1 << 15));
+    __m128i phase = _mm_loadu_si128((const __m128i *) pBlock->phase);
+    __m128i gains = _mm_loadu_si128((const __m128i *) pLanes->gain);
+    __m128i y1 = _mm_loadu_si128((const __m128i *) pLanes->y1);
+    __m128i y2 = _mm_loadu_si128((const __m128i *) pLanes->y2);
+    __m128i x1 = _mm_loadu_si128((const __m128i *) pLanes->x1);
+    __m128i x2 = _mm_loadu_si128((const __m128i *) pLanes->x2);
+#if (NUM_OUTPUT_CHANNELS == 2)
+    const __m128i gainLeft = _mm_setr_epi32(pLanes->panGains[0], pLanes->panGains[2], pLanes->panGains[4], pLanes->panGains[6]);
+    const __m128i gainRight = _mm_setr_epi32(pLanes->panGains[1], pLanes->panGains[3], pLanes->panGains[5], pLanes->panGains[7]);
+    __m128i left;
+    __m128i right;
+    __m128i pair;
+#else
+    EAS_I32 out[WT_FILTER_LANES];
+    EAS_INT lane;
+#endif
+    __m128i pairs;
+    __m128i frac;
+    __m128i acc;
+    __m128i smp;
+    __m128 acc0;
+    EAS_I32 index[WT_FILTER_LANES];
+
+    for (n = offset; n < offset + numSamples; n++)
+    {
+        _mm_storeu_si128((__m128i *) index, _mm_srai_epi32(phase, NUM_PHASE_FRAC_BITS));
+        pairs = _mm_setr_epi32(WT_LoadPair(&pSources[0][index[0]]), WT_LoadPair(&pSources[1][index[1]]),
+                               WT_LoadPair(&pSources[2][index[2]]), WT_LoadPair(&pSources[3][index[3]]));
+
+        /* (32767 - f) in the low half and f in the high half of each lane */
+        frac = _mm_and_si128(phase, fracMask);
+        acc = _mm_madd_epi16(pairs, _mm_or_si128(_mm_slli_epi32(frac, 16), _mm_sub_epi32(fracOne, frac)));
+        acc = _mm_add_epi32(acc, _mm_srai_epi32(_mm_slli_epi32(pairs, 16), 16));
+        acc = _mm_srai_epi32(acc, NUM_PHASE_FRAC_BITS);
+
+        /* next phase, wrapped back by the loop length at the limit */
+        phase = _mm_add_epi32(phase, step);
+        phase = _mm_sub_epi32(phase, _mm_and_si128(_mm_cmpgt_epi32(phase, limit), loopLength));
+
+        acc0 = _mm_mul_ps(b02, _mm_cvtepi32_ps(acc));
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(b1, _mm_cvtepi32_ps(x1)));
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(b02, _mm_cvtepi32_ps(x2)));
+        acc0 = _mm_sub_ps(acc0, _mm_mul_ps(a1, _mm_cvtepi32_ps(y1)));
+        acc0 = _mm_sub_ps(acc0, _mm_mul_ps(a2, _mm_cvtepi32_ps(y2)));
+
+        // saturate
+        acc0 = _mm_max_ps(_mm_min_ps(acc0, upper), lower);
+
+        y2 = y1;
+        y1 = _mm_cvttps_epi32(acc0);
+        x2 = x1;
+        x1 = acc;
+        acc = y1;
+
+        /* incremental gain step, gain / (1 << 16) rounds toward zero */
+        gains = _mm_add_epi32(gains, gainInc);
+        smp = _mm_add_epi32(gains, _mm_srli_epi32(_mm_srai_epi32(gains, 31), 16));
+        smp = _mm_srai_epi32(WT_MulLanesSSE2(acc, _mm_srai_epi32(smp, 16)), 15);
+
+#if (NUM_OUTPUT_CHANNELS == 2)
+        /* left and right channels, two lanes per store */
+        left = _mm_srai_epi32(WT_MulLanesSSE2(smp, gainLeft), NUM_EG1_FRAC_BITS);
+        right = _mm_srai_epi32(WT_MulLanesSSE2(smp, gainRight), NUM_EG1_FRAC_BITS);
+        pair = _mm_unpacklo_epi32(left, right);
+        _mm_storel_epi64((__m128i *) &pLanes->pMixBuffers[0][n * 2], pair);
+        _mm_storel_epi64((__m128i *) &pLanes->pMixBuffers[1][n * 2], _mm_srli_si128(pair, 8));
+        pair = _mm_unpackhi_epi32(left, right);
+        _mm_storel_epi64((__m128i *) &pLanes->pMixBuffers[2][n * 2], pair);
+        _mm_storel_epi64((__m128i *) &pLanes->pMixBuffers[3][n * 2], _mm_srli_si128(pair, 8));
+#else
+        /* mono output */
+        _mm_storeu_si128((__m128i *) out, smp);
+        for (lane = 0; lane < WT_FILTER_LANES; lane++)
+            pLanes->pMixBuffers[lane][n] = out[lane];
+#endif
+    }
+    _mm_storeu_si128((__m128i *) pBlock->phase, phase);
+    _mm_storeu_si128((__m128i *) pLanes->gain, gains);
+    _mm_storeu_si128((__m128i *) pLanes->y1, y1);
+    _mm_storeu_si128((__m128i *) pLanes->y2, y2);
+    _mm_storeu_si128((__m128i *) pLanes->x1, x1);
+    _mm_storeu_si128((__m128i *) pLanes->x2, x2);
+
+#else
+    /* other CPUs, NEON included, render the lanes one after the other */
+    const float limit = 1 << 15;
+    EAS_INT lane;
+
+    for (lane = 0; lane < WT_FILTER_LANES; lane++)
+    {
+        EAS_I32 phase = pBlock->phase[lane];
+        EAS_I32 smp;
+        float acc0;
+
+        for (n = offset; n < offset + numSamples; n++)
+        {
+            smp = WT_INTERPOLATE_ONE(pSources[lane], phase);
+            phase += pBlock->phaseInc[lane];
+            if (phase >= pBlock->phaseLimit[lane])
+                phase -= pBlock->loopLength[lane];
+
+            acc0 = pLanes->b02[lane] * smp + pLanes->b1[lane] * pLanes->x1[lane] + pLanes->b02[lane] * pLanes->x2[lane] -
+                   pLanes->a1[lane] * pLanes->y1[lane] - pLanes->a2[lane] * pLanes->y2[lane];
+
+            // saturate
+            if (acc0 > limit - 1) acc0 = limit - 1;
+            if (acc0 < -limit) acc0 = -limit;
+
+            pLanes->y2[lane] = pLanes->y1[lane];
+            pLanes->y1[lane] = (EAS_I32) acc0;
+            pLanes->x2[lane] = pLanes->x1[lane];
+            pLanes->x1[lane] = smp;
+            smp = pLanes->y1[lane];
+
+            pLanes->gain[lane] += pLanes->gainIncrement[lane];
+            smp = FMUL_15x15(smp, pLanes->gain[lane] / (1 << 16));
+#if (NUM_OUTPUT_CHANNELS == 2)
+            pLanes->pMixBuffers[lane][n * 2] = MULT_EG1_EG1(smp, pLanes->panGains[lane * 2]);
+            pLanes->pMixBuffers[lane][n * 2 + 1] = MULT_EG1_EG1(smp, pLanes->panGains[lane * 2 + 1]);
+#else
+            pLanes->pMixBuffers[lane][n] = smp;
+#endif
+        }
+        pBlock->phase[lane] = phase;
+    }
+#endif
+}
+#endif
+
+#endif /* _SIMD_KERNELS */
+
+/*----------------------------------------------------------------------------
+ * WT_SelectInterpolateKernel
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Returns the fastest interpolation kernel the CPU supports
+ *
+ * Outputs:
+ * Kernel, or NULL to use the C interpolator
+ *----------------------------------------------------------------------------
+*/
+WT_INTERPOLATE_KERNEL WT_SelectInterpolateKernel (void)
+{
+#if defined(_SIMD_KERNELS) && !defined(EAS_BIG_ENDIAN)
+#if defined(WT_AVX2)
+    if (WT_HasAVX2())
+        return WT_InterpolateAVX2;
+#endif
+#if defined(WT_SSE2)
+    return WT_InterpolateSSE2;
+#elif defined(WT_NEON)
+    return WT_InterpolateNEON;
+#endif
+#endif
+    return NULL;
+}
@@ -120,7 +120,7 @@ static EAS_RESULT WT_Initialize (S_VOICE_MGR *pVoiceMgr)
 {
     EAS_INT i;
 
-    for (i = 0; i < NUM_WT_VOICES; i++)
+    for (i = 0; i < NUM_WT_VOICES(pVoiceMgr->numVoices); i++)
     {
 
         pVoiceMgr->wtVoices[i].artIndex = DEFAULT_ARTICULATION_INDEX;
@@ -395,7 +395,7 @@ static EAS_RESULT WT_StartVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNT
     {
 
 #ifdef EAS_SPLIT_WT_SYNTH
-        if (voiceNum < NUM_PRIMARY_VOICES)
+        if (voiceNum < pVoiceMgr->numPrimaryVoices)
             pWTVoice->phaseAccum = (EAS_U32) pSynth->pEAS->pSamples + pSynth->pEAS->pSampleOffsets[pRegion->waveIndex];
         else
             pWTVoice->phaseAccum = pSynth->pEAS->pSampleOffsets[pRegion->waveIndex];
@@ -421,9 +421,16 @@ static EAS_RESULT WT_StartVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNT
         }
     }
 
+    /* the filter is always on for the wavetable articulations */
+#ifdef _FILTER_ENABLED
+    pWTVoice->pfProcess = WT_SelectVoiceKernel(pWTVoice, EAS_TRUE);
+#else
+    pWTVoice->pfProcess = WT_SelectVoiceKernel(pWTVoice, EAS_FALSE);
+#endif
+
 #ifdef EAS_SPLIT_WT_SYNTH
     /* configure off-chip voices */
-    if (voiceNum >= NUM_PRIMARY_VOICES)
+    if (voiceNum >= pVoiceMgr->numPrimaryVoices)
     {
         wtConfig.phaseAccum = pWTVoice->phaseAccum;
         wtConfig.loopStart = pWTVoice->loopStart;
@@ -435,7 +442,7 @@ static EAS_RESULT WT_StartVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNT
         wtConfig.gainRight = pWTVoice->gainRight;
 #endif
 
-        WTE_ConfigVoice(voiceNum - NUM_PRIMARY_VOICES, &wtConfig, pVoiceMgr->pFrameBuffer);
+        WTE_ConfigVoice(voiceNum - pVoiceMgr->numPrimaryVoices, &wtConfig, pVoiceMgr->pFrameBuffer);
     }
 #endif
 
@@ -465,7 +472,7 @@ EAS_BOOL WT_CheckSampleEnd (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame, E
 
     /* check to see if we hit the end of the waveform this time */
     /*lint -e{703} use shift for performance */
-    endPhaseFrac = pWTVoice->phaseFrac + pWTIntFrame->frame.phaseIncrement * BUFFER_SIZE_IN_MONO_SAMPLES;
+    endPhaseFrac = pWTVoice->phaseFrac + pWTIntFrame->frame.phaseIncrement * pWTIntFrame->controlPeriod;
     endPhaseAccum = pWTVoice->phaseAccum + GET_PHASE_INT_PART(endPhaseFrac);
     if (endPhaseAccum >= pWTVoice->loopEnd)
     {
@@ -490,12 +497,12 @@ EAS_BOOL WT_CheckSampleEnd (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame, E
             ALOGE("b/26366256");
             android_errorWriteLog(0x534e4554, "26366256");
             pWTIntFrame->numSamples = 0;
-        } else if (pWTIntFrame->numSamples > BUFFER_SIZE_IN_MONO_SAMPLES) {
-            EAS_Report(_EAS_SEVERITY_ERROR, "%s: numSamples %d > %d BUFFER_SIZE_IN_MONO_SAMPLES\n", __func__, pWTIntFrame->numSamples, BUFFER_SIZE_IN_MONO_SAMPLES);
+        } else if (pWTIntFrame->numSamples > pWTIntFrame->controlPeriod) {
+            EAS_Report(_EAS_SEVERITY_ERROR, "%s: numSamples %d > %d controlPeriod\n", __func__, pWTIntFrame->numSamples, pWTIntFrame->controlPeriod);
             ALOGE("b/317780080 clip numSamples %ld -> %d",
-                  pWTIntFrame->numSamples, BUFFER_SIZE_IN_MONO_SAMPLES);
+                  pWTIntFrame->numSamples, pWTIntFrame->controlPeriod);
             android_errorWriteLog(0x534e4554, "317780080");
-            pWTIntFrame->numSamples = BUFFER_SIZE_IN_MONO_SAMPLES;
+            pWTIntFrame->numSamples = pWTIntFrame->controlPeriod;
         }
 
         /* sound will be done this frame */
@@ -538,6 +545,7 @@ static EAS_BOOL WT_UpdateVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH
     const S_WT_REGION *pWTRegion;
     const S_ARTICULATION *pArt;
     EAS_I32 temp;
+    EAS_I32 ticks;
     EAS_BOOL done;
 
 #ifdef DLS_SYNTHESIZER
@@ -550,13 +558,30 @@ static EAS_BOOL WT_UpdateVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH
     pArt = &pSynth->pEAS->pArticulations[pWTVoice->artIndex];
     pChannel = &pSynth->channels[pVoice->channel & 15];
     intFrame.prevGain = pVoice->gain;
+    intFrame.pitchOffset = pVoiceMgr->pitchOffset;
+#if defined(_FILTER_ENABLED) && defined(_FLOAT_DCF)
+    intFrame.pFilterTable = &pVoiceMgr->filterTable;
+#if defined(_REFERENCE_RENDER_PATHS)
+    intFrame.pFilterBatch = (pVoiceMgr->renderPaths & VM_PATH_FILTER_BATCH) ? &pVoiceMgr->filterBatch : NULL;
+#else
+    intFrame.pFilterBatch = &pVoiceMgr->filterBatch;
+#endif
+#endif
+#if defined(_VOICE_PARALLEL)
+#if defined(_REFERENCE_RENDER_PATHS)
+    intFrame.pVoiceBatches = (pVoiceMgr->renderPaths & VM_PATH_VOICE_BATCHES) ? pVoiceMgr->voiceBatches : NULL;
+#else
+    intFrame.pVoiceBatches = pVoiceMgr->voiceBatches;
+#endif
+#endif
 
-    /* update the envelopes */
-    WT_UpdateEG1(pWTVoice, &pArt->eg1);
-    WT_UpdateEG2(pWTVoice, &pArt->eg2);
-
-    /* update the LFO */
-    WT_UpdateLFO(&pWTVoice->modLFO, pArt->lfoFreq);
+    /* update the envelopes and the LFO once per native control period */
+    for (ticks = VMControlTicks(pVoiceMgr, pVoice); ticks > 0; ticks--)
+    {
+        WT_UpdateEG1(pWTVoice, &pArt->eg1);
+        WT_UpdateEG2(pWTVoice, &pArt->eg2);
+        WT_UpdateLFO(&pWTVoice->modLFO, pArt->lfoFreq);
+    }
 
 #ifdef _FILTER_ENABLED
 /*
@@ -578,6 +603,11 @@ static EAS_BOOL WT_UpdateVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH
     /* update the gain */
     intFrame.frame.gainTarget = WT_UpdateGain(pVoice, pWTVoice, pArt, pChannel, pWTRegion->gain);
 
+    /* a released voice that has faded below the output resolution is finished */
+    if ((pWTVoice->eg1State == eEnvelopeStateRelease) &&
+        (intFrame.prevGain <= SYNTH_CULL_GAIN) && (intFrame.frame.gainTarget <= SYNTH_CULL_GAIN))
+        pWTVoice->eg1State = eEnvelopeStateMuted;
+
     /* calculate base pitch*/
     temp = pChannel->staticPitch + pWTRegion->tuning;
 
@@ -605,32 +635,35 @@ static EAS_BOOL WT_UpdateVoice (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, S_SYNTH
     intFrame.pAudioBuffer = pVoiceMgr->voiceBuffer;
     intFrame.pMixBuffer = pMixBuffer;
     intFrame.numSamples = numSamples;
+    intFrame.controlPeriod = pVoiceMgr->controlPeriod;
+    intFrame.controlPeriodBits = pVoiceMgr->controlPeriodBits;
+    intFrame.pfInterpolate = pVoiceMgr->pfInterpolate;
 
     /* check for end of sample */
     if ((pWTVoice->loopStart != WT_NOISE_GENERATOR) && (pWTVoice->loopStart == pWTVoice->loopEnd))
-        done = WT_CheckSampleEnd(pWTVoice, &intFrame, (EAS_BOOL) (voiceNum >= NUM_PRIMARY_VOICES));
+        done = WT_CheckSampleEnd(pWTVoice, &intFrame, (EAS_BOOL) (voiceNum >= pVoiceMgr->numPrimaryVoices));
     else
         done = EAS_FALSE;
 
     if (intFrame.numSamples < 0) intFrame.numSamples = 0;
 
-    if (intFrame.numSamples > BUFFER_SIZE_IN_MONO_SAMPLES)
-        intFrame.numSamples = BUFFER_SIZE_IN_MONO_SAMPLES;
+    if (intFrame.numSamples > intFrame.controlPeriod)
+        intFrame.numSamples = intFrame.controlPeriod;
 
-    if (intFrame.numSamples < BUFFER_SIZE_IN_MONO_SAMPLES)
-        memset(pMixBuffer + intFrame.numSamples * NUM_OUTPUT_CHANNELS, 0, (BUFFER_SIZE_IN_MONO_SAMPLES - intFrame.numSamples) * NUM_OUTPUT_CHANNELS * sizeof(EAS_I32));
+    if (intFrame.numSamples < intFrame.controlPeriod)
+        memset(pMixBuffer + intFrame.numSamples * NUM_OUTPUT_CHANNELS, 0, (intFrame.controlPeriod - intFrame.numSamples) * NUM_OUTPUT_CHANNELS * sizeof(EAS_I32));
 
 #ifdef EAS_SPLIT_WT_SYNTH
-    if (voiceNum < NUM_PRIMARY_VOICES)
+    if (voiceNum < pVoiceMgr->numPrimaryVoices)
     {
 #ifndef _SPLIT_WT_TEST_HARNESS
-        WT_ProcessVoice(pWTVoice, &intFrame);
+        pWTVoice->pfProcess(pWTVoice, &intFrame);
 #endif
     }
     else
-        WTE_ProcessVoice(voiceNum - NUM_PRIMARY_VOICES, &intFrame.frame, pVoiceMgr->pFrameBuffer);
+        WTE_ProcessVoice(voiceNum - pVoiceMgr->numPrimaryVoices, &intFrame.frame, pVoiceMgr->pFrameBuffer);
 #else
-    WT_ProcessVoice(pWTVoice, &intFrame);
+    pWTVoice->pfProcess(pWTVoice, &intFrame);
 #endif
 
     /* clear flag */
@@ -753,6 +786,9 @@ static void WT_UpdateChannel (S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 ch
     pChannel->staticPitch =
         MULT_EG1_EG1(pitchBend, pChannel->pitchBendSensitivity);
 
+    /* compensate for the output sample rate */
+    pChannel->staticPitch += pVoiceMgr->pitchOffset;
+
     /* if this is not a drum channel, then add in the per-channel tuning */
     if (!(pChannel->channelFlags & CHANNEL_FLAG_RHYTHM_CHANNEL))
         pChannel->staticPitch += pChannel->finePitch + (pChannel->coarsePitch * 100);
@@ -1015,7 +1051,7 @@ static void WT_UpdateEG2 (S_WT_VOICE *pWTVoice, const S_ENVELOPE *pEnv)
 */
 // triangle wave LFO
 // (0, 0) (8192, 32767) (16384, -1) (24576, -32768) (32767, -4)
-// x is added by phaseInc per BUFFER_SIZE_IN_MONO_SAMPLES
+// x is added by phaseInc per native control period (BUFFER_SIZE_IN_MONO_SAMPLES)
 // phaseinc = (32768*f)/(srate/bufsize)
 void WT_UpdateLFO (S_LFO_CONTROL *pLFO, EAS_I16 phaseInc)
 {
@@ -1076,7 +1112,7 @@ static void WT_UpdateFilter (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pIntFrame, co
     cutoff = MULT_EG1_EG1(pWTVoice->eg2Value, pArt->eg2ToFc);
     cutoff += pArt->filterCutoff;
 
-    WT_SetFilterCoeffs(pIntFrame, cutoff, pArt->filterQ);
+    WT_SetFilterCoeffs(&pWTVoice->filter, pIntFrame, cutoff, pArt->filterQ);
 }
 #endif
 
@@ -785,3 +785,21 @@ EAS_BOOL EAS_HWYield (EAS_HW_DATA_HANDLE hwInstData)
     /* put your code here */
     return EAS_FALSE;
 }
+
+/*----------------------------------------------------------------------------
+ *
+ * EAS_HWGetMicroseconds
+ *
+ * This function returns a monotonic time in microseconds. The EAS library
+ * only uses differences between two readings, so the value may wrap. It
+ * is only called when the host sets a render budget; a clock that does
+ * not advance leaves the polyphony at its full setting.
+ *
+ *----------------------------------------------------------------------------
+*/
+/*lint -esym(715, hwInstData) hwInstData available for customer use */
+EAS_U32 EAS_HWGetMicroseconds (EAS_HW_DATA_HANDLE hwInstData)
+{
+    /* put your code here */
+    return 0;
+}
@@ -10,6 +10,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #if defined(_WIN32)
 #include <io.h>
@@ -375,6 +376,7 @@ EAS_RESULT EAS_HWCloseFile(EAS_HW_DATA_HANDLE hwInstData, EAS_FILE_HANDLE file)
     }
 
     if (file->readAt != NULL) {
+        free(file);
         return EAS_SUCCESS;
     }
 
@@ -412,3 +414,19 @@ EAS_BOOL EAS_HWYield(EAS_HW_DATA_HANDLE hwInstData)
     // just let it run
     return EAS_FALSE;
 }
+
+EAS_U32 EAS_HWGetMicroseconds(EAS_HW_DATA_HANDLE hwInstData)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER counter, frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    // split the conversion so the product cannot overflow
+    return (EAS_U32) ((counter.QuadPart / frequency.QuadPart) * 1000000 +
+                      (counter.QuadPart % frequency.QuadPart) * 1000000 / frequency.QuadPart);
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (EAS_U32) ((uint64_t) now.tv_sec * 1000000 + (uint64_t) now.tv_nsec / 1000);
+#endif
+}
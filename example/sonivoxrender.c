@@ -44,6 +44,8 @@ EAS_BOOL reverb_override = EAS_FALSE;
 EAS_I32 chorus_type = 0;
 EAS_I32 chorus_level = 32767;
 EAS_BOOL chorus_override = EAS_FALSE;
+EAS_I32 sample_rate = 0;
+EAS_I32 max_voices = 0;
 EAS_DATA_HANDLE mEASDataHandle = NULL;
 int verbosity =
 #ifdef NDEBUG
@@ -93,7 +95,11 @@ int initializeLibrary(void)
     EAS_SetDebugFile(stderr, 1);
     EAS_SetDebugLevel(verbosity);
 
-    EAS_RESULT result = EAS_Init(&mEASDataHandle);
+    S_EAS_INIT_CONFIG config;
+    memset(&config, 0, sizeof(config));
+    config.sampleRate = sample_rate;
+    config.maxVoices = max_voices;
+    EAS_RESULT result = EAS_InitEx(&mEASDataHandle, &config);
     if (result != EAS_SUCCESS) {
         fprintf(stderr, "Failed to initialize synthesizer library\n");
         ok = EXIT_FAILURE;
@@ -368,10 +374,12 @@ int main (int argc, char **argv)
                                            {"reverb-post-mix", no_argument, 0, 'R'},
                                            {"chorus-post-mix", no_argument, 0, 'C'},
                                            {"sndlib", required_argument, 0, 's'},
+                                           {"sample-rate", required_argument, 0, 'S'},
+                                           {"polyphony", required_argument, 0, 'p'},
                                            {0, 0, 0, 0}};
 
     while (1) {
-        c = getopt_long(argc, argv, "hvd:r:w:n:c:l:g:V:RCs:", long_options, &option_index);
+        c = getopt_long(argc, argv, "hvd:r:w:n:c:l:g:V:RCs:S:p:", long_options, &option_index);
 
         if (c == -1) {
             break;
@@ -384,7 +392,8 @@ int main (int argc, char **argv)
                 "Usage: %s [-h|--help] [-v|--version] [-d|--dls soundfont] [-r|--reverb 0..4] "
                 "[-w|--wet 0..32767] [-n|--dry 0..32767] "
                 "[-c|--chorus 0..4] [-l|--level 0..32767] [-g|--gain 0..196] [-V|--Verbosity "
-                "0..5] [-R|--reverb-post-mix] [-C|--chorus-post-mix] [-s|--sndlib 1..3] file.mid ...\n"
+                "0..5] [-R|--reverb-post-mix] [-C|--chorus-post-mix] [-s|--sndlib 1..3] "
+                "[-S|--sample-rate Hz] [-p|--polyphony 1..1024] file.mid ...\n"
                 "Render standard MIDI files into raw PCM audio.\n"
                 "Options:\n"
                 "\t-h, --help\t\tthis help message.\n"
@@ -401,7 +410,9 @@ int main (int argc, char **argv)
                 "5=details\n"
                 "\t-R, --reverb-post-mix\tignore CC91 reverb send.\n"
                 "\t-C, --chorus-post-mix\tignore CC93 chorus send.\n"
-                "\t-s, --sndlib n\t\tsound engine library: 1=wt, 2=fm, 3=hybrid.\n",
+                "\t-s, --sndlib n\t\tsound engine library: 1=wt, 2=fm, 3=hybrid.\n"
+                "\t-S, --sample-rate n\toutput sample rate: 8000..96000 Hz.\n"
+                "\t-p, --polyphony n\tvoices to allocate: 1..1024.\n",
                 argv[0]);
             return EXIT_FAILURE;
         case 'v':
@@ -474,6 +485,20 @@ int main (int argc, char **argv)
             }
             break;
         }
+        case 'S':
+            sample_rate = atoi(optarg);
+            if ((sample_rate < 8000) || (sample_rate > 96000)) {
+                fprintf(stderr, "invalid sample rate: %d\n", sample_rate);
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'p':
+            max_voices = atoi(optarg);
+            if ((max_voices < 1) || (max_voices > 1024)) {
+                fprintf(stderr, "invalid polyphony: %d\n", max_voices);
+                return EXIT_FAILURE;
+            }
+            break;
         case '?':
             fprintf(stderr, "unknown option %c\n", optopt);
             return EXIT_FAILURE;
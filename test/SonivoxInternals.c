@@ -0,0 +1,615 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "eas_data.h"
+#include "eas_host.h"
+#include "eas_vm_protos.h"
+
+#include "SonivoxInternals.h"
+
+#if defined(_REFERENCE_RENDER_PATHS) && \
+    ((SONIVOX_PATH_VOICE_BATCHES != VM_PATH_VOICE_BATCHES) || (SONIVOX_PATH_FILTER_BATCH != VM_PATH_FILTER_BATCH) || \
+    (SONIVOX_PATH_FUSED_OUTPUT != VM_PATH_FUSED_OUTPUT) || (SONIVOX_PATH_VOICE_LIST != VM_PATH_VOICE_LIST))
+#error "SONIVOX_PATH_ flags differ from VM_PATH_ flags"
+#endif
+
+EAS_I32 SonivoxPitchOffset(EAS_DATA_HANDLE pEASData)
+{
+    return pEASData->pitchOffset;
+}
+
+EAS_BOOL SonivoxUseCInterpolator(EAS_DATA_HANDLE pEASData)
+{
+#ifdef _WT_SYNTH
+    if (pEASData->pVoiceMgr->pfInterpolate != NULL)
+    {
+        pEASData->pVoiceMgr->pfInterpolate = NULL;
+        return EAS_TRUE;
+    }
+#endif
+    return EAS_FALSE;
+}
+
+EAS_BOOL SonivoxProcessEffect32(EAS_DATA_HANDLE pEASData, EAS_INT module, EAS_I32 *pSrc, EAS_I32 *pDst,
+                                EAS_I32 numSamples)
+{
+    S_EFFECTS_MODULE *pModule = &pEASData->effectsModules[module];
+
+    if ((pModule->effect == NULL) || (pModule->effectData == NULL) || (pModule->effect->pfProcess32 == NULL))
+        return EAS_FALSE;
+    pModule->effect->pfProcess32(pModule->effectData, pSrc, pDst, numSamples);
+    return EAS_TRUE;
+}
+
+EAS_BOOL SonivoxDisableRenderPath(EAS_DATA_HANDLE pEASData, EAS_U32 paths)
+{
+#if defined(_REFERENCE_RENDER_PATHS)
+    EAS_U32 built = VM_PATH_VOICE_LIST;
+
+#if defined(_WT_SYNTH) && defined(_VOICE_PARALLEL) && defined(_FILTER_ENABLED) && defined(_FLOAT_DCF) && \
+    !defined(UNIFIED_MIXER)
+    built |= VM_PATH_VOICE_BATCHES;
+#endif
+#if defined(_WT_SYNTH) && defined(_FILTER_ENABLED) && defined(_FLOAT_DCF)
+    built |= VM_PATH_FILTER_BATCH;
+#endif
+#if defined(_WT_SYNTH) && defined(_FILTER_ENABLED) && defined(_FLOAT_DCF) && !defined(UNIFIED_MIXER)
+    built |= VM_PATH_FUSED_OUTPUT;
+#endif
+    if ((paths & built) != paths)
+        return EAS_FALSE;
+    pEASData->pVoiceMgr->renderPaths &= ~paths;
+    return EAS_TRUE;
+#else
+    (void) pEASData;
+    (void) paths;
+    return EAS_FALSE;
+#endif
+}
+
+#if defined(_WT_SYNTH) && !defined(UNIFIED_MIXER)
+/* stages of the engine, which the voices rendered one at a time here go through */
+extern void WT_NoiseGenerator (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame);
+extern void WT_Interpolate (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame);
+extern void WT_InterpolateNoLoop (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame);
+extern void WT_VoiceGain (S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame);
+#endif
+
+EAS_U32 SonivoxVoiceKinds(EAS_DATA_HANDLE pEASData)
+{
+    EAS_U32 kinds = 0;
+#if defined(_WT_SYNTH)
+    S_VOICE_MGR *pVoiceMgr = pEASData->pVoiceMgr;
+    const S_WT_VOICE *pWTVoice;
+    EAS_INT numVoices = MAX_SYNTH_VOICES;
+    EAS_INT i;
+
+#if defined(_HYBRID_SYNTH)
+    /* the wavetable voices come first */
+    numVoices = pVoiceMgr->numPrimaryVoices;
+#endif
+    for (i = 0; i < numVoices; i++)
+    {
+        if (pVoiceMgr->voices[i].voiceState == eVoiceStateFree)
+            continue;
+        pWTVoice = &pVoiceMgr->wtVoices[i];
+        if (pWTVoice->loopStart == WT_NOISE_GENERATOR)
+            continue;
+        kinds |= (pWTVoice->loopStart != pWTVoice->loopEnd) ? SONIVOX_VOICE_LOOPED : SONIVOX_VOICE_ONE_SHOT;
+        kinds |= (pWTVoice->pfProcess != WT_SelectVoiceKernel(pWTVoice, EAS_FALSE)) ?
+                 SONIVOX_VOICE_FILTERED : SONIVOX_VOICE_UNFILTERED;
+    }
+#else
+    (void) pEASData;
+#endif
+    return kinds;
+}
+
+#if defined(_WT_SYNTH) && !defined(_OPTIMIZED_MONO) && !defined(UNIFIED_MIXER)
+/* the generic code the voice kernels replace, which chooses the interpolator and the filter on
+ * every block */
+static void SonivoxProcessVoice(S_WT_VOICE *pWTVoice, S_WT_INT_FRAME *pWTIntFrame)
+{
+    if (pWTVoice->loopStart == WT_NOISE_GENERATOR)
+        WT_NoiseGenerator(pWTVoice, pWTIntFrame);
+    else if (pWTVoice->loopStart != pWTVoice->loopEnd)
+        WT_Interpolate(pWTVoice, pWTIntFrame);
+    else
+        WT_InterpolateNoLoop(pWTVoice, pWTIntFrame);
+
+#if defined(_FILTER_ENABLED)
+#if defined(_FLOAT_DCF)
+    if (pWTIntFrame->frame.b02 != 0.0f)
+#else
+    if (pWTIntFrame->frame.k != 0)
+#endif
+        WT_VoiceFilter(&pWTVoice->filter, pWTIntFrame);
+#endif
+
+    WT_VoiceGain(pWTVoice, pWTIntFrame);
+}
+
+/* control periods SonivoxCompareVoiceKernels renders, and the length of the loop it plays */
+#define SONIVOX_KERNEL_BLOCKS 8
+#define SONIVOX_KERNEL_LOOP 100
+#endif
+
+EAS_I32 SonivoxCompareVoiceKernels(EAS_DATA_HANDLE pEASData)
+{
+#if defined(_WT_SYNTH) && !defined(_OPTIMIZED_MONO) && !defined(UNIFIED_MIXER)
+    S_VOICE_MGR *pVoiceMgr = pEASData->pVoiceMgr;
+    S_WT_VOICE voices[2];
+    S_WT_INT_FRAME intFrame;
+    WT_VOICE_KERNEL pfProcess;
+    EAS_SAMPLE *pSamples;
+    EAS_PCM *pAudio;
+    EAS_I32 *pMix[2];
+    EAS_I32 waveLength;
+    EAS_I32 mixSize;
+    EAS_I32 mismatches = 0;
+    EAS_U32 noise;
+    EAS_INT numFilterModes = 1;
+    EAS_INT filterMode;
+    EAS_INT kind;
+    EAS_INT run;
+    EAS_INT block;
+    EAS_I32 i;
+
+    /* a wave longer than the one-shot voices play, the voice buffer and the mix buffers of the
+     * blocks of the kernel and of the generic code */
+    waveLength = 2 * SONIVOX_KERNEL_BLOCKS * pVoiceMgr->controlPeriod;
+    mixSize = pVoiceMgr->controlPeriod * NUM_OUTPUT_CHANNELS;
+    pSamples = malloc((waveLength + 1) * sizeof(EAS_SAMPLE));
+    pAudio = malloc(pVoiceMgr->controlPeriod * sizeof(EAS_PCM));
+    pMix[0] = malloc(2 * SONIVOX_KERNEL_BLOCKS * mixSize * sizeof(EAS_I32));
+    if ((pSamples == NULL) || (pAudio == NULL) || (pMix[0] == NULL))
+    {
+        free(pSamples);
+        free(pAudio);
+        free(pMix[0]);
+        return -1;
+    }
+    pMix[1] = pMix[0] + SONIVOX_KERNEL_BLOCKS * mixSize;
+
+    noise = 1;
+    for (i = 0; i < waveLength; i++)
+    {
+        noise = noise * 1664525 + 1013904223;
+        pSamples[i] = (EAS_SAMPLE) ((EAS_I32) noise >> (32 - 8 * (EAS_I32) sizeof(EAS_SAMPLE)));
+    }
+    /* the loop plays the samples from 1 to SONIVOX_KERNEL_LOOP, the engine wraps from its end to
+     * the sample before its start and reads the sample after its end, which repeat the ends */
+    pSamples[0] = pSamples[SONIVOX_KERNEL_LOOP];
+    pSamples[SONIVOX_KERNEL_LOOP + 1] = pSamples[1];
+    pSamples[waveLength] = pSamples[waveLength - 1];
+
+    /* without a filter, with one, and with one its coefficients bypass */
+#if defined(_FILTER_ENABLED)
+    numFilterModes = 3;
+#endif
+    for (kind = 0; kind < 3; kind++)
+    {
+        for (filterMode = 0; filterMode < numFilterModes; filterMode++)
+        {
+            for (run = 0; run < 2; run++)
+            {
+                S_WT_VOICE *pWTVoice = &voices[run];
+
+                memset(pWTVoice, 0, sizeof(S_WT_VOICE));
+                if (kind == 0)
+                {
+                    pWTVoice->loopStart = WT_NOISE_GENERATOR;
+                    pWTVoice->prngTmp0 = 0x12345678;
+                    pWTVoice->prngTmp1 = 0x2468ace0;
+                }
+                else if (kind == 1)
+                {
+                    pWTVoice->loopStart = pSamples + 1;
+                    pWTVoice->loopEnd = pSamples + SONIVOX_KERNEL_LOOP;
+                    pWTVoice->phaseAccum = pSamples + SONIVOX_KERNEL_LOOP / 2;
+                }
+                else
+                {
+                    pWTVoice->loopStart = pWTVoice->loopEnd = pSamples + waveLength - 1;
+                    pWTVoice->phaseAccum = pSamples;
+                }
+                pWTVoice->phaseFrac = 0x1234;
+#if (NUM_OUTPUT_CHANNELS == 2)
+                pWTVoice->gainLeft = 20000;
+                pWTVoice->gainRight = 12000;
+#endif
+#if defined(_FILTER_ENABLED) && defined(_FLOAT_DCF)
+                pWTVoice->filter.y1 = 100;
+                pWTVoice->filter.x1 = -50;
+#endif
+                pfProcess = (run == 0) ? WT_SelectVoiceKernel(pWTVoice, (filterMode != 0) ? EAS_TRUE : EAS_FALSE) :
+                            SonivoxProcessVoice;
+
+                for (i = 0; i < SONIVOX_KERNEL_BLOCKS * mixSize; i++)
+                    pMix[run][i] = 0;
+                for (block = 0; block < SONIVOX_KERNEL_BLOCKS; block++)
+                {
+                    memset(&intFrame, 0, sizeof(S_WT_INT_FRAME));
+                    intFrame.frame.gainTarget = 4000 + 3000 * ((block + kind) % 4);
+                    intFrame.frame.phaseIncrement = 0x5000 + 0x800 * block;
+#if defined(_FILTER_ENABLED)
+                    if (filterMode == 1)
+                    {
+#if defined(_FLOAT_DCF)
+                        intFrame.frame.b02 = 0.05f + 0.01f * (float) block;
+                        intFrame.frame.b1 = 2.0f * intFrame.frame.b02;
+                        intFrame.frame.a1 = -1.2f;
+                        intFrame.frame.a2 = 0.5f;
+#else
+                        intFrame.frame.k = 0x2000;
+#endif
+                    }
+#endif
+                    intFrame.prevGain = (block == 0) ? 0 : 4000 + 3000 * ((block + kind - 1) % 4);
+                    intFrame.controlPeriod = pVoiceMgr->controlPeriod;
+                    intFrame.controlPeriodBits = pVoiceMgr->controlPeriodBits;
+                    intFrame.numSamples = pVoiceMgr->controlPeriod;
+                    intFrame.pAudioBuffer = pAudio;
+                    intFrame.pMixBuffer = pMix[run] + block * mixSize;
+                    intFrame.pfInterpolate = pVoiceMgr->pfInterpolate;
+                    pfProcess(pWTVoice, &intFrame);
+                }
+            }
+
+            for (i = 0; i < SONIVOX_KERNEL_BLOCKS * mixSize; i++)
+            {
+                if (pMix[0][i] != pMix[1][i])
+                    mismatches++;
+            }
+            if (memcmp(&voices[0], &voices[1], sizeof(S_WT_VOICE)) != 0)
+                mismatches++;
+        }
+    }
+
+    free(pSamples);
+    free(pAudio);
+    free(pMix[0]);
+    return mismatches;
+#else
+    (void) pEASData;
+    return -1;
+#endif
+}
+
+EAS_I32 SonivoxFilterCoeffs(EAS_DATA_HANDLE pEASData, EAS_I32 cutoff, EAS_I32 resonance, float *pCoeffs)
+{
+#if defined(_WT_SYNTH) && defined(_FILTER_ENABLED) && defined(_FLOAT_DCF)
+    S_FILTER_CONTROL filter;
+    S_WT_INT_FRAME intFrame;
+
+    /* no cached coefficients, and no pitch offset */
+    memset(&filter, 0, sizeof(filter));
+    memset(&intFrame, 0, sizeof(intFrame));
+    intFrame.pFilterTable = &pEASData->pVoiceMgr->filterTable;
+    WT_SetFilterCoeffs(&filter, &intFrame, cutoff, resonance);
+    pCoeffs[0] = intFrame.frame.b02;
+    pCoeffs[1] = intFrame.frame.b1;
+    pCoeffs[2] = intFrame.frame.a1;
+    pCoeffs[3] = intFrame.frame.a2;
+    return _OUTPUT_SAMPLE_RATE;
+#else
+    (void) pEASData;
+    (void) cutoff;
+    (void) resonance;
+    (void) pCoeffs;
+    return 0;
+#endif
+}
+
+EAS_I32 SonivoxCompareFilterBatch(EAS_DATA_HANDLE pEASData, EAS_INT numLanes, const EAS_I32 *pShortfall)
+{
+#if defined(_REFERENCE_RENDER_PATHS) && defined(_WT_SYNTH) && defined(_FILTER_ENABLED) && defined(_FLOAT_DCF) && \
+    !defined(UNIFIED_MIXER)
+    S_VOICE_MGR *pVoiceMgr = pEASData->pVoiceMgr;
+    S_WT_FILTER_BATCH *pBatch = &pVoiceMgr->filterBatch;
+    S_WT_VOICE voices[3][WT_FILTER_LANES];
+    S_WT_INT_FRAME intFrames[WT_FILTER_LANES];
+    S_FILTER_CONTROL spareFilter;
+    EAS_I32 *pSpareMix;
+    EAS_I32 *pMix[3];
+    EAS_I32 mixSize;
+    EAS_I32 mismatches = 0;
+    EAS_U32 noise;
+    EAS_INT run;
+    EAS_INT lane;
+    EAS_I32 i;
+
+    if ((numLanes <= 0) || (numLanes > WT_FILTER_LANES))
+        return -1;
+    for (lane = 0; lane < numLanes; lane++)
+    {
+        if ((pShortfall[lane] < 0) || (pShortfall[lane] >= pVoiceMgr->controlPeriod))
+            return -1;
+    }
+
+    /* a mix buffer for each lane and one for the spare lanes, for each run */
+    mixSize = pVoiceMgr->controlPeriod * NUM_OUTPUT_CHANNELS;
+    pMix[0] = malloc(3 * (WT_FILTER_LANES + 1) * mixSize * sizeof(EAS_I32));
+    if (pMix[0] == NULL)
+        return -1;
+    pMix[1] = pMix[0] + (WT_FILTER_LANES + 1) * mixSize;
+    pMix[2] = pMix[1] + (WT_FILTER_LANES + 1) * mixSize;
+
+    /* the batch with the gain and pan in the filter loop, the batch without, and the voices
+     * filtered on their own, all from the same voices and noise */
+    spareFilter = pBatch->spareFilter;
+    pSpareMix = pBatch->pSpareMix;
+    for (run = 0; run < 3; run++)
+    {
+        noise = 1;
+        for (i = 0; i < (WT_FILTER_LANES + 1) * mixSize; i++)
+            pMix[run][i] = 0x5555;
+        for (i = 0; i < WT_FILTER_LANES * pVoiceMgr->controlPeriod; i++)
+        {
+            noise = noise * 1664525 + 1013904223;
+            pBatch->pBuffers[i] = (EAS_PCM) ((EAS_I32) noise >> 17);
+        }
+
+        for (lane = 0; lane < numLanes; lane++)
+        {
+            S_WT_VOICE *pWTVoice = &voices[run][lane];
+            S_WT_INT_FRAME *pFrame = &intFrames[lane];
+
+            /* lanes of different filters, gains and pans */
+            memset(pWTVoice, 0, sizeof(S_WT_VOICE));
+            pWTVoice->filter.y1 = 100 * lane;
+            pWTVoice->filter.x1 = -50 * lane;
+            pWTVoice->gainLeft = (EAS_I16) (8000 + 4000 * lane);
+            pWTVoice->gainRight = (EAS_I16) (24000 - 4000 * lane);
+            memset(pFrame, 0, sizeof(S_WT_INT_FRAME));
+            pFrame->frame.b02 = 0.05f + 0.02f * (float) lane;
+            pFrame->frame.b1 = 2.0f * pFrame->frame.b02;
+            pFrame->frame.a1 = -1.2f + 0.1f * (float) lane;
+            pFrame->frame.a2 = 0.5f - 0.05f * (float) lane;
+            pFrame->frame.gainTarget = (EAS_I16) (20000 - 6000 * lane);
+            pFrame->prevGain = (EAS_I16) (4000 + 5000 * lane);
+            pFrame->controlPeriod = pVoiceMgr->controlPeriod;
+            pFrame->controlPeriodBits = pVoiceMgr->controlPeriodBits;
+            pFrame->numSamples = pVoiceMgr->controlPeriod - pShortfall[lane];
+            pFrame->pAudioBuffer = pBatch->pBuffers + lane * pVoiceMgr->controlPeriod;
+            pFrame->pMixBuffer = pMix[run] + lane * mixSize;
+
+            if (run == 2)
+            {
+                WT_VoiceFilter(&pWTVoice->filter, pFrame);
+                WT_VoiceGain(pWTVoice, pFrame);
+                continue;
+            }
+            pBatch->pWTVoices[lane] = pWTVoice;
+            pBatch->intFrames[lane] = *pFrame;
+        }
+        if (run == 2)
+            break;
+
+        pBatch->numLanes = numLanes;
+        pBatch->spareFilter = spareFilter;
+        pBatch->pSpareMix = pMix[run] + WT_FILTER_LANES * mixSize;
+        pBatch->fuseOutput = (run == 0) ? EAS_TRUE : EAS_FALSE;
+        WT_FilterBatch(pBatch);
+    }
+    pBatch->spareFilter = spareFilter;
+    pBatch->pSpareMix = pSpareMix;
+
+    /* the mix buffers of the voices and the states of their filters */
+    for (run = 0; run < 2; run++)
+    {
+        for (lane = 0; lane < numLanes; lane++)
+        {
+            for (i = 0; i < mixSize; i++)
+            {
+                if (pMix[run][lane * mixSize + i] != pMix[2][lane * mixSize + i])
+                    mismatches++;
+            }
+            if ((voices[run][lane].filter.y1 != voices[2][lane].filter.y1) ||
+                (voices[run][lane].filter.y2 != voices[2][lane].filter.y2) ||
+                (voices[run][lane].filter.x1 != voices[2][lane].filter.x1) ||
+                (voices[run][lane].filter.x2 != voices[2][lane].filter.x2))
+                mismatches++;
+        }
+    }
+
+    free(pMix[0]);
+    return mismatches;
+#else
+    (void) pEASData;
+    (void) numLanes;
+    (void) pShortfall;
+    return -1;
+#endif
+}
+
+EAS_BOOL SonivoxDropNoteIndex(EAS_DATA_HANDLE pEASData, EAS_DLSLIB_HANDLE pDLS)
+{
+#if defined(DLS_SYNTHESIZER)
+    if (pDLS->pRegionNotes == NULL)
+        return EAS_FALSE;
+
+    /* DLSFindRegions finds no table for any program */
+    EAS_HWFree(pEASData->hwInstData, pDLS->pRegionNotes);
+    EAS_HWFree(pEASData->hwInstData, pDLS->pNoteIndex);
+    pDLS->pRegionNotes = NULL;
+    pDLS->pNoteIndex = NULL;
+    return EAS_TRUE;
+#else
+    (void) pEASData;
+    (void) pDLS;
+    return EAS_FALSE;
+#endif
+}
+
+EAS_I32 SonivoxActiveVoices(EAS_DATA_HANDLE pEASData)
+{
+    return pEASData->pVoiceMgr->numActiveVoiceList;
+}
+
+EAS_I32 SonivoxStolenVoices(EAS_DATA_HANDLE pEASData)
+{
+    const S_VOICE_MGR *pVoiceMgr = pEASData->pVoiceMgr;
+    EAS_I32 stolen = 0;
+    EAS_INT voiceNum;
+
+    for (voiceNum = 0; voiceNum < pVoiceMgr->numVoices; voiceNum++)
+    {
+        if (pVoiceMgr->voices[voiceNum].voiceState == eVoiceStateStolen)
+            stolen++;
+    }
+    return stolen;
+}
+
+/* the voice VMStealVoice picked by computing the priority of every voice, before the steal tree */
+static EAS_INT SonivoxScanStealVoice(const S_VOICE_MGR *pVoiceMgr, const S_SYNTH *pSynth, EAS_U8 channel, EAS_U8 note,
+                                     EAS_I32 lowVoice, EAS_I32 highVoice)
+{
+    const S_SYNTH_VOICE *pVoice;
+    const S_SYNTH *pCurrSynth;
+    EAS_INT bestCandidate = UNASSIGNED_SYNTH_VOICE;
+    EAS_I32 bestPriority = 0;
+    EAS_I32 priority;
+    EAS_INT voiceNum;
+    EAS_U8 currChannel;
+    EAS_U8 currNote;
+
+    for (voiceNum = lowVoice; voiceNum <= highVoice; voiceNum++)
+    {
+        pVoice = &pVoiceMgr->voices[voiceNum];
+        if (pVoice->voiceState == eVoiceStateFree)
+            continue;
+
+        /* stolen voices count with the note they are about to play */
+        currChannel = (pVoice->voiceState == eVoiceStateStolen) ? pVoice->nextChannel : pVoice->channel;
+        currNote = (pVoice->voiceState == eVoiceStateStolen) ? pVoice->nextNote : pVoice->note;
+        pCurrSynth = pVoiceMgr->pSynth[GET_VSYNTH(currChannel)];
+        if (pSynth->priority > pCurrSynth->priority)
+            continue;
+
+        if ((pVoice->voiceState == eVoiceStateStolen) || (pVoice->voiceFlags & VOICE_FLAG_NO_SAMPLES_SYNTHESIZED_YET))
+            priority = 128 - pVoice->nextVelocity;
+        else
+        {
+            priority = (EAS_I32) pVoice->age << NOTE_AGE_STEAL_WEIGHT;
+            priority += ((32768 >> (12 - NOTE_GAIN_STEAL_WEIGHT)) + 256) -
+                ((EAS_I32) pVoice->gain >> (12 - NOTE_GAIN_STEAL_WEIGHT));
+        }
+        if ((note == currNote) && (channel == currChannel))
+            priority += NOTE_MATCH_PENALTY;
+
+        if (priority >= bestPriority)
+        {
+            bestPriority = priority;
+            bestCandidate = voiceNum;
+        }
+    }
+    return bestCandidate;
+}
+
+/* number of the ranges in which VMStealVoice and the scan pick different voices for a note */
+static EAS_I32 SonivoxCompareSteal(S_VOICE_MGR *pVoiceMgr, S_SYNTH *pSynth, EAS_U8 channel, EAS_U8 note)
+{
+    EAS_I32 ranges[3][2];
+    EAS_I32 mismatches = 0;
+    EAS_INT voiceNum;
+    EAS_INT range;
+
+    /* all the voices, and two ranges that split the tree unevenly */
+    ranges[0][0] = 0;
+    ranges[0][1] = pVoiceMgr->numVoices - 1;
+    ranges[1][0] = 0;
+    ranges[1][1] = pVoiceMgr->numVoices / 3;
+    ranges[2][0] = ranges[1][1] + 1;
+    ranges[2][1] = pVoiceMgr->numVoices - 1;
+
+    for (range = 0; range < 3; range++)
+    {
+        if (VMStealVoice(pVoiceMgr, pSynth, &voiceNum, channel, note, ranges[range][0], ranges[range][1]) != EAS_SUCCESS)
+            voiceNum = UNASSIGNED_SYNTH_VOICE;
+        if (voiceNum != SonivoxScanStealVoice(pVoiceMgr, pSynth, channel, note, ranges[range][0], ranges[range][1]))
+            mismatches++;
+    }
+    return mismatches;
+}
+
+EAS_I32 SonivoxCheckStealTree(EAS_DATA_HANDLE pEASData)
+{
+    S_VOICE_MGR *pVoiceMgr = pEASData->pVoiceMgr;
+    const S_SYNTH_VOICE *pVoice;
+    S_SYNTH *pSynth;
+    EAS_I32 mismatches = 0;
+    EAS_INT voiceNum;
+    EAS_INT synthNum;
+
+    for (synthNum = 0; synthNum < MAX_VIRTUAL_SYNTHESIZERS; synthNum++)
+    {
+        pSynth = pVoiceMgr->pSynth[synthNum];
+        if (pSynth == NULL)
+            continue;
+
+        /* the notes of the voices, which get the match penalty, and a note no voice plays */
+        for (voiceNum = 0; voiceNum < pVoiceMgr->numVoices; voiceNum++)
+        {
+            pVoice = &pVoiceMgr->voices[voiceNum];
+            if (pVoice->voiceState == eVoiceStateFree)
+                continue;
+            if (pVoice->voiceState == eVoiceStateStolen)
+                mismatches += SonivoxCompareSteal(pVoiceMgr, pSynth, pVoice->nextChannel, pVoice->nextNote);
+            else
+                mismatches += SonivoxCompareSteal(pVoiceMgr, pSynth, pVoice->channel, pVoice->note);
+        }
+        mismatches += SonivoxCompareSteal(pVoiceMgr, pSynth, (EAS_U8) ((synthNum << 4) | 15), 0);
+    }
+    return mismatches;
+}
+
+EAS_I32 SonivoxCheckVoiceLists(EAS_DATA_HANDLE pEASData)
+{
+    const S_VOICE_MGR *pVoiceMgr = pEASData->pVoiceMgr;
+    EAS_I32 mismatches = 0;
+    EAS_INT numActive = 0;
+    EAS_INT voiceNum;
+    EAS_U16 pos;
+    EAS_BOOL isFree;
+
+    for (voiceNum = 0; voiceNum < pVoiceMgr->numVoices; voiceNum++)
+    {
+        isFree = (pVoiceMgr->freeVoiceMask[voiceNum >> 5] & (1u << (voiceNum & 31))) ? EAS_TRUE : EAS_FALSE;
+        if (isFree != (pVoiceMgr->voices[voiceNum].voiceState == eVoiceStateFree))
+            mismatches++;
+        else if (!isFree)
+        {
+            pos = pVoiceMgr->activeVoicePos[voiceNum];
+            if ((pos >= pVoiceMgr->numActiveVoiceList) || (pVoiceMgr->activeVoiceList[pos] != voiceNum))
+                mismatches++;
+            numActive++;
+        }
+    }
+
+    /* the list holds no voice twice, so it holds no other voices */
+    if (numActive != pVoiceMgr->numActiveVoiceList)
+        mismatches++;
+    return mismatches;
+}
+
+void SonivoxUpdateRenderBudget(EAS_DATA_HANDLE pEASData, EAS_I32 renderTime, EAS_I32 voicesRendered)
+{
+    VMUpdateRenderBudget(pEASData->pVoiceMgr, renderTime, voicesRendered);
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __SONIVOX_INTERNALS_H__
+#define __SONIVOX_INTERNALS_H__
+
+// Access to the internal state of a library instance, for the tests that
+// compare the optimized render paths with the reference ones. The internal
+// headers are C only, so this is implemented in C.
+
+#include <eas_types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// render paths SonivoxDisableRenderPath turns off, the VM_PATH_ flags of eas_synth.h
+#define SONIVOX_PATH_VOICE_BATCHES 0x01
+#define SONIVOX_PATH_FILTER_BATCH 0x02
+#define SONIVOX_PATH_FUSED_OUTPUT 0x08
+#define SONIVOX_PATH_VOICE_LIST 0x20
+
+// pitch correction in cents from the rate of the sound library to the output rate
+EAS_I32 SonivoxPitchOffset(EAS_DATA_HANDLE pEASData);
+
+// renders with the C interpolation loop instead of the SIMD kernel,
+// returns EAS_FALSE if the instance had no SIMD kernel
+EAS_BOOL SonivoxUseCInterpolator(EAS_DATA_HANDLE pEASData);
+
+// runs the 32-bit processing of the instance's reverb or chorus (EAS_MODULE_REVERB or
+// EAS_MODULE_CHORUS) on a send buffer, returns EAS_FALSE if the effect has none
+EAS_BOOL SonivoxProcessEffect32(EAS_DATA_HANDLE pEASData, EAS_INT module, EAS_I32 *pSrc, EAS_I32 *pDst,
+                                EAS_I32 numSamples);
+
+// renders with the generic code instead of the given render paths,
+// returns EAS_FALSE if the build does not have all of them or was built without
+// _REFERENCE_RENDER_PATHS
+EAS_BOOL SonivoxDisableRenderPath(EAS_DATA_HANDLE pEASData, EAS_U32 paths);
+
+// kinds of wavetable voice SonivoxVoiceKinds reports
+#define SONIVOX_VOICE_LOOPED 0x01
+#define SONIVOX_VOICE_ONE_SHOT 0x02
+#define SONIVOX_VOICE_FILTERED 0x04
+#define SONIVOX_VOICE_UNFILTERED 0x08
+
+// SONIVOX_VOICE_ flags of the wavetable voices playing, from the kernels they were given
+EAS_U32 SonivoxVoiceKinds(EAS_DATA_HANDLE pEASData);
+
+// renders a voice of each kind of wave, unfiltered, filtered and with the filter bypassed, for a
+// few control periods with the kernel WT_SelectVoiceKernel gives it and with the generic code
+// that chooses the interpolator and the filter on every block. Returns the number of mix buffer
+// samples and voice states that differ, or -1 if the build has no voice kernels
+EAS_I32 SonivoxCompareVoiceKernels(EAS_DATA_HANDLE pEASData);
+
+// filters a batch of numLanes voices of noise with the gain and pan in the filter loop, with them
+// after it, and one voice at a time, lane i rendering pShortfall[i] samples less than the control
+// period. Returns the number of mix buffer samples and filter states of the batches that differ
+// from the single voices, or -1 if the build cannot turn the fused output off
+EAS_I32 SonivoxCompareFilterBatch(EAS_DATA_HANDLE pEASData, EAS_INT numLanes, const EAS_I32 *pShortfall);
+
+// coefficients b02, b1, a1 and a2 of the filter at the cutoff in cents and the resonance in 0.1 dB,
+// from the filter table of the instance. Returns the sample rate of the table, or 0 if the build
+// has no filter table
+EAS_I32 SonivoxFilterCoeffs(EAS_DATA_HANDLE pEASData, EAS_I32 cutoff, EAS_I32 resonance, float *pCoeffs);
+
+// largest block SonivoxCompareReverb takes
+#define SONIVOX_REVERB_MAX_SAMPLES 1024
+
+// runs numBlocks blocks of noise through the block reverb of a new reverb instance set to the
+// preset, and through the per-sample reverb it replaced, with the 32-bit input when wide; apLength
+// overrides the allpass delays of the preset when not 0. Returns the number of output samples
+// that differ, or -1, and the shortest run of ReverbBlock in *pRunSize
+EAS_I32 SonivoxCompareReverb(EAS_DATA_HANDLE pEASData, EAS_I32 preset, EAS_I32 apLength, EAS_BOOL wide,
+                             EAS_I32 numSamples, EAS_I32 numBlocks, EAS_I32 *pRunSize);
+
+// frees the note tables of a collection, so note-on walks the regions of its programs,
+// returns EAS_FALSE if the collection had none
+EAS_BOOL SonivoxDropNoteIndex(EAS_DATA_HANDLE pEASData, EAS_DLSLIB_HANDLE pDLS);
+
+// number of voices the voice manager renders
+EAS_I32 SonivoxActiveVoices(EAS_DATA_HANDLE pEASData);
+
+// number of voices stolen for a note they have not started yet
+EAS_I32 SonivoxStolenVoices(EAS_DATA_HANDLE pEASData);
+
+// number of times VMStealVoice would steal another voice than the priority scan it replaced, which
+// is in the test, for the notes the voices play and for a note none plays, in three voice ranges
+EAS_I32 SonivoxCheckStealTree(EAS_DATA_HANDLE pEASData);
+
+// number of voices whose place in the active voice list or the free voice mask does not match their state
+EAS_I32 SonivoxCheckVoiceLists(EAS_DATA_HANDLE pEASData);
+
+// reports a block time to the render budget of the instance, in place of the host clock
+void SonivoxUpdateRenderBudget(EAS_DATA_HANDLE pEASData, EAS_I32 renderTime, EAS_I32 voicesRendered);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __SONIVOX_INTERNALS_H__
@@ -0,0 +1,389 @@
+/*
+ * Copyright (C) 2020 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+// The reverb before it was split into blocks of stages, one sample at a time,
+// to compare the block code with. eas_reverb.c is included to reach its static
+// functions, with its interface renamed so it does not clash with the library.
+
+#include <stdlib.h>
+#include <string.h>
+
+#define EAS_Reverb SonivoxReverbUnderTest
+#include "eas_reverb.c"
+#undef EAS_Reverb
+
+#include "SonivoxInternals.h"
+
+/*----------------------------------------------------------------------------
+ * ReverbSampleReference
+ *----------------------------------------------------------------------------
+ * Purpose:
+ * Computes one stereo frame of reverb
+ *
+ * Inputs:
+ * nBase    - delay line base index of the frame
+ * nMask    - delay line mask
+ * nInL     - left input, dry/4 in the 16-bit range
+ * nInR     - right input, dry/4 in the 16-bit range
+ *
+ * Outputs:
+ * pnOutL   - left output scaled by the wet level
+ * pnOutR   - right output scaled by the wet level
+ *
+ *----------------------------------------------------------------------------
+*/
+static void ReverbSampleReference (S_REVERB_OBJECT *pReverbData, EAS_U16 nBase, EAS_U16 nMask, EAS_I32 nInL, EAS_I32 nInR, EAS_I32 *pnOutL, EAS_I32 *pnOutR)
+{
+    EAS_I32 nDelayOut;
+    EAS_U32 nAddr;
+    EAS_I32 nTemp1;
+    EAS_I32 nTemp2;
+    EAS_I32 nApIn;
+    EAS_I32 nApOut;
+    EAS_I32 j;
+    EAS_I32 nEarlyOut;
+    EAS_I32 tempValue;
+
+    // ********** Left Allpass - start
+    // left input = left dry/4 + right feedback from previous period
+    nApIn = nInL + pReverbData->m_nRevOutFbkR;
+
+    // fetch allpass delay line out
+    //nAddr = CIRCULAR(nBase, psAp0->m_zApOut, REVERB_BUFFER_MASK);
+    nAddr = CIRCULAR(nBase, pReverbData->m_sAp0.m_zApOut, nMask);
+    nDelayOut = pReverbData->m_nDelayLine[nAddr];
+
+    // calculate allpass feedforward; subtract the feedforward result
+    nTemp1 = REVERB_MULT(nApIn, pReverbData->m_sAp0.m_nApGain);
+    nApOut = SATURATE(nDelayOut - nTemp1);          // allpass output
+
+    // calculate allpass feedback; add the feedback result
+    nTemp1 = REVERB_MULT(nApOut, pReverbData->m_sAp0.m_nApGain);
+    nTemp1 = SATURATE(nApIn + nTemp1);
+
+    // inject into allpass delay
+    nAddr = CIRCULAR(nBase, pReverbData->m_sAp0.m_zApIn, nMask);
+    pReverbData->m_nDelayLine[nAddr] = (EAS_PCM) nTemp1;
+
+    // inject allpass output into delay line
+    nAddr = CIRCULAR(nBase, pReverbData->m_zD0In, nMask);
+    pReverbData->m_nDelayLine[nAddr] = (EAS_PCM) nApOut;
+
+    // ********** Left Allpass - end
+
+    // ********** Right Allpass - start
+    // right input = right dry/4 + left feedback from previous period
+    nApIn = nInR + pReverbData->m_nRevOutFbkL;
+
+    // fetch allpass delay line out
+    nAddr = CIRCULAR(nBase, pReverbData->m_sAp1.m_zApOut, nMask);
+    nDelayOut = pReverbData->m_nDelayLine[nAddr];
+
+    // calculate allpass feedforward; subtract the feedforward result
+    nTemp1 = REVERB_MULT(nApIn, pReverbData->m_sAp1.m_nApGain);
+    nApOut = SATURATE(nDelayOut - nTemp1);          // allpass output
+
+    // calculate allpass feedback; add the feedback result
+    nTemp1 = REVERB_MULT(nApOut, pReverbData->m_sAp1.m_nApGain);
+    nTemp1 = SATURATE(nApIn + nTemp1);
+
+    // inject into allpass delay
+    nAddr = CIRCULAR(nBase, pReverbData->m_sAp1.m_zApIn, nMask);
+    pReverbData->m_nDelayLine[nAddr] = (EAS_PCM) nTemp1;
+
+    // inject allpass output into delay line
+    nAddr = CIRCULAR(nBase, pReverbData->m_zD1In, nMask);
+    pReverbData->m_nDelayLine[nAddr] = (EAS_PCM) nApOut;
+
+    // ********** Right Allpass - end
+
+    // ********** D0 output - start
+    // fetch delay line self out
+    nAddr = CIRCULAR(nBase, pReverbData->m_zD0Self, nMask);
+    nDelayOut = pReverbData->m_nDelayLine[nAddr];
+
+    // calculate delay line self out
+    nTemp1 = REVERB_MULT(nDelayOut, pReverbData->m_nSin);
+
+    // fetch delay line cross out
+    nAddr = CIRCULAR(nBase, pReverbData->m_zD1Cross, nMask);
+    nDelayOut = pReverbData->m_nDelayLine[nAddr];
+
+    // calculate delay line self out
+    nTemp2 = REVERB_MULT(nDelayOut, pReverbData->m_nCos);
+
+    // calculate unfiltered delay out
+    nDelayOut = SATURATE(nTemp1 + nTemp2);
+
+    // calculate lowpass filter (mixer scale factor included in LPF feedforward)
+    nTemp1 = REVERB_MULT(nDelayOut, pReverbData->m_nLpfFwd);
+
+    nTemp2 = REVERB_MULT(pReverbData->m_zLpf0, pReverbData->m_nLpfFbk);
+
+    // calculate filtered delay out and simultaneously update LPF state variable
+    // filtered delay output is stored in m_zLpf0
+    pReverbData->m_zLpf0 = (EAS_PCM) SATURATE(nTemp1 + nTemp2);
+
+    // ********** D0 output - end
+
+    // ********** D1 output - start
+    // fetch delay line self out
+    nAddr = CIRCULAR(nBase, pReverbData->m_zD1Self, nMask);
+    nDelayOut = pReverbData->m_nDelayLine[nAddr];
+
+    // calculate delay line self out
+    nTemp1 = REVERB_MULT(nDelayOut, pReverbData->m_nSin);
+
+    // fetch delay line cross out
+    nAddr = CIRCULAR(nBase, pReverbData->m_zD0Cross, nMask);
+    nDelayOut = pReverbData->m_nDelayLine[nAddr];
+
+    // calculate delay line self out
+    nTemp2 = REVERB_MULT(nDelayOut, pReverbData->m_nCos);
+
+    // calculate unfiltered delay out
+    nDelayOut = SATURATE(nTemp1 + nTemp2);
+
+    // calculate lowpass filter (mixer scale factor included in LPF feedforward)
+    nTemp1 = REVERB_MULT(nDelayOut, pReverbData->m_nLpfFwd);
+
+    nTemp2 = REVERB_MULT(pReverbData->m_zLpf1, pReverbData->m_nLpfFbk);
+
+    // calculate filtered delay out and simultaneously update LPF state variable
+    // filtered delay output is stored in m_zLpf1
+    pReverbData->m_zLpf1 = (EAS_PCM)SATURATE(nTemp1 + nTemp2);
+
+    // ********** D1 output - end
+
+    // ********** mixer and feedback - start
+    // sum is fedback to right input (R + L)
+    pReverbData->m_nRevOutFbkL =
+        (EAS_PCM)SATURATE((EAS_I32)pReverbData->m_zLpf1 + (EAS_I32)pReverbData->m_zLpf0);
+
+    // difference is feedback to left input (R - L)
+    /*lint -e{685} lint complains that it can't saturate negative */
+    pReverbData->m_nRevOutFbkR =
+        (EAS_PCM)SATURATE((EAS_I32)pReverbData->m_zLpf1 - (EAS_I32)pReverbData->m_zLpf0);
+
+    // ********** mixer and feedback - end
+
+    // ********** start early reflection generator, left
+    //psEarly = &(pReverbData->m_sEarlyL);
+
+    nEarlyOut = 0;
+
+    for (j=0; j < REVERB_MAX_NUM_REFLECTIONS; j++)
+    {
+        // fetch delay line out
+        //nAddr = CIRCULAR(nBase, psEarly->m_zDelay[j], REVERB_BUFFER_MASK);
+        nAddr = CIRCULAR(nBase, pReverbData->m_sEarlyL.m_zDelay[j], nMask);
+
+        nDelayOut = pReverbData->m_nDelayLine[nAddr];
+
+        // calculate reflection
+        //nTemp1 = MULT_EG1_EG1(nDelayOut, psEarly->m_nGain[j]);
+        nTemp1 = REVERB_MULT(nDelayOut, pReverbData->m_sEarlyL.m_nGain[j]);
+
+        nEarlyOut = SATURATE(nEarlyOut + nTemp1);
+
+    }   // end for (j=0; j < REVERB_MAX_NUM_REFLECTIONS; j++)
+
+    // apply lowpass to early reflections
+    //nTemp1 = MULT_EG1_EG1(nEarlyOut, psEarly->m_nLpfFwd);
+    nTemp1 = REVERB_MULT(nEarlyOut, pReverbData->m_sEarlyL.m_nLpfFwd);
+
+    //nTemp2 = MULT_EG1_EG1(psEarly->m_zLpf, psEarly->m_nLpfFbk);
+    nTemp2 = REVERB_MULT(pReverbData->m_sEarlyL.m_zLpf, pReverbData->m_sEarlyL.m_nLpfFbk);
+
+
+    // calculate filtered out and simultaneously update LPF state variable
+    // filtered output is stored in m_zLpf1
+    //psEarly->m_zLpf = SATURATE(nTemp1 + nTemp2);
+    pReverbData->m_sEarlyL.m_zLpf = (EAS_PCM) SATURATE(nTemp1 + nTemp2);
+
+    // combine filtered early and late reflections for output
+    //*pOutputBuffer++ = inL;
+    //tempValue = SATURATE(psEarly->m_zLpf + pReverbData->m_nRevOutFbkL);
+    tempValue = SATURATE((EAS_I32)pReverbData->m_sEarlyL.m_zLpf + (EAS_I32)pReverbData->m_nRevOutFbkL);
+    //scale reverb output by wet level
+    /*lint -e{701} use shift for performance */
+    *pnOutL = REVERB_MULT(tempValue, (pReverbData->m_nWet<<1));
+
+    // ********** end early reflection generator, left
+
+    // ********** start early reflection generator, right
+    //psEarly = &(pReverbData->m_sEarlyR);
+
+    nEarlyOut = 0;
+
+    for (j=0; j < REVERB_MAX_NUM_REFLECTIONS; j++)
+    {
+        // fetch delay line out
+        nAddr = CIRCULAR(nBase, pReverbData->m_sEarlyR.m_zDelay[j], nMask);
+        nDelayOut = pReverbData->m_nDelayLine[nAddr];
+
+        // calculate reflection
+        nTemp1 = REVERB_MULT(nDelayOut, pReverbData->m_sEarlyR.m_nGain[j]);
+
+        nEarlyOut = SATURATE(nEarlyOut + nTemp1);
+
+    }   // end for (j=0; j < REVERB_MAX_NUM_REFLECTIONS; j++)
+
+    // apply lowpass to early reflections
+    nTemp1 = REVERB_MULT(nEarlyOut, pReverbData->m_sEarlyR.m_nLpfFwd);
+
+    nTemp2 = REVERB_MULT(pReverbData->m_sEarlyR.m_zLpf, pReverbData->m_sEarlyR.m_nLpfFbk);
+
+    // calculate filtered out and simultaneously update LPF state variable
+    // filtered output is stored in m_zLpf1
+    pReverbData->m_sEarlyR.m_zLpf = (EAS_PCM)SATURATE(nTemp1 + nTemp2);
+
+    // combine filtered early and late reflections for output
+    //*pOutputBuffer++ = inR;
+    tempValue = SATURATE((EAS_I32)pReverbData->m_sEarlyR.m_zLpf + (EAS_I32)pReverbData->m_nRevOutFbkR);
+    //scale reverb output by wet level
+    /*lint -e{701} use shift for performance */
+    *pnOutR = REVERB_MULT(tempValue, (pReverbData->m_nWet << 1));
+
+    // ********** end early reflection generator, right
+}   /* end ReverbSampleReference */
+
+/* the per-sample loop of Reverb and of Reverb32 */
+static void ReverbReference (S_REVERB_OBJECT *pReverbData, EAS_INT nNumSamplesToAdd, EAS_I32 *pOutputBuffer,
+                             const EAS_I32 *pInputBuffer, EAS_BOOL wide)
+{
+    EAS_I32 i;
+    EAS_U16 nBase;
+    EAS_U16 nMask;
+    EAS_I32 nOutL;
+    EAS_I32 nOutR;
+
+    nBase = pReverbData->m_nBaseIndex;
+    nMask = pReverbData->m_nBufferMask;
+
+    for (i = 0; i < nNumSamplesToAdd; i++)
+    {
+        if (wide)
+        {
+            ReverbSampleReference(pReverbData, nBase, nMask, SATURATE(pInputBuffer[0] >> 2), SATURATE(pInputBuffer[1] >> 2), &nOutL, &nOutR);
+            pOutputBuffer[0] += nOutL;
+            pOutputBuffer[1] += nOutR;
+        }
+        else
+        {
+            ReverbSampleReference(pReverbData, nBase, nMask, pInputBuffer[0] >> 2, pInputBuffer[1] >> 2, &nOutL, &nOutR);
+            pOutputBuffer[0] = (EAS_PCM) SATURATE(nOutL + pOutputBuffer[0]);
+            pOutputBuffer[1] = (EAS_PCM) SATURATE(nOutR + pOutputBuffer[1]);
+        }
+        pInputBuffer += NUM_OUTPUT_CHANNELS;
+        pOutputBuffer += NUM_OUTPUT_CHANNELS;
+
+        nBase--;
+        pReverbData->m_nSin += pReverbData->m_nSinIncrement;
+        pReverbData->m_nCos += pReverbData->m_nCosIncrement;
+    }
+
+    pReverbData->m_nBaseIndex = nBase;
+}
+
+EAS_I32 SonivoxCompareReverb(EAS_DATA_HANDLE pEASData, EAS_I32 preset, EAS_I32 apLength, EAS_BOOL wide,
+                             EAS_I32 numSamples, EAS_I32 numBlocks, EAS_I32 *pRunSize)
+{
+    S_REVERB_OBJECT *pReverbData;
+    S_REVERB_OBJECT *pReference;
+    EAS_PCM pcmIn[NUM_OUTPUT_CHANNELS * SONIVOX_REVERB_MAX_SAMPLES];
+    EAS_PCM pcmOut[NUM_OUTPUT_CHANNELS * SONIVOX_REVERB_MAX_SAMPLES];
+    EAS_I32 input[NUM_OUTPUT_CHANNELS * SONIVOX_REVERB_MAX_SAMPLES];
+    EAS_I32 output[NUM_OUTPUT_CHANNELS * SONIVOX_REVERB_MAX_SAMPLES];
+    EAS_I32 reference[NUM_OUTPUT_CHANNELS * SONIVOX_REVERB_MAX_SAMPLES];
+    EAS_U32 noise = 1;
+    EAS_I32 mismatches = 0;
+    EAS_I32 size;
+    EAS_I32 block;
+    EAS_I32 i;
+
+    if ((numSamples <= 0) || (numSamples > SONIVOX_REVERB_MAX_SAMPLES))
+        return -1;
+    if (ReverbInit(pEASData, (EAS_VOID_PTR *) &pReverbData) != EAS_SUCCESS)
+        return -1;
+    ReverbSetParam(pReverbData, EAS_PARAM_REVERB_BYPASS, EAS_FALSE);
+    ReverbSetParam(pReverbData, EAS_PARAM_REVERB_PRESET, preset);
+    ReverbUpdateRoom(pReverbData);
+
+    /* an allpass output read soon after its input is written limits the runs of ReverbBlock */
+    if (apLength > 0)
+    {
+        pReverbData->m_sAp0.m_zApOut = (EAS_U16) (pReverbData->m_sAp0.m_zApIn + apLength);
+        pReverbData->m_sAp1.m_zApOut = (EAS_U16) (pReverbData->m_sAp1.m_zApIn + apLength);
+    }
+
+    /* the reference starts from a copy of the instance, delay line included */
+    size = (EAS_I32) sizeof(S_REVERB_OBJECT) + (pReverbData->m_nBufferMask + 1) * (EAS_I32) sizeof(EAS_PCM);
+    pReference = malloc(size);
+    if (pReference == NULL)
+    {
+        ReverbShutdown(pEASData, pReverbData);
+        return -1;
+    }
+    memcpy(pReference, pReverbData, size);
+    pReference->m_nDelayLine = (EAS_PCM *) (pReference + 1);
+
+    *pRunSize = REVERB_BLOCK_SIZE;
+    for (block = 0; block < numBlocks; block++)
+    {
+        /* noise is added to noise, and the 32-bit input goes beyond the 16-bit range */
+        for (i = 0; i < numSamples * NUM_OUTPUT_CHANNELS; i++)
+        {
+            noise = noise * 1664525 + 1013904223;
+            input[i] = (EAS_I32) noise >> (wide ? 14 : 16);
+            noise = noise * 1664525 + 1013904223;
+            output[i] = reference[i] = (EAS_I32) noise >> 18;
+        }
+
+        ReverbStartBlock(pReverbData, numSamples, EAS_FALSE);
+        ReverbStartBlock(pReference, numSamples, EAS_FALSE);
+        if (ReverbBlockSize(pReverbData) < *pRunSize)
+            *pRunSize = ReverbBlockSize(pReverbData);
+
+        if (wide)
+            Reverb32(pReverbData, numSamples, output, input);
+        else
+        {
+            for (i = 0; i < numSamples * NUM_OUTPUT_CHANNELS; i++)
+            {
+                pcmIn[i] = (EAS_PCM) input[i];
+                pcmOut[i] = (EAS_PCM) output[i];
+            }
+            Reverb(pReverbData, numSamples, pcmOut, pcmIn);
+            for (i = 0; i < numSamples * NUM_OUTPUT_CHANNELS; i++)
+                output[i] = pcmOut[i];
+        }
+        ReverbReference(pReference, numSamples, reference, input, wide);
+        ReverbEndBlock(pReverbData, numSamples);
+        ReverbEndBlock(pReference, numSamples);
+
+        for (i = 0; i < numSamples * NUM_OUTPUT_CHANNELS; i++)
+        {
+            if (output[i] != reference[i])
+                mismatches++;
+        }
+    }
+
+    free(pReference);
+    ReverbShutdown(pEASData, pReverbData);
+    return mismatches;
+}
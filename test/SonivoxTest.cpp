@@ -17,13 +17,23 @@
 #define LOG_TAG "SonivoxTest"
 #include <utils/Log.h>
 
+#include <algorithm>
+#include <cmath>
 #include <fcntl.h>
 #include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
 #include <eas.h>
+#include <eas_chorus.h>
 #include <eas_report.h>
 #include <eas_reverb.h>
 
+#include "SonivoxInternals.h"
 #include "SonivoxTestEnvironment.h"
 
 // number of Sonivox output buffers to aggregate into one MediaBuffer
@@ -40,6 +50,15 @@ static constexpr uint32_t numChannels = 2;
 
 static SonivoxTestEnvironment *gEnv = nullptr;
 
+// an instance of the library for the tests that do not play a file, shut down when it goes away
+using EASInstance = std::unique_ptr<std::remove_pointer<EAS_DATA_HANDLE>::type, decltype(&EAS_Shutdown)>;
+
+static EASInstance initInstance() {
+    EAS_DATA_HANDLE easData = nullptr;
+    if (EAS_Init(&easData) != EAS_SUCCESS) easData = nullptr;
+    return EASInstance(easData, EAS_Shutdown);
+}
+
 class SonivoxTest : public ::testing::TestWithParam<tuple</*fileName*/ string,
                                                           /*audioPlayTimeMs*/ uint32_t,
                                                           /*soundFont*/ string>>
@@ -175,6 +194,12 @@ public:
 
     bool seekToLocation(EAS_I32);
     bool renderAudio();
+    bool openInstance(EAS_DATA_HANDLE *, EAS_HANDLE *, EAS_FILE *, EAS_FILE *,
+                      const S_EAS_INIT_CONFIG *pConfig = nullptr, const char *library = nullptr,
+                      EAS_DLSLIB_HANDLE pDLS = nullptr);
+    bool renderInstance(const std::function<void(EAS_DATA_HANDLE)> &setup, EAS_I32 numBuffers,
+                        vector<EAS_PCM> &output,
+                        const std::function<void(EAS_DATA_HANDLE)> &inspect = nullptr);
 
     string mInputMediaFile;
     string mSoundFont;
@@ -226,6 +251,78 @@ bool SonivoxTest::renderAudio() {
     return true;
 }
 
+// opens the test file and soundfont on a second, independent library instance
+bool SonivoxTest::openInstance(EAS_DATA_HANDLE *pEASData, EAS_HANDLE *pStream, EAS_FILE *pEasFile,
+                               EAS_FILE *pDLSFile, const S_EAS_INIT_CONFIG *pConfig,
+                               const char *library, EAS_DLSLIB_HANDLE pDLS) {
+    *pStream = nullptr;
+    memset(pEasFile, 0, sizeof(*pEasFile));
+    if (EAS_InitEx(pEASData, pConfig) != EAS_SUCCESS) return false;
+
+    // releases what was opened so far, the caller only cleans up after a successful open
+    auto fail = [&]() {
+        if (*pStream != nullptr) EAS_CloseFile(*pEASData, *pStream);
+        EAS_Shutdown(*pEASData);
+        if (pEasFile->handle != nullptr) fclose((FILE *)pEasFile->handle);
+        *pStream = nullptr;
+        *pEASData = nullptr;
+        return false;
+    };
+
+    if (library != nullptr &&
+        EAS_SetSoundLibrary(*pEASData, nullptr, EAS_GetSoundLibrary(*pEASData, library)) != EAS_SUCCESS)
+        return fail();
+
+    if (pDLS != nullptr) {
+        if (EAS_SetDLSCollection(*pEASData, nullptr, pDLS) != EAS_SUCCESS) return fail();
+    } else if (mSoundFont.length() > 0) {
+        string soundfontpath = gEnv->getTmp() + mSoundFont;
+        memset(pDLSFile, 0, sizeof(*pDLSFile));
+        pDLSFile->handle = fopen(soundfontpath.c_str(), "rb");
+        if (pDLSFile->handle == nullptr) return fail();
+        EAS_RESULT result = EAS_LoadDLSCollection(*pEASData, nullptr, pDLSFile);
+        fclose((FILE *)pDLSFile->handle);
+        if (result != EAS_SUCCESS) return fail();
+    }
+
+    pEasFile->handle = fopen(mInputMediaFile.c_str(), "rb");
+    if (pEasFile->handle == nullptr) return fail();
+    if (EAS_OpenFile(*pEASData, pEasFile, pStream) != EAS_SUCCESS) return fail();
+
+    if (EAS_Prepare(*pEASData, *pStream) != EAS_SUCCESS) return fail();
+
+    // parse the meta data like SetUp does, so both instances start in the same state
+    EAS_I32 playTimeMs;
+    if (EAS_ParseMetaData(*pEASData, *pStream, &playTimeMs) != EAS_SUCCESS) return fail();
+    return true;
+}
+
+// renders the start of the test file on a second instance, after setup has changed its render paths,
+// calling inspect after every buffer
+bool SonivoxTest::renderInstance(const std::function<void(EAS_DATA_HANDLE)> &setup, EAS_I32 numBuffers,
+                                 vector<EAS_PCM> &output,
+                                 const std::function<void(EAS_DATA_HANDLE)> &inspect) {
+    EAS_DATA_HANDLE easData;
+    EAS_HANDLE stream;
+    EAS_FILE easFile, dlsFile;
+    if (!openInstance(&easData, &stream, &easFile, &dlsFile)) return false;
+    if (setup) setup(easData);
+
+    EAS_I32 bufferSize = mEASConfig->mixBufferSize;
+    output.assign(bufferSize * numBuffers * numChannels, 0);
+    bool rendered = true;
+    for (EAS_I32 i = 0; i < numBuffers && rendered; i++) {
+        EAS_I32 count;
+        rendered = EAS_Render(easData, &output[i * bufferSize * numChannels], bufferSize, &count) == EAS_SUCCESS &&
+                   count == bufferSize;
+        if (inspect) inspect(easData);
+    }
+    EAS_CloseFile(easData, stream);
+    EAS_Shutdown(easData);
+    fclose((FILE *)easFile.handle);
+    return rendered;
+}
+
 TEST_P(SonivoxTest, DecodeTest) {
     EAS_I32 totalChannels = mEASConfig->numChannels;
     ASSERT_EQ(totalChannels, mTotalAudioChannels)
@@ -354,6 +451,1315 @@ TEST_P(SonivoxTest, DecodePauseResumeTest) {
     ASSERT_EQ(state, EAS_STATE_PLAY) << "Invalid state reached when resumed";
 }
 
+TEST_P(SonivoxTest, RenderFramesTest) {
+    static constexpr EAS_I32 kNumBuffers = 64;
+    static constexpr EAS_I32 kRequestSizes[] = {1, 100, 333, 1000, 17};
+
+    EAS_I32 bufferSize = mEASConfig->mixBufferSize;
+    EAS_I32 totalFrames = bufferSize * kNumBuffers;
+    vector<EAS_PCM> reference(totalFrames * numChannels);
+    vector<EAS_PCM> frames(totalFrames * numChannels);
+
+    // reference output, rendered one mix buffer at a time
+    EAS_I32 count;
+    for (EAS_I32 i = 0; i < kNumBuffers; i++) {
+        EAS_RESULT result = EAS_Render(mEASDataHandle, &reference[i * bufferSize * numChannels],
+                                       bufferSize, &count);
+        ASSERT_EQ(result, EAS_SUCCESS) << "Failed to render the audio data";
+        ASSERT_EQ(count, bufferSize);
+    }
+
+    EAS_DATA_HANDLE easData = nullptr;
+    EAS_HANDLE stream = nullptr;
+    EAS_FILE easFile, dlsFile;
+    ASSERT_TRUE(openInstance(&easData, &stream, &easFile, &dlsFile))
+        << "Failed to open a second instance for: " << mInputMediaFile;
+
+    // same stream rendered in requests that do not line up with the mix buffer
+    EAS_I32 rendered = 0;
+    for (size_t i = 0; rendered < totalFrames; i++) {
+        EAS_I32 request = kRequestSizes[i % (sizeof(kRequestSizes) / sizeof(kRequestSizes[0]))];
+        if (request > totalFrames - rendered) request = totalFrames - rendered;
+        EAS_RESULT result = EAS_RenderFrames(easData, &frames[rendered * numChannels], request, &count);
+        ASSERT_EQ(result, EAS_SUCCESS) << "Failed to render " << request << " frames";
+        ASSERT_EQ(count, request);
+        rendered += count;
+    }
+
+    EXPECT_EQ(EAS_CloseFile(easData, stream), EAS_SUCCESS);
+    EXPECT_EQ(EAS_Shutdown(easData), EAS_SUCCESS);
+    fclose((FILE *)easFile.handle);
+
+    ASSERT_TRUE(reference == frames) << "EAS_RenderFrames output differs from EAS_Render";
+}
+
+TEST_P(SonivoxTest, RenderFramesSeekTest) {
+    static constexpr EAS_I32 kNumBuffers = 64;
+    static constexpr EAS_I32 kPartialFrames = 7;
+
+    EAS_I32 bufferSize = mEASConfig->mixBufferSize;
+    EAS_I32 totalFrames = bufferSize * kNumBuffers;
+    EAS_I32 seekMs = mAudioplayTimeMs / 2;
+    vector<EAS_PCM> reference(totalFrames * numChannels);
+    vector<EAS_PCM> frames(totalFrames * numChannels);
+    EAS_I32 count;
+
+    // a seek does not silence the effects and voices, so both instances render the same blocks
+    // before it: half of the frames, plus the block of which only kPartialFrames are consumed
+    EAS_DATA_HANDLE easData = nullptr;
+    EAS_HANDLE stream = nullptr;
+    EAS_FILE easFile, dlsFile;
+    ASSERT_TRUE(openInstance(&easData, &stream, &easFile, &dlsFile))
+        << "Failed to open a second instance for: " << mInputMediaFile;
+    for (EAS_I32 i = 0; i < kNumBuffers / 2 + 1; i++) {
+        EXPECT_EQ(EAS_Render(easData, reference.data(), bufferSize, &count), EAS_SUCCESS);
+    }
+    EXPECT_EQ(EAS_Locate(easData, stream, seekMs, false), EAS_SUCCESS);
+    for (EAS_I32 i = 0; i < kNumBuffers; i++) {
+        EXPECT_EQ(EAS_Render(easData, &reference[i * bufferSize * numChannels], bufferSize, &count),
+                  EAS_SUCCESS);
+    }
+    EXPECT_EQ(EAS_CloseFile(easData, stream), EAS_SUCCESS);
+    EXPECT_EQ(EAS_Shutdown(easData), EAS_SUCCESS);
+    fclose((FILE *)easFile.handle);
+
+    ASSERT_TRUE(openInstance(&easData, &stream, &easFile, &dlsFile))
+        << "Failed to open a second instance for: " << mInputMediaFile;
+    EXPECT_EQ(EAS_RenderFrames(easData, frames.data(), totalFrames / 2 + kPartialFrames, &count), EAS_SUCCESS);
+    EXPECT_EQ(EAS_Render(easData, frames.data(), bufferSize, &count), EAS_ERROR_NOT_VALID_IN_THIS_STATE)
+        << "EAS_Render skipped the pending frames";
+
+    // the frames pending from before the seek must not be returned after it
+    EXPECT_EQ(EAS_Locate(easData, stream, seekMs, false), EAS_SUCCESS);
+    EXPECT_EQ(EAS_RenderFrames(easData, frames.data(), totalFrames, &count), EAS_SUCCESS);
+    EXPECT_EQ(count, totalFrames);
+    EXPECT_EQ(EAS_CloseFile(easData, stream), EAS_SUCCESS);
+    EXPECT_EQ(EAS_Shutdown(easData), EAS_SUCCESS);
+    fclose((FILE *)easFile.handle);
+
+    ASSERT_TRUE(reference == frames) << "Rendering after a seek differs from a render from the same position";
+}
+
+TEST_P(SonivoxTest, RenderFloatTest) {
+    static constexpr EAS_I32 kNumBuffers = 64;
+
+    EAS_I32 bufferSize = mEASConfig->mixBufferSize;
+    EAS_I32 totalFrames = bufferSize * kNumBuffers;
+
+    // without and with the post-mix (16-bit) reverb and chorus
+    for (EAS_BOOL postMix : {EAS_FALSE, EAS_TRUE}) {
+        EAS_DATA_HANDLE easData[3] = {nullptr, nullptr, nullptr};
+        EAS_HANDLE stream[3];
+        EAS_FILE easFile[3], dlsFile[3];
+        for (int i = 0; i < 3; i++) {
+            ASSERT_TRUE(openInstance(&easData[i], &stream[i], &easFile[i], &dlsFile[i]))
+                << "Failed to open an instance for: " << mInputMediaFile;
+            ASSERT_EQ(EAS_SetParameter(easData[i], EAS_MODULE_REVERB, EAS_PARAM_REVERB_OVERRIDE_CC, postMix),
+                      EAS_SUCCESS);
+            ASSERT_EQ(EAS_SetParameter(easData[i], EAS_MODULE_CHORUS, EAS_PARAM_CHORUS_OVERRIDE_CC, postMix),
+                      EAS_SUCCESS);
+        }
+
+        vector<EAS_PCM> pcm(totalFrames * numChannels);
+        vector<float> interleaved(totalFrames * numChannels);
+        vector<vector<float>> planar(numChannels, vector<float>(totalFrames));
+        EAS_I32 count;
+        for (EAS_I32 i = 0; i < kNumBuffers; i++) {
+            EAS_I32 offset = i * bufferSize;
+            ASSERT_EQ(EAS_Render(easData[0], &pcm[offset * numChannels], bufferSize, &count), EAS_SUCCESS);
+            ASSERT_EQ(count, bufferSize);
+            ASSERT_EQ(EAS_RenderFloat(easData[1], &interleaved[offset * numChannels], bufferSize, &count),
+                      EAS_SUCCESS);
+            ASSERT_EQ(count, bufferSize);
+            vector<float *> channels;
+            for (auto &channel : planar) channels.push_back(&channel[offset]);
+            ASSERT_EQ(EAS_RenderFloatPlanar(easData[2], channels.data(), bufferSize, &count), EAS_SUCCESS);
+            ASSERT_EQ(count, bufferSize);
+        }
+
+        for (int i = 0; i < 3; i++) {
+            EXPECT_EQ(EAS_CloseFile(easData[i], stream[i]), EAS_SUCCESS);
+            EXPECT_EQ(EAS_Shutdown(easData[i]), EAS_SUCCESS);
+            fclose((FILE *)easFile[i].handle);
+        }
+
+        for (EAS_I32 frame = 0; frame < totalFrames; frame++) {
+            for (uint32_t chan = 0; chan < numChannels; chan++) {
+                EAS_I32 index = frame * numChannels + chan;
+                ASSERT_EQ(interleaved[index], planar[chan][frame])
+                    << "Planar output differs from interleaved at frame " << frame;
+                if (postMix) {
+                    // the post-mix effects run at 16 bits, the float output matches exactly
+                    ASSERT_EQ(interleaved[index], pcm[index] / 32768.0f) << "at frame " << frame;
+                } else if (pcm[index] > -32768 && pcm[index] < 32767) {
+                    // 16-bit output truncates, float keeps the fraction
+                    ASSERT_NEAR(interleaved[index] * 32768.0f, pcm[index], 1.0f) << "at frame " << frame;
+                }
+            }
+        }
+    }
+}
+
+TEST_P(SonivoxTest, BlockSizeTest) {
+    static constexpr EAS_I32 kNumBuffers = 256;
+    static constexpr EAS_I32 kInvalidSizes[] = {16, 100, 2048};
+    static constexpr EAS_I32 kBlockSizes[] = {64, 1024};
+
+    for (EAS_I32 blockSize : kInvalidSizes) {
+        S_EAS_INIT_CONFIG config = {};
+        config.blockSize = blockSize;
+        EAS_DATA_HANDLE easData = nullptr;
+        EXPECT_NE(EAS_InitEx(&easData, &config), EAS_SUCCESS) << "block size " << blockSize;
+        EXPECT_EQ(easData, nullptr);
+    }
+
+    // the control period may not exceed the block size
+    S_EAS_INIT_CONFIG invalidPeriod = {};
+    invalidPeriod.blockSize = 64;
+    invalidPeriod.controlPeriod = 128;
+    EAS_DATA_HANDLE invalidData = nullptr;
+    EXPECT_NE(EAS_InitEx(&invalidData, &invalidPeriod), EAS_SUCCESS);
+    EXPECT_EQ(invalidData, nullptr);
+
+    // reference energy, rendered with the default block size
+    EAS_I32 bufferSize = mEASConfig->mixBufferSize;
+    EAS_I32 totalFrames = bufferSize * kNumBuffers;
+    vector<EAS_PCM> reference(totalFrames * numChannels);
+    EAS_I32 count;
+    for (EAS_I32 i = 0; i < kNumBuffers; i++) {
+        ASSERT_EQ(EAS_Render(mEASDataHandle, &reference[i * bufferSize * numChannels], bufferSize,
+                             &count), EAS_SUCCESS);
+    }
+    double referenceEnergy = 0;
+    for (EAS_PCM sample : reference) referenceEnergy += (double)sample * sample;
+    EAS_I32 referenceTimeMs;
+    ASSERT_EQ(EAS_GetRenderTime(mEASDataHandle, &referenceTimeMs), EAS_SUCCESS);
+
+    for (EAS_I32 blockSize : kBlockSizes) {
+        S_EAS_INIT_CONFIG config = {};
+        config.blockSize = blockSize;
+        EAS_DATA_HANDLE easData = nullptr;
+        EAS_HANDLE stream = nullptr;
+        EAS_FILE easFile, dlsFile;
+        ASSERT_TRUE(openInstance(&easData, &stream, &easFile, &dlsFile, &config))
+            << "Failed to open an instance with block size " << blockSize;
+
+        S_EAS_INIT_CONFIG actual;
+        ASSERT_EQ(EAS_GetInitConfig(easData, &actual), EAS_SUCCESS);
+        EXPECT_EQ(actual.blockSize, blockSize);
+        EXPECT_LE(actual.controlPeriod, blockSize);
+
+        // EAS_Render only accepts the instance block size
+        vector<EAS_PCM> frames(totalFrames * numChannels);
+        EXPECT_EQ(EAS_Render(easData, frames.data(), bufferSize, &count), EAS_BUFFER_SIZE_MISMATCH);
+
+        for (EAS_I32 rendered = 0; rendered < totalFrames; rendered += blockSize) {
+            ASSERT_EQ(EAS_Render(easData, &frames[rendered * numChannels], blockSize, &count),
+                      EAS_SUCCESS);
+            ASSERT_EQ(count, blockSize);
+        }
+        EAS_I32 timeMs;
+        ASSERT_EQ(EAS_GetRenderTime(easData, &timeMs), EAS_SUCCESS);
+
+        EXPECT_EQ(EAS_CloseFile(easData, stream), EAS_SUCCESS);
+        EXPECT_EQ(EAS_Shutdown(easData), EAS_SUCCESS);
+        fclose((FILE *)easFile.handle);
+
+        // envelopes and LFOs run at the same rate, so the output carries the same energy
+        double energy = 0;
+        for (EAS_PCM sample : frames) energy += (double)sample * sample;
+        EXPECT_NEAR(energy, referenceEnergy, referenceEnergy * 0.1) << "block size " << blockSize;
+        EXPECT_NEAR(timeMs, referenceTimeMs, 2) << "block size " << blockSize;
+    }
+}
+
+TEST_P(SonivoxTest, SampleRateTest) {
+    static constexpr EAS_I32 kRenderTimeMs = 3000;
+    static constexpr EAS_I32 kInvalidRates[] = {12345, 192000};
+    static constexpr EAS_I32 kSampleRates[] = {22050, 48000, 96000};
+
+    for (EAS_I32 sampleRate : kInvalidRates) {
+        S_EAS_INIT_CONFIG config = {};
+        config.sampleRate = sampleRate;
+        EAS_DATA_HANDLE easData = nullptr;
+        EXPECT_NE(EAS_InitEx(&easData, &config), EAS_SUCCESS) << "sample rate " << sampleRate;
+        EXPECT_EQ(easData, nullptr);
+    }
+
+    // reference power, rendered at the build sample rate
+    EAS_I32 bufferSize = mEASConfig->mixBufferSize;
+    vector<EAS_PCM> frames(bufferSize * numChannels);
+    EAS_I32 count;
+    EAS_I32 numBuffers = mEASConfig->sampleRate * kRenderTimeMs / 1000 / bufferSize;
+    double referencePower = 0;
+    for (EAS_I32 i = 0; i < numBuffers; i++) {
+        ASSERT_EQ(EAS_Render(mEASDataHandle, frames.data(), bufferSize, &count), EAS_SUCCESS);
+        for (EAS_PCM sample : frames) referencePower += (double)sample * sample;
+    }
+    referencePower /= numBuffers * bufferSize;
+
+    for (EAS_I32 sampleRate : kSampleRates) {
+        S_EAS_INIT_CONFIG config = {};
+        config.sampleRate = sampleRate;
+        EAS_DATA_HANDLE easData = nullptr;
+        EAS_HANDLE stream = nullptr;
+        EAS_FILE easFile, dlsFile;
+        ASSERT_TRUE(openInstance(&easData, &stream, &easFile, &dlsFile, &config))
+            << "Failed to open an instance at " << sampleRate << " Hz";
+
+        S_EAS_INIT_CONFIG actual;
+        ASSERT_EQ(EAS_GetInitConfig(easData, &actual), EAS_SUCCESS);
+        EXPECT_EQ(actual.sampleRate, sampleRate);
+
+        numBuffers = sampleRate * kRenderTimeMs / 1000 / bufferSize;
+        double power = 0;
+        for (EAS_I32 i = 0; i < numBuffers; i++) {
+            ASSERT_EQ(EAS_Render(easData, frames.data(), bufferSize, &count), EAS_SUCCESS);
+            for (EAS_PCM sample : frames) power += (double)sample * sample;
+        }
+        power /= numBuffers * bufferSize;
+        EAS_I32 timeMs;
+        ASSERT_EQ(EAS_GetRenderTime(easData, &timeMs), EAS_SUCCESS);
+
+        EXPECT_EQ(EAS_CloseFile(easData, stream), EAS_SUCCESS);
+        EXPECT_EQ(EAS_Shutdown(easData), EAS_SUCCESS);
+        fclose((FILE *)easFile.handle);
+
+        // the song plays at the same tempo and level at any output rate
+        EXPECT_NEAR(timeMs, (double)numBuffers * bufferSize * 1000 / sampleRate, 2)
+            << "sample rate " << sampleRate;
+        EXPECT_NEAR(power, referencePower, referencePower * 0.15) << "sample rate " << sampleRate;
+    }
+}
+
+TEST_P(SonivoxTest, PitchOffsetTest) {
+    static constexpr EAS_I32 kSampleRates[] = {8000,  11025, 16000, 20000, 22050, 24000,
+                                               32000, 44100, 48000, 88200, 96000};
+
+    // the pitch correction is the exact interval, rounded to the nearest cent
+    for (EAS_I32 sampleRate : kSampleRates) {
+        S_EAS_INIT_CONFIG config = {};
+        config.sampleRate = sampleRate;
+        EAS_DATA_HANDLE easData = nullptr;
+        ASSERT_EQ(EAS_InitEx(&easData, &config), EAS_SUCCESS) << "sample rate " << sampleRate;
+        double cents = 1200 * log2((double)mEASConfig->sampleRate / sampleRate);
+        EXPECT_NEAR(SonivoxPitchOffset(easData), cents, 0.5) << "sample rate " << sampleRate;
+        EXPECT_EQ(EAS_Shutdown(easData), EAS_SUCCESS);
+    }
+}
+
+TEST_P(SonivoxTest, VoiceCapacityTest) {
+    static constexpr EAS_I32 kNumBuffers = 256;
+    static constexpr EAS_I32 kInvalidCapacities[] = {-1, 1025};
+    static constexpr EAS_I32 kCapacities[] = {1, 8, 256};
+
+    for (EAS_I32 maxVoices : kInvalidCapacities) {
+        S_EAS_INIT_CONFIG config = {};
+        config.maxVoices = maxVoices;
+        EAS_DATA_HANDLE easData = nullptr;
+        EXPECT_NE(EAS_InitEx(&easData, &config), EAS_SUCCESS) << "capacity " << maxVoices;
+        EXPECT_EQ(easData, nullptr);
+    }
+
+    // reference, rendered with the build default capacity
+    EAS_I32 bufferSize = mEASConfig->mixBufferSize;
+    EAS_I32 totalSamples = bufferSize * kNumBuffers * numChannels;
+    vector<EAS_PCM> reference(totalSamples);
+    EAS_I32 count;
+    for (EAS_I32 i = 0; i < kNumBuffers; i++) {
+        ASSERT_EQ(EAS_Render(mEASDataHandle, &reference[i * bufferSize * numChannels], bufferSize,
+                             &count), EAS_SUCCESS);
+    }
+
+    for (EAS_I32 maxVoices : kCapacities) {
+        S_EAS_INIT_CONFIG config = {};
+        config.maxVoices = maxVoices;
+        EAS_DATA_HANDLE easData = nullptr;
+        EAS_HANDLE stream = nullptr;
+        EAS_FILE easFile, dlsFile;
+        ASSERT_TRUE(openInstance(&easData, &stream, &easFile, &dlsFile, &config))
+            << "Failed to open an instance with " << maxVoices << " voices";
+
+        S_EAS_INIT_CONFIG actual;
+        ASSERT_EQ(EAS_GetInitConfig(easData, &actual), EAS_SUCCESS);
+        EXPECT_EQ(actual.maxVoices, maxVoices);
+
+        // the polyphony of the synthesizers is pinned to the capacity
+        EAS_I32 polyphony = 0;
+        for (EAS_I32 synthNum = 0; synthNum < 2; synthNum++) {
+            EAS_I32 synthPolyphony;
+            if (EAS_SetSynthPolyphony(easData, synthNum, maxVoices + 1) != EAS_SUCCESS) continue;
+            ASSERT_EQ(EAS_GetSynthPolyphony(easData, synthNum, &synthPolyphony), EAS_SUCCESS);
+            polyphony += synthPolyphony;
+        }
+        EXPECT_EQ(polyphony, maxVoices);
+
+        vector<EAS_PCM> frames(totalSamples);
+        for (EAS_I32 i = 0; i < kNumBuffers; i++) {
+            ASSERT_EQ(EAS_Render(easData, &frames[i * bufferSize * numChannels], bufferSize, &count),
+                      EAS_SUCCESS);
+        }
+
+        EXPECT_EQ(EAS_CloseFile(easData, stream), EAS_SUCCESS);
+        EXPECT_EQ(EAS_Shutdown(easData), EAS_SUCCESS);
+        fclose((FILE *)easFile.handle);
+
+        // a larger capacity plays every note the reference played
+        if (maxVoices >= mEASConfig->maxVoices) {
+            EXPECT_EQ(frames, reference) << "capacity " << maxVoices;
+        }
+    }
+}
+
+TEST_P(SonivoxTest, RenderBudgetTest) {
+    static constexpr EAS_I32 kNumBuffers = 256;
+
+    EXPECT_EQ(EAS_SetRenderBudget(mEASDataHandle, -1), EAS_ERROR_PARAMETER_RANGE);
+    EXPECT_EQ(EAS_SetRenderBudget(mEASDataHandle, 100001), EAS_ERROR_PARAMETER_RANGE);
+
+    EAS_I32 fullPolyphony;
+    ASSERT_EQ(EAS_GetBudgetPolyphony(mEASDataHandle, &fullPolyphony), EAS_SUCCESS);
+    EXPECT_EQ(fullPolyphony, mEASConfig->maxVoices);
+
+    EAS_I32 bufferSize = mEASConfig->mixBufferSize;
+    vector<EAS_PCM> frames(bufferSize * numChannels);
+    EAS_I32 count;
+    EAS_I32 polyphony;
+
+    // a budget that every block meets keeps all the voices
+    ASSERT_EQ(EAS_SetRenderBudget(mEASDataHandle, 100000), EAS_SUCCESS);
+    for (EAS_I32 i = 0; i < kNumBuffers / 4; i++) {
+        ASSERT_EQ(EAS_Render(mEASDataHandle, frames.data(), bufferSize, &count), EAS_SUCCESS);
+        ASSERT_EQ(EAS_GetBudgetPolyphony(mEASDataHandle, &polyphony), EAS_SUCCESS);
+        EXPECT_EQ(polyphony, fullPolyphony);
+    }
+
+    // a budget that no block meets lowers the polyphony
+    ASSERT_EQ(EAS_SetRenderBudget(mEASDataHandle, 1), EAS_SUCCESS);
+    EAS_I32 lowest = fullPolyphony;
+    for (EAS_I32 i = 0; i < kNumBuffers; i++) {
+        ASSERT_EQ(EAS_Render(mEASDataHandle, frames.data(), bufferSize, &count), EAS_SUCCESS);
+        ASSERT_EQ(EAS_GetBudgetPolyphony(mEASDataHandle, &polyphony), EAS_SUCCESS);
+        EXPECT_GE(polyphony, 1);
+        lowest = std::min(lowest, polyphony);
+    }
+    EXPECT_LT(lowest, fullPolyphony);
+
+    // turning the budget off restores the polyphony
+    ASSERT_EQ(EAS_SetRenderBudget(mEASDataHandle, 0), EAS_SUCCESS);
+    ASSERT_EQ(EAS_GetBudgetPolyphony(mEASDataHandle, &polyphony), EAS_SUCCESS);
+    EXPECT_EQ(polyphony, fullPolyphony);
+}
+
+TEST_P(SonivoxTest, RenderBudgetHysteresisTest) {
+    static constexpr EAS_I32 kBudget = 1000;
+    static constexpr EAS_I32 kNumBlocks = 64;
+
+    EAS_DATA_HANDLE easData;
+    ASSERT_EQ(EAS_Init(&easData), EAS_SUCCESS);
+    ASSERT_EQ(EAS_SetRenderBudget(easData, kBudget), EAS_SUCCESS);
+    EAS_I32 fullPolyphony, polyphony;
+    ASSERT_EQ(EAS_GetBudgetPolyphony(easData, &fullPolyphony), EAS_SUCCESS);
+
+    // a steady load just under the budget: 450 us plus 25 us per voice, for 16 or 20 voices
+    auto steady = [&](EAS_I32 numBlocks) {
+        for (EAS_I32 i = 0; i < numBlocks; i++) {
+            EAS_I32 voices = (i & 1) ? 20 : 16;
+            SonivoxUpdateRenderBudget(easData, 450 + 25 * voices, voices);
+        }
+    };
+    steady(kNumBlocks);
+    ASSERT_EQ(EAS_GetBudgetPolyphony(easData, &polyphony), EAS_SUCCESS);
+    EXPECT_EQ(polyphony, fullPolyphony);
+
+    // one block the host delayed to twice the budget does not cut voices
+    SonivoxUpdateRenderBudget(easData, 2 * kBudget, 20);
+    ASSERT_EQ(EAS_GetBudgetPolyphony(easData, &polyphony), EAS_SUCCESS);
+    EXPECT_EQ(polyphony, fullPolyphony) << "a single slow block lowered the polyphony";
+    steady(kNumBlocks);
+    ASSERT_EQ(EAS_GetBudgetPolyphony(easData, &polyphony), EAS_SUCCESS);
+    EXPECT_EQ(polyphony, fullPolyphony);
+
+    // a load that stays over the budget does
+    for (EAS_I32 i = 0; i < kNumBlocks && polyphony == fullPolyphony; i++) {
+        SonivoxUpdateRenderBudget(easData, 2 * kBudget, 20);
+        ASSERT_EQ(EAS_GetBudgetPolyphony(easData, &polyphony), EAS_SUCCESS);
+    }
+    EXPECT_LT(polyphony, fullPolyphony) << "a sustained overrun kept the polyphony";
+    EXPECT_GE(polyphony, 1);
+
+    EXPECT_EQ(EAS_Shutdown(easData), EAS_SUCCESS);
+}
+
+TEST_P(SonivoxTest, SilenceTest) {
+    static constexpr EAS_I32 kNumBuffers = 64;
+    static constexpr EAS_I32 kMaxTailMs = 20000;
+
+    // the post-mix reverb and chorus run on every block
+    ASSERT_EQ(EAS_SetParameter(mEASDataHandle, EAS_MODULE_REVERB, EAS_PARAM_REVERB_OVERRIDE_CC, EAS_TRUE),
+              EAS_SUCCESS);
+    ASSERT_EQ(EAS_SetParameter(mEASDataHandle, EAS_MODULE_CHORUS, EAS_PARAM_CHORUS_OVERRIDE_CC, EAS_TRUE),
+              EAS_SUCCESS);
+    ASSERT_EQ(EAS_SetParameter(mEASDataHandle, EAS_MODULE_REVERB, EAS_PARAM_REVERB_BYPASS, EAS_FALSE),
+              EAS_SUCCESS);
+    ASSERT_EQ(EAS_SetParameter(mEASDataHandle, EAS_MODULE_CHORUS, EAS_PARAM_CHORUS_BYPASS, EAS_FALSE),
+              EAS_SUCCESS);
+
+    // the tail state is read only, and there is no tail yet
+    EAS_I32 reverbSilent;
+    EAS_I32 chorusSilent;
+    EXPECT_NE(EAS_SetParameter(mEASDataHandle, EAS_MODULE_REVERB, EAS_PARAM_REVERB_TAIL_SILENT, EAS_TRUE),
+              EAS_SUCCESS);
+    ASSERT_EQ(EAS_GetParameter(mEASDataHandle, EAS_MODULE_REVERB, EAS_PARAM_REVERB_TAIL_SILENT, &reverbSilent),
+              EAS_SUCCESS);
+    ASSERT_EQ(EAS_GetParameter(mEASDataHandle, EAS_MODULE_CHORUS, EAS_PARAM_CHORUS_TAIL_SILENT, &chorusSilent),
+              EAS_SUCCESS);
+    EXPECT_TRUE(reverbSilent);
+    EXPECT_TRUE(chorusSilent);
+
+    EAS_I32 bufferSize = mEASConfig->mixBufferSize;
+    vector<EAS_PCM> frames(bufferSize * numChannels);
+    EAS_I32 count;
+    bool sounded = false;
+    for (EAS_I32 i = 0; i < kNumBuffers; i++) {
+        ASSERT_EQ(EAS_Render(mEASDataHandle, frames.data(), bufferSize, &count), EAS_SUCCESS);
+        sounded |= std::any_of(frames.begin(), frames.end(), [](EAS_PCM s) { return s != 0; });
+    }
+    EXPECT_TRUE(sounded);
+
+    // pause the music, the voices and then the tails die out
+    ASSERT_EQ(EAS_Pause(mEASDataHandle, mEASStreamHandle), EAS_SUCCESS);
+    EAS_I32 maxBuffers = kMaxTailMs * mEASConfig->sampleRate / 1000 / bufferSize;
+    reverbSilent = chorusSilent = EAS_FALSE;
+    for (EAS_I32 i = 0; i < maxBuffers && !(reverbSilent && chorusSilent); i++) {
+        ASSERT_EQ(EAS_Render(mEASDataHandle, frames.data(), bufferSize, &count), EAS_SUCCESS);
+        ASSERT_EQ(EAS_GetParameter(mEASDataHandle, EAS_MODULE_REVERB, EAS_PARAM_REVERB_TAIL_SILENT,
+                                   &reverbSilent), EAS_SUCCESS);
+        ASSERT_EQ(EAS_GetParameter(mEASDataHandle, EAS_MODULE_CHORUS, EAS_PARAM_CHORUS_TAIL_SILENT,
+                                   &chorusSilent), EAS_SUCCESS);
+    }
+    EXPECT_TRUE(reverbSilent) << "Reverb tail did not decay in " << kMaxTailMs << " ms";
+    EXPECT_TRUE(chorusSilent) << "Chorus tail did not decay in " << kMaxTailMs << " ms";
+
+    // from then on every block is silent, in both output formats
+    vector<float> floatFrames(bufferSize * numChannels, 1.0f);
+    for (EAS_I32 i = 0; i < kNumBuffers; i++) {
+        frames.assign(frames.size(), 1);
+        ASSERT_EQ(EAS_Render(mEASDataHandle, frames.data(), bufferSize, &count), EAS_SUCCESS);
+        ASSERT_EQ(count, bufferSize);
+        ASSERT_TRUE(std::all_of(frames.begin(), frames.end(), [](EAS_PCM s) { return s == 0; }))
+            << "Silent block " << i << " is not silent";
+        ASSERT_EQ(EAS_RenderFloat(mEASDataHandle, floatFrames.data(), bufferSize, &count), EAS_SUCCESS);
+        ASSERT_TRUE(std::all_of(floatFrames.begin(), floatFrames.end(), [](float s) { return s == 0.0f; }))
+            << "Silent float block " << i << " is not silent";
+    }
+}
+
+TEST_P(SonivoxTest, EffectTailTest) {
+    static constexpr EAS_I32 kNumBuffers = 16;
+    static constexpr EAS_I32 kMaxTailMs = 20000;
+
+    // a note sent fully to the reverb the voice manager runs as a send effect
+    EAS_DATA_HANDLE easData;
+    ASSERT_EQ(EAS_Init(&easData), EAS_SUCCESS);
+    EAS_I32 sendEffect;
+    ASSERT_EQ(EAS_GetParameter(easData, EAS_MODULE_REVERB, EAS_PARAM_REVERB_OVERRIDE_CC, &sendEffect),
+              EAS_SUCCESS);
+    if (!sendEffect) {
+        EXPECT_EQ(EAS_Shutdown(easData), EAS_SUCCESS);
+        GTEST_SKIP() << "No send reverb in this build";
+    }
+    EAS_HANDLE stream;
+    ASSERT_EQ(EAS_OpenMIDIStream(easData, &stream, nullptr), EAS_SUCCESS);
+    EAS_U8 noteOn[] = {0xb0, 91, 127, 0x90, 60, 100};
+    ASSERT_EQ(EAS_WriteMIDIStream(easData, stream, noteOn, sizeof(noteOn)), EAS_SUCCESS);
+
+    EAS_I32 bufferSize = mEASConfig->mixBufferSize;
+    vector<EAS_PCM> frames(bufferSize * numChannels);
+    EAS_I32 count;
+    for (EAS_I32 i = 0; i < kNumBuffers; i++) {
+        ASSERT_EQ(EAS_Render(easData, frames.data(), bufferSize, &count), EAS_SUCCESS);
+    }
+
+    // release the note and render until its voice has stopped
+    EAS_U8 noteOff[] = {0x80, 60, 0};
+    ASSERT_EQ(EAS_WriteMIDIStream(easData, stream, noteOff, sizeof(noteOff)), EAS_SUCCESS);
+    EAS_I32 maxBuffers = kMaxTailMs * mEASConfig->sampleRate / 1000 / bufferSize;
+    EAS_I32 i = 0;
+    for (; i < maxBuffers && SonivoxActiveVoices(easData) > 0; i++) {
+        ASSERT_EQ(EAS_Render(easData, frames.data(), bufferSize, &count), EAS_SUCCESS);
+    }
+    ASSERT_EQ(SonivoxActiveVoices(easData), 0) << "Voice did not stop in " << kMaxTailMs << " ms";
+
+    // the reverb plays out its tail with no voice left to send to it, and then falls silent
+    EAS_I32 tailSilent = EAS_FALSE;
+    EAS_I32 tailBuffers = 0;
+    for (i = 0; i < maxBuffers && !tailSilent; i++) {
+        ASSERT_EQ(EAS_Render(easData, frames.data(), bufferSize, &count), EAS_SUCCESS);
+        if (std::any_of(frames.begin(), frames.end(), [](EAS_PCM s) { return s != 0; })) tailBuffers++;
+        ASSERT_EQ(EAS_GetParameter(easData, EAS_MODULE_REVERB, EAS_PARAM_REVERB_TAIL_SILENT, &tailSilent),
+                  EAS_SUCCESS);
+    }
+    EXPECT_GT(tailBuffers, 1) << "Reverb tail is cut off when the voice stops";
+    EXPECT_TRUE(tailSilent) << "Reverb tail did not decay in " << kMaxTailMs << " ms";
+    for (i = 0; i < kNumBuffers; i++) {
+        ASSERT_EQ(EAS_Render(easData, frames.data(), bufferSize, &count), EAS_SUCCESS);
+        ASSERT_TRUE(std::all_of(frames.begin(), frames.end(), [](EAS_PCM s) { return s == 0; }))
+            << "Block " << i << " after the tail is not silent";
+    }
+
+    EXPECT_EQ(EAS_CloseMIDIStream(easData, stream), EAS_SUCCESS);
+    EXPECT_EQ(EAS_Shutdown(easData), EAS_SUCCESS);
+}
+
+TEST_P(SonivoxTest, EffectSaturationTest) {
+    static constexpr EAS_I32 kNumSamples = 64;
+    static constexpr EAS_I32 kNumBlocks = 64;
+    static constexpr EAS_I32 kPeriod = 50;
+    static constexpr EAS_I32 kOverRange = 400000;
+
+    // processes a square wave send between the given levels with the effect of a new instance
+    auto process = [&](EAS_INT module, EAS_I32 high, EAS_I32 low, bool bypass, vector<EAS_I32> &input,
+                       vector<EAS_I32> &output) {
+        EAS_DATA_HANDLE easData;
+        ASSERT_EQ(EAS_Init(&easData), EAS_SUCCESS);
+        if (module == EAS_MODULE_REVERB) {
+            EXPECT_EQ(EAS_SetParameter(easData, module, EAS_PARAM_REVERB_PRESET, EAS_PARAM_REVERB_LARGE_HALL),
+                      EAS_SUCCESS);
+            EXPECT_EQ(EAS_SetParameter(easData, module, EAS_PARAM_REVERB_BYPASS, bypass), EAS_SUCCESS);
+        } else {
+            EXPECT_EQ(EAS_SetParameter(easData, module, EAS_PARAM_CHORUS_PRESET, EAS_PARAM_CHORUS_PRESET1),
+                      EAS_SUCCESS);
+            EXPECT_EQ(EAS_SetParameter(easData, module, EAS_PARAM_CHORUS_DRY, 0), EAS_SUCCESS);
+            EXPECT_EQ(EAS_SetParameter(easData, module, EAS_PARAM_CHORUS_BYPASS, bypass), EAS_SUCCESS);
+        }
+
+        input.resize(kNumSamples * kNumBlocks * numChannels);
+        for (size_t i = 0; i < input.size(); i++) input[i] = (i / numChannels / kPeriod) & 1 ? low : high;
+        // the effect gets a copy, so a bypass that writes to its send is caught
+        vector<EAS_I32> send(input);
+        output.assign(input.size(), 0);
+        bool processed = true;
+        for (EAS_I32 block = 0; block < kNumBlocks && processed; block++) {
+            processed = SonivoxProcessEffect32(easData, module, &send[block * kNumSamples * numChannels],
+                                               &output[block * kNumSamples * numChannels], kNumSamples);
+        }
+        EXPECT_EQ(EAS_Shutdown(easData), EAS_SUCCESS);
+        if (!processed) output.clear();
+    };
+
+    for (EAS_INT module : {EAS_MODULE_REVERB, EAS_MODULE_CHORUS}) {
+        // the reverb scales its send by 1/4 before the delay line, the chorus does not
+        EAS_I32 scale = (module == EAS_MODULE_REVERB) ? 4 : 1;
+        vector<EAS_I32> input, reference, output;
+        ASSERT_NO_FATAL_FAILURE(process(module, 32767 * scale, -32768 * scale, false, input, reference));
+        if (reference.empty()) continue;
+        ASSERT_TRUE(any_of(reference.begin(), reference.end(), [](EAS_I32 s) { return s != 0; }))
+            << "module " << module << " is silent";
+
+        // a send beyond the 16-bit range saturates to full scale instead of wrapping
+        ASSERT_NO_FATAL_FAILURE(process(module, kOverRange, -kOverRange, false, input, output));
+        EXPECT_TRUE(output == reference) << "module " << module << " wraps an over-range send";
+
+        // a bypassed effect passes its send through
+        ASSERT_NO_FATAL_FAILURE(process(module, kOverRange, -kOverRange, true, input, output));
+        EXPECT_TRUE(output == input) << "bypassed module " << module << " does not pass its send through";
+    }
+}
+
+TEST(SonivoxReverbTest, ReverbBlockTest) {
+    static constexpr EAS_I32 kNumBlocks = 64;
+    static constexpr EAS_I32 kShortAllpass = 5;
+
+    EASInstance easData = initInstance();
+    ASSERT_NE(easData, nullptr) << "Failed to initialize synthesizer library";
+
+    // the mix buffer size and a longer block, with the allpass lengths of the preset and with
+    // allpass filters short enough that ReverbBlockSize splits the blocks at their taps
+    const EAS_I32 kSizes[] = {EAS_Config()->mixBufferSize, 100};
+    for (EAS_I32 preset = EAS_PARAM_REVERB_LARGE_HALL; preset <= EAS_PARAM_REVERB_ROOM; preset++) {
+        for (EAS_I32 apLength : {0, kShortAllpass}) {
+            for (EAS_BOOL wide : {EAS_FALSE, EAS_TRUE}) {
+                for (EAS_I32 numSamples : kSizes) {
+                    EAS_I32 runSize;
+                    EAS_I32 mismatches = SonivoxCompareReverb(easData.get(), preset, apLength, wide, numSamples,
+                                                              kNumBlocks, &runSize);
+                    ASSERT_GE(mismatches, 0) << "Failed to compare the reverb";
+                    EXPECT_EQ(mismatches, 0) << "preset " << preset << ", allpass " << apLength
+                                             << (wide ? ", 32-bit, " : ", 16-bit, ") << numSamples
+                                             << " samples: block reverb differs from the per-sample one";
+                    EXPECT_LT(runSize, numSamples) << "preset " << preset << " was not split";
+                    if (apLength > 0) EXPECT_LE(runSize, apLength);
+                }
+            }
+        }
+    }
+}
+
+TEST_P(SonivoxTest, MultiThreadTest) {
+    static constexpr int kNumThreads = 4;
+    static constexpr EAS_I32 kNumBuffers = 256;
+
+    EAS_I32 bufferSize = mEASConfig->mixBufferSize;
+    EAS_I32 totalSamples = bufferSize * kNumBuffers * numChannels;
+
+    // the sound libraries built into the library, used in turn by the threads
+    vector<const char *> libraries;
+    for (E_EAS_SNDLIB_TYPE type : {EAS_SNDLIB_WT, EAS_SNDLIB_FM}) {
+        const char *name = EAS_GetDefaultSoundLibrary(type);
+        if (name != nullptr) libraries.push_back(name);
+    }
+    ASSERT_FALSE(libraries.empty()) << "No sound library available";
+
+    // opens, renders and closes an instance
+    auto render = [this, bufferSize](const char *library, vector<EAS_PCM> &output) {
+        EAS_DATA_HANDLE easData = nullptr;
+        EAS_HANDLE stream = nullptr;
+        EAS_FILE easFile, dlsFile;
+        bool ok = openInstance(&easData, &stream, &easFile, &dlsFile, nullptr, library);
+        for (EAS_I32 i = 0; ok && i < kNumBuffers; i++) {
+            EAS_I32 count;
+            ok = EAS_Render(easData, &output[i * bufferSize * numChannels], bufferSize, &count) == EAS_SUCCESS &&
+                 count == bufferSize;
+        }
+        if (stream != nullptr) {
+            ok = EAS_CloseFile(easData, stream) == EAS_SUCCESS && ok;
+            fclose((FILE *)easFile.handle);
+        }
+        if (easData != nullptr) ok = EAS_Shutdown(easData) == EAS_SUCCESS && ok;
+        return ok;
+    };
+
+    // serial reference for each sound library
+    vector<vector<EAS_PCM>> reference(libraries.size(), vector<EAS_PCM>(totalSamples));
+    for (size_t lib = 0; lib < libraries.size(); lib++)
+        ASSERT_TRUE(render(libraries[lib], reference[lib])) << "Failed to render " << libraries[lib];
+
+    // all instances rendering at the same time
+    vector<vector<EAS_PCM>> output(kNumThreads, vector<EAS_PCM>(totalSamples));
+    vector<int> succeeded(kNumThreads, 0);
+    vector<thread> threads;
+    for (int t = 0; t < kNumThreads; t++) {
+        threads.emplace_back([&, t]() {
+            succeeded[t] = render(libraries[t % libraries.size()], output[t]);
+        });
+    }
+    for (auto &th : threads) th.join();
+
+    for (int t = 0; t < kNumThreads; t++) {
+        const char *library = libraries[t % libraries.size()];
+        ASSERT_TRUE(succeeded[t]) << "Thread " << t << " failed to render " << library;
+        ASSERT_TRUE(output[t] == reference[t % libraries.size()])
+            << "Thread " << t << " (" << library << ") output differs from serial rendering";
+    }
+}
+
+TEST_P(SonivoxTest, SharedDLSTest) {
+    static constexpr int kNumInstances = 4;
+    static constexpr EAS_I32 kNumBuffers = 128;
+
+    if (mSoundFont.empty()) GTEST_SKIP() << "No soundfont for: " << mInputMediaFile;
+
+    EAS_I32 bufferSize = mEASConfig->mixBufferSize;
+    EAS_I32 totalSamples = bufferSize * kNumBuffers * numChannels;
+
+    // reference, with the collection loaded by the instance
+    vector<EAS_PCM> reference(totalSamples);
+    EAS_I32 count;
+    for (EAS_I32 i = 0; i < kNumBuffers; i++) {
+        ASSERT_EQ(EAS_Render(mEASDataHandle, &reference[i * bufferSize * numChannels], bufferSize, &count),
+                  EAS_SUCCESS);
+    }
+
+    // load the collection once, the loading instance does not have to stay alive
+    EAS_DATA_HANDLE loader = nullptr;
+    ASSERT_EQ(EAS_Init(&loader), EAS_SUCCESS);
+    string soundfontpath = gEnv->getTmp() + mSoundFont;
+    EAS_FILE dlsFile;
+    memset(&dlsFile, 0, sizeof(dlsFile));
+    dlsFile.handle = fopen(soundfontpath.c_str(), "rb");
+    ASSERT_NE(dlsFile.handle, nullptr) << "Failed to open " << soundfontpath;
+    EAS_DLSLIB_HANDLE pDLS = nullptr;
+    ASSERT_EQ(EAS_LoadDLSCollectionHandle(loader, &dlsFile, &pDLS), EAS_SUCCESS);
+    fclose((FILE *)dlsFile.handle);
+    ASSERT_NE(pDLS, nullptr);
+    EXPECT_EQ(EAS_Shutdown(loader), EAS_SUCCESS);
+
+    // instances attached to the collection globally and per stream
+    EAS_DATA_HANDLE easData[kNumInstances];
+    EAS_HANDLE stream[kNumInstances];
+    EAS_FILE easFile[kNumInstances], unused[kNumInstances];
+    for (int i = 0; i < kNumInstances; i++) {
+        if (i % 2 == 0) {
+            ASSERT_TRUE(openInstance(&easData[i], &stream[i], &easFile[i], &unused[i], nullptr, nullptr, pDLS));
+        } else {
+            // open without a soundfont, then attach it to the stream
+            string soundFont;
+            swap(soundFont, mSoundFont);
+            bool opened = openInstance(&easData[i], &stream[i], &easFile[i], &unused[i]);
+            swap(soundFont, mSoundFont);
+            ASSERT_TRUE(opened);
+            ASSERT_EQ(EAS_SetDLSCollection(easData[i], stream[i], pDLS), EAS_SUCCESS);
+        }
+    }
+
+    // the instances keep the collection alive
+    EXPECT_EQ(EAS_ReleaseDLSCollection(pDLS), EAS_SUCCESS);
+
+    vector<vector<EAS_PCM>> output(kNumInstances, vector<EAS_PCM>(totalSamples));
+    vector<int> succeeded(kNumInstances, 0);
+    vector<thread> threads;
+    for (int t = 0; t < kNumInstances; t++) {
+        threads.emplace_back([&, t]() {
+            bool ok = true;
+            for (EAS_I32 i = 0; ok && i < kNumBuffers; i++) {
+                EAS_I32 generated;
+                ok = EAS_Render(easData[t], &output[t][i * bufferSize * numChannels], bufferSize, &generated) ==
+                     EAS_SUCCESS;
+            }
+            ok = EAS_CloseFile(easData[t], stream[t]) == EAS_SUCCESS && ok;
+            ok = EAS_Shutdown(easData[t]) == EAS_SUCCESS && ok;
+            succeeded[t] = ok;
+        });
+    }
+    for (auto &th : threads) th.join();
+
+    for (int t = 0; t < kNumInstances; t++) {
+        fclose((FILE *)easFile[t].handle);
+        ASSERT_TRUE(succeeded[t]) << "Instance " << t << " failed to render";
+        ASSERT_TRUE(output[t] == reference) << "Instance " << t << " output differs from a loaded collection";
+    }
+}
+
+TEST_P(SonivoxTest, MappedDLSTest) {
+    static constexpr EAS_I32 kNumBuffers = 128;
+
+    if (mSoundFont.empty()) GTEST_SKIP() << "No soundfont for: " << mInputMediaFile;
+
+    EAS_I32 bufferSize = mEASConfig->mixBufferSize;
+    EAS_I32 totalSamples = bufferSize * kNumBuffers * numChannels;
+
+    // reference, with the samples copied by the loader
+    vector<EAS_PCM> reference(totalSamples);
+    EAS_I32 count;
+    for (EAS_I32 i = 0; i < kNumBuffers; i++) {
+        ASSERT_EQ(EAS_Render(mEASDataHandle, &reference[i * bufferSize * numChannels], bufferSize, &count),
+                  EAS_SUCCESS);
+    }
+
+    // the whole file in memory, as the host would map it
+    string soundfontpath = gEnv->getTmp() + mSoundFont;
+    FILE *fp = fopen(soundfontpath.c_str(), "rb");
+    ASSERT_NE(fp, nullptr) << "Failed to open " << soundfontpath;
+    fseek(fp, 0, SEEK_END);
+    vector<EAS_I16> fileData((ftell(fp) + 1) / sizeof(EAS_I16));
+    fseek(fp, 0, SEEK_SET);
+    EAS_I32 fileSize = fread(fileData.data(), 1, fileData.size() * sizeof(EAS_I16), fp);
+    fclose(fp);
+
+    EAS_DLSLIB_HANDLE pDLS = nullptr;
+    ASSERT_EQ(EAS_LoadDLSCollectionMapped(mEASDataHandle, fileData.data(), fileSize, &pDLS), EAS_SUCCESS);
+    ASSERT_NE(pDLS, nullptr);
+
+    EAS_DATA_HANDLE easData;
+    EAS_HANDLE stream;
+    EAS_FILE easFile, unused;
+    ASSERT_TRUE(openInstance(&easData, &stream, &easFile, &unused, nullptr, nullptr, pDLS));
+    EXPECT_EQ(EAS_ReleaseDLSCollection(pDLS), EAS_SUCCESS);
+
+    vector<EAS_PCM> output(totalSamples);
+    for (EAS_I32 i = 0; i < kNumBuffers; i++) {
+        ASSERT_EQ(EAS_Render(easData, &output[i * bufferSize * numChannels], bufferSize, &count), EAS_SUCCESS);
+    }
+    EXPECT_EQ(EAS_CloseFile(easData, stream), EAS_SUCCESS);
+    EXPECT_EQ(EAS_Shutdown(easData), EAS_SUCCESS);
+    fclose((FILE *)easFile.handle);
+    ASSERT_TRUE(output == reference) << "Mapped samples render differently from copied samples";
+
+    // truncated data must be rejected rather than read past the end
+    EXPECT_NE(EAS_LoadDLSCollectionMapped(mEASDataHandle, fileData.data(), fileSize / 2, &pDLS), EAS_SUCCESS);
+    EXPECT_EQ(pDLS, nullptr);
+}
+
+TEST_P(SonivoxTest, DLSCacheTest) {
+    static constexpr EAS_I32 kNumBuffers = 128;
+    static constexpr EAS_U32 kStamp = 0x5eed;
+
+    if (mSoundFont.empty()) GTEST_SKIP() << "No soundfont for: " << mInputMediaFile;
+
+    EAS_I32 bufferSize = mEASConfig->mixBufferSize;
+    EAS_I32 totalSamples = bufferSize * kNumBuffers * numChannels;
+
+    vector<EAS_PCM> reference(totalSamples);
+    EAS_I32 count;
+    for (EAS_I32 i = 0; i < kNumBuffers; i++) {
+        ASSERT_EQ(EAS_Render(mEASDataHandle, &reference[i * bufferSize * numChannels], bufferSize, &count),
+                  EAS_SUCCESS);
+    }
+
+    string soundfontpath = gEnv->getTmp() + mSoundFont;
+    FILE *fp = fopen(soundfontpath.c_str(), "rb");
+    ASSERT_NE(fp, nullptr) << "Failed to open " << soundfontpath;
+    fseek(fp, 0, SEEK_END);
+    vector<EAS_I16> fileData((ftell(fp) + 1) / sizeof(EAS_I16));
+    fseek(fp, 0, SEEK_SET);
+    EAS_I32 fileSize = fread(fileData.data(), 1, fileData.size() * sizeof(EAS_I16), fp);
+    fclose(fp);
+
+    // caches written from a copied and from a mapped collection
+    for (bool mapped : {false, true}) {
+        EAS_DLSLIB_HANDLE pDLS = nullptr;
+        if (mapped) {
+            ASSERT_EQ(EAS_LoadDLSCollectionMapped(mEASDataHandle, fileData.data(), fileSize, &pDLS), EAS_SUCCESS);
+        } else {
+            EAS_FILE dlsFile;
+            memset(&dlsFile, 0, sizeof(dlsFile));
+            dlsFile.handle = fopen(soundfontpath.c_str(), "rb");
+            ASSERT_NE(dlsFile.handle, nullptr) << "Failed to open " << soundfontpath;
+            ASSERT_EQ(EAS_LoadDLSCollectionHandle(mEASDataHandle, &dlsFile, &pDLS), EAS_SUCCESS);
+            fclose((FILE *)dlsFile.handle);
+        }
+        ASSERT_NE(pDLS, nullptr);
+
+        EAS_I32 cacheSize = 0;
+        ASSERT_EQ(EAS_WriteDLSCollectionCache(pDLS, fileSize, kStamp, nullptr, 0, &cacheSize), EAS_SUCCESS);
+        ASSERT_GT(cacheSize, 0);
+        vector<uint64_t> cache((cacheSize + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+        EXPECT_NE(EAS_WriteDLSCollectionCache(pDLS, fileSize, kStamp, cache.data(), cacheSize - 1, &count),
+                  EAS_SUCCESS);
+        ASSERT_EQ(EAS_WriteDLSCollectionCache(pDLS, fileSize, kStamp, cache.data(), cacheSize, &count),
+                  EAS_SUCCESS);
+        ASSERT_EQ(count, cacheSize);
+        EXPECT_EQ(EAS_ReleaseDLSCollection(pDLS), EAS_SUCCESS);
+
+        // a changed source file invalidates the cache
+        pDLS = nullptr;
+        EXPECT_EQ(EAS_LoadDLSCollectionCache(mEASDataHandle, cache.data(), cacheSize, fileData.data(), fileSize,
+                                             kStamp + 1, &pDLS),
+                  EAS_ERROR_DATA_INCONSISTENCY);
+        EXPECT_EQ(pDLS, nullptr);
+
+        ASSERT_EQ(EAS_LoadDLSCollectionCache(mEASDataHandle, cache.data(), cacheSize, fileData.data(), fileSize,
+                                             kStamp, &pDLS),
+                  EAS_SUCCESS);
+        ASSERT_NE(pDLS, nullptr);
+
+        EAS_DATA_HANDLE easData;
+        EAS_HANDLE stream;
+        EAS_FILE easFile, unused;
+        ASSERT_TRUE(openInstance(&easData, &stream, &easFile, &unused, nullptr, nullptr, pDLS));
+        EXPECT_EQ(EAS_ReleaseDLSCollection(pDLS), EAS_SUCCESS);
+
+        vector<EAS_PCM> output(totalSamples);
+        for (EAS_I32 i = 0; i < kNumBuffers; i++) {
+            ASSERT_EQ(EAS_Render(easData, &output[i * bufferSize * numChannels], bufferSize, &count), EAS_SUCCESS);
+        }
+        EXPECT_EQ(EAS_CloseFile(easData, stream), EAS_SUCCESS);
+        EXPECT_EQ(EAS_Shutdown(easData), EAS_SUCCESS);
+        fclose((FILE *)easFile.handle);
+        ASSERT_TRUE(output == reference) << "Collection loaded from a cache renders differently";
+
+        // a damaged cache must be rejected
+        cache[0] ^= 1;
+        EXPECT_EQ(EAS_LoadDLSCollectionCache(mEASDataHandle, cache.data(), cacheSize, fileData.data(), fileSize,
+                                             kStamp, &pDLS),
+                  EAS_ERROR_FILE_FORMAT);
+        EXPECT_EQ(pDLS, nullptr);
+    }
+}
+
+TEST_P(SonivoxTest, ProgramSubstitutionTest) {
+    static constexpr EAS_I32 kNumBuffers = 32;
+
+    if (mSoundFont.empty()) GTEST_SKIP() << "No soundfont for: " << mInputMediaFile;
+
+    EAS_I32 bufferSize = mEASConfig->mixBufferSize;
+
+    // plays a note after selecting a bank and program on a live MIDI stream
+    auto play = [&](EAS_U8 bankMSB, EAS_U8 bankLSB, vector<EAS_PCM> &output) {
+        EAS_DATA_HANDLE easData;
+        ASSERT_EQ(EAS_Init(&easData), EAS_SUCCESS);
+        string soundfontpath = gEnv->getTmp() + mSoundFont;
+        EAS_FILE dlsFile;
+        memset(&dlsFile, 0, sizeof(dlsFile));
+        dlsFile.handle = fopen(soundfontpath.c_str(), "rb");
+        ASSERT_NE(dlsFile.handle, nullptr) << "Failed to open " << soundfontpath;
+        EAS_RESULT result = EAS_LoadDLSCollection(easData, nullptr, &dlsFile);
+        fclose((FILE *)dlsFile.handle);
+        ASSERT_EQ(result, EAS_SUCCESS);
+
+        EAS_HANDLE stream;
+        ASSERT_EQ(EAS_OpenMIDIStream(easData, &stream, nullptr), EAS_SUCCESS);
+        EAS_U8 midi[] = {0xb0, 0x00, bankMSB, 0xb0, 0x20, bankLSB, 0xc0, 0x00, 0x90, 60, 100};
+        ASSERT_EQ(EAS_WriteMIDIStream(easData, stream, midi, sizeof(midi)), EAS_SUCCESS);
+
+        output.assign(bufferSize * kNumBuffers * numChannels, 0);
+        EAS_I32 count;
+        for (EAS_I32 i = 0; i < kNumBuffers; i++) {
+            ASSERT_EQ(EAS_Render(easData, &output[i * bufferSize * numChannels], bufferSize, &count), EAS_SUCCESS);
+        }
+        EXPECT_EQ(EAS_CloseMIDIStream(easData, stream), EAS_SUCCESS);
+        EXPECT_EQ(EAS_Shutdown(easData), EAS_SUCCESS);
+    };
+
+    // a bank missing from the collection falls back like the default melody bank does
+    vector<EAS_PCM> missingBank, defaultBank;
+    ASSERT_NO_FATAL_FAILURE(play(5, 3, missingBank));
+    ASSERT_NO_FATAL_FAILURE(play(0x79, 0, defaultBank));
+    ASSERT_TRUE(missingBank == defaultBank) << "Missing bank is not substituted";
+    ASSERT_TRUE(any_of(missingBank.begin(), missingBank.end(), [](EAS_PCM s) { return s != 0; }))
+            << "Substituted program is silent";
+}
+
+TEST_P(SonivoxTest, SimdInterpolatorTest) {
+    EAS_I32 numBuffers = mAudioplayTimeMs * mEASConfig->sampleRate / 1000 / mEASConfig->mixBufferSize;
+
+    // the SIMD kernel must produce the samples of the C loop
+    vector<EAS_PCM> output, reference;
+    bool simd = false;
+    ASSERT_TRUE(renderInstance(nullptr, numBuffers, output));
+    ASSERT_TRUE(renderInstance([&](EAS_DATA_HANDLE easData) { simd = SonivoxUseCInterpolator(easData); },
+                               numBuffers, reference));
+    if (!simd) GTEST_SKIP() << "No SIMD interpolation kernel";
+    ASSERT_TRUE(output == reference) << "SIMD interpolation kernel renders differently from the C loop";
+}
+
+TEST_P(SonivoxTest, VoiceBatchTest) {
+    EAS_I32 numBuffers = mAudioplayTimeMs * mEASConfig->sampleRate / 1000 / mEASConfig->mixBufferSize;
+
+    // the voices rendered together in SIMD lanes must sound as when rendered one at a time
+    vector<EAS_PCM> output, reference;
+    bool batched = false;
+    ASSERT_TRUE(renderInstance(nullptr, numBuffers, output));
+    ASSERT_TRUE(renderInstance(
+            [&](EAS_DATA_HANDLE easData) {
+                batched = SonivoxDisableRenderPath(easData, SONIVOX_PATH_VOICE_BATCHES);
+            },
+            numBuffers, reference));
+    if (!batched) GTEST_SKIP() << "No voice batches in this build";
+    ASSERT_TRUE(output == reference) << "Voice batches render differently from single voices";
+}
+
+TEST_P(SonivoxTest, FilterBatchTest) {
+    EAS_I32 numBuffers = mAudioplayTimeMs * mEASConfig->sampleRate / 1000 / mEASConfig->mixBufferSize;
+
+    // the voice batches filter most voices themselves, without them every filtered voice goes
+    // through the filter batch, which must sound as filtering the voices one at a time
+    vector<EAS_PCM> output, reference;
+    bool batched = false;
+    ASSERT_TRUE(renderInstance(
+            [&](EAS_DATA_HANDLE easData) {
+                SonivoxDisableRenderPath(easData, SONIVOX_PATH_VOICE_BATCHES);
+            },
+            numBuffers, output));
+    ASSERT_TRUE(renderInstance(
+            [&](EAS_DATA_HANDLE easData) {
+                SonivoxDisableRenderPath(easData, SONIVOX_PATH_VOICE_BATCHES);
+                batched = SonivoxDisableRenderPath(easData, SONIVOX_PATH_FILTER_BATCH);
+            },
+            numBuffers, reference));
+    if (!batched) GTEST_SKIP() << "No filter batch in this build";
+    ASSERT_TRUE(output == reference) << "The filter batch renders differently from single voices";
+}
+
+TEST_P(SonivoxTest, FusedOutputTest) {
+    EAS_I32 numBuffers = mAudioplayTimeMs * mEASConfig->sampleRate / 1000 / mEASConfig->mixBufferSize;
+
+    // the gain and pan in the filter loop must sound as after it, in renders where the filter
+    // batch gets the voices
+    vector<EAS_PCM> output, reference;
+    bool fused = false;
+    ASSERT_TRUE(renderInstance(
+            [&](EAS_DATA_HANDLE easData) {
+                SonivoxDisableRenderPath(easData, SONIVOX_PATH_VOICE_BATCHES);
+            },
+            numBuffers, output));
+    ASSERT_TRUE(renderInstance(
+            [&](EAS_DATA_HANDLE easData) {
+                SonivoxDisableRenderPath(easData, SONIVOX_PATH_VOICE_BATCHES);
+                fused = SonivoxDisableRenderPath(easData, SONIVOX_PATH_FUSED_OUTPUT);
+            },
+            numBuffers, reference));
+    if (!fused) GTEST_SKIP() << "No fused output in this build";
+    ASSERT_TRUE(output == reference) << "The fused output renders differently from the gain stage";
+
+    // the test files never give the filter batch voices of different lengths, which are only
+    // filtered together, so such batches are made up, with and without spare lanes
+    const vector<vector<EAS_I32>> kShortfalls = {{0, 0, 0, 0}, {0, 0}, {0},    {0, 5, 0, 1},
+                                                 {3, 0, 7},    {1, 2}, {6, 6}, {9, 0, 0, 0}};
+    for (const auto &shortfall : kShortfalls) {
+        EAS_I32 mismatches = SonivoxCompareFilterBatch(mEASDataHandle, shortfall.size(), shortfall.data());
+        ASSERT_GE(mismatches, 0) << "Failed to compare the filter batch";
+        EXPECT_EQ(mismatches, 0) << shortfall.size() << " lanes, the first " << shortfall[0]
+                                 << " samples short: the batch differs from single voices";
+    }
+}
+
+// the coefficients of the filter computed directly from the cutoff in cents and the resonance in
+// 0.1 dB, with the bilinear transform, as before the filter table
+static void filterCoeffs(double fs, EAS_I32 cutoff, EAS_I32 resonance, double coeffs[4]) {
+    double fc = pow(2.0, (cutoff - 6900.0) / 1200.0) * 440.0;
+    fc = fmax(fmin(fc, fs / 2.0), fs / 240.0);
+    const double resonance_dB = fmax(resonance / 10.0, 0.0);
+    const double omega0T = 2.0 * tan(M_PI * fc / fs);
+    const double q = (resonance_dB < 1e-9) ? 1.0 / sqrt(2.0) : pow(10.0, resonance_dB / 20.0);
+    const double D = 4 + 2 * omega0T / q + omega0T * omega0T;
+    const double g = pow(10.0, -resonance_dB / 40.0);
+    coeffs[0] = g * omega0T * omega0T / D;
+    coeffs[1] = 2 * coeffs[0];
+    coeffs[2] = (-8 + 2 * omega0T * omega0T) / D;
+    coeffs[3] = (4 - 2 * omega0T / q + omega0T * omega0T) / D;
+}
+
+TEST(SonivoxFilterTest, FilterTableTest) {
+    // the table interpolates the cutoff every 10 cents, the coefficients stay within 2e-5 of the
+    // formula up to the last step, where the table goes to the scale of 0 at Nyquist and the
+    // coefficients are within 5e-3
+    static constexpr double kTolerance = 2e-5;
+    static constexpr double kNyquistTolerance = 5e-3;
+    static constexpr EAS_I32 kTableStep = 10;
+
+    EASInstance easData = initInstance();
+    ASSERT_NE(easData, nullptr) << "Failed to initialize synthesizer library";
+
+    float coeffs[4];
+    const double fs = SonivoxFilterCoeffs(easData.get(), 0, 0, coeffs);
+    if (fs == 0) GTEST_SKIP() << "No filter table in this build";
+    const double nyquist = 6900 + 1200 * log2(fs / 2 / 440);
+
+    // below 0 and in the table, and above the 96 dB of the table where the resonance is computed
+    for (EAS_I32 resonance : {-5, 0, 1, 10, 75, 225, 600, 960, 961, 1000, 1500}) {
+        for (EAS_I32 cutoff = 0; cutoff <= 14000; cutoff++) {
+            double expected[4];
+            SonivoxFilterCoeffs(easData.get(), cutoff, resonance, coeffs);
+            filterCoeffs(fs, cutoff, resonance, expected);
+            const double tolerance = (cutoff < nyquist - kTableStep) ? kTolerance : kNyquistTolerance;
+            for (int i = 0; i < 4; i++) {
+                ASSERT_NEAR(coeffs[i], expected[i], tolerance)
+                    << "coefficient " << i << " at " << cutoff << " cents, resonance " << resonance;
+            }
+        }
+    }
+}
+
+TEST_P(SonivoxTest, VoiceKernelTest) {
+    EAS_I32 numBuffers = mAudioplayTimeMs * mEASConfig->sampleRate / 1000 / mEASConfig->mixBufferSize;
+
+    // the kernels chosen at note-on must sound as the generic code choosing on every block
+    EAS_I32 mismatches = SonivoxCompareVoiceKernels(mEASDataHandle);
+    if (mismatches < 0) GTEST_SKIP() << "No voice kernels in this build";
+    ASSERT_EQ(mismatches, 0) << "The voice kernels render differently from the generic code";
+
+    vector<EAS_PCM> output;
+    EAS_U32 kinds = 0;
+    ASSERT_TRUE(renderInstance(nullptr, numBuffers, output,
+                               [&](EAS_DATA_HANDLE easData) { kinds |= SonivoxVoiceKinds(easData); }));
+
+    // between them the files of the repository play every kind of voice: the built-in library
+    // filters its voices and the DLS of the mxmf file does not, and ants.mid has one-shot drums
+    static const std::map<string, EAS_U32> kExpectedKinds = {
+            {"test.mid", SONIVOX_VOICE_LOOPED | SONIVOX_VOICE_FILTERED},
+            {"ants.mid", SONIVOX_VOICE_LOOPED | SONIVOX_VOICE_ONE_SHOT | SONIVOX_VOICE_FILTERED},
+            {"testmxmf.mxmf", SONIVOX_VOICE_LOOPED | SONIVOX_VOICE_UNFILTERED},
+    };
+    auto expected = mSoundFont.empty() ? kExpectedKinds.find(get<0>(GetParam())) : kExpectedKinds.end();
+    if (expected != kExpectedKinds.end())
+        EXPECT_EQ(kinds & expected->second, expected->second) << "Not all the expected kinds of voice played";
+}
+
+#if defined(DLS_SYNTHESIZER)
+// a DLS collection whose regions overlap: the melodic program layers regions across key and
+// velocity ranges, and the drum kit has overlapping key ranges, velocity layers and a key group
+static vector<EAS_I16> layeredDLS() {
+    static constexpr int kWaveLength = 2048;
+
+    auto u16 = [](uint32_t v) { return string{char(v & 0xff), char(v >> 8 & 0xff)}; };
+    auto u32 = [&](uint32_t v) { return u16(v & 0xffff) + u16(v >> 16); };
+    auto chunk = [&](const string &tag, string data) {
+        if (data.size() & 1) data += '\0';
+        return tag + u32(data.size()) + data;
+    };
+    auto list = [&](const string &tag, const string &data) { return chunk("LIST", tag + data); };
+    auto wsmp = [&](uint32_t unityNote, bool loop) {
+        string data = u32(20) + u16(unityNote) + u16(0) + u32(0) + u32(0) + u32(loop ? 1 : 0);
+        if (loop) data += u32(16) + u32(0) + u32(0) + u32(kWaveLength);
+        return chunk("wsmp", data);
+    };
+
+    // a looped sine and a one-shot half of it, each region tuned to its own unity note
+    string wav;
+    for (int i = 0; i < kWaveLength; i++) wav += u16(uint16_t(int16_t(12000 * sin(2 * M_PI * i * 8 / kWaveLength))));
+    string fmt = u16(1) + u16(1) + u32(22050) + u32(44100) + u16(2) + u16(16);
+    const string waves[] = {list("wave", chunk("fmt ", fmt) + wsmp(60, true) + chunk("data", wav)),
+                            list("wave", chunk("fmt ", fmt) + wsmp(60, false) +
+                                                 chunk("data", wav.substr(0, wav.size() / 2)))};
+    string ptbl = u32(8) + u32(2) + u32(0) + u32(waves[0].size());
+    int unityNote = 48;
+    auto rgn = [&](uint32_t low, uint32_t high, uint32_t velLow, uint32_t velHigh, uint32_t keyGroup,
+                   uint32_t wave) {
+        return list("rgn ", chunk("rgnh", u16(low) + u16(high) + u16(velLow) + u16(velHigh) + u16(0) + u16(keyGroup)) +
+                                    wsmp(unityNote++, wave == 0) +
+                                    chunk("wlnk", u16(0) + u16(0) + u32(1) + u32(wave)));
+    };
+    auto ins = [&](uint32_t bank, const vector<string> &regions) {
+        string lrgn;
+        for (const string &region : regions) lrgn += region;
+        return list("ins ", chunk("insh", u32(regions.size()) + u32(bank) + u32(0)) + list("lrgn", lrgn));
+    };
+    string lins = ins(0, {rgn(0, 127, 0, 127, 0, 0), rgn(40, 80, 0, 63, 0, 0), rgn(60, 100, 64, 127, 0, 0),
+                          rgn(50, 70, 32, 95, 0, 0), rgn(70, 70, 0, 127, 0, 0)}) +
+                  ins(0x80000000, {rgn(35, 50, 0, 127, 0, 1), rgn(40, 60, 0, 127, 1, 1), rgn(45, 45, 0, 100, 0, 1),
+                                   rgn(45, 45, 101, 127, 0, 1), rgn(42, 46, 0, 127, 1, 1),
+                                   rgn(36, 81, 64, 127, 0, 1)});
+    string body = "DLS " + chunk("colh", u32(2)) + list("lins", lins) + chunk("ptbl", ptbl) +
+                  list("wvpl", waves[0] + waves[1]) + list("INFO", chunk("INAM", string("layered", 8)));
+    string riff = chunk("RIFF", body);
+
+    // 16-bit aligned like a mapped file
+    vector<EAS_I16> data((riff.size() + 1) / 2);
+    memcpy(data.data(), riff.data(), riff.size());
+    return data;
+}
+
+// plays layered notes and drum hits on the collection of layeredDLS, with the polyphony set when not 0,
+// calling setup once the collection is loaded, and inspect after every MIDI message and every buffer.
+// The output is left empty if setup returns false
+static void playLayered(const std::function<bool(EAS_DATA_HANDLE, EAS_DLSLIB_HANDLE)> &setup, EAS_I32 polyphony,
+                        EAS_I32 bufferSize, EAS_I32 numBuffers, vector<EAS_PCM> &output,
+                        const std::function<void(EAS_DATA_HANDLE)> &inspect = nullptr) {
+    static constexpr EAS_I32 kNotesPerBuffer = 3;
+    static constexpr EAS_I32 kHoldBuffers = 16;
+
+    output.clear();
+    EAS_DATA_HANDLE easData;
+    ASSERT_EQ(EAS_Init(&easData), EAS_SUCCESS);
+    if (polyphony > 0) ASSERT_EQ(EAS_SetSynthPolyphony(easData, 0, polyphony), EAS_SUCCESS);
+
+    // the collection stays mapped until the instance is shut down
+    vector<EAS_I16> dls = layeredDLS();
+    EAS_DLSLIB_HANDLE pDLS = nullptr;
+    ASSERT_EQ(EAS_LoadDLSCollectionMapped(easData, dls.data(), dls.size() * sizeof(EAS_I16), &pDLS), EAS_SUCCESS);
+    if (setup && !setup(easData, pDLS)) {
+        EXPECT_EQ(EAS_ReleaseDLSCollection(pDLS), EAS_SUCCESS);
+        EXPECT_EQ(EAS_Shutdown(easData), EAS_SUCCESS);
+        return;
+    }
+    ASSERT_EQ(EAS_SetDLSCollection(easData, nullptr, pDLS), EAS_SUCCESS);
+    EXPECT_EQ(EAS_ReleaseDLSCollection(pDLS), EAS_SUCCESS);
+
+    EAS_HANDLE stream;
+    ASSERT_EQ(EAS_OpenMIDIStream(easData, &stream, nullptr), EAS_SUCCESS);
+
+    // the same pseudo-random notes on every run, each released kHoldBuffers later
+    uint32_t seed = 1;
+    auto next = [&](uint32_t range) {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 16) % range;
+    };
+    vector<EAS_U8> notes(numBuffers * kNotesPerBuffer * 2);
+    output.assign(bufferSize * numBuffers * numChannels, 0);
+    EAS_I32 count;
+    for (EAS_I32 i = 0; i < numBuffers; i++) {
+        vector<EAS_U8> midi;
+        for (EAS_I32 n = 0; n < kNotesPerBuffer; n++) {
+            EAS_U8 status = next(2) ? 0x90 : 0x99;
+            EAS_U8 note = status == 0x90 ? 30 + next(80) : 33 + next(50);
+            midi.insert(midi.end(), {status, note, EAS_U8(1 + next(127))});
+            notes[(i * kNotesPerBuffer + n) * 2] = status;
+            notes[(i * kNotesPerBuffer + n) * 2 + 1] = note;
+        }
+        for (EAS_I32 n = 0; i >= kHoldBuffers && n < kNotesPerBuffer; n++) {
+            const EAS_U8 *pNote = &notes[((i - kHoldBuffers) * kNotesPerBuffer + n) * 2];
+            midi.insert(midi.end(), {EAS_U8(pNote[0] - 0x10), pNote[1], 64});
+        }
+        for (size_t m = 0; m < midi.size(); m += 3) {
+            ASSERT_EQ(EAS_WriteMIDIStream(easData, stream, &midi[m], 3), EAS_SUCCESS);
+            if (inspect) inspect(easData);
+        }
+        ASSERT_EQ(EAS_Render(easData, &output[i * bufferSize * numChannels], bufferSize, &count), EAS_SUCCESS);
+        if (inspect) inspect(easData);
+    }
+    EXPECT_EQ(EAS_CloseMIDIStream(easData, stream), EAS_SUCCESS);
+    EXPECT_EQ(EAS_Shutdown(easData), EAS_SUCCESS);
+}
+
+TEST_P(SonivoxTest, NoteIndexTest) {
+    static constexpr EAS_I32 kNumBuffers = 256;
+    static constexpr EAS_I32 kLowPolyphony = 8;
+
+    // the regions the note index starts must sound as the regions found by walking the program,
+    // also when the layers steal voices from each other
+    EAS_I32 bufferSize = mEASConfig->mixBufferSize;
+    for (EAS_I32 polyphony : {0, kLowPolyphony}) {
+        vector<EAS_PCM> output, reference;
+        ASSERT_NO_FATAL_FAILURE(playLayered(nullptr, polyphony, bufferSize, kNumBuffers, output));
+        ASSERT_NO_FATAL_FAILURE(playLayered(SonivoxDropNoteIndex, polyphony, bufferSize, kNumBuffers, reference));
+        ASSERT_FALSE(reference.empty()) << "The layered collection has no note index";
+        ASSERT_TRUE(any_of(output.begin(), output.end(), [](EAS_PCM s) { return s != 0; }))
+            << "Layered collection is silent";
+        ASSERT_TRUE(output == reference) << "polyphony " << polyphony
+                                         << ": the note index starts other regions than the region walk";
+    }
+}
+
+TEST_P(SonivoxTest, VoiceListTest) {
+    static constexpr EAS_I32 kNumBuffers = 256;
+    static constexpr EAS_I32 kLowPolyphony = 8;
+
+    // voices taken from the free voice mask and rendered in list order must sound as voices found
+    // by scanning and rendered in voice number order, with the lists matching the voice states
+    EAS_I32 bufferSize = mEASConfig->mixBufferSize;
+    for (EAS_I32 polyphony : {0, kLowPolyphony}) {
+        vector<EAS_PCM> output, reference;
+        EAS_I32 mismatches = 0;
+        EAS_I32 maxVoices = 0;
+        EAS_I32 synthPolyphony = 0;
+        auto inspect = [&](EAS_DATA_HANDLE easData) {
+            mismatches += SonivoxCheckVoiceLists(easData);
+            maxVoices = std::max(maxVoices, SonivoxActiveVoices(easData));
+            EXPECT_EQ(EAS_GetSynthPolyphony(easData, 0, &synthPolyphony), EAS_SUCCESS);
+        };
+        ASSERT_NO_FATAL_FAILURE(playLayered(nullptr, polyphony, bufferSize, kNumBuffers, output, inspect));
+        EXPECT_EQ(mismatches, 0) << "polyphony " << polyphony << ": voice lists do not match the voice states";
+        if (polyphony > 0) {
+            EXPECT_GE(maxVoices, synthPolyphony) << "polyphony " << polyphony << ": not all the voices played";
+        }
+        ASSERT_NO_FATAL_FAILURE(playLayered(
+                [](EAS_DATA_HANDLE easData, EAS_DLSLIB_HANDLE) {
+                    return SonivoxDisableRenderPath(easData, SONIVOX_PATH_VOICE_LIST);
+                },
+                polyphony, bufferSize, kNumBuffers, reference, inspect));
+        if (reference.empty()) GTEST_SKIP() << "Render path not in this build";
+        EXPECT_EQ(mismatches, 0) << "polyphony " << polyphony << ": voice scan breaks the voice lists";
+        ASSERT_TRUE(output == reference) << "polyphony " << polyphony
+                                         << ": the voice list renders differently from the voice scan";
+    }
+}
+
+TEST_P(SonivoxTest, StealTreeTest) {
+    static constexpr EAS_I32 kNumBuffers = 256;
+    static constexpr EAS_I32 kLowPolyphony = 8;
+
+    // whenever a note starts or stops, the tournament tree must pick the voice the priority scan picks,
+    // with the layered notes and drum hits going over the polyphony
+    EAS_I32 bufferSize = mEASConfig->mixBufferSize;
+    for (EAS_I32 polyphony : {0, kLowPolyphony}) {
+        vector<EAS_PCM> output;
+        EAS_I32 stolen = 0;
+        EAS_I32 mismatches = 0;
+        auto inspect = [&](EAS_DATA_HANDLE easData) {
+            stolen += SonivoxStolenVoices(easData);
+            mismatches += SonivoxCheckStealTree(easData);
+        };
+        ASSERT_NO_FATAL_FAILURE(playLayered(nullptr, polyphony, bufferSize, kNumBuffers, output, inspect));
+        EXPECT_GT(stolen, 0) << "polyphony " << polyphony << ": no voice was stolen";
+        EXPECT_EQ(mismatches, 0) << "polyphony " << polyphony
+                                 << ": the steal tree steals other voices than the priority scan";
+    }
+}
+
+#endif  // DLS_SYNTHESIZER
+
 INSTANTIATE_TEST_SUITE_P(SonivoxTest1,
                          SonivoxTest,
                          ::testing::Values(make_tuple("test.mid", 2400, ""),